@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * libds :: arena_bench.c
+ *
+ * Benchmarks for DSArena.
+ *
+ * Simulates request handlers which build a handful of containers that
+ * all die together at the end of the request, comparing individually
+ * destroying each container against resetting an arena.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "libds/arena.h"
+#include "libds/array.h"
+#include "libds/buffer.h"
+#include "libds/dict.h"
+#include "libds/list.h"
+#include "bench.h"
+#include "arena_bench.h"
+
+enum {
+    ARENA_BENCH_REQUESTS = 2000,
+    ARENA_BENCH_CONTAINERS = 4,
+    ARENA_BENCH_ELEMENTS = 64,
+};
+
+struct request {
+    DSArray *arrays[ARENA_BENCH_CONTAINERS];
+    DSList *lists[ARENA_BENCH_CONTAINERS];
+    DSDict *dicts[ARENA_BENCH_CONTAINERS];
+};
+
+static void build_request(struct request *req, const DSAllocator *alloc);
+static void destroy_request(struct request *req);
+
+void arena_bench(void) {
+    struct request req;
+    double build = 0;
+    double teardown = 0;
+
+    for (int i = 0; i < ARENA_BENCH_REQUESTS; i++) {
+        double start = bench_now();
+        build_request(&req, NULL);
+        double mid = bench_now();
+        destroy_request(&req);
+        double end = bench_now();
+        build += (mid - start);
+        teardown += (end - mid);
+    }
+    bench_report("malloc build (per request)", build, ARENA_BENCH_REQUESTS);
+    bench_report("malloc teardown (per request)", teardown, ARENA_BENCH_REQUESTS);
+
+    DSArena *arena = dsarena_new(0);
+    if (!arena) {
+        fprintf(stderr, "could not create arena\n");
+        return;
+    }
+
+    build = 0;
+    teardown = 0;
+    for (int i = 0; i < ARENA_BENCH_REQUESTS; i++) {
+        double start = bench_now();
+        build_request(&req, dsarena_allocator(arena));
+        double mid = bench_now();
+        dsarena_reset(arena);
+        double end = bench_now();
+        build += (mid - start);
+        teardown += (end - mid);
+    }
+    bench_report("arena build (per request)", build, ARENA_BENCH_REQUESTS);
+    bench_report("arena teardown (per request)", teardown, ARENA_BENCH_REQUESTS);
+
+    dsarena_destroy(arena);
+}
+
+// Build every container for one request. Keys are owned by the dictionaries
+// unless the request is allocated from an arena.
+static void build_request(struct request *req, const DSAllocator *alloc) {
+    for (int c = 0; c < ARENA_BENCH_CONTAINERS; c++) {
+        req->arrays[c] = dsarray_new_alloc(DSARRAY_DEFAULT_CAPACITY, NULL, NULL, alloc);
+        req->lists[c] = dslist_new_alloc(NULL, NULL, alloc);
+        req->dicts[c] = dsdict_new_alloc((dsdict_hash_fn) dsbuf_hash,
+                                         (dsdict_compare_fn) dsbuf_compare,
+                                         (alloc) ? NULL : (dsdict_free_fn) dsbuf_destroy,
+                                         NULL, DSDICT_CHAINED, alloc);
+
+        for (int i = 0; i < ARENA_BENCH_ELEMENTS; i++) {
+            char key[32];
+            snprintf(key, sizeof(key), "request key %d", i);
+            DSBuffer *buf = dsbuf_new_buffer_alloc(0, alloc);
+            dsbuf_append_str(buf, key);
+            dsarray_append(req->arrays[c], buf);
+            dslist_append(req->lists[c], buf);
+            dsdict_put(req->dicts[c], buf, buf);
+        }
+        bench_sink += dsdict_count(req->dicts[c]);
+    }
+}
+
+// Destroy every container for one request individually.
+static void destroy_request(struct request *req) {
+    for (int c = 0; c < ARENA_BENCH_CONTAINERS; c++) {
+        dsarray_destroy(req->arrays[c]);
+        dslist_destroy(req->lists[c]);
+        dsdict_destroy(req->dicts[c]);
+    }
+}
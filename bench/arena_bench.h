@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: arena_bench.h
+ *
+ * Benchmarks for DSArena.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_ARENA_BENCH_H
+#define LIBDS_ARENA_BENCH_H
+
+void arena_bench(void);
+
+#endif //LIBDS_ARENA_BENCH_H
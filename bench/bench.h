@@ -0,0 +1,37 @@
+/*****************************************************************************
+ * libds :: bench.h
+ *
+ * Timing helpers shared by the benchmark routines.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_BENCH_H
+#define LIBDS_BENCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Benchmarks accumulate results into this value so the compiler cannot
+ * discard the work being measured.
+ */
+extern volatile size_t bench_sink;
+
+// Return a monotonic timestamp in seconds.
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+// Print the total time and time per operation for a benchmark.
+static inline void bench_report(const char *name, double secs, size_t ops) {
+    printf("  %-44s %10.2f ms %12.1f ns/op\n",
+           name, secs * 1e3, (ops > 0) ? ((secs * 1e9) / (double)ops) : 0.0);
+}
+
+#endif //LIBDS_BENCH_H
@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * libds :: cdict_bench.c
+ *
+ * Benchmarks for DSConcurrentDict.
+ *
+ * Compares read throughput of a sharded DSConcurrentDict and a lock-free
+ * DSReadDict against a single DSDict guarded by one global mutex as the
+ * number of reader threads grows. Set LIBDS_BENCH_THREADS in the environment to change the largest
+ * number of threads (32 by default).
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libds/cdict.h"
+#include "libds/dict.h"
+#include "libds/hash.h"
+#include "libds/rdict.h"
+#include "bench.h"
+#include "cdict_bench.h"
+
+static const size_t CDICT_BENCH_KEYS = ((size_t)1 << 20);
+static const size_t CDICT_BENCH_LOOKUPS = ((size_t)1 << 19);
+static const size_t CDICT_BENCH_DEFAULT_THREADS = 32;
+
+struct cdict_bench_reader {
+    DSConcurrentDict *cdict;
+    DSDict *dict;
+    DSReadDict *rdict;
+    pthread_mutex_t *lock;
+    uint64_t *keys;
+    uint64_t seed;
+    size_t found;
+};
+
+static uint32_t cdict_bench_hash(void *key);
+static int cdict_bench_compare(const void *left, const void *right);
+static size_t cdict_bench_threads(void);
+static double cdict_bench_run(struct cdict_bench_reader *readers, size_t nthreads, void *(*fn)(void *));
+static void *cdict_bench_sharded(void *arg);
+static void *cdict_bench_locked(void *arg);
+static void *cdict_bench_rcu(void *arg);
+
+void cdict_bench(void) {
+    uint64_t *keys = malloc(CDICT_BENCH_KEYS * sizeof(uint64_t));
+    size_t maxthreads = cdict_bench_threads();
+    struct cdict_bench_reader *readers = malloc(maxthreads * sizeof(struct cdict_bench_reader));
+    DSConcurrentDict *cdict = dscdict_new(cdict_bench_hash, cdict_bench_compare, NULL, NULL,
+                                          DSDICT_OPEN_ADDRESSING, 0);
+    DSDict *dict = dsdict_new_cap(CDICT_BENCH_KEYS, cdict_bench_hash, cdict_bench_compare, NULL, NULL,
+                                  DSDICT_OPEN_ADDRESSING, NULL);
+    DSReadDict *rdict = dsrdict_new(cdict_bench_hash, cdict_bench_compare, NULL, NULL);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    if ((!keys) || (!readers) || (!cdict) || (!dict) || (!rdict)) {
+        fprintf(stderr, "could not allocate concurrent dict benchmark\n");
+        goto cleanup_cdict_bench;
+    }
+
+    for (size_t i = 0; i < CDICT_BENCH_KEYS; i++) {
+        keys[i] = (uint64_t)i * 0x9E3779B97F4A7C15ull;
+        dscdict_put(cdict, &keys[i], &keys[i]);
+        dsdict_put(dict, &keys[i], &keys[i]);
+        dsrdict_put(rdict, &keys[i], &keys[i]);
+    }
+
+    printf("  (%zu keys, %zu lookups per thread, %zu shards)\n",
+           CDICT_BENCH_KEYS, CDICT_BENCH_LOOKUPS, dscdict_shards(cdict));
+    for (size_t n = 1; n <= maxthreads; n *= 2) {
+        for (size_t t = 0; t < n; t++) {
+            readers[t].cdict = cdict;
+            readers[t].dict = dict;
+            readers[t].rdict = rdict;
+            readers[t].lock = &lock;
+            readers[t].keys = keys;
+            readers[t].seed = 0x853c49e6748fea9bull + t;
+            readers[t].found = 0;
+        }
+
+        char name[64];
+        double secs = cdict_bench_run(readers, n, cdict_bench_sharded);
+        snprintf(name, sizeof(name), "sharded dscdict_get, %zu threads", n);
+        bench_report(name, secs, CDICT_BENCH_LOOKUPS * n);
+
+        secs = cdict_bench_run(readers, n, cdict_bench_rcu);
+        snprintf(name, sizeof(name), "read-mostly dsrdict_get, %zu threads", n);
+        bench_report(name, secs, CDICT_BENCH_LOOKUPS * n);
+
+        secs = cdict_bench_run(readers, n, cdict_bench_locked);
+        snprintf(name, sizeof(name), "global mutex dsdict_get, %zu threads", n);
+        bench_report(name, secs, CDICT_BENCH_LOOKUPS * n);
+    }
+
+cleanup_cdict_bench:
+    dscdict_destroy(cdict);
+    dsdict_destroy(dict);
+    dsrdict_destroy(rdict);
+    free(readers);
+    free(keys);
+}
+
+// Run the given reader in nthreads threads at once and return the wall
+// clock time until they have all finished.
+static double cdict_bench_run(struct cdict_bench_reader *readers, size_t nthreads, void *(*fn)(void *)) {
+    pthread_t threads[nthreads];
+    size_t started = 0;
+
+    double start = bench_now();
+    for (size_t t = 0; t < nthreads; t++) {
+        if (pthread_create(&threads[t], NULL, fn, &readers[t]) != 0) {
+            fprintf(stderr, "could not start thread %zu\n", t);
+            break;
+        }
+        started++;
+    }
+    for (size_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        bench_sink += readers[t].found;
+    }
+    return bench_now() - start;
+}
+
+// Look up random keys in the sharded dictionary.
+static void *cdict_bench_sharded(void *arg) {
+    struct cdict_bench_reader *reader = arg;
+    uint64_t state = reader->seed;
+    for (size_t i = 0; i < CDICT_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t *key = &reader->keys[(state >> 33) % CDICT_BENCH_KEYS];
+        reader->found += (dscdict_get(reader->cdict, key) != NULL);
+    }
+    return NULL;
+}
+
+// Look up random keys in a single dictionary behind one global mutex.
+static void *cdict_bench_locked(void *arg) {
+    struct cdict_bench_reader *reader = arg;
+    uint64_t state = reader->seed;
+    for (size_t i = 0; i < CDICT_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t *key = &reader->keys[(state >> 33) % CDICT_BENCH_KEYS];
+        pthread_mutex_lock(reader->lock);
+        reader->found += (dsdict_get(reader->dict, key) != NULL);
+        pthread_mutex_unlock(reader->lock);
+    }
+    return NULL;
+}
+
+// Look up random keys in the read-mostly dictionary inside one read
+// section per thread.
+static void *cdict_bench_rcu(void *arg) {
+    struct cdict_bench_reader *reader = arg;
+    DSReadDictReader *handle = dsrdict_reader_new(reader->rdict);
+    if (!handle) {
+        return NULL;
+    }
+
+    uint64_t state = reader->seed;
+    dsrdict_read_begin(handle);
+    for (size_t i = 0; i < CDICT_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t *key = &reader->keys[(state >> 33) % CDICT_BENCH_KEYS];
+        reader->found += (dsrdict_get(handle, key) != NULL);
+    }
+    dsrdict_read_end(handle);
+
+    dsrdict_reader_destroy(handle);
+    return NULL;
+}
+
+// Read the largest number of threads from the environment, if given.
+static size_t cdict_bench_threads(void) {
+    const char *env = getenv("LIBDS_BENCH_THREADS");
+    if (env) {
+        unsigned long n = strtoul(env, NULL, 10);
+        if (n > 0) {
+            return (size_t)n;
+        }
+    }
+    return CDICT_BENCH_DEFAULT_THREADS;
+}
+
+static uint32_t cdict_bench_hash(void *key) {
+    return (uint32_t)hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static int cdict_bench_compare(const void *left, const void *right) {
+    uint64_t l = *(const uint64_t *)left;
+    uint64_t r = *(const uint64_t *)right;
+    return (l < r) ? -1 : (l > r);
+}
@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: cdict_bench.h
+ *
+ * Benchmarks for DSConcurrentDict.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_CDICT_BENCH_H
+#define LIBDS_CDICT_BENCH_H
+
+void cdict_bench(void);
+
+#endif //LIBDS_CDICT_BENCH_H
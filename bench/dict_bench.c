@@ -0,0 +1,166 @@
+/*****************************************************************************
+ * libds :: dict_bench.c
+ *
+ * Benchmarks for DSDict.
+ *
+ * Tables are sized to be larger than the last level cache by default, so
+ * lookups are dominated by memory latency. Set LIBDS_BENCH_DICT_KEYS in
+ * the environment to change the number of keys.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libds/dict.h"
+#include "libds/hash.h"
+#include "libds/iter.h"
+#include "bench.h"
+#include "dict_bench.h"
+
+static const size_t DICT_BENCH_DEFAULT_KEYS = ((size_t)1 << 23);
+static const size_t DICT_BENCH_LOOKUPS = ((size_t)1 << 22);
+
+enum { DICT_BENCH_BATCH = 64 };
+
+static uint32_t dict_bench_hash(void *key);
+static int dict_bench_compare(const void *left, const void *right);
+static size_t dict_bench_keys(void);
+static void dict_bench_engine(const char *engine, int flags, uint64_t *keys, size_t nkeys, void **probes);
+
+void dict_bench(void) {
+    size_t nkeys = dict_bench_keys();
+    uint64_t *keys = malloc(nkeys * sizeof(uint64_t));
+    void **probes = malloc(DICT_BENCH_LOOKUPS * sizeof(void *));
+    if ((!keys) || (!probes)) {
+        fprintf(stderr, "could not allocate dict benchmark keys\n");
+        free(keys);
+        free(probes);
+        return;
+    }
+
+    // Random probe order defeats both the hardware prefetcher and any
+    // locality from insertion order
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (size_t i = 0; i < nkeys; i++) {
+        keys[i] = (uint64_t)i * 0x9E3779B97F4A7C15ull;
+    }
+    for (size_t i = 0; i < DICT_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        probes[i] = &keys[(state >> 33) % nkeys];
+    }
+
+    printf("  (%zu keys, %zu random lookups)\n", nkeys, DICT_BENCH_LOOKUPS);
+    dict_bench_engine("chained", DSDICT_CHAINED, keys, nkeys, probes);
+    dict_bench_engine("open addressing", DSDICT_OPEN_ADDRESSING, keys, nkeys, probes);
+    dict_bench_engine("ordered", DSDICT_ORDERED, keys, nkeys, probes);
+    dict_bench_engine("cuckoo", DSDICT_CUCKOO, keys, nkeys, probes);
+
+    free(keys);
+    free(probes);
+}
+
+// Compare single and batched puts and lookups for one dictionary engine.
+static void dict_bench_engine(const char *engine, int flags, uint64_t *keys, size_t nkeys, void **probes) {
+    char name[64];
+    DSDict *dict = dsdict_new_flags(dict_bench_hash, dict_bench_compare, NULL, NULL, flags);
+    if (!dict) {
+        fprintf(stderr, "could not create dict\n");
+        return;
+    }
+
+    double start = bench_now();
+    for (size_t i = 0; i < nkeys; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_put", engine);
+    bench_report(name, bench_now() - start, nkeys);
+    dsdict_destroy(dict);
+
+    start = bench_now();
+    dict = dsdict_new_cap(nkeys, dict_bench_hash, dict_bench_compare, NULL, NULL, flags, NULL);
+    if (!dict) {
+        fprintf(stderr, "could not create dict\n");
+        return;
+    }
+    for (size_t i = 0; i < nkeys; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_put (pre-sized)", engine);
+    bench_report(name, bench_now() - start, nkeys);
+    dsdict_destroy(dict);
+
+    dict = dsdict_new_flags(dict_bench_hash, dict_bench_compare, NULL, NULL, flags);
+    if (!dict) {
+        fprintf(stderr, "could not create dict\n");
+        return;
+    }
+
+    void *batch[DICT_BENCH_BATCH];
+    start = bench_now();
+    for (size_t i = 0; i < nkeys; i += DICT_BENCH_BATCH) {
+        size_t n = ((nkeys - i) < DICT_BENCH_BATCH) ? (nkeys - i) : DICT_BENCH_BATCH;
+        for (size_t j = 0; j < n; j++) {
+            batch[j] = &keys[i + j];
+        }
+        dsdict_put_many(dict, batch, batch, n);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_put_many", engine);
+    bench_report(name, bench_now() - start, nkeys);
+
+    start = bench_now();
+    for (size_t i = 0; i < DICT_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsdict_get(dict, probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_get", engine);
+    bench_report(name, bench_now() - start, DICT_BENCH_LOOKUPS);
+
+    void *vals[DICT_BENCH_BATCH];
+    start = bench_now();
+    for (size_t i = 0; i < DICT_BENCH_LOOKUPS; i += DICT_BENCH_BATCH) {
+        size_t n = ((DICT_BENCH_LOOKUPS - i) < DICT_BENCH_BATCH) ? (DICT_BENCH_LOOKUPS - i) : DICT_BENCH_BATCH;
+        bench_sink += dsdict_get_many(dict, &probes[i], n, vals);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_get_many (%d)", engine, DICT_BENCH_BATCH);
+    bench_report(name, bench_now() - start, DICT_BENCH_LOOKUPS);
+
+    // Iteration visits every element once; its cost depends on how much
+    // empty table each engine has to step over to find them
+    DSIter *iter = dsdict_iter(dict);
+    if (iter) {
+        start = bench_now();
+        while (dsiter_next(iter)) {
+            bench_sink += (uintptr_t)dsiter_value(iter);
+        }
+        snprintf(name, sizeof(name), "%s dsiter_next", engine);
+        bench_report(name, bench_now() - start, dsdict_count(dict));
+        dsiter_destroy(iter);
+    }
+
+    dsdict_destroy(dict);
+}
+
+// Read the number of keys from the environment, if given.
+static size_t dict_bench_keys(void) {
+    const char *env = getenv("LIBDS_BENCH_DICT_KEYS");
+    if (env) {
+        unsigned long long n = strtoull(env, NULL, 10);
+        if (n > 0) {
+            return (size_t)n;
+        }
+    }
+    return DICT_BENCH_DEFAULT_KEYS;
+}
+
+static uint32_t dict_bench_hash(void *key) {
+    return (uint32_t)hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static int dict_bench_compare(const void *left, const void *right) {
+    uint64_t l = *(const uint64_t *)left;
+    uint64_t r = *(const uint64_t *)right;
+    return (l < r) ? -1 : (l > r);
+}
@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: dict_bench.h
+ *
+ * Benchmarks for DSDict.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_DICT_BENCH_H
+#define LIBDS_DICT_BENCH_H
+
+void dict_bench(void);
+
+#endif //LIBDS_DICT_BENCH_H
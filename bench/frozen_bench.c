@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * libds :: frozen_bench.c
+ *
+ * Benchmarks for DSFrozenDict.
+ *
+ * Compares the startup cost of rebuilding a DSDict from scratch with
+ * opening a frozen dictionary file and serving the first lookup, then
+ * compares random lookups against both.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "libds/dict.h"
+#include "libds/frozen.h"
+#include "libds/hash.h"
+#include "bench.h"
+#include "frozen_bench.h"
+
+static const size_t FROZEN_BENCH_KEYS = ((size_t)1 << 20);
+static const size_t FROZEN_BENCH_LOOKUPS = ((size_t)1 << 22);
+
+static uint32_t frozen_bench_hash(void *key);
+static int frozen_bench_compare(const void *left, const void *right);
+static const void *frozen_bench_serialize(const void *obj, size_t *len);
+
+void frozen_bench(void) {
+    char name[64];
+    char path[] = "/tmp/libds_frozen_bench_XXXXXX";
+    uint64_t *keys = malloc(FROZEN_BENCH_KEYS * sizeof(uint64_t));
+    uint64_t **probes = malloc(FROZEN_BENCH_LOOKUPS * sizeof(uint64_t *));
+    DSDict *dict = NULL;
+    DSFrozenDict *frozen = NULL;
+    int fd = mkstemp(path);
+    if ((!keys) || (!probes) || (fd < 0)) {
+        fprintf(stderr, "could not allocate frozen dict benchmark\n");
+        goto cleanup_frozen_bench;
+    }
+    close(fd);
+
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (size_t i = 0; i < FROZEN_BENCH_KEYS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        keys[i] = state;
+    }
+    for (size_t i = 0; i < FROZEN_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        probes[i] = &keys[(state >> 33) % FROZEN_BENCH_KEYS];
+    }
+
+    printf("  (%zu keys, %zu random lookups)\n", FROZEN_BENCH_KEYS, FROZEN_BENCH_LOOKUPS);
+    double start = bench_now();
+    dict = dsdict_new_flags(frozen_bench_hash, frozen_bench_compare, NULL, NULL, DSDICT_OPEN_ADDRESSING);
+    if (!dict) {
+        fprintf(stderr, "could not allocate frozen dict benchmark\n");
+        goto cleanup_frozen_bench;
+    }
+    for (size_t i = 0; i < FROZEN_BENCH_KEYS; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    bench_sink += (dsdict_get(dict, probes[0]) != NULL);
+    snprintf(name, sizeof(name), "dsdict build + first get");
+    bench_report(name, bench_now() - start, 1);
+
+    start = bench_now();
+    if (!dsdict_freeze_to_file(dict, path, frozen_bench_serialize, frozen_bench_serialize)) {
+        fprintf(stderr, "could not write frozen dict benchmark file\n");
+        goto cleanup_frozen_bench;
+    }
+    snprintf(name, sizeof(name), "dsdict_freeze_to_file");
+    bench_report(name, bench_now() - start, FROZEN_BENCH_KEYS);
+
+    start = bench_now();
+    frozen = dsfrozen_open(path);
+    if (!frozen) {
+        fprintf(stderr, "could not open frozen dict benchmark file\n");
+        goto cleanup_frozen_bench;
+    }
+    bench_sink += (dsfrozen_get(frozen, probes[0], sizeof(uint64_t), NULL) != NULL);
+    snprintf(name, sizeof(name), "dsfrozen_open + first get");
+    bench_report(name, bench_now() - start, 1);
+
+    start = bench_now();
+    for (size_t i = 0; i < FROZEN_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsdict_get(dict, probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "dsdict_get");
+    bench_report(name, bench_now() - start, FROZEN_BENCH_LOOKUPS);
+
+    start = bench_now();
+    for (size_t i = 0; i < FROZEN_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsfrozen_get(frozen, probes[i], sizeof(uint64_t), NULL) != NULL);
+    }
+    snprintf(name, sizeof(name), "dsfrozen_get");
+    bench_report(name, bench_now() - start, FROZEN_BENCH_LOOKUPS);
+
+cleanup_frozen_bench:
+    dsfrozen_close(frozen);
+    dsdict_destroy(dict);
+    if (fd >= 0) { unlink(path); }
+    free(probes);
+    free(keys);
+}
+
+static uint32_t frozen_bench_hash(void *key) {
+    return (uint32_t)hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static int frozen_bench_compare(const void *left, const void *right) {
+    uint64_t l = *(const uint64_t *)left;
+    uint64_t r = *(const uint64_t *)right;
+    return (l < r) ? -1 : (l > r);
+}
+
+// Keys and values are both the 8 bytes of an ID.
+static const void *frozen_bench_serialize(const void *obj, size_t *len) {
+    *len = sizeof(uint64_t);
+    return obj;
+}
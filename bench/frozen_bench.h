@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: frozen_bench.h
+ *
+ * Benchmarks for DSFrozenDict.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_FROZEN_BENCH_H
+#define LIBDS_FROZEN_BENCH_H
+
+void frozen_bench(void);
+
+#endif //LIBDS_FROZEN_BENCH_H
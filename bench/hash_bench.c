@@ -0,0 +1,70 @@
+/*****************************************************************************
+ * libds :: hash_bench.c
+ *
+ * Benchmarks for hashing algorithms.
+ *
+ * Each hash function is run over keys of several lengths which are
+ * representative of short identifiers, URLs, headers and larger buffers.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libds/hash.h"
+#include "bench.h"
+#include "hash_bench.h"
+
+static const size_t HASH_BENCH_LENGTHS[] = { 8, 32, 256, 4096 };
+static const size_t HASH_BENCH_BYTES = (64 * 1024 * 1024);
+
+void hash_bench(void) {
+    size_t maxlen = 4096;
+    char *key = malloc(maxlen + 1);
+    if (!key) {
+        fprintf(stderr, "could not allocate hash key\n");
+        return;
+    }
+
+    size_t nlens = sizeof(HASH_BENCH_LENGTHS) / sizeof(HASH_BENCH_LENGTHS[0]);
+    for (size_t l = 0; l < nlens; l++) {
+        size_t len = HASH_BENCH_LENGTHS[l];
+        size_t iters = HASH_BENCH_BYTES / len;
+        char name[64];
+
+        // String hashes stop at the first NUL, so keys must not contain any
+        for (size_t i = 0; i < len; i++) {
+            key[i] = (char)('a' + (i % 26));
+        }
+        key[len] = '\0';
+
+        double start = bench_now();
+        for (size_t i = 0; i < iters; i++) {
+            key[0] = (char)('a' + (i % 26));
+            bench_sink += hash_fnv1(key);
+        }
+        snprintf(name, sizeof(name), "hash_fnv1 (%zu bytes)", len);
+        bench_report(name, bench_now() - start, iters);
+
+        start = bench_now();
+        for (size_t i = 0; i < iters; i++) {
+            key[0] = (char)('a' + (i % 26));
+            bench_sink += (size_t)hash_wyhash(key, len, 0);
+        }
+        snprintf(name, sizeof(name), "hash_wyhash (%zu bytes)", len);
+        bench_report(name, bench_now() - start, iters);
+
+        start = bench_now();
+        for (size_t i = 0; i < iters; i++) {
+            key[0] = (char)('a' + (i % 26));
+            bench_sink += hash_crc32c(key, len, 0);
+        }
+        snprintf(name, sizeof(name), "hash_crc32c (%zu bytes)", len);
+        bench_report(name, bench_now() - start, iters);
+    }
+
+    free(key);
+}
@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: hash_bench.h
+ *
+ * Benchmarks for hashing algorithms.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_HASH_BENCH_H
+#define LIBDS_HASH_BENCH_H
+
+void hash_bench(void);
+
+#endif //LIBDS_HASH_BENCH_H
@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * libds :: idict_bench.c
+ *
+ * Benchmarks for DSIntDict.
+ *
+ * Compares puts and lookups of 64-bit IDs in a DSIntDict against an open
+ * addressing DSDict with boxed keys and hash and compare callbacks and a
+ * dictionary generated by LIBDS_DEFINE_DICT, for a table which fits in
+ * cache and one which does not.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libds/dict.h"
+#include "libds/generic.h"
+#include "libds/hash.h"
+#include "libds/idict.h"
+#include "bench.h"
+#include "idict_bench.h"
+
+#define IDICT_BENCH_FOLD(key) ((uint32_t)((key) ^ ((key) >> 32)))
+#define IDICT_BENCH_EQ(left, right) ((left) == (right))
+LIBDS_DEFINE_DICT(idict_bench_map, uint64_t, void *, IDICT_BENCH_FOLD, IDICT_BENCH_EQ)
+
+static const size_t IDICT_BENCH_LOOKUPS = ((size_t)1 << 22);
+
+static uint32_t idict_bench_hash(void *key);
+static int idict_bench_compare(const void *left, const void *right);
+static void idict_bench_size(size_t nkeys);
+
+void idict_bench(void) {
+    idict_bench_size((size_t)1 << 12);
+    idict_bench_size((size_t)1 << 22);
+}
+
+// Compare both dictionaries holding nkeys random IDs.
+static void idict_bench_size(size_t nkeys) {
+    char name[64];
+    uint64_t *keys = malloc(nkeys * sizeof(uint64_t));
+    uint64_t **probes = malloc(IDICT_BENCH_LOOKUPS * sizeof(uint64_t *));
+    DSIntDict *idict = dsidict_new(NULL);
+    DSDict *dict = dsdict_new_flags(idict_bench_hash, idict_bench_compare, NULL, NULL, DSDICT_OPEN_ADDRESSING);
+    idict_bench_map map;
+    bool mapok = idict_bench_map_init(&map);
+    if ((!keys) || (!probes) || (!idict) || (!dict) || (!mapok)) {
+        fprintf(stderr, "could not allocate int dict benchmark\n");
+        goto cleanup_idict_bench;
+    }
+
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (size_t i = 0; i < nkeys; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        keys[i] = state;
+    }
+    for (size_t i = 0; i < IDICT_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        probes[i] = &keys[(state >> 33) % nkeys];
+    }
+
+    printf("  (%zu keys, %zu random lookups)\n", nkeys, IDICT_BENCH_LOOKUPS);
+    double start = bench_now();
+    for (size_t i = 0; i < nkeys; i++) {
+        dsidict_put(idict, keys[i], &keys[i]);
+    }
+    snprintf(name, sizeof(name), "dsidict_put");
+    bench_report(name, bench_now() - start, nkeys);
+
+    start = bench_now();
+    for (size_t i = 0; i < nkeys; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    snprintf(name, sizeof(name), "boxed dsdict_put");
+    bench_report(name, bench_now() - start, nkeys);
+
+    start = bench_now();
+    for (size_t i = 0; i < nkeys; i++) {
+        idict_bench_map_put(&map, keys[i], &keys[i]);
+    }
+    snprintf(name, sizeof(name), "generated dict put");
+    bench_report(name, bench_now() - start, nkeys);
+
+    start = bench_now();
+    for (size_t i = 0; i < IDICT_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsidict_get(idict, *probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "dsidict_get");
+    bench_report(name, bench_now() - start, IDICT_BENCH_LOOKUPS);
+
+    start = bench_now();
+    for (size_t i = 0; i < IDICT_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsdict_get(dict, probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "boxed dsdict_get");
+    bench_report(name, bench_now() - start, IDICT_BENCH_LOOKUPS);
+
+    start = bench_now();
+    for (size_t i = 0; i < IDICT_BENCH_LOOKUPS; i++) {
+        bench_sink += (idict_bench_map_get(&map, *probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "generated dict get");
+    bench_report(name, bench_now() - start, IDICT_BENCH_LOOKUPS);
+
+cleanup_idict_bench:
+    idict_bench_map_destroy(&map);
+    dsidict_destroy(idict);
+    dsdict_destroy(dict);
+    free(probes);
+    free(keys);
+}
+
+static uint32_t idict_bench_hash(void *key) {
+    return (uint32_t)hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static int idict_bench_compare(const void *left, const void *right) {
+    uint64_t l = *(const uint64_t *)left;
+    uint64_t r = *(const uint64_t *)right;
+    return (l < r) ? -1 : (l > r);
+}
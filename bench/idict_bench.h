@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: idict_bench.h
+ *
+ * Benchmarks for DSIntDict.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_IDICT_BENCH_H
+#define LIBDS_IDICT_BENCH_H
+
+void idict_bench(void);
+
+#endif //LIBDS_IDICT_BENCH_H
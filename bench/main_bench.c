@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * libds :: main_bench.c
+ *
+ * Benchmark runner routine.
+ *
+ * Run with no arguments to run every benchmark, or give the names of the
+ * benchmarks to run.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "arena_bench.h"
+#include "cdict_bench.h"
+#include "dict_bench.h"
+#include "frozen_bench.h"
+#include "hash_bench.h"
+#include "idict_bench.h"
+#include "perfect_bench.h"
+#include "scale_bench.h"
+
+volatile size_t bench_sink = 0;
+
+struct bench {
+    const char *name;
+    void (*run)(void);
+};
+
+static const struct bench BENCHMARKS[] = {
+        { "arena", arena_bench },
+        { "cdict", cdict_bench },
+        { "dict", dict_bench },
+        { "frozen", frozen_bench },
+        { "hash", hash_bench },
+        { "idict", idict_bench },
+        { "perfect", perfect_bench },
+        { "scale", scale_bench },
+};
+
+static bool should_run(const char *name, int argc, const char *argv[]);
+
+int main(int argc, const char *argv[]) {
+    size_t nbench = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+    for (size_t i = 0; i < nbench; i++) {
+        if (!should_run(BENCHMARKS[i].name, argc, argv)) {
+            continue;
+        }
+        printf("%s:\n", BENCHMARKS[i].name);
+        BENCHMARKS[i].run();
+    }
+
+    return 0;
+}
+
+// Return true if the benchmark was requested on the command line.
+static bool should_run(const char *name, int argc, const char *argv[]) {
+    if (argc < 2) {
+        return true;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,117 @@
+/*****************************************************************************
+ * libds :: perfect_bench.c
+ *
+ * Benchmarks for DSPerfectDict.
+ *
+ * Compares building and reading a perfect hash dictionary against the
+ * chained and open addressing DSDict engines holding the same keys, for
+ * a key set which fits in cache and one which does not.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libds/dict.h"
+#include "libds/hash.h"
+#include "libds/perfect.h"
+#include "bench.h"
+#include "perfect_bench.h"
+
+static const size_t PERFECT_BENCH_LOOKUPS = ((size_t)1 << 22);
+
+static uint32_t perfect_bench_hash(void *key);
+static int perfect_bench_compare(const void *left, const void *right);
+static void perfect_bench_size(size_t nkeys);
+static void perfect_bench_dict(const char *engine, int flags, uint64_t *keys, void **ptrs, uint64_t **probes, size_t nkeys);
+
+void perfect_bench(void) {
+    perfect_bench_size((size_t)1 << 10);
+    perfect_bench_size((size_t)1 << 20);
+}
+
+// Compare each dictionary holding nkeys random IDs.
+static void perfect_bench_size(size_t nkeys) {
+    char name[64];
+    uint64_t *keys = malloc(nkeys * sizeof(uint64_t));
+    void **ptrs = malloc(nkeys * sizeof(void *));
+    uint64_t **probes = malloc(PERFECT_BENCH_LOOKUPS * sizeof(uint64_t *));
+    if ((!keys) || (!ptrs) || (!probes)) {
+        fprintf(stderr, "could not allocate perfect dict benchmark\n");
+        goto cleanup_perfect_bench;
+    }
+
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (size_t i = 0; i < nkeys; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        keys[i] = state;
+        ptrs[i] = &keys[i];
+    }
+    for (size_t i = 0; i < PERFECT_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        probes[i] = &keys[(state >> 33) % nkeys];
+    }
+
+    printf("  (%zu keys, %zu random lookups)\n", nkeys, PERFECT_BENCH_LOOKUPS);
+    perfect_bench_dict("chained", 0, keys, ptrs, probes, nkeys);
+    perfect_bench_dict("open addressing", DSDICT_OPEN_ADDRESSING, keys, ptrs, probes, nkeys);
+
+    double start = bench_now();
+    DSPerfectDict *dict = dsdict_build_perfect(ptrs, ptrs, nkeys, perfect_bench_hash, perfect_bench_compare);
+    if (!dict) {
+        fprintf(stderr, "could not build perfect dict benchmark\n");
+        goto cleanup_perfect_bench;
+    }
+    snprintf(name, sizeof(name), "dsdict_build_perfect");
+    bench_report(name, bench_now() - start, nkeys);
+
+    start = bench_now();
+    for (size_t i = 0; i < PERFECT_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsperfect_get(dict, probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "dsperfect_get");
+    bench_report(name, bench_now() - start, PERFECT_BENCH_LOOKUPS);
+    dsperfect_destroy(dict);
+
+cleanup_perfect_bench:
+    free(probes);
+    free(ptrs);
+    free(keys);
+}
+
+// Build and read a DSDict using the given engine.
+static void perfect_bench_dict(const char *engine, int flags, uint64_t *keys, void **ptrs, uint64_t **probes, size_t nkeys) {
+    char name[64];
+    double start = bench_now();
+    DSDict *dict = dsdict_new_flags(perfect_bench_hash, perfect_bench_compare, NULL, NULL, flags);
+    if (!dict) {
+        fprintf(stderr, "could not allocate perfect dict benchmark\n");
+        return;
+    }
+    for (size_t i = 0; i < nkeys; i++) {
+        dsdict_put(dict, &keys[i], ptrs[i]);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_put", engine);
+    bench_report(name, bench_now() - start, nkeys);
+
+    start = bench_now();
+    for (size_t i = 0; i < PERFECT_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsdict_get(dict, probes[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_get", engine);
+    bench_report(name, bench_now() - start, PERFECT_BENCH_LOOKUPS);
+    dsdict_destroy(dict);
+}
+
+static uint32_t perfect_bench_hash(void *key) {
+    return (uint32_t)hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static int perfect_bench_compare(const void *left, const void *right) {
+    uint64_t l = *(const uint64_t *)left;
+    uint64_t r = *(const uint64_t *)right;
+    return (l < r) ? -1 : (l > r);
+}
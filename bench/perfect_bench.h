@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: perfect_bench.h
+ *
+ * Benchmarks for DSPerfectDict.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_PERFECT_BENCH_H
+#define LIBDS_PERFECT_BENCH_H
+
+void perfect_bench(void);
+
+#endif //LIBDS_PERFECT_BENCH_H
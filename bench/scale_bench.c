@@ -0,0 +1,154 @@
+/*****************************************************************************
+ * libds :: scale_bench.c
+ *
+ * Benchmarks for DSDict scaling to very large sizes.
+ *
+ * Builds open addressing dictionaries of 2^20 keys and upwards (by 4x
+ * each step) using both a 32-bit and a 64-bit hash of the same keys, and
+ * reports the cost of puts, lookups of present keys and lookups of absent
+ * keys along with the number of key comparisons each lookup made. With a
+ * 32-bit hash, comparisons against keys which merely share a hash value
+ * climb with the size of the dictionary.
+ *
+ * The largest size is 2^24 keys by default, which needs about 1 GB. Set
+ * LIBDS_BENCH_SCALE_KEYS in the environment to raise it; 2^30 (about a
+ * billion) keys needs about 64 GB.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libds/dict.h"
+#include "libds/hash.h"
+#include "bench.h"
+#include "scale_bench.h"
+
+static const size_t SCALE_BENCH_MIN_KEYS = ((size_t)1 << 20);
+static const size_t SCALE_BENCH_DEFAULT_KEYS = ((size_t)1 << 24);
+static const size_t SCALE_BENCH_STEP = 4;
+static const size_t SCALE_BENCH_LOOKUPS = ((size_t)1 << 22);
+static const uint64_t SCALE_BENCH_SEED = 0x2545F4914F6CDD1Dull;
+
+static size_t scale_bench_compares = 0;
+
+static uint32_t scale_bench_hash32(void *key);
+static uint64_t scale_bench_hash64(void *key);
+static int scale_bench_compare(const void *left, const void *right);
+static size_t scale_bench_max_keys(void);
+static void scale_bench_size(uint64_t *keys, uint64_t *hits, uint64_t *misses, size_t nkeys);
+static void scale_bench_dict(const char *label, DSDict *dict, uint64_t *keys, uint64_t *hits, uint64_t *misses, size_t nkeys);
+
+void scale_bench(void) {
+    size_t maxkeys = scale_bench_max_keys();
+    uint64_t *keys = malloc(maxkeys * sizeof(uint64_t));
+    uint64_t *hits = malloc(SCALE_BENCH_LOOKUPS * sizeof(uint64_t));
+    uint64_t *misses = malloc(SCALE_BENCH_LOOKUPS * sizeof(uint64_t));
+    if ((!keys) || (!hits) || (!misses)) {
+        fprintf(stderr, "could not allocate scale benchmark keys\n");
+        goto cleanup_scale_bench;
+    }
+
+    // Keys are distinct since hash_u64 is a bijection for a fixed seed
+    for (size_t i = 0; i < maxkeys; i++) {
+        keys[i] = hash_u64(i, SCALE_BENCH_SEED);
+    }
+
+    for (size_t n = SCALE_BENCH_MIN_KEYS; n <= maxkeys; n *= SCALE_BENCH_STEP) {
+        scale_bench_size(keys, hits, misses, n);
+    }
+
+cleanup_scale_bench:
+    free(keys);
+    free(hits);
+    free(misses);
+}
+
+// Compare 32-bit and 64-bit hashed dictionaries of the first nkeys keys.
+static void scale_bench_size(uint64_t *keys, uint64_t *hits, uint64_t *misses, size_t nkeys) {
+    // Lookups use copies of the keys, so each match requires a comparison
+    // as it would for keys read from elsewhere
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (size_t i = 0; i < SCALE_BENCH_LOOKUPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        hits[i] = keys[(state >> 11) % nkeys];
+        misses[i] = hash_u64(nkeys + (state >> 11), SCALE_BENCH_SEED);
+    }
+
+    printf("  (%zu keys, %zu random lookups)\n", nkeys, SCALE_BENCH_LOOKUPS);
+    DSDict *dict = dsdict_new_cap(nkeys, scale_bench_hash32, scale_bench_compare, NULL, NULL, DSDICT_OPEN_ADDRESSING, NULL);
+    scale_bench_dict("32-bit", dict, keys, hits, misses, nkeys);
+
+    dict = dsdict_new_hash64(scale_bench_hash64, scale_bench_compare, NULL, NULL, DSDICT_OPEN_ADDRESSING, NULL);
+    if ((dict) && (!dsdict_reserve(dict, nkeys))) {
+        dsdict_destroy(dict);
+        dict = NULL;
+    }
+    scale_bench_dict("64-bit", dict, keys, hits, misses, nkeys);
+}
+
+// Fill a pre-sized dictionary and time lookups of present and absent keys.
+static void scale_bench_dict(const char *label, DSDict *dict, uint64_t *keys, uint64_t *hits, uint64_t *misses, size_t nkeys) {
+    char name[64];
+    if (!dict) {
+        fprintf(stderr, "could not create %s dict of %zu keys\n", label, nkeys);
+        return;
+    }
+
+    double start = bench_now();
+    for (size_t i = 0; i < nkeys; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_put (pre-sized)", label);
+    bench_report(name, bench_now() - start, nkeys);
+
+    scale_bench_compares = 0;
+    start = bench_now();
+    for (size_t i = 0; i < SCALE_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsdict_get(dict, &hits[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_get (hit)", label);
+    bench_report(name, bench_now() - start, SCALE_BENCH_LOOKUPS);
+    printf("  %-44s %10.4f compares/op\n", name, (double)scale_bench_compares / SCALE_BENCH_LOOKUPS);
+
+    scale_bench_compares = 0;
+    start = bench_now();
+    for (size_t i = 0; i < SCALE_BENCH_LOOKUPS; i++) {
+        bench_sink += (dsdict_get(dict, &misses[i]) != NULL);
+    }
+    snprintf(name, sizeof(name), "%s dsdict_get (miss)", label);
+    bench_report(name, bench_now() - start, SCALE_BENCH_LOOKUPS);
+    printf("  %-44s %10.4f compares/op\n", name, (double)scale_bench_compares / SCALE_BENCH_LOOKUPS);
+
+    dsdict_destroy(dict);
+}
+
+// Read the largest number of keys from the environment, if given.
+static size_t scale_bench_max_keys(void) {
+    const char *env = getenv("LIBDS_BENCH_SCALE_KEYS");
+    if (env) {
+        unsigned long long n = strtoull(env, NULL, 10);
+        if (n >= SCALE_BENCH_MIN_KEYS) {
+            return (size_t)n;
+        }
+    }
+    return SCALE_BENCH_DEFAULT_KEYS;
+}
+
+static uint32_t scale_bench_hash32(void *key) {
+    return (uint32_t)hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static uint64_t scale_bench_hash64(void *key) {
+    return hash_wyhash(key, sizeof(uint64_t), 0);
+}
+
+static int scale_bench_compare(const void *left, const void *right) {
+    scale_bench_compares++;
+    uint64_t l = *(const uint64_t *)left;
+    uint64_t r = *(const uint64_t *)right;
+    return (l < r) ? -1 : (l > r);
+}
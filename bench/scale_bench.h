@@ -0,0 +1,16 @@
+/*****************************************************************************
+ * libds :: scale_bench.h
+ *
+ * Benchmarks for DSDict scaling to very large sizes.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_SCALE_BENCH_H
+#define LIBDS_SCALE_BENCH_H
+
+void scale_bench(void);
+
+#endif //LIBDS_SCALE_BENCH_H
@@ -0,0 +1,57 @@
+/**
+ * @file alloc.h
+ *
+ * @brief Pluggable memory allocator used by all containers.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_ALLOC_H
+#define LIBDS_ALLOC_H
+
+#include <stddef.h>
+
+/**
+* @brief Memory allocator used for every internal allocation made by a
+* container, including its iterators.
+*
+* Each function receives the @c ctx pointer as its first argument, so
+* allocators may keep their own state (such as an arena or a jemalloc
+* arena index). Callers of @c realloc and @c free always pass the size
+* which was originally requested for the block, so allocators do not
+* need to track allocation sizes themselves.
+*
+* The @c alloc function is required. If @c calloc is @c NULL, zeroed
+* blocks are allocated with @c alloc and cleared by the container.
+* Allocators which can hand out memory which is already zero (such as
+* fresh pages from the operating system) should provide @c calloc , since
+* containers allocate their large tables this way. If @c realloc is
+* @c NULL, blocks will be resized by allocating a new block, copying the
+* contents and freeing the old block. If @c free is @c NULL, memory will never be
+* returned to the allocator (which is appropriate for bump or region
+* allocators which release all of their memory at once).
+*
+* Containers keep their own copy of this structure, so it does not need
+* to outlive the containers created with it (though @c ctx must).
+*/
+typedef struct DSAllocator {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*calloc)(void *ctx, size_t num, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} DSAllocator;
+
+/**
+* @brief Return the default allocator, which uses the C standard library
+* functions @c malloc , @c calloc , @c realloc and @c free .
+*
+* Containers created without an explicit allocator use this allocator.
+*
+* @returns the default @c DSAllocator
+*/
+const DSAllocator *dsalloc_default(void);
+
+#endif //LIBDS_ALLOC_H
@@ -0,0 +1,97 @@
+/**
+ * @file arena.h
+ *
+ * @brief Region allocator for containers which are destroyed together.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_ARENA_H
+#define LIBDS_ARENA_H
+
+#include <stddef.h>
+#include "libds/alloc.h"
+
+/**
+* @brief Region allocator which hands out memory from large blocks and
+* releases all of it at once.
+*
+* Containers are created inside an arena by passing the allocator returned
+* by @c dsarena_allocator to any of the @c *_new_alloc constructors. All of
+* their memory (including growth from resizing) then comes from the arena.
+* Calling @c dsarena_reset reclaims every allocation at once, without
+* visiting any container or calling any element free functions.
+*
+* Individual frees are only honored for the most recent allocation, which
+* allows short lived buffers and in place resizing of the last allocated
+* block to reuse memory; all other frees are deferred until the arena is
+* reset or destroyed.
+*/
+typedef struct DSArena DSArena;
+
+/**
+* @brief The default block size of a @c DSArena.
+*/
+static const size_t DSARENA_DEFAULT_BLOCK_SIZE = (64 * 1024);
+
+/**
+* @brief Create a new @c DSArena object which allocates blocks of
+* @c blocksize bytes.
+*
+* Allocations larger than a quarter of the block size are given their own
+* block, so they do not waste the remainder of the current block.
+*
+* @param blocksize the size of each block; if 0 the arena will use
+*                  @c DSARENA_DEFAULT_BLOCK_SIZE
+* @returns a new @c DSArena object or @c NULL if memory could not be
+*          allocated
+*/
+DSArena *dsarena_new(size_t blocksize);
+
+/**
+* @brief Dispose of a @c DSArena object and every allocation made from it.
+*
+* Every container created in the arena is invalid after this call, and
+* must not be destroyed using its own @c *_destroy function.
+*
+* @param arena a @c DSArena object
+*/
+void dsarena_destroy(DSArena *arena);
+
+/**
+* @brief Return an allocator which allocates from the arena.
+*
+* The returned pointer remains valid until the arena is destroyed.
+*
+* @param arena a @c DSArena object
+* @returns an allocator backed by @c arena
+*/
+const DSAllocator *dsarena_allocator(DSArena *arena);
+
+/**
+* @brief Reclaim every allocation made from the arena at once.
+*
+* Containers created in the arena are invalid after this call and must
+* not be destroyed using their own @c *_destroy functions. Element free
+* functions are not called, so containers in an arena should only hold
+* elements which are also owned by the arena (or not owned at all).
+*
+* A single block is kept for reuse, so a reset arena can serve another
+* request of a similar size without returning to the system allocator.
+*
+* @param arena a @c DSArena object
+*/
+void dsarena_reset(DSArena *arena);
+
+/**
+* @brief Return the number of bytes handed out by the arena since it was
+* created or last reset.
+*
+* @param arena a @c DSArena object
+* @returns the number of bytes allocated from the arena
+*/
+size_t dsarena_used(const DSArena *arena);
+
+#endif //LIBDS_ARENA_H
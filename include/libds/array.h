@@ -13,6 +13,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "libds/alloc.h"
 #include "libds/iter.h"
 
 /**
@@ -84,6 +85,24 @@ DSArray *dsarray_new(dsarray_compare_fn cmpfn, dsarray_free_fn freefn);
 */
 DSArray *dsarray_new_cap(size_t cap, dsarray_compare_fn cmpfn, dsarray_free_fn freefn);
 
+/**
+* @brief Create a new @c DSArray object with @c cap slots, the given
+* comparator and free function, and the given memory allocator.
+*
+* The array slots, the array object itself and any iterators created
+* from the array are all allocated using @c alloc . The allocator is
+* copied into the array, though its context must outlive the array.
+*
+* @param cap the starting capacity of the @c DSArray
+* @param cmpfn a function which can compare two array elements
+* @param freefn a function which can free a array element
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSArray object or @c NULL if memory could not be
+*          allocated
+*/
+DSArray *dsarray_new_alloc(size_t cap, dsarray_compare_fn cmpfn, dsarray_free_fn freefn, const DSAllocator *alloc);
+
 /**
 * @brief Create a new @c DSArray object with the given literal array items and
 * the given comparator and free function.
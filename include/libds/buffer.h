@@ -13,6 +13,8 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include "libds/alloc.h"
 
 /**
 * @brief Auto-resizing character buffer object.
@@ -82,6 +84,23 @@ DSBuffer *dsbuf_new_l(const char *value, size_t len);
 */
 DSBuffer *dsbuf_new_buffer(size_t cap);
 
+/**
+* @brief Create a new empty @c DSBuffer object with the given capacity
+* which allocates memory using the given allocator.
+*
+* The buffer contents, the buffer object itself and any buffers created
+* from it by @c dsbuf_dup or @c dsbuf_substr are all allocated using
+* @c alloc . The allocator is copied into the buffer, though its context
+* must outlive the buffer.
+*
+* @param cap the requested capacity for the @c DSBuffer
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSBuffer object with the requested capacity or @c NULL
+*          if memory could not be allocated
+*/
+DSBuffer *dsbuf_new_buffer_alloc(size_t cap, const DSAllocator *alloc);
+
 /**
 * @brief Dispose of the @c DSBuffer object.
 *
@@ -226,7 +245,8 @@ const char *dsbuf_char_ptr(const DSBuffer *str);
 * @c DSBuffer objects are not bound to be terminated with @c NUL bytes
 * like a C string. This function returns the body of the string up until
 * the first @c NUL byte. Callers are required to call @c free on the
-* return value from this function.
+* return value from this function. The copy is always allocated with
+* @c malloc , regardless of the allocator used by the buffer.
 *
 * @param str a @c DSBuffer object
 * @returns a copy of the internal buffer as a C string up to the first
@@ -237,14 +257,84 @@ char *dsbuf_to_char_array(const DSBuffer *str);
 /**
 * @brief Return a hash of the underlying string.
 *
-* This function is intended to be used for hashing @c DSBuffer objects
-* for a @c DSDict key, so it uses a generic void pointer parameter.
+* The buffer is hashed with @c hash_wyhash over its full length, so
+* buffers containing @c NUL bytes hash correctly. The hash is cached in
+* the buffer and only recomputed after the buffer is modified, so looking
+* up the same key buffer repeatedly only hashes it once.
+*
+* The cache is updated atomically, so any number of threads may hash or
+* compare (with @c dsbuf_dict_compare ) the same buffer at once, provided
+* no thread modifies the buffer while they do. This makes @c dsbuf_hash ,
+* @c dsbuf_dict_hash and @c dsbuf_dict_compare suitable for use with
+* @c DSConcurrentDict and @c DSReadDict .
 *
 * @param str a @c DSBuffer object
 * @returns a hash of the internal buffer
 */
 unsigned int dsbuf_hash(const DSBuffer *str);
 
+/**
+* @brief Hash a @c DSBuffer dictionary key.
+*
+* This function has the exact signature of a @c dsdict_hash_fn , so it can
+* be given to @c dsdict_new without a cast. It returns the same cached
+* value as @c dsbuf_hash , and may likewise be called from several threads
+* at once on a buffer which is not being modified.
+*
+* @param key a @c DSBuffer object
+* @returns a hash of the internal buffer
+*/
+uint32_t dsbuf_dict_hash(void *key);
+
+/**
+* @brief Compare two @c DSBuffer dictionary keys.
+*
+* This function has the exact signature of a @c dsdict_compare_fn , so it
+* can be given to @c dsdict_new without a cast. Buffers are ordered first
+* by their cached hash, then by length and finally by their contents, so
+* unequal keys are almost always distinguished without reading either
+* buffer. The ordering is consistent, but unlike @c dsbuf_compare it is
+* not lexicographic. It may be called from several threads at once on
+* buffers which are not being modified (see @c dsbuf_hash ).
+*
+* @param left a @c DSBuffer object
+* @param right a @c DSBuffer object
+* @returns @c INT_MIN if left is @c NULL or @c INT_MAX if right is @c NULL;
+*          0 if the buffers are equal; a value less than or greater than
+*          zero otherwise
+*/
+int dsbuf_dict_compare(const void *left, const void *right);
+
+/**
+* @brief Keep a running @c hash_wyhash of the buffer contents as bytes are
+* appended.
+*
+* The current contents are hashed once, after which every call to
+* @c dsbuf_append , @c dsbuf_append_char and @c dsbuf_append_str only
+* hashes the newly appended bytes, so the hash of a large buffer built up
+* over time is available without another pass over the buffer. Calling
+* this function again restarts the hash with the new seed. Buffers
+* created by @c dsbuf_dup continue the running hash of their source.
+*
+* @param str a @c DSBuffer object
+* @param seed an arbitrary seed value
+* @returns @c true if the running hash was started; @c false if @c str is
+*          @c NULL or memory could not be allocated
+*/
+bool dsbuf_track_hash(DSBuffer *str, uint64_t seed);
+
+/**
+* @brief Return the @c hash_wyhash of the buffer contents.
+*
+* If @c dsbuf_track_hash was called on the buffer, this returns the
+* running hash (using the seed given to @c dsbuf_track_hash ) without
+* reading the buffer; otherwise, the contents are hashed with a seed of 0.
+*
+* @param str a @c DSBuffer object
+* @returns the same value as @c hash_wyhash over the buffer contents
+*/
+uint64_t dsbuf_running_hash(const DSBuffer *str);
+
 /**
 * @brief Compare two DSBuffers.
 *
@@ -0,0 +1,189 @@
+/**
+ * @file cdict.h
+ *
+ * @brief Thread safe dictionary built from sharded @c DSDict objects.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_CDICT_H
+#define LIBDS_CDICT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "libds/dict.h"
+#include "libds/iter.h"
+
+/**
+* @brief Dictionary which may be used from many threads at once.
+*
+* The key space is partitioned into a power of 2 number of shards using
+* the high bits of each key hash. Each shard is an ordinary @c DSDict
+* guarded by its own reader-writer lock, so readers never block each
+* other and writers only block operations on keys in the same shard.
+* Keys are hashed once per operation; the shard dictionaries reuse that
+* hash rather than calling the hash function again.
+*
+* Every function may be called concurrently from any number of threads,
+* except @c dscdict_destroy . The dictionary only protects its own
+* structure: a value returned by @c dscdict_get may be replaced (and
+* freed, if a value free function was given) by another thread at any
+* time. Applications which replace or delete values while other threads
+* read them should either not give a value free function and manage
+* value lifetimes themselves, or modify values in place using
+* @c dscdict_update , which runs under the shard lock.
+*/
+typedef struct DSConcurrentDict DSConcurrentDict;
+
+/**
+* @brief The default number of shards in a @c DSConcurrentDict.
+*/
+static const size_t DSCDICT_DEFAULT_SHARDS = 64;
+
+/**
+* @brief Create a new @c DSConcurrentDict object.
+*
+* The hash, compare and free functions behave exactly as they do for
+* @c dsdict_new and must themselves be safe to call from many threads.
+* @c flags selects the storage engine of each shard as it would for
+* @c dsdict_new_flags . Incremental resizes of a shard only progress
+* while that shard is locked for writing.
+*
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param flags @c DSDICT_CHAINED or @c DSDICT_OPEN_ADDRESSING, optionally
+*              combined with other @c DSDICT_* flags
+* @param shards the number of shards, which is rounded up to a power of
+*               2; if 0 the dictionary uses @c DSCDICT_DEFAULT_SHARDS
+* @returns a new @c DSConcurrentDict object or @c NULL if no hash function
+*          is specified or memory could not be allocated
+*/
+DSConcurrentDict *dscdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, size_t shards);
+
+/**
+* @brief Create a new @c DSConcurrentDict object which allocates memory
+* using the given allocator.
+*
+* The shard array, every shard dictionary, the dictionary object itself
+* and any iterators (and their shard snapshots) are all allocated using
+* @c alloc . The allocator is copied into the dictionary, though its
+* context must outlive the dictionary. The allocator is called from
+* whichever threads use the dictionary, so it must be safe to call from
+* many threads at once.
+*
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param flags @c DSDICT_CHAINED or @c DSDICT_OPEN_ADDRESSING, optionally
+*              combined with other @c DSDICT_* flags
+* @param shards the number of shards, which is rounded up to a power of
+*               2; if 0 the dictionary uses @c DSCDICT_DEFAULT_SHARDS
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSConcurrentDict object or @c NULL if no hash function
+*          is specified or memory could not be allocated
+*/
+DSConcurrentDict *dscdict_new_alloc(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, size_t shards, const DSAllocator *alloc);
+
+/**
+* @brief Destroy a @c DSConcurrentDict object.
+*
+* Keys and values are freed as they would be by @c dsdict_destroy . No
+* other thread may be using the dictionary.
+*
+* @param dict a @c DSConcurrentDict object
+*/
+void dscdict_destroy(DSConcurrentDict *dict);
+
+/**
+* @brief Return the number of elements in the collection.
+*
+* Each shard is counted under its own lock, so the result may be stale
+* if other threads are modifying the dictionary.
+*
+* @param dict a @c DSConcurrentDict object
+* @returns the number of elements in @c dict
+*/
+size_t dscdict_count(const DSConcurrentDict *dict);
+
+/**
+* @brief Return the number of shards in the dictionary.
+*
+* @param dict a @c DSConcurrentDict object
+* @returns the number of shards in @c dict
+*/
+size_t dscdict_shards(const DSConcurrentDict *dict);
+
+/**
+* @brief Put the given element in the dictionary by key.
+*
+* This function behaves exactly as @c dsdict_put .
+*
+* @param dict a @c DSConcurrentDict object
+* @param key the key
+* @param val the value
+*/
+void dscdict_put(DSConcurrentDict *dict, void *key, void *val);
+
+/**
+* @brief Get the element given by the key.
+*
+* @param dict a @c DSConcurrentDict object
+* @param key the keyed element to find
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dscdict_get(const DSConcurrentDict *dict, void *key);
+
+/**
+* @brief Remove the element from the dictionary and return it to the caller.
+*
+* @param dict a @c DSConcurrentDict object
+* @param key the keyed element to find
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dscdict_del(DSConcurrentDict *dict, void *key);
+
+/**
+* @brief Atomically replace the value for the given key with the result
+* of calling @c func on its current value.
+*
+* This function behaves exactly as @c dsdict_update . @c func is called
+* while holding the lock on the shard containing @c key , so it must not
+* call any other function on this dictionary.
+*
+* @param dict a @c DSConcurrentDict object
+* @param key the key
+* @param func a function returning the new value for the key
+* @param ctx a context pointer passed to @c func
+* @returns @c true if the value was updated; @c false if any argument
+*          was @c NULL or memory could not be allocated
+*/
+bool dscdict_update(DSConcurrentDict *dict, void *key, dsdict_update_fn func, void *ctx);
+
+/**
+* @brief Create a new @c DSIter object for this dictionary.
+*
+* The iterator visits the dictionary one shard at a time. When it reaches
+* a shard, it copies every key/value pair in that shard under the shard
+* lock, so the elements visited from each shard form a consistent
+* snapshot of that shard. No lock is held between calls to
+* @c dsiter_next , so other threads (and the iterating thread) may freely
+* modify the dictionary during iteration; changes to shards which have
+* not been reached yet will be visible to the iterator. If a shard cannot
+* be copied because memory could not be allocated, iteration stops early
+* and @c dsiter_error returns @c true .
+*
+* @param dict a @c DSConcurrentDict object
+* @returns a new @c DSIter object or @c NULL if memory could not be
+*          allocated
+*/
+DSIter *dscdict_iter(DSConcurrentDict *dict);
+
+#endif //LIBDS_CDICT_H
@@ -11,8 +11,10 @@
 #ifndef LIBDS_DICT_H
 #define LIBDS_DICT_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "libds/alloc.h"
 #include "libds/iter.h"
 
 /**
@@ -25,6 +27,12 @@ typedef struct DSDict DSDict;
 */
 typedef uint32_t (*dsdict_hash_fn)(void*);
 
+/**
+* @brief 64-bit hash function used in a @c DSDict created by
+* @c dsdict_new_hash64 .
+*/
+typedef uint64_t (*dsdict_hash64_fn)(void*);
+
 /**
 * @brief Free function used in a @c DSDict free remaining elements when
 * the dictionary is destroyed.
@@ -41,6 +49,89 @@ typedef int (*dsdict_compare_fn)(const void*, const void*);
 */
 typedef void (*dsdict_foreach_fn)(const void*, void*);
 
+/**
+* @brief A function accepting the current value for a key (or @c NULL if
+* the key was not present) and a caller supplied context, which returns
+* the new value for the key. Used by @c dsdict_update .
+*/
+typedef void *(*dsdict_update_fn)(void*, void*);
+
+/**
+* @brief Flags used to select the storage engine of a new @c DSDict.
+*
+* @c DSDICT_CHAINED dictionaries store each element in a separately
+* allocated node and resolve collisions with a linked list per slot.
+*
+* @c DSDICT_OPEN_ADDRESSING dictionaries store keys and values in a
+* single flat array of slots alongside a packed array of one byte per
+* slot of hash metadata. Lookups scan 16 metadata bytes at a time
+* (using SSE2 where available) and only touch the slot array for likely
+* matches, so they typically incur far fewer cache misses than chained
+* lookups. Elements move when the table is resized.
+*
+* By default, chained dictionaries keep a power of 2 capacity and select
+* a slot by masking off the low bits of a multiplicative mix of the key
+* hash, which makes lookups and resizes cheap. @c DSDICT_PRIME_MODULI may
+* be combined with @c DSDICT_CHAINED to instead select slots by taking
+* the hash modulo a prime close to the capacity. This is slower, but may
+* tolerate hash functions with very poorly distributed bits. It has no
+* effect on open addressing dictionaries.
+*
+* Chained dictionaries normally rehash every element into a larger table
+* as soon as the load factor is exceeded, which makes that single put
+* operation proportional to the size of the dictionary. Combining
+* @c DSDICT_INCREMENTAL_RESIZE with @c DSDICT_CHAINED instead keeps both
+* the old and new tables live during a resize and migrates a small,
+* bounded number of old buckets during each subsequent put, update and
+* delete, so no single operation pays for the whole resize. Lookups never
+* modify the dictionary and check both tables while a resize is in
+* progress; read-mostly callers may finish a resize with
+* @c dsdict_migrate . Migration is paused while any @c DSIter on the
+* dictionary exists, so iterators (and lookups performed while
+* iterating) remain valid during a resize. An iterator which is never
+* destroyed therefore keeps both tables alive indefinitely.
+*
+* @c DSDICT_ORDERED dictionaries store keys and values densely in a
+* single array in the order they were first inserted, alongside a compact
+* open addressing index of positions in that array (1 to 8 bytes per slot
+* depending on the capacity). Iterators and foreach visit elements in
+* insertion order, and iteration cost is proportional to the number of
+* elements rather than the capacity. Overwriting the value of a key does
+* not change its position; deleting a key and putting it again moves it
+* to the end. Deleting elements during iteration is safe. Elements move
+* when the table is resized. @c DSDICT_ORDERED takes precedence over
+* @c DSDICT_OPEN_ADDRESSING, and neither @c DSDICT_PRIME_MODULI nor
+* @c DSDICT_INCREMENTAL_RESIZE has any effect on ordered dictionaries.
+*
+* @c DSDICT_CUCKOO dictionaries use bucketized cuckoo hashing: every key
+* may only be stored in one of two buckets, each filling a single cache
+* line with its slots and a fingerprint of each slot's hash, or in a
+* stash of elements which fit in neither. Lookups therefore read at most
+* two cache lines of the table no matter how full it is, giving a firm
+* bound on the cost of lookups for hits and misses alike; the stash is
+* only searched when the first of the key's buckets has overflowed into
+* it, and then only for elements sharing that bucket. Puts into a pair
+* of full buckets move other elements to their alternate bucket, so
+* inserts are somewhat slower than with @c DSDICT_OPEN_ADDRESSING. Once
+* eight elements are stashed, the table is rehashed with new bucket
+* choices, or grown if it is crowded. Keys which share a single hash
+* value cannot be separated that way, so any more of them than fit in
+* two buckets stay in the stash, where lookups for them search every
+* key sharing the hash as a chained dictionary would. Cuckoo
+* dictionaries therefore need a hash function which rarely gives
+* distinct keys the same hash. Deleting elements during iteration is
+* safe. Elements move when the table is resized. @c DSDICT_CUCKOO takes
+* precedence over @c DSDICT_OPEN_ADDRESSING but not @c DSDICT_ORDERED,
+* and neither @c DSDICT_PRIME_MODULI nor @c DSDICT_INCREMENTAL_RESIZE
+* has any effect on cuckoo dictionaries.
+*/
+static const int DSDICT_CHAINED = 0;
+static const int DSDICT_OPEN_ADDRESSING = (1 << 0);
+static const int DSDICT_PRIME_MODULI = (1 << 1);
+static const int DSDICT_INCREMENTAL_RESIZE = (1 << 2);
+static const int DSDICT_ORDERED = (1 << 3);
+static const int DSDICT_CUCKOO = (1 << 4);
+
 /**
 * @brief Create a new @c DSDict object with the given hash and free function.
 *
@@ -51,6 +142,11 @@ typedef void (*dsdict_foreach_fn)(const void*, void*);
 * @c keyfree is also optional. If the caller does not specify @c keyfree,
 * then keys will not be freed when the @c DSDict object is destroyed.
 *
+* Chained dictionary buckets are allocated in chunks owned by the
+* dictionary. Buckets freed by deletions are reused by later puts, but
+* the chunks themselves are only released when the dictionary is
+* destroyed.
+*
 * @param hash a hashing function used to hash dictionary keys
 * @param cmpfn a function which can compare two dictionary keys by value
 * @param keyfree a function which can free hash table keys
@@ -60,6 +156,112 @@ typedef void (*dsdict_foreach_fn)(const void*, void*);
 */
 DSDict *dsdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree);
 
+/**
+* @brief Create a new @c DSDict object using the storage engine selected
+* by @c flags.
+*
+* Other than the engine selection, this function behaves exactly as
+* @c dsdict_new. All of the other @c DSDict functions (including
+* iterators) work identically regardless of the selected engine.
+*
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param flags @c DSDICT_CHAINED, @c DSDICT_OPEN_ADDRESSING,
+*              @c DSDICT_ORDERED or @c DSDICT_CUCKOO, optionally
+*              combined with other @c DSDICT_* flags
+* @returns a new @c DSDict object or @c NULL if no hash function is
+*          specified or memory could not be allocated
+*/
+DSDict *dsdict_new_flags(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags);
+
+/**
+* @brief Create a new @c DSDict object using the storage engine selected
+* by @c flags which allocates memory using the given allocator.
+*
+* The bucket arrays, bucket chunks, the dictionary object itself and any
+* iterators created from the dictionary are all allocated using @c alloc .
+* The allocator is copied into the dictionary, though its context must
+* outlive the dictionary. Keys and values are never allocated by the
+* dictionary, so they are not affected by the allocator.
+*
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param flags @c DSDICT_CHAINED, @c DSDICT_OPEN_ADDRESSING,
+*              @c DSDICT_ORDERED or @c DSDICT_CUCKOO, optionally
+*              combined with other @c DSDICT_* flags
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSDict object or @c NULL if no hash function is
+*          specified or memory could not be allocated
+*/
+DSDict *dsdict_new_alloc(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, const DSAllocator *alloc);
+
+/**
+* @brief Create a new @c DSDict object which can hold @c cap elements
+* without resizing.
+*
+* Other than the initial capacity, this function behaves exactly as
+* @c dsdict_new_alloc . Creating a dictionary at its final size avoids
+* every intermediate resize when bulk loading a known number of
+* elements. The dictionary will not automatically shrink below this
+* size (see @c dsdict_reserve ).
+*
+* @param cap the number of elements the dictionary should hold before
+*            its first resize
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param flags @c DSDICT_CHAINED, @c DSDICT_OPEN_ADDRESSING,
+*              @c DSDICT_ORDERED or @c DSDICT_CUCKOO, optionally
+*              combined with other @c DSDICT_* flags
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSDict object or @c NULL if no hash function is
+*          specified or memory could not be allocated
+*/
+DSDict *dsdict_new_cap(size_t cap, dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, const DSAllocator *alloc);
+
+/**
+* @brief Create a new @c DSDict object which hashes keys with a 64-bit
+* hash function.
+*
+* Other than the hash function, this function behaves exactly as
+* @c dsdict_new_alloc . Every engine stores the full 64-bit hash of each
+* element and only compares keys whose stored hashes match, so a
+* dictionary with a good 64-bit hash function almost never compares
+* unequal keys. With a 32-bit hash function, distinct keys begin to share
+* hash values once a dictionary holds more than a few tens of thousands
+* of elements, and a dictionary of a billion elements holds over a
+* hundred million such pairs. Use this for dictionaries which may grow
+* very large, with a hash such as @c hash_wyhash or @c hash_u64 .
+*
+* Hashes passed to the @c dsdict_*_hashed functions of these
+* dictionaries must be those returned by @c dsdict_hash_of , which
+* returns the full 64-bit hash.
+*
+* To bulk load a known number of elements, call @c dsdict_reserve on the
+* new dictionary before inserting anything; while it is empty, this only
+* swaps its default sized table for one of the reserved size.
+*
+* @param hash a 64-bit hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param flags @c DSDICT_CHAINED, @c DSDICT_OPEN_ADDRESSING,
+*              @c DSDICT_ORDERED or @c DSDICT_CUCKOO, optionally
+*              combined with other @c DSDICT_* flags
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSDict object or @c NULL if no hash function is
+*          specified or memory could not be allocated
+*/
+DSDict *dsdict_new_hash64(dsdict_hash64_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, const DSAllocator *alloc);
+
 /**
 * @brief Destroy a @c DSDict object.
 *
@@ -67,6 +269,9 @@ DSDict *dsdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn
 * will be called on each element. Otherwise, only the dictionary object
 * itself and any references it owned will be destroyed.
 *
+* Any iterators created by @c dsdict_iter must be destroyed before the
+* dictionary they iterate over.
+*
 * @param dict a @c DSDict object
 */
 void dsdict_destroy(DSDict *dict);
@@ -92,6 +297,137 @@ size_t dsdict_count(const DSDict *dict);
 */
 size_t dsdict_cap(const DSDict *dict);
 
+/**
+* @brief Make sure the dictionary can hold at least @c n elements without
+* resizing.
+*
+* The table is grown at once if it is too small; dictionaries created
+* with @c DSDICT_INCREMENTAL_RESIZE begin an incremental resize instead.
+* The reservation also becomes the minimum size of the dictionary, so it
+* will not automatically shrink below it as elements are deleted.
+*
+* @param dict a @c DSDict object
+* @param n the number of elements to reserve room for
+* @returns @c true if the dictionary can hold @c n elements; @c false if
+*          memory could not be allocated
+*/
+bool dsdict_reserve(DSDict *dict, size_t n);
+
+/**
+* @brief Set the load factor of the dictionary.
+*
+* The load factor is the ratio of elements to capacity at which the
+* dictionary grows. Lower load factors make lookups faster at the cost of
+* memory; higher load factors save memory, though lookups slow down
+* sharply for open addressing dictionaries as the load factor approaches
+* 1. The default is 0.66. The dictionary is grown immediately if it
+* already exceeds the new load factor.
+*
+* Dictionaries automatically shrink after deletions once they fall below
+* a quarter of their load factor, to half of their load factor, so a
+* dictionary which briefly grew very large does not keep its memory.
+*
+* @param dict a @c DSDict object
+* @param load the new load factor, which must be greater than 0 and less
+*             than 1
+* @returns @c true if the load factor was changed; @c false if it was out
+*          of range or memory could not be allocated
+*/
+bool dsdict_set_load_factor(DSDict *dict, double load);
+
+/**
+* @brief Perform a bounded amount of the work of an incremental resize.
+*
+* Incremental resizes normally progress during puts, updates and deletes.
+* Dictionaries which are mostly read can call this function (for instance
+* in a loop, or between batches of lookups) to release the old table
+* sooner. It does nothing for dictionaries which are not being
+* incrementally resized, or while any @c DSIter on the dictionary exists.
+*
+* @param dict a @c DSDict object
+* @returns @c true if an incremental resize is still in progress;
+*          @c false otherwise
+*/
+bool dsdict_migrate(DSDict *dict);
+
+/**
+* @brief Shrink the dictionary to the smallest capacity which holds its
+* current elements below its load factor.
+*
+* Any previous reservation (from @c dsdict_reserve or @c dsdict_new_cap )
+* is released. This function always resizes immediately, even for
+* dictionaries created with @c DSDICT_INCREMENTAL_RESIZE , and must not be
+* called while any @c DSIter on the dictionary exists.
+*
+* @param dict a @c DSDict object
+*/
+void dsdict_shrink_to_fit(DSDict *dict);
+
+/**
+* @brief Number of bins in the chain length histogram of a @c DSDictStats.
+*/
+#define DSDICT_STATS_HISTOGRAM_BINS 16
+
+/**
+* @brief Snapshot of the internal health of a @c DSDict , filled in by
+* @c dsdict_stats .
+*
+* For chained dictionaries, a chain is the list of elements in a single
+* bucket. @c occupied is the number of buckets with at least one element,
+* @c histogram[i] is the number of buckets with a chain of exactly @c i
+* elements, and @c mean_chain is the mean length of the occupied chains.
+* The buckets of both tables are counted during an incremental resize.
+*
+* Open addressing and insertion ordered dictionaries have no chains, so
+* each element is counted by its probe length instead: the number of
+* slots (ordered) or 16 slot groups (open addressing) a lookup for it
+* reads. @c occupied is the number of slots holding an element,
+* @c histogram[i] is the number of elements with a probe length of
+* exactly @c i , and @c mean_chain is the mean probe length. @c deleted is
+* the number of slots left behind by deletions, which lengthen probes
+* until the next rehash (it is always 0 for chained dictionaries).
+*
+* For either kind of dictionary, the last bin of the histogram also
+* counts everything longer, and @c max_chain is the longest chain or
+* probe length. Long chains mean more work per lookup and usually point to
+* a poor hash function or many keys which hash alike.
+*
+* @c table_bytes is the memory allocated for the table itself (bucket
+* array, slots or index), and @c bucket_bytes the memory allocated
+* separately for elements (chained bucket chunks or the ordered entries
+* array). @c resizes counts every change of table capacity (or rehash to
+* clear deletions) since the dictionary was created and @c resize_nanos
+* is the total time spent in them. Only the start and end of an
+* incremental resize are timed, not the migration steps in between.
+*/
+typedef struct DSDictStats {
+    size_t count;
+    size_t cap;
+    size_t occupied;
+    size_t deleted;
+    size_t max_chain;
+    double mean_chain;
+    size_t histogram[DSDICT_STATS_HISTOGRAM_BINS];
+    size_t table_bytes;
+    size_t bucket_bytes;
+    size_t resizes;
+    uint64_t resize_nanos;
+} DSDictStats;
+
+/**
+* @brief Fill in a snapshot of the internal health of the dictionary.
+*
+* Collecting statistics visits every bucket or slot in the table, so this
+* is proportional to the capacity of the dictionary and is meant to be
+* called periodically rather than on every operation.
+*
+* @param dict a @c DSDict object
+* @param out the statistics to fill in
+* @returns @c true if the statistics were filled in; @c false if either
+*          argument is @c NULL
+*/
+bool dsdict_stats(const DSDict *dict, DSDictStats *out);
+
 /**
 * @brief Perform the given function on each object in the dictionary.
 *
@@ -108,6 +444,11 @@ void dsdict_foreach(DSDict *dict, dsdict_foreach_fn func);
 
 /**
  * @brief Create a new @c DSIter object for this dictionary.
+ *
+ * Incremental resizes on @c DSDICT_INCREMENTAL_RESIZE dictionaries, and
+ * shrinks of ordered and cuckoo dictionaries, are paused until the iterator
+ * is destroyed, so iterators must not be leaked. The iterator must be
+ * destroyed before the dictionary.
  */
 DSIter *dsdict_iter(DSDict *dict);
 
@@ -119,9 +460,11 @@ DSIter *dsdict_iter(DSDict *dict);
 * when this @c dict was created, the previous value will be freed before
 * it is overwritten.
 *
-* A put operation may trigger a resize if the dictionary exceeds its
-* internal load factor. Puts are not guaranteed to be O(1) because
-* hashing collisions in the table are handled with a linked list.
+* A put operation may trigger a resize (or begin an incremental resize
+* for dictionaries created with @c DSDICT_INCREMENTAL_RESIZE ) if the
+* dictionary exceeds its internal load factor. Puts are not guaranteed
+* to be O(1) because hashing collisions in the table are handled with a
+* linked list (or by probing, for open addressing dictionaries).
 *
 * @param dict a @c DSDict object
 * @param key the key
@@ -151,4 +494,147 @@ void *dsdict_get(const DSDict *dict, void *key);
 */
 void *dsdict_del(DSDict *dict, void *key);
 
+/**
+* @brief Return the hash the dictionary would compute for the given key.
+*
+* The result may be passed to the @c dsdict_*_hashed functions for this
+* key (or any key which compares equal to it) so that a sequence of
+* operations on the same key only calls the hash function once. Hashes
+* are only meaningful to dictionaries using the same hash function.
+*
+* @param dict a @c DSDict object
+* @param key the key to hash
+* @returns the hash of @c key or 0 if @c dict or @c key is @c NULL
+*/
+uint64_t dsdict_hash_of(const DSDict *dict, void *key);
+
+/**
+* @brief Put the given element in the dictionary by key, using a hash
+* which the caller has already computed.
+*
+* This function behaves exactly as @c dsdict_put , except that it does
+* not call the dictionary hash function. The caller must supply the same
+* hash that @c dsdict_hash_of would return for @c key ; supplying any
+* other hash leaves the dictionary in an invalid state.
+*
+* @param dict a @c DSDict object
+* @param key the key
+* @param hash the hash of @c key
+* @param val the value
+*/
+void dsdict_put_hashed(DSDict *dict, void *key, uint64_t hash, void *val);
+
+/**
+* @brief Get the element given by the key, using a hash which the caller
+* has already computed.
+*
+* This function behaves exactly as @c dsdict_get , except that it does
+* not call the dictionary hash function. A hash which differs from the
+* one returned by @c dsdict_hash_of for @c key will generally not find
+* the element.
+*
+* @param dict a @c DSDict object
+* @param key the keyed element to find
+* @param hash the hash of @c key
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dsdict_get_hashed(const DSDict *dict, void *key, uint64_t hash);
+
+/**
+* @brief Remove the element from the dictionary and return it to the
+* caller, using a hash which the caller has already computed.
+*
+* This function behaves exactly as @c dsdict_del , except that it does
+* not call the dictionary hash function.
+*
+* @param dict a @c DSDict object
+* @param key the keyed element to find
+* @param hash the hash of @c key
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dsdict_del_hashed(DSDict *dict, void *key, uint64_t hash);
+
+/**
+* @brief Return a pointer to the value for the given key, adding the key
+* with a @c NULL value if it is not already present.
+*
+* The key is located (or its new slot found) with a single hash and a
+* single probe of the table, so read-modify-write sequences such as
+* incrementing a counter do not pay for a @c dsdict_get followed by a
+* @c dsdict_put . The caller may read or replace the value through the
+* returned pointer; the previous value is not freed if it is replaced.
+*
+* If the key was added, the dictionary takes ownership of @c key as it
+* would for @c dsdict_put . Otherwise the dictionary keeps its existing
+* key and @c key remains owned by the caller.
+*
+* The returned pointer is only valid until the next operation which
+* modifies the dictionary.
+*
+* @param dict a @c DSDict object
+* @param key the key
+* @param inserted if not @c NULL, set to @c true if @c key was added and
+*                 @c false otherwise
+* @returns a pointer to the value for @c key or @c NULL if @c dict or
+*          @c key is @c NULL or memory could not be allocated
+*/
+void **dsdict_get_or_insert(DSDict *dict, void *key, bool *inserted);
+
+/**
+* @brief Replace the value for the given key with the result of calling
+* @c func on its current value.
+*
+* @c func is called with the current value for @c key and @c ctx , or
+* with @c NULL if the key is not present, in which case the key is added.
+* Its return value becomes the new value for the key. As with
+* @c dsdict_get_or_insert , only a single hash and probe are performed.
+*
+* If the returned value differs from the previous value and a value free
+* function was specified when @c dict was created, the previous value
+* will be freed. Key ownership follows @c dsdict_get_or_insert .
+*
+* @param dict a @c DSDict object
+* @param key the key
+* @param func a function returning the new value for the key
+* @param ctx a context pointer passed to @c func
+* @returns @c true if the value was updated; @c false if any argument
+*          was @c NULL or memory could not be allocated
+*/
+bool dsdict_update(DSDict *dict, void *key, dsdict_update_fn func, void *ctx);
+
+/**
+* @brief Look up many keys at once.
+*
+* Keys are processed in small batches: every key in a batch is hashed
+* and the memory its lookup will touch is prefetched before any of the
+* lookups are performed. This overlaps the cache misses of independent
+* lookups, which is considerably faster than calling @c dsdict_get in a
+* loop once the dictionary is larger than the CPU cache.
+*
+* @param dict a @c DSDict object
+* @param keys an array of @c n keys; @c NULL keys are never found
+* @param n the number of keys
+* @param vals an array of @c n pointers which will be set to the value for
+*             the key at the same index, or @c NULL if it is not present
+* @returns the number of keys which were found
+*/
+size_t dsdict_get_many(const DSDict *dict, void **keys, size_t n, void **vals);
+
+/**
+* @brief Put many key/value pairs into the dictionary at once.
+*
+* This is equivalent to calling @c dsdict_put for every pair in order,
+* but hashes and prefetches keys in batches as @c dsdict_get_many does.
+* Chained dictionaries also grow once ahead of each batch, rather than
+* part way through it.
+*
+* @param dict a @c DSDict object
+* @param keys an array of @c n keys; @c NULL keys are skipped
+* @param vals an array of @c n values, which correspond to @c keys
+* @param n the number of pairs
+*/
+void dsdict_put_many(DSDict *dict, void **keys, void **vals, size_t n);
+
 #endif //LIBDS_DICT_H
@@ -0,0 +1,133 @@
+/**
+ * @file frozen.h
+ *
+ * @brief Immutable memory mapped dictionary file format.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_FROZEN_H
+#define LIBDS_FROZEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "libds/dict.h"
+
+/**
+* @brief Read-only dictionary served directly from a memory mapped file
+* written by @c dsdict_freeze_to_file .
+*
+* The file holds an open addressing hash table of serialized keys and
+* values which is used in place: opening a frozen dictionary only maps
+* the file and checks its header, so it takes the same time however many
+* elements the file holds, and lookups read keys and values straight out
+* of the page cache without deserializing anything. Every process which
+* opens the same file shares the same physical pages.
+*
+* Keys are looked up by their serialized bytes, which are hashed with
+* @c hash_wyhash , so no hash or compare callbacks are needed to read the
+* file. Positions within the file are stored as offsets from the start of
+* the file, so it may be mapped at any address. Files are written in the
+* byte order of the machine which wrote them and can only be opened on
+* machines with the same byte order.
+*
+* Frozen dictionaries are never modified, so any number of threads may
+* read one at once.
+*/
+typedef struct DSFrozenDict DSFrozenDict;
+
+/**
+* @brief Function which serializes a dictionary key or value for
+* @c dsdict_freeze_to_file .
+*
+* The function returns a pointer to the serialized bytes of @c obj and
+* stores their length in @c len , or returns @c NULL if the object could
+* not be serialized. The bytes only need to remain valid until the next
+* call to either of the functions given to @c dsdict_freeze_to_file .
+*/
+typedef const void *(*dsfrozen_serialize_fn)(const void *obj, size_t *len);
+
+/**
+* @brief A function accepting a serialized key and value to be used in
+* @c dsfrozen_foreach .
+*/
+typedef void (*dsfrozen_foreach_fn)(const void *key, size_t keylen, const void *val, size_t vallen);
+
+/**
+* @brief Write every element of a dictionary to a file which can be
+* opened with @c dsfrozen_open .
+*
+* The file is first written under a unique temporary name in the same
+* directory (@c path followed by @c . and six random characters), synced
+* to disk and then renamed over @c path , so readers never see a
+* partially written file, even after a crash, and processes which still
+* have an older version of the file mapped keep reading the older
+* version until they reopen it. The new file is readable by every user
+* and writable only by its owner.
+*
+* Distinct keys must serialize to distinct bytes. Serialized keys and
+* values may each be at most 4 GiB.
+*
+* @param dict a @c DSDict object
+* @param path the path of the file to write
+* @param keyfn a function which serializes dictionary keys
+* @param valfn a function which serializes dictionary values
+* @returns @c true if the file was written; @c false if any argument is
+*          @c NULL , an element could not be serialized, memory could not
+*          be allocated or the file could not be written
+*/
+bool dsdict_freeze_to_file(const DSDict *dict, const char *path, dsfrozen_serialize_fn keyfn, dsfrozen_serialize_fn valfn);
+
+/**
+* @brief Map a file written by @c dsdict_freeze_to_file .
+*
+* @param path the path of the file to open
+* @returns a new @c DSFrozenDict object or @c NULL if the file could not
+*          be mapped or is not a valid frozen dictionary file
+*/
+DSFrozenDict *dsfrozen_open(const char *path);
+
+/**
+* @brief Unmap the file and destroy a @c DSFrozenDict object.
+*
+* Pointers returned by @c dsfrozen_get are invalid once the dictionary
+* is closed.
+*
+* @param dict a @c DSFrozenDict object
+*/
+void dsfrozen_close(DSFrozenDict *dict);
+
+/**
+* @brief Return the number of elements in the collection.
+*
+* @param dict a @c DSFrozenDict object
+* @returns the number of elements in @c dict
+*/
+size_t dsfrozen_count(const DSFrozenDict *dict);
+
+/**
+* @brief Get the serialized value for the given serialized key.
+*
+* @param dict a @c DSFrozenDict object
+* @param key the serialized key to find
+* @param keylen the length of @c key in bytes
+* @param vallen if not @c NULL , set to the length of the value in bytes
+* @returns @c NULL if the key is not in the dictionary; otherwise a
+*          pointer to the serialized value inside the mapped file, which
+*          is aligned to 8 bytes and remains valid until the dictionary
+*          is closed
+*/
+const void *dsfrozen_get(const DSFrozenDict *dict, const void *key, size_t keylen, size_t *vallen);
+
+/**
+* @brief Perform the given function on each serialized key and value in
+* the dictionary.
+*
+* @param dict a @c DSFrozenDict object
+* @param func a function accepting the key/value pair
+*/
+void dsfrozen_foreach(const DSFrozenDict *dict, dsfrozen_foreach_fn func);
+
+#endif //LIBDS_FROZEN_H
@@ -0,0 +1,493 @@
+/**
+ * @file generic.h
+ *
+ * @brief Generators for type-specialized arrays and hash tables.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_GENERIC_H
+#define LIBDS_GENERIC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "libds/alloc.h"
+#include "libds/array.h"
+
+/**
+* @brief Maximum fraction of slots in a generated dictionary which may be
+* filled before it is resized, given as @c NUM / @c DEN .
+*
+* This matches the default load factor of a @c DSDict .
+*/
+#define LIBDS_GENERIC_DICT_LOAD_NUM 2
+#define LIBDS_GENERIC_DICT_LOAD_DEN 3
+
+/**
+* @brief The smallest number of slots in a generated dictionary which holds
+* any elements.
+*/
+#define LIBDS_GENERIC_DICT_MIN_CAP 16
+
+/**
+* @brief Spread a 32-bit hash over the low bits used to pick a slot.
+*
+* This is the same mixer applied to @c dsdict_hash_fn results by a
+* @c DSDict , so hash functions which are good enough for one are good
+* enough for the other.
+*/
+static inline uint64_t libds_generic_mix(uint32_t hash) {
+    uint64_t mixed = (uint64_t)hash * UINT64_C(0x9E3779B97F4A7C15);
+    return mixed ^ (mixed >> 32);
+}
+
+/**
+* @brief Return the number of elements a generated dictionary with @c cap
+* slots can hold before it is resized.
+*/
+static inline size_t libds_generic_dict_usable(size_t cap) {
+    return (cap / LIBDS_GENERIC_DICT_LOAD_DEN) * LIBDS_GENERIC_DICT_LOAD_NUM +
+           ((cap % LIBDS_GENERIC_DICT_LOAD_DEN) * LIBDS_GENERIC_DICT_LOAD_NUM) / LIBDS_GENERIC_DICT_LOAD_DEN;
+}
+
+/**
+* @brief Return the smallest power of two number of slots (and at least
+* @c LIBDS_GENERIC_DICT_MIN_CAP ) which holds @c n elements, or 0 if no
+* such capacity can be allocated.
+*/
+static inline size_t libds_generic_dict_cap_for(size_t n, size_t slotsize) {
+    size_t cap = LIBDS_GENERIC_DICT_MIN_CAP;
+    while (libds_generic_dict_usable(cap) < n) {
+        if (cap > (SIZE_MAX / 2)) { return 0; }
+        cap *= 2;
+    }
+    if (cap > (SIZE_MAX / slotsize)) { return 0; }
+    return cap;
+}
+
+/**
+* @brief Resize a block of memory from the given allocator, falling back
+* on allocating, copying and freeing for allocators without @c realloc .
+*/
+static inline void *libds_generic_realloc(const DSAllocator *alloc, void *ptr, size_t oldsize, size_t newsize) {
+    if (!ptr) { return alloc->alloc(alloc->ctx, newsize); }
+    if (alloc->realloc) { return alloc->realloc(alloc->ctx, ptr, oldsize, newsize); }
+
+    void *newptr = alloc->alloc(alloc->ctx, newsize);
+    if (!newptr) { return NULL; }
+    memcpy(newptr, ptr, (oldsize < newsize) ? oldsize : newsize);
+    if (alloc->free) { alloc->free(alloc->ctx, ptr, oldsize); }
+    return newptr;
+}
+
+/**
+* @brief Copy the given allocator into @c dest , using the default
+* allocator if no allocator was given.
+*
+* Invalid allocators are replaced by an empty allocator, so containers
+* which fail to initialize can still safely be destroyed.
+*/
+static inline bool libds_generic_alloc_init(DSAllocator *dest, const DSAllocator *alloc) {
+    if (!alloc) { alloc = dsalloc_default(); }
+    if (!alloc->alloc) {
+        memset(dest, 0, sizeof(DSAllocator));
+        return false;
+    }
+    *dest = *alloc;
+    return true;
+}
+
+/**
+* @brief Define an automatically resizing array type @c name holding
+* elements of type @c T by value, along with functions operating on it.
+*
+* The generated functions are @c static @c inline and are named by
+* prefixing @c name to the @c DSArray function they mirror:
+*
+* - @c bool name_init(name *vec) and
+*   @c bool name_init_alloc(name *vec, const DSAllocator *alloc)
+*   initialize an empty array (no memory is allocated until the first
+*   element is added)
+* - @c void name_destroy(name *vec) frees the array's storage
+* - @c size_t name_len(const name *vec) and
+*   @c size_t name_cap(const name *vec)
+* - @c T *name_get(const name *vec, size_t index) and
+*   @c T *name_top(const name *vec) return a pointer to an element,
+*   which is valid until the array is next resized, or @c NULL
+* - @c bool name_append(name *vec, T elem) and
+*   @c bool name_insert(name *vec, T elem, size_t index)
+* - @c bool name_remove_index(name *vec, size_t index, T *out) and
+*   @c bool name_pop(name *vec, T *out) copy the removed element into
+*   @c out if it is not @c NULL
+* - @c bool name_reserve(name *vec, size_t n)
+* - @c void name_clear(name *vec) and @c void name_reverse(name *vec)
+*
+* Arrays start with @c DSARRAY_DEFAULT_CAPACITY elements and grow by
+* @c DSARRAY_CAPACITY_FACTOR , exactly as a @c DSArray does. Elements are
+* never freed by the array. The array may be used directly as a C array
+* through its @c data and @c len fields (e.g. to @c qsort it).
+*
+* This macro must be used at file scope, once per translation unit.
+*/
+#define LIBDS_DEFINE_VEC(name, T)                                              \
+typedef struct name {                                                          \
+    T *data;                                                                   \
+    size_t len;                                                                \
+    size_t cap;                                                                \
+    DSAllocator alloc;                                                         \
+} name;                                                                        \
+                                                                               \
+static inline bool name##_init_alloc(name *vec, const DSAllocator *alloc) {    \
+    vec->data = NULL;                                                          \
+    vec->len = 0;                                                              \
+    vec->cap = 0;                                                              \
+    return libds_generic_alloc_init(&vec->alloc, alloc);                       \
+}                                                                              \
+                                                                               \
+static inline bool name##_init(name *vec) {                                    \
+    return name##_init_alloc(vec, NULL);                                       \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name *vec) {                                 \
+    if (!vec) { return; }                                                      \
+    if ((vec->data) && (vec->alloc.free)) {                                    \
+        vec->alloc.free(vec->alloc.ctx, vec->data, vec->cap * sizeof(T));      \
+    }                                                                          \
+    vec->data = NULL;                                                          \
+    vec->len = 0;                                                              \
+    vec->cap = 0;                                                              \
+}                                                                              \
+                                                                               \
+static inline size_t name##_len(const name *vec) {                             \
+    return vec->len;                                                           \
+}                                                                              \
+                                                                               \
+static inline size_t name##_cap(const name *vec) {                             \
+    return vec->cap;                                                           \
+}                                                                              \
+                                                                               \
+static inline bool name##_reserve(name *vec, size_t n) {                       \
+    if (!vec) { return false; }                                                \
+    if (n <= vec->cap) { return true; }                                        \
+    if (n > (SIZE_MAX / sizeof(T))) { return false; }                          \
+    T *data = (T *)libds_generic_realloc(&vec->alloc, vec->data,               \
+                                         vec->cap * sizeof(T), n * sizeof(T)); \
+    if (!data) { return false; }                                               \
+    vec->data = data;                                                          \
+    vec->cap = n;                                                              \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline T *name##_get(const name *vec, size_t index) {                   \
+    if ((!vec) || (index >= vec->len)) { return NULL; }                        \
+    return &vec->data[index];                                                  \
+}                                                                              \
+                                                                               \
+static inline T *name##_top(const name *vec) {                                 \
+    if ((!vec) || (vec->len == 0)) { return NULL; }                            \
+    return &vec->data[vec->len - 1];                                           \
+}                                                                              \
+                                                                               \
+static inline bool name##_insert(name *vec, T elem, size_t index) {            \
+    if ((!vec) || (index > vec->len)) { return false; }                        \
+    if (vec->len == vec->cap) {                                                \
+        size_t newcap = DSARRAY_DEFAULT_CAPACITY;                              \
+        if (vec->cap > 0) {                                                    \
+            if (vec->cap > (SIZE_MAX / DSARRAY_CAPACITY_FACTOR)) {             \
+                return false;                                                  \
+            }                                                                  \
+            newcap = vec->cap * DSARRAY_CAPACITY_FACTOR;                       \
+        }                                                                      \
+        if (!name##_reserve(vec, newcap)) { return false; }                    \
+    }                                                                          \
+    if (index < vec->len) {                                                    \
+        memmove(&vec->data[index + 1], &vec->data[index],                      \
+                (vec->len - index) * sizeof(T));                               \
+    }                                                                          \
+    vec->data[index] = elem;                                                   \
+    vec->len++;                                                                \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_append(name *vec, T elem) {                          \
+    return (!vec) ? (false) : name##_insert(vec, elem, vec->len);              \
+}                                                                              \
+                                                                               \
+static inline bool name##_remove_index(name *vec, size_t index, T *out) {      \
+    if ((!vec) || (index >= vec->len)) { return false; }                       \
+    if (out) { *out = vec->data[index]; }                                      \
+    memmove(&vec->data[index], &vec->data[index + 1],                          \
+            (vec->len - index - 1) * sizeof(T));                               \
+    vec->len--;                                                                \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_pop(name *vec, T *out) {                             \
+    if ((!vec) || (vec->len == 0)) { return false; }                           \
+    return name##_remove_index(vec, vec->len - 1, out);                        \
+}                                                                              \
+                                                                               \
+static inline void name##_clear(name *vec) {                                   \
+    if (!vec) { return; }                                                      \
+    vec->len = 0;                                                              \
+}                                                                              \
+                                                                               \
+static inline void name##_reverse(name *vec) {                                 \
+    if ((!vec) || (vec->len < 2)) { return; }                                  \
+    for (size_t i = 0, j = vec->len - 1; i < j; i++, j--) {                    \
+        T tmp = vec->data[i];                                                  \
+        vec->data[i] = vec->data[j];                                           \
+        vec->data[j] = tmp;                                                    \
+    }                                                                          \
+}
+
+/**
+* @brief Define a hash table type @c name mapping keys of type @c K to
+* values of type @c V , both stored by value, along with functions
+* operating on it.
+*
+* @c hashfn is called as @c hashfn(key) and must return a @c uint32_t
+* hash of the key, exactly like a @c dsdict_hash_fn . @c eqfn is called as
+* @c eqfn(left, right) and must return nonzero if the keys are equal.
+* Either may be a function or a function-like macro; since they are named
+* directly rather than called through a pointer, the compiler is free to
+* inline them.
+*
+* The generated functions are @c static @c inline and are named by
+* prefixing @c name to the @c DSDict function they mirror:
+*
+* - @c bool name_init(name *dict) and
+*   @c bool name_init_alloc(name *dict, const DSAllocator *alloc)
+*   initialize an empty dictionary (no memory is allocated until the
+*   first element is added)
+* - @c void name_destroy(name *dict) frees the dictionary's storage
+* - @c size_t name_count(const name *dict) and
+*   @c size_t name_cap(const name *dict)
+* - @c bool name_put(name *dict, K key, V val)
+* - @c V *name_get(const name *dict, K key) returns a pointer to the
+*   value for @c key , or @c NULL if it is not in the dictionary
+* - @c V *name_get_or_insert(name *dict, K key, bool *inserted) adds
+*   @c key with a zeroed value if it is not already present
+* - @c bool name_del(name *dict, K key, V *out) copies the removed value
+*   into @c out if it is not @c NULL
+* - @c bool name_reserve(name *dict, size_t n) and
+*   @c void name_clear(name *dict)
+* - @c bool name_next(const name *dict, size_t *pos, K **key, V **val)
+*   visits each element in turn, starting from @c *pos equal to 0
+*
+* Pointers to keys and values are only valid until the next operation
+* which adds or removes elements, and the dictionary must not be modified
+* while it is being iterated. Keys and values are never freed by the
+* dictionary.
+*
+* Dictionaries use linear probing over a power of two number of slots,
+* with the load factor, minimum capacity, growth factor and automatic
+* shrinking of a @c DSDict . Deletions shift later elements of the probe
+* run back rather than leaving tombstones, as in a @c DSIntDict .
+*
+* This macro must be used at file scope, once per translation unit.
+*/
+#define LIBDS_DEFINE_DICT(name, K, V, hashfn, eqfn)                            \
+typedef struct name##_slot {                                                   \
+    K key;                                                                     \
+    V val;                                                                     \
+    uint32_t hash;                                                             \
+    bool used;                                                                 \
+} name##_slot;                                                                 \
+                                                                               \
+typedef struct name {                                                          \
+    name##_slot *slots;                                                        \
+    size_t cap;                                                                \
+    size_t cnt;                                                                \
+    DSAllocator alloc;                                                         \
+} name;                                                                        \
+                                                                               \
+static inline bool name##_init_alloc(name *dict, const DSAllocator *alloc) {   \
+    dict->slots = NULL;                                                        \
+    dict->cap = 0;                                                             \
+    dict->cnt = 0;                                                             \
+    return libds_generic_alloc_init(&dict->alloc, alloc);                      \
+}                                                                              \
+                                                                               \
+static inline bool name##_init(name *dict) {                                   \
+    return name##_init_alloc(dict, NULL);                                      \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name *dict) {                                \
+    if (!dict) { return; }                                                     \
+    if ((dict->slots) && (dict->alloc.free)) {                                 \
+        dict->alloc.free(dict->alloc.ctx, dict->slots,                         \
+                         dict->cap * sizeof(name##_slot));                     \
+    }                                                                          \
+    dict->slots = NULL;                                                        \
+    dict->cap = 0;                                                             \
+    dict->cnt = 0;                                                             \
+}                                                                              \
+                                                                               \
+static inline size_t name##_count(const name *dict) {                          \
+    return dict->cnt;                                                          \
+}                                                                              \
+                                                                               \
+static inline size_t name##_cap(const name *dict) {                            \
+    return dict->cap;                                                          \
+}                                                                              \
+                                                                               \
+/* Find the slot holding key, or the empty slot ending its probe run. */      \
+static inline bool name##_find_slot(const name *dict, K key, uint32_t hash,    \
+                                    size_t *place) {                           \
+    size_t mask = dict->cap - 1;                                               \
+    size_t i = (size_t)libds_generic_mix(hash) & mask;                         \
+    while (dict->slots[i].used) {                                              \
+        if ((dict->slots[i].hash == hash) && (eqfn(dict->slots[i].key, key))) { \
+            *place = i;                                                        \
+            return true;                                                       \
+        }                                                                      \
+        i = (i + 1) & mask;                                                    \
+    }                                                                          \
+    *place = i;                                                                \
+    return false;                                                              \
+}                                                                              \
+                                                                               \
+/* Move every element into a new array of newcap slots. */                    \
+static inline bool name##_resize(name *dict, size_t newcap) {                  \
+    name##_slot *slots = (name##_slot *)dict->alloc.alloc(dict->alloc.ctx,     \
+                                        newcap * sizeof(name##_slot));         \
+    if (!slots) { return false; }                                              \
+    for (size_t i = 0; i < newcap; i++) {                                      \
+        slots[i].used = false;                                                 \
+    }                                                                          \
+                                                                               \
+    size_t mask = newcap - 1;                                                  \
+    for (size_t i = 0; i < dict->cap; i++) {                                   \
+        if (!dict->slots[i].used) { continue; }                                \
+        size_t j = (size_t)libds_generic_mix(dict->slots[i].hash) & mask;      \
+        while (slots[j].used) {                                                \
+            j = (j + 1) & mask;                                                \
+        }                                                                      \
+        slots[j] = dict->slots[i];                                             \
+    }                                                                          \
+                                                                               \
+    if ((dict->slots) && (dict->alloc.free)) {                                 \
+        dict->alloc.free(dict->alloc.ctx, dict->slots,                         \
+                         dict->cap * sizeof(name##_slot));                     \
+    }                                                                          \
+    dict->slots = slots;                                                       \
+    dict->cap = newcap;                                                        \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_reserve(name *dict, size_t n) {                      \
+    if (!dict) { return false; }                                               \
+    size_t newcap = libds_generic_dict_cap_for(n, sizeof(name##_slot));        \
+    if (newcap == 0) { return false; }                                         \
+    if (newcap <= dict->cap) { return true; }                                  \
+    return name##_resize(dict, newcap);                                        \
+}                                                                              \
+                                                                               \
+static inline V *name##_get(const name *dict, K key) {                         \
+    if ((!dict) || (dict->cnt == 0)) { return NULL; }                          \
+    size_t i;                                                                  \
+    if (!name##_find_slot(dict, key, (uint32_t)(hashfn(key)), &i)) {           \
+        return NULL;                                                           \
+    }                                                                          \
+    return &dict->slots[i].val;                                                \
+}                                                                              \
+                                                                               \
+static inline V *name##_get_or_insert(name *dict, K key, bool *inserted) {     \
+    if (inserted) { *inserted = false; }                                       \
+    if (!dict) { return NULL; }                                                \
+                                                                               \
+    uint32_t hash = (uint32_t)(hashfn(key));                                   \
+    size_t i = 0;                                                              \
+    if ((dict->cap > 0) && (name##_find_slot(dict, key, hash, &i))) {          \
+        return &dict->slots[i].val;                                            \
+    }                                                                          \
+    if ((dict->cnt + 1) > libds_generic_dict_usable(dict->cap)) {              \
+        size_t newcap = LIBDS_GENERIC_DICT_MIN_CAP;                            \
+        if (dict->cap > 0) {                                                   \
+            if (dict->cap > (SIZE_MAX / (2 * sizeof(name##_slot)))) {          \
+                return NULL;                                                   \
+            }                                                                  \
+            newcap = dict->cap * 2;                                            \
+        }                                                                      \
+        if (!name##_resize(dict, newcap)) { return NULL; }                     \
+        name##_find_slot(dict, key, hash, &i);                                 \
+    }                                                                          \
+                                                                               \
+    name##_slot *slot = &dict->slots[i];                                       \
+    memset(&slot->val, 0, sizeof(V));                                          \
+    slot->key = key;                                                           \
+    slot->hash = hash;                                                         \
+    slot->used = true;                                                         \
+    dict->cnt++;                                                               \
+    if (inserted) { *inserted = true; }                                        \
+    return &slot->val;                                                         \
+}                                                                              \
+                                                                               \
+static inline bool name##_put(name *dict, K key, V val) {                      \
+    V *slot = name##_get_or_insert(dict, key, NULL);                           \
+    if (!slot) { return false; }                                               \
+    *slot = val;                                                               \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_del(name *dict, K key, V *out) {                     \
+    if ((!dict) || (dict->cnt == 0)) { return false; }                         \
+    size_t i;                                                                  \
+    if (!name##_find_slot(dict, key, (uint32_t)(hashfn(key)), &i)) {           \
+        return false;                                                          \
+    }                                                                          \
+    if (out) { *out = dict->slots[i].val; }                                    \
+                                                                               \
+    /* Shift later elements of the probe run back over the hole */            \
+    size_t mask = dict->cap - 1;                                               \
+    size_t j = i;                                                              \
+    for (;;) {                                                                 \
+        j = (j + 1) & mask;                                                    \
+        if (!dict->slots[j].used) { break; }                                   \
+        size_t home = (size_t)libds_generic_mix(dict->slots[j].hash) & mask;   \
+        bool stays = (i <= j) ? ((i < home) && (home <= j))                    \
+                              : ((i < home) || (home <= j));                   \
+        if (stays) { continue; }                                               \
+        dict->slots[i] = dict->slots[j];                                       \
+        i = j;                                                                 \
+    }                                                                          \
+    dict->slots[i].used = false;                                               \
+    dict->cnt--;                                                               \
+                                                                               \
+    /* Shrink once the table is a quarter full, as a DSDict does */           \
+    if ((dict->cap > LIBDS_GENERIC_DICT_MIN_CAP) &&                            \
+        (dict->cnt < (libds_generic_dict_usable(dict->cap) / 4))) {            \
+        name##_resize(dict, libds_generic_dict_cap_for(dict->cnt * 2,          \
+                                                       sizeof(name##_slot)));  \
+    }                                                                          \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline void name##_clear(name *dict) {                                  \
+    if (!dict) { return; }                                                     \
+    for (size_t i = 0; i < dict->cap; i++) {                                   \
+        dict->slots[i].used = false;                                           \
+    }                                                                          \
+    dict->cnt = 0;                                                             \
+}                                                                              \
+                                                                               \
+static inline bool name##_next(const name *dict, size_t *pos, K **key,         \
+                               V **val) {                                      \
+    if ((!dict) || (!pos)) { return false; }                                   \
+    for (size_t i = *pos; i < dict->cap; i++) {                                \
+        if (!dict->slots[i].used) { continue; }                                \
+        if (key) { *key = &dict->slots[i].key; }                               \
+        if (val) { *val = &dict->slots[i].val; }                               \
+        *pos = i + 1;                                                          \
+        return true;                                                           \
+    }                                                                          \
+    *pos = dict->cap;                                                          \
+    return false;                                                              \
+}
+
+#endif //LIBDS_GENERIC_H
@@ -11,6 +11,7 @@
 #ifndef LIBDS_HASH_H
 #define LIBDS_HASH_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -58,4 +59,130 @@ uint32_t hash_djb2(const char *str);
 */
 uint32_t hash_sdbm(const char *str);
 
+/**
+* @brief Hash an arbitrary block of bytes.
+*
+* This is an implementation of the wyhash algorithm by Wang Yi, described
+* [here](https://github.com/wangyi-fudan/wyhash). Unlike the other string
+* hashes in this file, it consumes 8 to 48 bytes per step rather than a
+* single byte, and it hashes exactly @c len bytes (so @c data may contain
+* @c NUL bytes and need not be terminated).
+*
+* Different seeds produce independent hash functions, which can be used
+* to defend dictionaries against hash flooding.
+*
+* @param data a pointer to the bytes to hash
+* @param len the number of bytes to hash
+* @param seed an arbitrary seed value
+* @returns a 64-bit hash value
+*/
+uint64_t hash_wyhash(const void *data, size_t len, uint64_t seed);
+
+/**
+* @brief Incremental @c hash_wyhash state.
+*
+* The state may be declared on the stack or embedded in other objects.
+* Hashing data with @c hash_wyhash_init , any number of calls to
+* @c hash_wyhash_update and then @c hash_wyhash_final produces exactly the
+* same value as a single call to @c hash_wyhash over the concatenated data,
+* however the data was split. Callers should treat the fields as private.
+*/
+typedef struct DSWyhashState {
+    uint64_t seed;
+    uint64_t see1;
+    uint64_t see2;
+    uint64_t len;
+    size_t pending;
+    uint8_t buf[64];
+} DSWyhashState;
+
+/**
+* @brief Initialize an incremental @c hash_wyhash state.
+*
+* @param state a @c DSWyhashState object
+* @param seed an arbitrary seed value
+*/
+void hash_wyhash_init(DSWyhashState *state, uint64_t seed);
+
+/**
+* @brief Add bytes to an incremental @c hash_wyhash state.
+*
+* Input is consumed in 48 byte blocks as it arrives and at most 48 bytes
+* are buffered in the state, so data never needs to be materialized in
+* one place to be hashed.
+*
+* @param state a @c DSWyhashState object
+* @param data a pointer to the bytes to hash
+* @param len the number of bytes to hash
+*/
+void hash_wyhash_update(DSWyhashState *state, const void *data, size_t len);
+
+/**
+* @brief Return the hash of every byte added to an incremental state.
+*
+* The state is not modified, so more data may be added after computing
+* the hash of a prefix.
+*
+* @param state a @c DSWyhashState object
+* @returns the same 64-bit hash value as @c hash_wyhash
+*/
+uint64_t hash_wyhash_final(const DSWyhashState *state);
+
+/**
+* @brief Hash a string using @c hash_wyhash with a seed of 0.
+*
+* This function is provided for use as a @c dsdict_hash_fn for keys which
+* are @c NUL terminated C strings.
+*
+* @param str a @c NUL terminated C string
+* @returns a hash value
+*/
+uint32_t hash_wyhash_str(const char *str);
+
+/**
+* @brief Hash a 64-bit integer.
+*
+* The result depends on every bit of @c key , so it is suitable for use
+* with power of 2 table sizes even when keys are sequential or share
+* their low bits. This is the hash used by @c DSIntDict .
+*
+* @param key the integer to hash
+* @param seed an arbitrary seed value
+* @returns a 64-bit hash value
+*/
+uint64_t hash_u64(uint64_t key, uint64_t seed);
+
+/**
+* @brief Compute the CRC32C (Castagnoli) checksum of a block of bytes.
+*
+* On x86 CPUs supporting SSE4.2 and ARMv8 CPUs with the CRC extension,
+* the checksum is computed using the dedicated CRC instructions, which
+* are selected at runtime. Other CPUs use a table driven implementation.
+* Every implementation produces identical results.
+*
+* The @c seed is the checksum of any preceding data, so a checksum may be
+* computed incrementally by passing the result of the previous call as
+* the seed of the next call (starting from 0). No separate incremental
+* state is needed for CRC32C.
+*
+* @param data a pointer to the bytes to checksum
+* @param len the number of bytes to checksum
+* @param seed the checksum of preceding data, or 0
+* @returns a CRC32C checksum
+*/
+uint32_t hash_crc32c(const void *data, size_t len, uint32_t seed);
+
+/**
+* @brief Hash a string using @c hash_crc32c with a seed of 0.
+*
+* CRC32C is extremely cheap for short keys when hardware support is
+* available, though it is not as well distributed as @c hash_wyhash .
+* This function is provided for use as a @c dsdict_hash_fn for keys which
+* are @c NUL terminated C strings.
+*
+* @param str a @c NUL terminated C string
+* @returns a hash value
+*/
+uint32_t hash_crc32c_str(const char *str);
+
 #endif //LIBDS_HASH_H
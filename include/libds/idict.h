@@ -0,0 +1,206 @@
+/**
+ * @file idict.h
+ *
+ * @brief Hash table specialized for 64-bit integer keys.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_IDICT_H
+#define LIBDS_IDICT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "libds/alloc.h"
+#include "libds/dict.h"
+#include "libds/iter.h"
+
+/**
+* @brief Hash table keyed by unsigned 64-bit integers.
+*
+* Keys are stored inline next to their values in a single flat array of
+* slots, rather than boxed behind a pointer, and are hashed with the
+* built-in @c hash_u64 mixer and compared with @c == , so no hash or
+* compare callbacks are called on any operation. Collisions are resolved
+* with linear probing, and deletions shift later elements of the probe
+* run back rather than leaving tombstones, so lookups never scan past
+* deleted elements. Every key value (including 0) may be stored.
+*/
+typedef struct DSIntDict DSIntDict;
+
+/**
+* @brief A function accepting a key/value pair to be used in
+* @c dsidict_foreach .
+*/
+typedef void (*dsidict_foreach_fn)(uint64_t, void*);
+
+/**
+* @brief Create a new @c DSIntDict object.
+*
+* The parameter @c valfree is optional. If the caller does not specify
+* @c valfree , then element values will not be freed when the
+* @c DSIntDict object is destroyed or values are overwritten.
+*
+* @param valfree a function which can free hash table values
+* @returns a new @c DSIntDict object or @c NULL if memory could not be
+*          allocated
+*/
+DSIntDict *dsidict_new(dsdict_free_fn valfree);
+
+/**
+* @brief Create a new @c DSIntDict object which can hold @c cap elements
+* without resizing.
+*
+* Other than the initial capacity, this function behaves exactly as
+* @c dsidict_new . The dictionary will not automatically shrink below
+* this size (see @c dsidict_reserve ).
+*
+* @param cap the number of elements the dictionary should hold before
+*            its first resize
+* @param valfree a function which can free hash table values
+* @returns a new @c DSIntDict object or @c NULL if memory could not be
+*          allocated
+*/
+DSIntDict *dsidict_new_cap(size_t cap, dsdict_free_fn valfree);
+
+/**
+* @brief Create a new @c DSIntDict object which allocates memory using
+* the given allocator.
+*
+* The slot array, the dictionary object itself and any iterators created
+* from the dictionary are all allocated using @c alloc . The allocator is
+* copied into the dictionary, though its context must outlive the
+* dictionary.
+*
+* @param valfree a function which can free hash table values
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSIntDict object or @c NULL if memory could not be
+*          allocated
+*/
+DSIntDict *dsidict_new_alloc(dsdict_free_fn valfree, const DSAllocator *alloc);
+
+/**
+* @brief Destroy a @c DSIntDict object.
+*
+* If a @c dsdict_free_fn was specified when the dictionary was created, it
+* will be called on each value.
+*
+* @param dict a @c DSIntDict object
+*/
+void dsidict_destroy(DSIntDict *dict);
+
+/**
+* @brief Return the number of elements in the collection.
+*
+* @param dict a @c DSIntDict object
+* @returns the number of elements in @c dict
+*/
+size_t dsidict_count(const DSIntDict *dict);
+
+/**
+* @brief Return the capacity of this collection.
+*
+* @param dict a @c DSIntDict object
+* @returns the number of slots in @c dict
+*/
+size_t dsidict_cap(const DSIntDict *dict);
+
+/**
+* @brief Make sure the dictionary can hold at least @c n elements without
+* resizing.
+*
+* The reservation also becomes the minimum size of the dictionary, so it
+* will not automatically shrink below it as elements are deleted.
+*
+* @param dict a @c DSIntDict object
+* @param n the number of elements to reserve room for
+* @returns @c true if the dictionary can hold @c n elements; @c false if
+*          memory could not be allocated
+*/
+bool dsidict_reserve(DSIntDict *dict, size_t n);
+
+/**
+* @brief Shrink the dictionary to the smallest capacity which holds its
+* elements, and clear any minimum size set by @c dsidict_reserve .
+*
+* @param dict a @c DSIntDict object
+*/
+void dsidict_shrink_to_fit(DSIntDict *dict);
+
+/**
+* @brief Perform the given function on each object in the dictionary.
+*
+* @param dict a @c DSIntDict object
+* @param func a function accepting the key/value pair
+*/
+void dsidict_foreach(DSIntDict *dict, dsidict_foreach_fn func);
+
+/**
+* @brief Put the given element in the dictionary by key.
+*
+* Put operations overwrite the value of elements already in the
+* dictionary, freeing the previous value if a free function was given.
+*
+* @param dict a @c DSIntDict object
+* @param key the key
+* @param val the value
+* @returns @c true if the element was stored; @c false if memory could
+*          not be allocated
+*/
+bool dsidict_put(DSIntDict *dict, uint64_t key, void *val);
+
+/**
+* @brief Get the element given by the key.
+*
+* @param dict a @c DSIntDict object
+* @param key the keyed element to find
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dsidict_get(const DSIntDict *dict, uint64_t key);
+
+/**
+* @brief Return a pointer to the value for the given key, adding the key
+* with a @c NULL value if it is not already present.
+*
+* This function behaves exactly as @c dsdict_get_or_insert . The
+* returned pointer is only valid until the next operation which may add
+* or remove elements.
+*
+* @param dict a @c DSIntDict object
+* @param key the key
+* @param inserted if not @c NULL , set to @c true if the key was added
+* @returns a pointer to the value for @c key or @c NULL if memory could
+*          not be allocated
+*/
+void **dsidict_get_or_insert(DSIntDict *dict, uint64_t key, bool *inserted);
+
+/**
+* @brief Remove the element from the dictionary and return it to the caller.
+*
+* @param dict a @c DSIntDict object
+* @param key the keyed element to find
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dsidict_del(DSIntDict *dict, uint64_t key);
+
+/**
+* @brief Create a new @c DSIter object for this dictionary.
+*
+* @c dsiter_key returns a pointer to a @c uint64_t holding the key of the
+* current element. Deleting elements moves other elements within the
+* table, so the dictionary must not be modified while it is being
+* iterated.
+*
+* @param dict a @c DSIntDict object
+* @returns a new @c DSIter object or @c NULL if memory could not be
+*          allocated
+*/
+DSIter *dsidict_iter(DSIntDict *dict);
+
+#endif //LIBDS_IDICT_H
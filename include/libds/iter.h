@@ -30,6 +30,7 @@ typedef struct DSIter DSIter;
 static const int DSITER_NORMAL = 0;
 static const int DSITER_NEW_ITERATOR = (1 << 0);
 static const int DSITER_NO_MORE_ELEMENTS = (1 << 1);
+static const int DSITER_ERROR = (1 << 2);
 
 /**
 * @brief Advance the pointer to next element in the collection.
@@ -87,6 +88,21 @@ void *dsiter_value(DSIter *iter);
 */
 size_t dsiter_index(const DSIter *iter);
 
+/**
+* @brief Indicates whether iteration stopped early because of an error.
+*
+* Iterators which must allocate memory as they go (such as those for
+* @c DSConcurrentDict objects, which copy each shard as they reach it)
+* stop if that memory cannot be allocated. @c dsiter_next then returns
+* @c false as it would at the end of the collection, and continues to do
+* so until the iterator is reset.
+*
+* @param iter a @c DSIter object
+* @returns @c true if iteration stopped because of an error; @c false
+*          otherwise
+*/
+bool dsiter_error(const DSIter *iter);
+
 /**
 * @brief Reset a @c DSIter object to a new state.
 *
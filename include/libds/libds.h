@@ -11,11 +11,19 @@
 #ifndef LIBDS_LIBDS_H
 #define LIBDS_LIBDS_H
 
+#include "libds/alloc.h"
+#include "libds/arena.h"
 #include "libds/array.h"
 #include "libds/buffer.h"
+#include "libds/cdict.h"
 #include "libds/dict.h"
+#include "libds/frozen.h"
+#include "libds/generic.h"
 #include "libds/hash.h"
+#include "libds/idict.h"
 #include "libds/iter.h"
 #include "libds/list.h"
+#include "libds/perfect.h"
+#include "libds/rdict.h"
 
 #endif //LIBDS_LIBDS_H
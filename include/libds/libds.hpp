@@ -0,0 +1,746 @@
+/**
+ * @file libds.hpp
+ *
+ * @brief Header-only C++ facade over libds containers.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_LIBDS_HPP
+#define LIBDS_LIBDS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "libds/array.h"
+#include "libds/buffer.h"
+#include "libds/generic.h"
+#include "libds/hash.h"
+}
+
+/**
+* @brief C++ wrappers for libds containers.
+*
+* @c ds::array and @c ds::dict are templates which store their elements by
+* value, and take their hash and comparison as function objects, so the
+* compiler may inline them into every probe. They use the same growth
+* policies and probing algorithm as the C containers generated by
+* @c LIBDS_DEFINE_VEC and @c LIBDS_DEFINE_DICT . @c ds::buffer owns a
+* @c DSBuffer .
+*
+* Unlike the C API, these classes report allocation failures by throwing
+* @c std::bad_alloc .
+*/
+namespace ds {
+
+namespace detail {
+
+// Fold an integer of up to 64 bits into a 32-bit hash.
+inline uint32_t fold(uint64_t key) {
+    return static_cast<uint32_t>(key ^ (key >> 32));
+}
+
+}
+
+/**
+* @brief Hash function object used by @c ds::dict by default.
+*
+* Specializations are provided for integral, enumeration and pointer types
+* (which hash by address), @c std::string and @c ds::buffer . Like a
+* @c dsdict_hash_fn , a hash returns 32 bits which are mixed again before
+* choosing a slot.
+*/
+template <typename T, typename Enable = void>
+struct hash;
+
+template <typename T>
+struct hash<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+    uint32_t operator()(T key) const {
+        return detail::fold(static_cast<uint64_t>(key));
+    }
+};
+
+template <typename T>
+struct hash<T *, void> {
+    uint32_t operator()(T *key) const {
+        return detail::fold(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key)));
+    }
+};
+
+template <>
+struct hash<std::string, void> {
+    uint32_t operator()(const std::string &key) const {
+        return static_cast<uint32_t>(hash_wyhash(key.data(), key.size(), 0));
+    }
+};
+
+/**
+* @brief Equality function object used by @c ds::dict by default.
+*/
+template <typename T>
+struct equal_to {
+    bool operator()(const T &left, const T &right) const {
+        return left == right;
+    }
+};
+
+/**
+* @brief Owning handle to a @c DSBuffer .
+*
+* Copies duplicate the underlying buffer and moves transfer it. A buffer
+* which has been moved from may only be assigned to or destroyed.
+*/
+class buffer {
+public:
+    buffer() : buf_(check(dsbuf_new(""))) {}
+    buffer(const char *value) : buf_(check(dsbuf_new(value))) {}
+    buffer(const char *value, size_t len) : buf_(check(dsbuf_new_l(value, len))) {}
+    explicit buffer(const std::string &value) : buf_(check(dsbuf_new_l(value.data(), value.size()))) {}
+
+    /**
+    * @brief Take ownership of an existing @c DSBuffer , which must not be
+    * @c NULL .
+    */
+    explicit buffer(DSBuffer *buf) : buf_(check(buf)) {}
+
+    buffer(const buffer &other) : buf_(check(dsbuf_dup(other.buf_))) {}
+    buffer(buffer &&other) noexcept : buf_(other.buf_) { other.buf_ = nullptr; }
+    ~buffer() { dsbuf_destroy(buf_); }
+
+    buffer &operator=(const buffer &other) {
+        if (this != &other) {
+            DSBuffer *copy = check(dsbuf_dup(other.buf_));
+            dsbuf_destroy(buf_);
+            buf_ = copy;
+        }
+        return *this;
+    }
+
+    buffer &operator=(buffer &&other) noexcept {
+        if (this != &other) {
+            dsbuf_destroy(buf_);
+            buf_ = other.buf_;
+            other.buf_ = nullptr;
+        }
+        return *this;
+    }
+
+    size_t size() const { return dsbuf_len(buf_); }
+    size_t capacity() const { return dsbuf_cap(buf_); }
+    bool empty() const { return size() == 0; }
+    const char *c_str() const { return dsbuf_char_ptr(buf_); }
+    char operator[](size_t pos) const { return static_cast<char>(dsbuf_char_at(buf_, pos)); }
+
+    buffer &append(const char *value) {
+        if (!dsbuf_append_str(buf_, value)) { throw std::bad_alloc(); }
+        return *this;
+    }
+
+    buffer &append(char value) {
+        if (!dsbuf_append_char(buf_, value)) { throw std::bad_alloc(); }
+        return *this;
+    }
+
+    buffer &append(const buffer &other) {
+        if (!dsbuf_append(buf_, other.buf_)) { throw std::bad_alloc(); }
+        return *this;
+    }
+
+    buffer &operator+=(const char *value) { return append(value); }
+    buffer &operator+=(char value) { return append(value); }
+    buffer &operator+=(const buffer &other) { return append(other); }
+
+    /**
+    * @brief Return a new buffer holding up to @c len characters starting
+    * at @c start , or throw @c std::out_of_range if @c start is past the
+    * end of the buffer.
+    */
+    buffer substr(size_t start, size_t len) const {
+        DSBuffer *sub = dsbuf_substr(buf_, start, len);
+        if (!sub) { throw std::out_of_range("ds::buffer::substr"); }
+        return buffer(sub);
+    }
+
+    int compare(const buffer &other) const { return dsbuf_compare(buf_, other.buf_); }
+    uint32_t hash() const { return static_cast<uint32_t>(dsbuf_hash(buf_)); }
+
+    bool operator==(const buffer &other) const { return dsbuf_equals(buf_, other.buf_); }
+    bool operator!=(const buffer &other) const { return !(*this == other); }
+    bool operator==(const char *other) const { return dsbuf_equals_char(buf_, other); }
+    bool operator!=(const char *other) const { return !(*this == other); }
+    bool operator<(const buffer &other) const { return compare(other) < 0; }
+
+    /**
+    * @brief Return the underlying @c DSBuffer , which remains owned by
+    * this object.
+    */
+    DSBuffer *get() const { return buf_; }
+
+    /**
+    * @brief Give up ownership of the underlying @c DSBuffer .
+    */
+    DSBuffer *release() {
+        DSBuffer *buf = buf_;
+        buf_ = nullptr;
+        return buf;
+    }
+
+private:
+    static DSBuffer *check(DSBuffer *buf) {
+        if (!buf) { throw std::bad_alloc(); }
+        return buf;
+    }
+
+    DSBuffer *buf_;
+};
+
+template <>
+struct hash<buffer, void> {
+    uint32_t operator()(const buffer &key) const {
+        return key.hash();
+    }
+};
+
+/**
+* @brief Automatically resizing array holding elements of type @c T by
+* value.
+*
+* Arrays start with @c DSARRAY_DEFAULT_CAPACITY elements and grow by
+* @c DSARRAY_CAPACITY_FACTOR , exactly as a @c DSArray does. Iterators
+* are plain pointers, which are invalidated whenever the array grows.
+*/
+template <typename T>
+class array {
+public:
+    typedef T value_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+
+    array() : data_(nullptr), len_(0), cap_(0) {}
+
+    array(std::initializer_list<T> elems) : array() {
+        reserve(elems.size());
+        for (const T &elem : elems) {
+            push_back(elem);
+        }
+    }
+
+    array(const array &other) : array() {
+        reserve(other.len_);
+        for (const T &elem : other) {
+            push_back(elem);
+        }
+    }
+
+    array(array &&other) noexcept : data_(other.data_), len_(other.len_), cap_(other.cap_) {
+        other.data_ = nullptr;
+        other.len_ = 0;
+        other.cap_ = 0;
+    }
+
+    ~array() {
+        clear();
+        ::operator delete(data_);
+    }
+
+    array &operator=(array other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(len_, other.len_);
+        std::swap(cap_, other.cap_);
+        return *this;
+    }
+
+    size_t size() const { return len_; }
+    size_t capacity() const { return cap_; }
+    bool empty() const { return len_ == 0; }
+    T *data() { return data_; }
+    const T *data() const { return data_; }
+
+    T &operator[](size_t index) { return data_[index]; }
+    const T &operator[](size_t index) const { return data_[index]; }
+
+    T &at(size_t index) {
+        if (index >= len_) { throw std::out_of_range("ds::array::at"); }
+        return data_[index];
+    }
+
+    const T &at(size_t index) const {
+        if (index >= len_) { throw std::out_of_range("ds::array::at"); }
+        return data_[index];
+    }
+
+    T &back() { return data_[len_ - 1]; }
+    const T &back() const { return data_[len_ - 1]; }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + len_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + len_; }
+
+    /**
+    * @brief Make room for at least @c n elements. If moving an element
+    * may throw, elements are copied instead, so the array is unchanged if
+    * an exception is thrown.
+    */
+    void reserve(size_t n) {
+        if (n <= cap_) { return; }
+
+        T *data = allocate(n);
+        try {
+            move_into(data, data_, len_);
+        } catch (...) {
+            ::operator delete(data);
+            throw;
+        }
+        adopt(data, n);
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&... args) {
+        if (len_ < cap_) {
+            new (&data_[len_]) T(std::forward<Args>(args)...);
+            return data_[len_++];
+        }
+
+        // The new element is built before the old elements are moved,
+        // since the arguments may refer to one of them
+        size_t cap = grown_cap();
+        T *data = allocate(cap);
+        try {
+            new (&data[len_]) T(std::forward<Args>(args)...);
+        } catch (...) {
+            ::operator delete(data);
+            throw;
+        }
+        try {
+            move_into(data, data_, len_);
+        } catch (...) {
+            data[len_].~T();
+            ::operator delete(data);
+            throw;
+        }
+        adopt(data, cap);
+        return data_[len_++];
+    }
+
+    void push_back(const T &elem) { emplace_back(elem); }
+    void push_back(T &&elem) { emplace_back(std::move(elem)); }
+
+    /**
+    * @brief Insert @c elem before @c index , shifting later elements up,
+    * or throw @c std::out_of_range if @c index is past the end.
+    */
+    void insert(size_t index, T elem) {
+        if (index > len_) { throw std::out_of_range("ds::array::insert"); }
+        grow_for_one();
+        if (index == len_) {
+            new (&data_[len_]) T(std::move(elem));
+        } else {
+            new (&data_[len_]) T(std::move(data_[len_ - 1]));
+            for (size_t i = len_ - 1; i > index; i--) {
+                data_[i] = std::move(data_[i - 1]);
+            }
+            data_[index] = std::move(elem);
+        }
+        len_++;
+    }
+
+    /**
+    * @brief Remove and return the element at @c index , shifting later
+    * elements down, or throw @c std::out_of_range if there is none.
+    */
+    T remove_index(size_t index) {
+        if (index >= len_) { throw std::out_of_range("ds::array::remove_index"); }
+        T elem(std::move(data_[index]));
+        for (size_t i = index; i + 1 < len_; i++) {
+            data_[i] = std::move(data_[i + 1]);
+        }
+        data_[--len_].~T();
+        return elem;
+    }
+
+    T pop() {
+        if (len_ == 0) { throw std::out_of_range("ds::array::pop"); }
+        return remove_index(len_ - 1);
+    }
+
+    void reverse() {
+        for (size_t i = 0, j = len_; i + 1 < j; i++, j--) {
+            std::swap(data_[i], data_[j - 1]);
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < len_; i++) {
+            data_[i].~T();
+        }
+        len_ = 0;
+    }
+
+private:
+    void grow_for_one() {
+        if (len_ < cap_) { return; }
+        reserve(grown_cap());
+    }
+
+    size_t grown_cap() const {
+        if (cap_ == 0) { return DSARRAY_DEFAULT_CAPACITY; }
+        if (cap_ > (SIZE_MAX / DSARRAY_CAPACITY_FACTOR)) { throw std::bad_alloc(); }
+        return cap_ * DSARRAY_CAPACITY_FACTOR;
+    }
+
+    static T *allocate(size_t n) {
+        if (n > (SIZE_MAX / sizeof(T))) { throw std::bad_alloc(); }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    // Construct n elements in uninitialized storage from src, moving them
+    // unless moving could throw. Should constructing one throw, the ones
+    // already built are destroyed and src is left untouched.
+    static void move_into(T *dst, T *src, size_t n) {
+        size_t i = 0;
+        try {
+            for (; i < n; i++) {
+                new (&dst[i]) T(std::move_if_noexcept(src[i]));
+            }
+        } catch (...) {
+            while (i > 0) {
+                dst[--i].~T();
+            }
+            throw;
+        }
+    }
+
+    // Destroy the current elements and storage, replacing the storage with
+    // data, which already holds every element.
+    void adopt(T *data, size_t cap) {
+        for (size_t i = 0; i < len_; i++) {
+            data_[i].~T();
+        }
+        ::operator delete(data_);
+        data_ = data;
+        cap_ = cap;
+    }
+
+    T *data_;
+    size_t len_;
+    size_t cap_;
+};
+
+/**
+* @brief Hash table mapping keys of type @c K to values of type @c V , both
+* stored by value.
+*
+* @c Hash is called with a key and returns a @c uint32_t hash, and @c Eq
+* is called with two keys and returns @c true if they are equal. Both are
+* called directly rather than through a function pointer.
+*
+* Dictionaries use linear probing over a power of two number of slots with
+* the load factor, minimum capacity, growth factor and shrinking of a
+* @c DSDict , and shift elements back on deletion rather than leaving
+* tombstones. Adding or removing elements invalidates all iterators and
+* references into the dictionary.
+*/
+template <typename K, typename V, typename Hash = ds::hash<K>, typename Eq = ds::equal_to<K> >
+class dict {
+    struct slot {
+        typename std::aligned_storage<sizeof(std::pair<const K, V>), alignof(std::pair<const K, V>)>::type storage;
+        uint32_t hash;
+        bool used;
+
+        std::pair<const K, V> &entry() { return *reinterpret_cast<std::pair<const K, V> *>(&storage); }
+        const std::pair<const K, V> &entry() const { return *reinterpret_cast<const std::pair<const K, V> *>(&storage); }
+    };
+
+    template <typename S, typename E>
+    class iter_base {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef E value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef E *pointer;
+        typedef E &reference;
+
+        iter_base(S *pos, S *end) : pos_(pos), end_(end) { skip(); }
+        E &operator*() const { return pos_->entry(); }
+        E *operator->() const { return &pos_->entry(); }
+        iter_base &operator++() { pos_++; skip(); return *this; }
+        iter_base operator++(int) { iter_base prev = *this; ++(*this); return prev; }
+        bool operator==(const iter_base &other) const { return pos_ == other.pos_; }
+        bool operator!=(const iter_base &other) const { return pos_ != other.pos_; }
+
+    private:
+        void skip() {
+            while ((pos_ != end_) && (!pos_->used)) {
+                pos_++;
+            }
+        }
+
+        S *pos_;
+        S *end_;
+    };
+
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<const K, V> value_type;
+    typedef iter_base<slot, value_type> iterator;
+    typedef iter_base<const slot, const value_type> const_iterator;
+
+    explicit dict(const Hash &hash = Hash(), const Eq &eq = Eq())
+        : slots_(nullptr), cap_(0), cnt_(0), hash_(hash), eq_(eq) {}
+
+    dict(const dict &other) : dict(other.hash_, other.eq_) {
+        reserve(other.cnt_);
+        for (const value_type &entry : other) {
+            put(entry.first, entry.second);
+        }
+    }
+
+    dict(dict &&other) noexcept
+        : slots_(other.slots_), cap_(other.cap_), cnt_(other.cnt_), hash_(other.hash_), eq_(other.eq_) {
+        other.slots_ = nullptr;
+        other.cap_ = 0;
+        other.cnt_ = 0;
+    }
+
+    ~dict() {
+        clear();
+        ::operator delete(slots_);
+    }
+
+    dict &operator=(dict other) noexcept {
+        std::swap(slots_, other.slots_);
+        std::swap(cap_, other.cap_);
+        std::swap(cnt_, other.cnt_);
+        std::swap(hash_, other.hash_);
+        std::swap(eq_, other.eq_);
+        return *this;
+    }
+
+    size_t size() const { return cnt_; }
+    size_t capacity() const { return cap_; }
+    bool empty() const { return cnt_ == 0; }
+
+    iterator begin() { return iterator(slots_, slots_ + cap_); }
+    iterator end() { return iterator(slots_ + cap_, slots_ + cap_); }
+    const_iterator begin() const { return const_iterator(slots_, slots_ + cap_); }
+    const_iterator end() const { return const_iterator(slots_ + cap_, slots_ + cap_); }
+
+    /**
+    * @brief Make sure the dictionary can hold at least @c n elements
+    * without resizing.
+    */
+    void reserve(size_t n) {
+        size_t newcap = libds_generic_dict_cap_for(n, sizeof(slot));
+        if (newcap == 0) { throw std::bad_alloc(); }
+        if (newcap > cap_) {
+            if (!resize(newcap)) { throw std::bad_alloc(); }
+        }
+    }
+
+    /**
+    * @brief Put the given element in the dictionary, overwriting the value
+    * of any element with an equal key.
+    *
+    * @returns @c true if the key was not already in the dictionary
+    */
+    bool put(const K &key, V val) {
+        bool inserted;
+        lookup_or_insert(key, inserted).entry().second = std::move(val);
+        return inserted;
+    }
+
+    /**
+    * @brief Return a pointer to the value for @c key , or @c nullptr if it
+    * is not in the dictionary.
+    */
+    V *get(const K &key) {
+        size_t i;
+        if ((cnt_ == 0) || (!find(key, hash_(key), i))) { return nullptr; }
+        return &slots_[i].entry().second;
+    }
+
+    const V *get(const K &key) const {
+        size_t i;
+        if ((cnt_ == 0) || (!find(key, hash_(key), i))) { return nullptr; }
+        return &slots_[i].entry().second;
+    }
+
+    bool contains(const K &key) const { return get(key) != nullptr; }
+
+    /**
+    * @brief Return the value for @c key , adding the key with a value
+    * initialized @c V if it is not already present.
+    */
+    V &get_or_insert(const K &key, bool *inserted = nullptr) {
+        bool added;
+        slot &s = lookup_or_insert(key, added);
+        if (inserted) { *inserted = added; }
+        return s.entry().second;
+    }
+
+    V &operator[](const K &key) { return get_or_insert(key); }
+
+    /**
+    * @brief Remove the element with the given key.
+    *
+    * @returns @c true if the key was in the dictionary
+    */
+    bool del(const K &key) {
+        size_t i;
+        if ((cnt_ == 0) || (!find(key, hash_(key), i))) { return false; }
+        erase(i);
+        return true;
+    }
+
+    /**
+    * @brief Remove the element with the given key, moving its value into
+    * @c out .
+    *
+    * @returns @c true if the key was in the dictionary
+    */
+    bool del(const K &key, V &out) {
+        size_t i;
+        if ((cnt_ == 0) || (!find(key, hash_(key), i))) { return false; }
+        out = std::move(slots_[i].entry().second);
+        erase(i);
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < cap_; i++) {
+            if (slots_[i].used) {
+                slots_[i].entry().~value_type();
+                slots_[i].used = false;
+            }
+        }
+        cnt_ = 0;
+    }
+
+private:
+    // Find the slot holding key, or the empty slot ending its probe run.
+    bool find(const K &key, uint32_t hash, size_t &place) const {
+        size_t mask = cap_ - 1;
+        size_t i = static_cast<size_t>(libds_generic_mix(hash)) & mask;
+        while (slots_[i].used) {
+            if ((slots_[i].hash == hash) && (eq_(slots_[i].entry().first, key))) {
+                place = i;
+                return true;
+            }
+            i = (i + 1) & mask;
+        }
+        place = i;
+        return false;
+    }
+
+    // Return the slot for key, adding it with a value initialized V first
+    // if it is not in the dictionary.
+    slot &lookup_or_insert(const K &key, bool &inserted) {
+        uint32_t hash = hash_(key);
+        size_t i = 0;
+        inserted = false;
+        if ((cap_ > 0) && (find(key, hash, i))) {
+            return slots_[i];
+        }
+
+        if ((cnt_ + 1) > libds_generic_dict_usable(cap_)) {
+            size_t newcap = LIBDS_GENERIC_DICT_MIN_CAP;
+            if (cap_ > 0) {
+                if (cap_ > (SIZE_MAX / (2 * sizeof(slot)))) { throw std::bad_alloc(); }
+                newcap = cap_ * 2;
+            }
+            if (!resize(newcap)) { throw std::bad_alloc(); }
+            find(key, hash, i);
+        }
+
+        new (&slots_[i].storage) value_type(std::piecewise_construct,
+                                            std::forward_as_tuple(key),
+                                            std::forward_as_tuple());
+        slots_[i].hash = hash;
+        slots_[i].used = true;
+        cnt_++;
+        inserted = true;
+        return slots_[i];
+    }
+
+    // Destroy the element in slot i and shift later elements of the probe
+    // run back over the hole.
+    void erase(size_t i) {
+        slots_[i].entry().~value_type();
+        slots_[i].used = false;
+
+        size_t mask = cap_ - 1;
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (!slots_[j].used) { break; }
+            size_t home = static_cast<size_t>(libds_generic_mix(slots_[j].hash)) & mask;
+            bool stays = (i <= j) ? ((i < home) && (home <= j))
+                                  : ((i < home) || (home <= j));
+            if (stays) { continue; }
+            relocate(slots_[j], slots_[i]);
+            i = j;
+        }
+        cnt_--;
+
+        // Shrink once the table is a quarter full, as a DSDict does
+        if ((cap_ > LIBDS_GENERIC_DICT_MIN_CAP) && (cnt_ < (libds_generic_dict_usable(cap_) / 4))) {
+            resize(libds_generic_dict_cap_for(cnt_ * 2, sizeof(slot)));
+        }
+    }
+
+    // Move every element into a new array of newcap slots.
+    bool resize(size_t newcap) {
+        slot *slots = static_cast<slot *>(::operator new(newcap * sizeof(slot), std::nothrow));
+        if (!slots) { return false; }
+        for (size_t i = 0; i < newcap; i++) {
+            slots[i].used = false;
+        }
+
+        size_t mask = newcap - 1;
+        for (size_t i = 0; i < cap_; i++) {
+            if (!slots_[i].used) { continue; }
+            size_t j = static_cast<size_t>(libds_generic_mix(slots_[i].hash)) & mask;
+            while (slots[j].used) {
+                j = (j + 1) & mask;
+            }
+            relocate(slots_[i], slots[j]);
+        }
+
+        ::operator delete(slots_);
+        slots_ = slots;
+        cap_ = newcap;
+        return true;
+    }
+
+    // Move the element in from into the empty slot to.
+    static void relocate(slot &from, slot &to) {
+        new (&to.storage) value_type(std::move(from.entry()));
+        from.entry().~value_type();
+        to.hash = from.hash;
+        to.used = true;
+        from.used = false;
+    }
+
+    slot *slots_;
+    size_t cap_;
+    size_t cnt_;
+    Hash hash_;
+    Eq eq_;
+};
+
+}
+
+#endif //LIBDS_LIBDS_HPP
@@ -13,6 +13,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "alloc.h"
 #include "iter.h"
 
 /**
@@ -47,6 +48,10 @@ static const int DSLIST_NO_CMP_FUNC = -3;
 * a no-op. Likewise, if no @c dslist_free_fn is specified, then the list
 * will not free list elements when it is destroyed.
 *
+* List nodes are allocated in chunks owned by the list. Nodes freed by
+* removing elements are reused by later insertions, but the chunks
+* themselves are only released when the list is cleared or destroyed.
+*
 * @param cmpfn a function which can compare two list elements
 * @param freefn a function which can free a list element
 * @returns a new @c DSList object or @c NULL if memory could not be
@@ -54,6 +59,23 @@ static const int DSLIST_NO_CMP_FUNC = -3;
 */
 DSList *dslist_new(dslist_compare_fn cmpfn, dslist_free_fn freefn);
 
+/**
+* @brief Create a new @c DSList object with the given comparator and
+* free function which allocates memory using the given allocator.
+*
+* Node chunks, the list object itself and any iterators created from
+* the list are all allocated using @c alloc . The allocator is copied
+* into the list, though its context must outlive the list.
+*
+* @param cmpfn a function which can compare two list elements
+* @param freefn a function which can free a list element
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSList object or @c NULL if memory could not be
+*          allocated
+*/
+DSList *dslist_new_alloc(dslist_compare_fn cmpfn, dslist_free_fn freefn, const DSAllocator *alloc);
+
 /**
 * @brief Destroy a @c DSList object.
 *
@@ -109,9 +131,14 @@ bool dslist_append(DSList *list, void *elem);
 * Callers will still be required to destroy the @c other list object,
 * though it will no longer contain any references.
 *
+* Both lists must have been created with the same comparator, free
+* function and allocator, since the nodes of @c other are moved into
+* @c list rather than copied.
+*
 * @param list the destination @c DSList object
 * @param other the source @c DSList object
-* @returns @c false if @c list or @c other were @c NULL ; @c true otherwise
+* @returns @c false if @c list or @c other were @c NULL or the lists are
+*          not compatible; @c true otherwise
 */
 bool dslist_extend(DSList *list, DSList *other);
 
@@ -0,0 +1,118 @@
+/**
+ * @file perfect.h
+ *
+ * @brief Read-only dictionary built on a minimal perfect hash function.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_PERFECT_H
+#define LIBDS_PERFECT_H
+
+#include <stddef.h>
+#include "libds/dict.h"
+
+/**
+* @brief Read-only dictionary over a fixed set of keys.
+*
+* The dictionary is built once from every key and value it will ever
+* hold, using the hash and displace (CHD) method: keys are split into
+* small groups, and each group is given a displacement value chosen so
+* that every key in the table lands in a different slot. The table has
+* exactly one slot per distinct hash value and about one extra byte per
+* key of displacements, so a lookup reads one displacement, probes one
+* slot and calls the compare function at most once for keys which are
+* in the dictionary and almost never for keys which are not.
+*
+* Keys whose hash values are exactly equal cannot be told apart by any
+* hash function of those values, so only the first such key is stored
+* in the table and the others are kept in a side list which is searched
+* when the first does not match. With a well distributed hash function
+* this is rare for all but very large key sets.
+*
+* The dictionary does not take ownership of its keys or values, which
+* must remain valid for as long as the dictionary is in use. It is never
+* modified once it is built, so any number of threads may read it at
+* once.
+*/
+typedef struct DSPerfectDict DSPerfectDict;
+
+/**
+* @brief Build a read-only dictionary mapping @c keys[i] to @c vals[i] .
+*
+* If the same key appears more than once, the value appearing last is
+* kept, as if each pair had been given to @c dsdict_put in order.
+*
+* @param keys an array of @c n keys, none of which may be @c NULL
+* @param vals an array of @c n values
+* @param n the number of keys and values
+* @param hash a function which can hash the keys
+* @param cmpfn a function which can compare the keys
+* @returns a new @c DSPerfectDict object or @c NULL if any argument is
+*          invalid, memory could not be allocated or no perfect hash
+*          function could be found for the keys
+*/
+DSPerfectDict *dsdict_build_perfect(void **keys, void **vals, size_t n, dsdict_hash_fn hash, dsdict_compare_fn cmpfn);
+
+/**
+* @brief Build a read-only dictionary mapping @c keys[i] to @c vals[i]
+* which allocates memory using the given allocator.
+*
+* Other than the allocator, this function behaves exactly as
+* @c dsdict_build_perfect . The table, the dictionary object itself and
+* the scratch space used while building it are all allocated using
+* @c alloc . The allocator is copied into the dictionary, though its
+* context must outlive the dictionary.
+*
+* @param keys an array of @c n keys, none of which may be @c NULL
+* @param vals an array of @c n values
+* @param n the number of keys and values
+* @param hash a function which can hash the keys
+* @param cmpfn a function which can compare the keys
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSPerfectDict object or @c NULL if any argument is
+*          invalid, memory could not be allocated or no perfect hash
+*          function could be found for the keys
+*/
+DSPerfectDict *dsdict_build_perfect_alloc(void **keys, void **vals, size_t n, dsdict_hash_fn hash, dsdict_compare_fn cmpfn, const DSAllocator *alloc);
+
+/**
+* @brief Destroy a @c DSPerfectDict object.
+*
+* The keys and values are not freed.
+*
+* @param dict a @c DSPerfectDict object
+*/
+void dsperfect_destroy(DSPerfectDict *dict);
+
+/**
+* @brief Return the number of distinct keys in the collection.
+*
+* @param dict a @c DSPerfectDict object
+* @returns the number of elements in @c dict
+*/
+size_t dsperfect_count(const DSPerfectDict *dict);
+
+/**
+* @brief Get the value for the given key.
+*
+* @param dict a @c DSPerfectDict object
+* @param key the key to find
+* @returns @c NULL if the key is not in the dictionary; the value
+*          otherwise
+*/
+void *dsperfect_get(const DSPerfectDict *dict, void *key);
+
+/**
+* @brief Perform the given function on each key/value pair in the
+* dictionary.
+*
+* @param dict a @c DSPerfectDict object
+* @param func a function accepting the key/value pair
+*/
+void dsperfect_foreach(const DSPerfectDict *dict, dsdict_foreach_fn func);
+
+#endif //LIBDS_PERFECT_H
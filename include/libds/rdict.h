@@ -0,0 +1,220 @@
+/**
+ * @file rdict.h
+ *
+ * @brief Read-mostly dictionary with wait-free lookups.
+ *
+ * @author Chris Rink <chrisrink10@gmail.com>
+ *
+ * @copyright 2015 Chris Rink. MIT Licensed.
+ */
+
+#ifndef LIBDS_RDICT_H
+#define LIBDS_RDICT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "libds/dict.h"
+
+/**
+* @brief Dictionary for data which is read far more often than it is
+* written, such as routing tables and configuration maps.
+*
+* Lookups never take a lock or perform an atomic read-modify-write, so
+* any number of threads may read the dictionary at once without
+* contending with each other or with writers. Writers are serialized by a
+* mutex. Writers never modify an element in a way a reader could observe
+* half done: new elements and tables are fully built before they are
+* published, and elements, tables and values which are removed or
+* replaced are only freed once no reader can still be using them
+* (epoch-based reclamation).
+*
+* Each thread which reads the dictionary registers a @c DSReadDictReader
+* and performs its lookups through it. Lookups (and any use of the values
+* they return) must happen inside a read section, which begins with
+* @c dsrdict_read_begin and ends with @c dsrdict_read_end . Entering and
+* leaving a read section is a single store to memory owned by the reader
+* (plus a memory fence on entry). @c dsrdict_get will enter and leave a
+* read section itself if it is called outside of one, though values it
+* returns may then be freed by a writer at any time afterwards.
+*
+* Writers free retired memory opportunistically during each write, or all
+* at once by calling @c dsrdict_synchronize .
+*/
+typedef struct DSReadDict DSReadDict;
+
+/**
+* @brief Per-thread handle used to read a @c DSReadDict.
+*
+* A reader must only be used by one thread at a time.
+*/
+typedef struct DSReadDictReader DSReadDictReader;
+
+/**
+* @brief Create a new @c DSReadDict object.
+*
+* The hash, compare and free functions behave exactly as they do for
+* @c dsdict_new , except that the free functions are called only once no
+* reader can still be using the key or value, which may be during a later
+* write, a call to @c dsrdict_synchronize or @c dsrdict_destroy . The
+* hash and compare functions must be safe to call from many threads.
+*
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @returns a new @c DSReadDict object or @c NULL if no hash function is
+*          specified or memory could not be allocated
+*/
+DSReadDict *dsrdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree);
+
+/**
+* @brief Create a new @c DSReadDict object which allocates memory using
+* the given allocator.
+*
+* Tables, nodes, readers, the retire queue and the dictionary object
+* itself are all allocated using @c alloc , but only by writers,
+* @c dsrdict_synchronize , @c dsrdict_reader_new and
+* @c dsrdict_reader_destroy ; lookups never call the allocator. The
+* allocator is copied into the dictionary, though its context must
+* outlive the dictionary.
+*
+* @param hash a hashing function used to hash dictionary keys
+* @param cmpfn a function which can compare two dictionary keys by value
+* @param keyfree a function which can free hash table keys
+* @param valfree a function which can free hash table values
+* @param alloc the allocator to use; if @c NULL the default allocator
+*              will be used
+* @returns a new @c DSReadDict object or @c NULL if no hash function is
+*          specified or memory could not be allocated
+*/
+DSReadDict *dsrdict_new_alloc(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, const DSAllocator *alloc);
+
+/**
+* @brief Destroy a @c DSReadDict object.
+*
+* Every remaining key and value (including those waiting to be reclaimed)
+* is freed, as are any readers which have not been destroyed. No other
+* thread may be using the dictionary or any of its readers.
+*
+* @param dict a @c DSReadDict object
+*/
+void dsrdict_destroy(DSReadDict *dict);
+
+/**
+* @brief Return the number of elements in the collection.
+*
+* @param dict a @c DSReadDict object
+* @returns the number of elements in @c dict
+*/
+size_t dsrdict_count(const DSReadDict *dict);
+
+/**
+* @brief Put the given element in the dictionary by key.
+*
+* Put operations overwrite the value of elements already in the
+* dictionary with keys that compare equal. The previous value is freed
+* once no reader can still be using it.
+*
+* @param dict a @c DSReadDict object
+* @param key the key
+* @param val the value
+* @returns @c true if the element was stored; @c false if memory could
+*          not be allocated
+*/
+bool dsrdict_put(DSReadDict *dict, void *key, void *val);
+
+/**
+* @brief Remove the element from the dictionary.
+*
+* Unlike @c dsdict_del , the value is not returned to the caller, since
+* readers may still be using it. The key and value are freed once no
+* reader can still be using them.
+*
+* @param dict a @c DSReadDict object
+* @param key the keyed element to remove
+* @returns @c true if the element was in the dictionary; @c false
+*          otherwise
+*/
+bool dsrdict_del(DSReadDict *dict, void *key);
+
+/**
+* @brief Wait until every reader has left any read section it was in, and
+* free all memory retired by previous writes.
+*
+* The dictionary lock is not held while waiting, so readers and writers
+* may continue to use the dictionary in the meantime. Memory retired by
+* writes which complete after this call begins is not waited for.
+*
+* This must not be called by a thread which is inside a read section on
+* any reader of @c dict , since the wait would never finish.
+*
+* @param dict a @c DSReadDict object
+*/
+void dsrdict_synchronize(DSReadDict *dict);
+
+/**
+* @brief Register a new reader for the calling thread.
+*
+* @param dict a @c DSReadDict object
+* @returns a new @c DSReadDictReader object or @c NULL if memory could
+*          not be allocated
+*/
+DSReadDictReader *dsrdict_reader_new(DSReadDict *dict);
+
+/**
+* @brief Unregister and destroy a reader, which must not be inside a read
+* section.
+*
+* @param reader a @c DSReadDictReader object
+*/
+void dsrdict_reader_destroy(DSReadDictReader *reader);
+
+/**
+* @brief Enter a read section.
+*
+* Keys and values found by lookups inside a read section remain valid
+* until the matching call to @c dsrdict_read_end . Read sections may be
+* nested, and only the outermost section has any effect. Writes from the
+* same thread are allowed inside a read section, but
+* @c dsrdict_synchronize is not.
+*
+* Long read sections delay the reclamation of retired memory, but never
+* block writers.
+*
+* @param reader a @c DSReadDictReader object
+*/
+void dsrdict_read_begin(DSReadDictReader *reader);
+
+/**
+* @brief Leave a read section.
+*
+* @param reader a @c DSReadDictReader object
+*/
+void dsrdict_read_end(DSReadDictReader *reader);
+
+/**
+* @brief Get the element given by the key.
+*
+* Lookups are wait-free. If the reader is not inside a read section, the
+* lookup is performed inside its own read section.
+*
+* @param reader a @c DSReadDictReader object
+* @param key the keyed element to find
+* @returns @c NULL if the element does not exist in the dictionary;
+*          the element otherwise
+*/
+void *dsrdict_get(DSReadDictReader *reader, void *key);
+
+/**
+* @brief Perform the given function on each object in the dictionary.
+*
+* The function is called inside a read section, and sees the elements of
+* the table as of the start of the call along with some subset of any
+* concurrent changes.
+*
+* @param reader a @c DSReadDictReader object
+* @param func a function accepting the key/value pair
+*/
+void dsrdict_foreach(DSReadDictReader *reader, dsdict_foreach_fn func);
+
+#endif //LIBDS_RDICT_H
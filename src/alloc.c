@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * libds :: alloc.c
+ *
+ * Default memory allocator.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include "libds/alloc.h"
+
+static void *default_alloc(void *ctx, size_t size);
+static void *default_calloc(void *ctx, size_t num, size_t size);
+static void *default_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+static void default_free(void *ctx, void *ptr, size_t size);
+
+static const DSAllocator DSALLOC_DEFAULT = {
+        default_alloc,
+        default_calloc,
+        default_realloc,
+        default_free,
+        NULL,
+};
+
+/*
+ * ALLOCATOR PUBLIC FUNCTIONS
+ */
+
+const DSAllocator *dsalloc_default(void) {
+    return &DSALLOC_DEFAULT;
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+static void *default_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *default_calloc(void *ctx, size_t num, size_t size) {
+    (void)ctx;
+    return calloc(num, size);
+}
+
+static void *default_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+    (void)ctx;
+    (void)oldsize;
+    return realloc(ptr, newsize);
+}
+
+static void default_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
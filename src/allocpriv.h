@@ -0,0 +1,73 @@
+/*****************************************************************************
+ * libds :: allocpriv.h
+ *
+ * Private helpers for allocating memory through a DSAllocator.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_ALLOCPRIV_H
+#define LIBDS_ALLOCPRIV_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "libds/alloc.h"
+
+// Copy the given allocator into dest, using the default allocator if
+// no allocator was given. Returns false for allocators which are invalid.
+static inline bool ds_alloc_init(DSAllocator *dest, const DSAllocator *alloc) {
+    assert(dest);
+    if (!alloc) { alloc = dsalloc_default(); }
+    if (!alloc->alloc) { return false; }
+    *dest = *alloc;
+    return true;
+}
+
+// Return true if two allocators would allocate from the same source.
+static inline bool ds_alloc_same(const DSAllocator *left, const DSAllocator *right) {
+    return (left->alloc == right->alloc) &&
+           (left->calloc == right->calloc) &&
+           (left->realloc == right->realloc) &&
+           (left->free == right->free) &&
+           (left->ctx == right->ctx);
+}
+
+static inline void *ds_alloc(const DSAllocator *alloc, size_t size) {
+    return alloc->alloc(alloc->ctx, size);
+}
+
+static inline void *ds_calloc(const DSAllocator *alloc, size_t num, size_t size) {
+    if ((size != 0) && (num > (SIZE_MAX / size))) { return NULL; }
+    if (alloc->calloc) {
+        return alloc->calloc(alloc->ctx, num, size);
+    }
+
+    void *ptr = alloc->alloc(alloc->ctx, num * size);
+    if (ptr) { memset(ptr, 0, num * size); }
+    return ptr;
+}
+
+static inline void ds_free(const DSAllocator *alloc, void *ptr, size_t size) {
+    if ((!ptr) || (!alloc->free)) { return; }
+    alloc->free(alloc->ctx, ptr, size);
+}
+
+static inline void *ds_realloc(const DSAllocator *alloc, void *ptr, size_t oldsize, size_t newsize) {
+    if (alloc->realloc) {
+        return alloc->realloc(alloc->ctx, ptr, oldsize, newsize);
+    }
+
+    void *fresh = alloc->alloc(alloc->ctx, newsize);
+    if (!fresh) { return NULL; }
+    if (ptr) {
+        memcpy(fresh, ptr, (oldsize < newsize) ? oldsize : newsize);
+        ds_free(alloc, ptr, oldsize);
+    }
+    return fresh;
+}
+
+#endif //LIBDS_ALLOCPRIV_H
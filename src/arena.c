@@ -0,0 +1,235 @@
+/*****************************************************************************
+ * libds :: arena.c
+ *
+ * Region allocator for containers which are destroyed together.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libds/arena.h"
+
+struct arena_block {
+    struct arena_block *next;
+    size_t cap;
+};
+
+/*
+ * Round block headers and allocation sizes up so every pointer handed
+ * out by the arena is suitably aligned for any type.
+ */
+union arena_header {
+    struct arena_block block;
+    void *ptr;
+    long long ll;
+    long double ld;
+};
+
+struct DSArena {
+    struct arena_block *blocks;
+    char *next;
+    char *end;
+    char *last;
+    size_t blocksize;
+    size_t used;
+    DSAllocator alloc;
+};
+
+static void *arena_alloc(void *ctx, size_t size);
+static void *arena_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+static void arena_free(void *ctx, void *ptr, size_t size);
+static bool add_block(DSArena *arena);
+static void *add_large_block(DSArena *arena, size_t size);
+static inline size_t round_size(size_t size);
+
+/*
+ * ARENA PUBLIC FUNCTIONS
+ */
+
+DSArena *dsarena_new(size_t blocksize) {
+    DSArena *arena = malloc(sizeof(DSArena));
+    if (!arena) {
+        return NULL;
+    }
+
+    arena->blocks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->last = NULL;
+    arena->blocksize = round_size((blocksize > 0) ? blocksize : DSARENA_DEFAULT_BLOCK_SIZE);
+    arena->used = 0;
+    arena->alloc.alloc = arena_alloc;
+    arena->alloc.calloc = NULL;
+    arena->alloc.realloc = arena_realloc;
+    arena->alloc.free = arena_free;
+    arena->alloc.ctx = arena;
+    return arena;
+}
+
+void dsarena_destroy(DSArena *arena) {
+    if (!arena) { return; }
+
+    struct arena_block *cur = arena->blocks;
+    while (cur) {
+        struct arena_block *next = cur->next;
+        free(cur);
+        cur = next;
+    }
+
+    free(arena);
+}
+
+const DSAllocator *dsarena_allocator(DSArena *arena) {
+    assert(arena);
+    return &arena->alloc;
+}
+
+void dsarena_reset(DSArena *arena) {
+    if (!arena) { return; }
+
+    // Keep the first regular sized block for the next round of allocations
+    struct arena_block *keep = NULL;
+    struct arena_block *cur = arena->blocks;
+    while (cur) {
+        struct arena_block *next = cur->next;
+        if ((!keep) && (cur->cap == arena->blocksize)) {
+            keep = cur;
+            keep->next = NULL;
+        } else {
+            free(cur);
+        }
+        cur = next;
+    }
+
+    arena->blocks = keep;
+    arena->next = (keep) ? ((char *)keep + sizeof(union arena_header)) : NULL;
+    arena->end = (keep) ? (arena->next + keep->cap) : NULL;
+    arena->last = NULL;
+    arena->used = 0;
+}
+
+size_t dsarena_used(const DSArena *arena) {
+    assert(arena);
+    return arena->used;
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Bump allocate from the current block, adding a new block if needed.
+static void *arena_alloc(void *ctx, size_t size) {
+    DSArena *arena = ctx;
+    assert(arena);
+
+    size = round_size((size > 0) ? size : 1);
+    if (size > (arena->blocksize / 4)) {
+        return add_large_block(arena, size);
+    }
+
+    if ((!arena->next) || ((size_t)(arena->end - arena->next) < size)) {
+        if (!add_block(arena)) {
+            return NULL;
+        }
+    }
+
+    void *ptr = arena->next;
+    arena->last = arena->next;
+    arena->next += size;
+    arena->used += size;
+    return ptr;
+}
+
+// Grow the most recent allocation in place if it fits, otherwise copy
+// the block into a fresh allocation.
+static void *arena_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+    DSArena *arena = ctx;
+    assert(arena);
+
+    if (!ptr) {
+        return arena_alloc(arena, newsize);
+    }
+
+    if (((char *)ptr == arena->last) && (newsize <= (arena->blocksize / 4))) {
+        size_t oldr = round_size((oldsize > 0) ? oldsize : 1);
+        size_t newr = round_size((newsize > 0) ? newsize : 1);
+        if (newr <= (size_t)(arena->end - arena->last)) {
+            arena->next = arena->last + newr;
+            arena->used = arena->used - oldr + newr;
+            return ptr;
+        }
+    }
+
+    void *fresh = arena_alloc(arena, newsize);
+    if (!fresh) {
+        return NULL;
+    }
+    memcpy(fresh, ptr, (oldsize < newsize) ? oldsize : newsize);
+    return fresh;
+}
+
+// Only the most recent allocation can be returned to the arena.
+static void arena_free(void *ctx, void *ptr, size_t size) {
+    DSArena *arena = ctx;
+    assert(arena);
+
+    if ((!ptr) || ((char *)ptr != arena->last)) {
+        return;
+    }
+
+    arena->next = arena->last;
+    arena->used -= round_size((size > 0) ? size : 1);
+    arena->last = NULL;
+}
+
+// Add a new regular sized block at the head of the block list and make
+// it the current block.
+static bool add_block(DSArena *arena) {
+    assert(arena);
+
+    struct arena_block *block = malloc(sizeof(union arena_header) + arena->blocksize);
+    if (!block) {
+        return false;
+    }
+
+    block->next = arena->blocks;
+    block->cap = arena->blocksize;
+    arena->blocks = block;
+    arena->next = (char *)block + sizeof(union arena_header);
+    arena->end = arena->next + block->cap;
+    return true;
+}
+
+// Allocate a dedicated block for a single large allocation without
+// abandoning the rest of the current block.
+static void *add_large_block(DSArena *arena, size_t size) {
+    assert(arena);
+
+    struct arena_block *block = malloc(sizeof(union arena_header) + size);
+    if (!block) {
+        return NULL;
+    }
+
+    block->cap = size;
+    if (arena->blocks) {
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+    } else {
+        block->next = NULL;
+        arena->blocks = block;
+    }
+
+    arena->used += size;
+    return (char *)block + sizeof(union arena_header);
+}
+
+// Round an allocation size up to the arena alignment.
+static inline size_t round_size(size_t size) {
+    size_t align = sizeof(union arena_header);
+    return ((size + align - 1) / align) * align;
+}
@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "libds/array.h"
+#include "allocpriv.h"
 #include "iterpriv.h"
 
 struct DSArray {
@@ -20,6 +21,7 @@ struct DSArray {
     size_t cap;
     dsarray_compare_fn cmp;
     dsarray_free_fn free;
+    DSAllocator alloc;
 };
 
 static bool dsarray_resize(DSArray *array, size_t cap);
@@ -34,15 +36,25 @@ DSArray* dsarray_new(dsarray_compare_fn cmpfn, dsarray_free_fn freefn) {
 }
 
 DSArray* dsarray_new_cap(size_t cap, dsarray_compare_fn cmpfn, dsarray_free_fn freefn) {
+    return dsarray_new_alloc(cap, cmpfn, freefn, NULL);
+}
+
+DSArray* dsarray_new_alloc(size_t cap, dsarray_compare_fn cmpfn, dsarray_free_fn freefn, const DSAllocator *alloc) {
     assert(cap > 0);
-    DSArray *array = malloc(sizeof(DSArray));
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+
+    DSArray *array = ds_alloc(&a, sizeof(DSArray));
     if (!array) {
         return NULL;
     }
 
-    array->data = calloc(cap, sizeof(void *));
+    array->alloc = a;
+    array->data = ds_calloc(&array->alloc, cap, sizeof(void *));
     if (!array->data) {
-        free(array);
+        ds_free(&a, array, sizeof(DSArray));
         return NULL;
     }
 
@@ -72,8 +84,9 @@ DSArray *dsarray_new_lit(void **list, size_t len, size_t cap, dsarray_compare_fn
 void dsarray_destroy(DSArray *array) {
     if (!array) { return; }
     dsarray_free(array);
-    free(array->data);
-    free(array);
+    DSAllocator alloc = array->alloc;
+    ds_free(&alloc, array->data, array->cap * sizeof(void *));
+    ds_free(&alloc, array, sizeof(DSArray));
 }
 
 size_t dsarray_len(const DSArray *array) {
@@ -232,7 +245,7 @@ void dsarray_reverse(DSArray *array) {
 DSIter* dsarray_iter(DSArray *array) {
     if (!array) { return NULL; }
 
-    DSIter *iter = dsiter_priv_new(ITER_ARRAY, array);
+    DSIter *iter = dsiter_priv_new(ITER_ARRAY, array, &array->alloc);
     if (!iter) {
         return NULL;
     }
@@ -252,18 +265,17 @@ static bool dsarray_resize(DSArray *array, size_t cap) {
         return false;
     }
 
-    void **cache = array->data;
-    array->data = calloc(cap, sizeof(void *));
-    if (!array->data) {
-        array->data = cache;
+    void **data = ds_realloc(&array->alloc, array->data,
+                             array->cap * sizeof(void *), cap * sizeof(void *));
+    if (!data) {
         return false;
     }
 
-    for (size_t i = 0; i < array->len; i++) {
-        array->data[i] = cache[i];
+    for (size_t i = array->cap; i < cap; i++) {
+        data[i] = NULL;
     }
 
-    free(cache);
+    array->data = data;
     array->cap = cap;
     return true;
 }
@@ -0,0 +1,45 @@
+/*****************************************************************************
+ * libds :: atomicpriv.h
+ *
+ * Private header wrapping the atomic operations used by the library.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_ATOMICPRIV_H
+#define LIBDS_ATOMICPRIV_H
+
+/*
+ * Objects shared between threads are declared with DS_ATOMIC(type) and
+ * only read or written through DS_ATOMIC_LOAD and DS_ATOMIC_STORE with
+ * one of the DS_ATOMIC_* orders below. C11 atomics are used by compilers
+ * which provide them; the library itself is built as C99, so GCC and
+ * compatible compilers (Clang, ICC) use their __atomic builtins on plain
+ * objects instead.
+ */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define DS_ATOMIC(type) _Atomic(type)
+#define DS_ATOMIC_RELAXED memory_order_relaxed
+#define DS_ATOMIC_ACQUIRE memory_order_acquire
+#define DS_ATOMIC_RELEASE memory_order_release
+#define DS_ATOMIC_SEQ_CST memory_order_seq_cst
+#define DS_ATOMIC_LOAD(ptr, order) atomic_load_explicit((ptr), (order))
+#define DS_ATOMIC_STORE(ptr, val, order) atomic_store_explicit((ptr), (val), (order))
+#define DS_ATOMIC_FENCE(order) atomic_thread_fence(order)
+#elif defined(__GNUC__)
+#define DS_ATOMIC(type) type
+#define DS_ATOMIC_RELAXED __ATOMIC_RELAXED
+#define DS_ATOMIC_ACQUIRE __ATOMIC_ACQUIRE
+#define DS_ATOMIC_RELEASE __ATOMIC_RELEASE
+#define DS_ATOMIC_SEQ_CST __ATOMIC_SEQ_CST
+#define DS_ATOMIC_LOAD(ptr, order) __atomic_load_n((ptr), (order))
+#define DS_ATOMIC_STORE(ptr, val, order) __atomic_store_n((ptr), (val), (order))
+#define DS_ATOMIC_FENCE(order) __atomic_thread_fence(order)
+#else
+#error "libds requires C11 atomics or GCC-compatible __atomic builtins"
+#endif
+
+#endif //LIBDS_ATOMICPRIV_H
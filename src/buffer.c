@@ -16,14 +16,21 @@
 #include <string.h>
 #include "libds/buffer.h"
 #include "libds/hash.h"
+#include "allocpriv.h"
+#include "atomicpriv.h"
 
 struct DSBuffer {
     char* str;
     size_t len;
     size_t cap;
+    DSAllocator alloc;
+    DSWyhashState *running;
+    DS_ATOMIC(uint64_t) hash;   /* only accessed atomically once hashed is set */
+    DS_ATOMIC(bool) hashed;
 };
 
 static bool dsbuf_resize(DSBuffer *str, size_t size);
+static uint64_t dsbuf_hash_full(const DSBuffer *str);
 static int utf8_validate_char(const char *s, const char *e);
 
 /*
@@ -40,14 +47,18 @@ DSBuffer *dsbuf_new_l(const char *value, size_t len) {
         return NULL;
     }
 
-    DSBuffer *s = malloc(sizeof(DSBuffer));
+    const DSAllocator *alloc = dsalloc_default();
+    DSBuffer *s = ds_alloc(alloc, sizeof(DSBuffer));
     if (!s) {
         return NULL;
     }
 
+    s->alloc = *alloc;
+    s->running = NULL;
+    s->hashed = false;
     s->len = len;
     s->cap = len * DSBUFFER_CAPACITY_FACTOR;
-    s->str = malloc(s->cap);
+    s->str = ds_alloc(&s->alloc, s->cap);
     if (!s->str) {
         goto cleanup_dsbuf;
     }
@@ -57,58 +68,86 @@ DSBuffer *dsbuf_new_l(const char *value, size_t len) {
     return s;
 
 cleanup_dsbuf:
-    free(s);
+    ds_free(alloc, s, sizeof(DSBuffer));
     return NULL;
 }
 
 DSBuffer *dsbuf_new_buffer(size_t cap) {
+    return dsbuf_new_buffer_alloc(cap, NULL);
+}
+
+DSBuffer *dsbuf_new_buffer_alloc(size_t cap, const DSAllocator *alloc) {
     cap = (cap < DSBUFFER_MINIMUM_CAPACITY) ? DSBUFFER_MINIMUM_CAPACITY : cap;
 
-    DSBuffer *s = malloc(sizeof(DSBuffer));
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+
+    DSBuffer *s = ds_alloc(&a, sizeof(DSBuffer));
     if (!s) {
         return NULL;
     }
 
+    s->alloc = a;
+    s->running = NULL;
+    s->hashed = false;
     s->len = 0;
     s->cap = cap;
-    s->str = calloc(s->cap, 1);
+    s->str = ds_calloc(&s->alloc, s->cap, 1);
     if (!s->str) {
         goto cleanup_dsbuf_buffer;
     }
     return s;
 
 cleanup_dsbuf_buffer:
-    free(s);
+    ds_free(&a, s, sizeof(DSBuffer));
     return NULL;
 }
 
 void dsbuf_destroy(DSBuffer *str) {
     if (!str) { return; }
-    free(str->str);
+    DSAllocator alloc = str->alloc;
+    ds_free(&alloc, str->running, sizeof(DSWyhashState));
+    ds_free(&alloc, str->str, str->cap);
     str->str = NULL;
-    free(str);
+    ds_free(&alloc, str, sizeof(DSBuffer));
 }
 
 DSBuffer *dsbuf_dup(const DSBuffer *str) {
     if (!str) { return NULL; }
 
-    DSBuffer *s = malloc(sizeof(DSBuffer));
+    DSBuffer *s = ds_alloc(&str->alloc, sizeof(DSBuffer));
     if (!s) {
         return NULL;
     }
 
+    s->alloc = str->alloc;
+    s->running = NULL;
+    s->hashed = DS_ATOMIC_LOAD(&str->hashed, DS_ATOMIC_ACQUIRE);
+    s->hash = DS_ATOMIC_LOAD(&str->hash, DS_ATOMIC_RELAXED);
     s->len = str->len;
     s->cap = str->cap;
-    s->str = calloc(s->cap, 1);
+    s->str = ds_calloc(&s->alloc, s->cap, 1);
     if (!s->str) {
         goto cleanup_dsbuf_dup;
     }
 
+    if (str->running) {
+        s->running = ds_alloc(&s->alloc, sizeof(DSWyhashState));
+        if (!s->running) {
+            goto cleanup_dsbuf_dup_str;
+        }
+        *s->running = *str->running;
+    }
+
     memcpy(s->str, &str->str[0], s->len);
     return s;
 
+cleanup_dsbuf_dup_str:
+    ds_free(&str->alloc, s->str, s->cap);
 cleanup_dsbuf_dup:
-    free(s);
+    ds_free(&str->alloc, s, sizeof(DSBuffer));
     return NULL;
 }
 
@@ -136,6 +175,10 @@ bool dsbuf_append(DSBuffer *str, DSBuffer *newc) {
     }
 
     memcpy(&str->str[str->len], newc->str, newc->len);
+    if (str->running) {
+        hash_wyhash_update(str->running, newc->str, newc->len);
+    }
+    str->hashed = false;
     str->len += newc->len;
     return true;
 }
@@ -153,6 +196,10 @@ bool dsbuf_append_char(DSBuffer *str, int newc) {
     }
 
     str->str[str->len] = (char)newc;
+    if (str->running) {
+        hash_wyhash_update(str->running, &str->str[str->len], 1);
+    }
+    str->hashed = false;
     str->len++;
     return true;
 }
@@ -165,16 +212,44 @@ bool dsbuf_append_str(DSBuffer *str, const char *newstr) {
     size_t addlen = strlen(newstr);
     size_t size = str->len + addlen;
     if (str->cap < size) {
-        if (!dsbuf_resize(str, str->cap * DSBUFFER_CAPACITY_FACTOR)) {
+        size_t newcap = str->cap * DSBUFFER_CAPACITY_FACTOR;
+        if (!dsbuf_resize(str, (newcap < size) ? (size * DSBUFFER_CAPACITY_FACTOR) : newcap)) {
             return false;
         }
     }
 
     memcpy(&str->str[str->len], newstr, addlen);
+    if (str->running) {
+        hash_wyhash_update(str->running, newstr, addlen);
+    }
+    str->hashed = false;
     str->len = size;
     return true;
 }
 
+bool dsbuf_track_hash(DSBuffer *str, uint64_t seed) {
+    if (!str) { return false; }
+
+    if (!str->running) {
+        str->running = ds_alloc(&str->alloc, sizeof(DSWyhashState));
+        if (!str->running) {
+            return false;
+        }
+    }
+
+    hash_wyhash_init(str->running, seed);
+    hash_wyhash_update(str->running, str->str, str->len);
+    return true;
+}
+
+uint64_t dsbuf_running_hash(const DSBuffer *str) {
+    if (!str) { return 0; }
+    if (!str->running) {
+        return dsbuf_hash_full(str);
+    }
+    return hash_wyhash_final(str->running);
+}
+
 int dsbuf_char_at(const DSBuffer *str, size_t pos) {
     if ((!str) || (pos >= str->len)) {
         return DSBUFFER_CHAR_NOT_FOUND;
@@ -188,7 +263,7 @@ DSBuffer *dsbuf_substr(const DSBuffer *str, size_t start, size_t len) {
         return NULL;
     }
 
-    DSBuffer * sub = dsbuf_new_buffer(len * DSBUFFER_CAPACITY_FACTOR);
+    DSBuffer * sub = dsbuf_new_buffer_alloc(len * DSBUFFER_CAPACITY_FACTOR, &str->alloc);
     if (!sub) {
         return NULL;
     }
@@ -241,13 +316,34 @@ char *dsbuf_to_char_array(const DSBuffer *str) {
     }
 
     memcpy(cpy, str->str, str->len);
-    str->str[str->len] = '\0';
+    cpy[str->len] = '\0';
     return cpy;
 }
 
 unsigned int dsbuf_hash(const DSBuffer *str) {
     if (!str) { return 0; }
-    return (unsigned int) hash_fnv1(str->str);
+    return (unsigned int) dsbuf_hash_full(str);
+}
+
+uint32_t dsbuf_dict_hash(void *key) {
+    if (!key) { return 0; }
+    return (uint32_t) dsbuf_hash_full(key);
+}
+
+int dsbuf_dict_compare(const void *left, const void *right) {
+    if (!left) { return INT_MIN; }
+    if (!right) { return INT_MAX; }
+
+    // Differing cached hashes settle most comparisons without touching
+    // the buffer contents at all
+    uint64_t lhash = dsbuf_hash_full(left);
+    uint64_t rhash = dsbuf_hash_full(right);
+    if (lhash != rhash) { return (lhash < rhash) ? -1 : 1; }
+
+    const DSBuffer *l = left;
+    const DSBuffer *r = right;
+    if (l->len != r->len) { return (l->len < r->len) ? -1 : 1; }
+    return memcmp(l->str, r->str, l->len);
 }
 
 int dsbuf_compare(const DSBuffer *left, const DSBuffer *right) {
@@ -305,19 +401,36 @@ static bool dsbuf_resize(DSBuffer *str, size_t size) {
         return false;
     }
 
-    char* cache = str->str; // Cache a pointer to the old string
-    str->str = malloc(size);
-    if (!str->str) {
-        str->str = cache;   // Point the old pointer back to the cached value
+    char *resized = ds_realloc(&str->alloc, str->str, str->cap, size);
+    if (!resized) {
         return false;
     }
 
+    memset(&resized[str->cap], '\0', (size - str->cap));
+    str->str = resized;
     str->cap = size;
-    memcpy(str->str, cache, str->len);
-    free(cache);
     return true;
 }
 
+// Return the hash of the buffer contents, computing it only if the buffer
+// has been modified since it was last hashed. Several threads may hash the
+// same unmodified buffer at once (as concurrent dictionaries do with their
+// keys), so the cache is only read and written atomically: racing threads
+// compute and store the same value, and the flag is published after the
+// hash so a reader which sees it set also sees the hash.
+static uint64_t dsbuf_hash_full(const DSBuffer *str) {
+    assert(str);
+    DSBuffer *cache = (DSBuffer *)str;
+    if (DS_ATOMIC_LOAD(&cache->hashed, DS_ATOMIC_ACQUIRE)) {
+        return DS_ATOMIC_LOAD(&cache->hash, DS_ATOMIC_RELAXED);
+    }
+
+    uint64_t hash = hash_wyhash(str->str, str->len, 0);
+    DS_ATOMIC_STORE(&cache->hash, hash, DS_ATOMIC_RELAXED);
+    DS_ATOMIC_STORE(&cache->hashed, true, DS_ATOMIC_RELEASE);
+    return hash;
+}
+
 /*
  * This function was taken from the charset module on CCAN
  * (http://ccodearchive.net).
@@ -0,0 +1,345 @@
+/*****************************************************************************
+ * libds :: cdict.c
+ *
+ * Thread safe dictionary built from sharded DSDict objects.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "allocpriv.h"
+#include "cdictpriv.h"
+#include "dictpriv.h"
+#include "iterpriv.h"
+
+static const size_t DSCDICT_MAX_SHARDS = ((size_t)1 << 16);
+
+/*
+ * Shards are padded out to two cache lines so that threads working on
+ * neighboring shards do not contend on the same line (the adjacent line
+ * prefetcher on many CPUs fetches lines in pairs).
+ */
+#define CDICT_SHARD_PAD 128
+
+struct cdict_shard {
+    pthread_rwlock_t lock;
+    DSDict *dict;
+};
+
+union cdict_slot {
+    struct cdict_shard shard;
+    char pad[CDICT_SHARD_PAD];
+};
+
+struct DSConcurrentDict {
+    union cdict_slot *shards;
+    size_t nshards;
+    unsigned int bits;
+    dsdict_hash_fn hash;
+    DSAllocator alloc;
+};
+
+static struct cdict_shard *shard_for(const DSConcurrentDict *dict, uint32_t hash);
+static bool snapshot_shard(const DSConcurrentDict *dict, struct cdict_iter *state, const DSAllocator *alloc);
+static void collect_pair(const void *key, void *val, void *ctx);
+static void release_shards(DSConcurrentDict *dict, size_t n);
+
+/*
+ * CONCURRENT DICTIONARY PUBLIC FUNCTIONS
+ */
+
+DSConcurrentDict *dscdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, size_t shards) {
+    return dscdict_new_alloc(hash, cmpfn, keyfree, valfree, flags, shards, NULL);
+}
+
+DSConcurrentDict *dscdict_new_alloc(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, size_t shards, const DSAllocator *alloc) {
+    if ((!hash) || (!cmpfn)) { return NULL; }
+    if (shards == 0) { shards = DSCDICT_DEFAULT_SHARDS; }
+    if (shards > DSCDICT_MAX_SHARDS) { shards = DSCDICT_MAX_SHARDS; }
+
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+    DSConcurrentDict *dict = ds_alloc(&a, sizeof(DSConcurrentDict));
+    if (!dict) {
+        return NULL;
+    }
+
+    dict->alloc = a;
+    dict->hash = hash;
+    dict->bits = 0;
+    while (((size_t)1 << dict->bits) < shards) {
+        dict->bits++;
+    }
+    dict->nshards = (size_t)1 << dict->bits;
+
+    dict->shards = ds_calloc(&dict->alloc, dict->nshards, sizeof(union cdict_slot));
+    if (!dict->shards) {
+        ds_free(&a, dict, sizeof(DSConcurrentDict));
+        return NULL;
+    }
+
+    for (size_t i = 0; i < dict->nshards; i++) {
+        struct cdict_shard *shard = &dict->shards[i].shard;
+        shard->dict = dsdict_new_alloc(hash, cmpfn, keyfree, valfree, flags, &dict->alloc);
+        if (!shard->dict) {
+            release_shards(dict, i);
+            return NULL;
+        }
+        if (pthread_rwlock_init(&shard->lock, NULL) != 0) {
+            dsdict_destroy(shard->dict);
+            release_shards(dict, i);
+            return NULL;
+        }
+    }
+
+    return dict;
+}
+
+void dscdict_destroy(DSConcurrentDict *dict) {
+    if (!dict) { return; }
+    release_shards(dict, dict->nshards);
+}
+
+size_t dscdict_count(const DSConcurrentDict *dict) {
+    assert(dict);
+
+    size_t cnt = 0;
+    for (size_t i = 0; i < dict->nshards; i++) {
+        struct cdict_shard *shard = &dict->shards[i].shard;
+        pthread_rwlock_rdlock(&shard->lock);
+        cnt += dsdict_count(shard->dict);
+        pthread_rwlock_unlock(&shard->lock);
+    }
+    return cnt;
+}
+
+size_t dscdict_shards(const DSConcurrentDict *dict) {
+    assert(dict);
+    return dict->nshards;
+}
+
+void dscdict_put(DSConcurrentDict *dict, void *key, void *val) {
+    if ((!dict) || (!key)) { return; }
+
+    uint32_t hash = dict->hash(key);
+    struct cdict_shard *shard = shard_for(dict, hash);
+    pthread_rwlock_wrlock(&shard->lock);
+    dsdict_put_hashed(shard->dict, key, hash, val);
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+void *dscdict_get(const DSConcurrentDict *dict, void *key) {
+    if ((!dict) || (!key)) { return NULL; }
+
+    uint32_t hash = dict->hash(key);
+    struct cdict_shard *shard = shard_for(dict, hash);
+    pthread_rwlock_rdlock(&shard->lock);
+    void *val = dsdict_get_hashed(shard->dict, key, hash);
+    pthread_rwlock_unlock(&shard->lock);
+    return val;
+}
+
+void *dscdict_del(DSConcurrentDict *dict, void *key) {
+    if ((!dict) || (!key)) { return NULL; }
+
+    uint32_t hash = dict->hash(key);
+    struct cdict_shard *shard = shard_for(dict, hash);
+    pthread_rwlock_wrlock(&shard->lock);
+    void *val = dsdict_del_hashed(shard->dict, key, hash);
+    pthread_rwlock_unlock(&shard->lock);
+    return val;
+}
+
+bool dscdict_update(DSConcurrentDict *dict, void *key, dsdict_update_fn func, void *ctx) {
+    if ((!dict) || (!key) || (!func)) { return false; }
+
+    uint32_t hash = dict->hash(key);
+    struct cdict_shard *shard = shard_for(dict, hash);
+    pthread_rwlock_wrlock(&shard->lock);
+    bool updated = dsdict_priv_update(shard->dict, key, hash, func, ctx);
+    pthread_rwlock_unlock(&shard->lock);
+    return updated;
+}
+
+DSIter *dscdict_iter(DSConcurrentDict *dict) {
+    if (!dict) { return NULL; }
+
+    DSIter *iter = dsiter_priv_new(ITER_CDICT, dict, &dict->alloc);
+    if (!iter) {
+        return NULL;
+    }
+
+    struct cdict_iter *state = ds_calloc(&dict->alloc, 1, sizeof(struct cdict_iter));
+    if (!state) {
+        dsiter_destroy(iter);
+        return NULL;
+    }
+
+    iter->node.cdict = state;
+    return iter;
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Return the shard responsible for a key hash. Shards are selected by the
+// high bits of the mixed hash, since the shard dictionaries index their
+// own tables using the low bits.
+static struct cdict_shard *shard_for(const DSConcurrentDict *dict, uint32_t hash) {
+    assert(dict);
+
+    if (dict->bits == 0) {
+        return &dict->shards[0].shard;
+    }
+
+    size_t i = (size_t)(dict_mix(hash) >> (64 - dict->bits));
+    return &dict->shards[i].shard;
+}
+
+// Copy every element of the shard the iterator is currently on while
+// holding its lock.
+static bool snapshot_shard(const DSConcurrentDict *dict, struct cdict_iter *state, const DSAllocator *alloc) {
+    assert(dict);
+    assert(state);
+    assert(state->shard < dict->nshards);
+
+    struct cdict_shard *shard = &dict->shards[state->shard].shard;
+    pthread_rwlock_rdlock(&shard->lock);
+
+    size_t cnt = dsdict_count(shard->dict);
+    if (cnt > state->cap) {
+        struct cdict_pair *pairs = ds_realloc(alloc, state->pairs,
+                                              state->cap * sizeof(struct cdict_pair),
+                                              cnt * sizeof(struct cdict_pair));
+        if (!pairs) {
+            pthread_rwlock_unlock(&shard->lock);
+            return false;
+        }
+        state->pairs = pairs;
+        state->cap = cnt;
+    }
+
+    state->len = 0;
+    state->next = 0;
+    dsdict_priv_foreach(shard->dict, collect_pair, state);
+    pthread_rwlock_unlock(&shard->lock);
+    return true;
+}
+
+// Append a key/value pair to an iterator snapshot.
+static void collect_pair(const void *key, void *val, void *ctx) {
+    struct cdict_iter *state = ctx;
+    assert(state->len < state->cap);
+
+    state->pairs[state->len].key = (void *)key;
+    state->pairs[state->len].val = val;
+    state->len++;
+}
+
+// Destroy the first n shards (which must have been fully initialized)
+// and the dictionary itself.
+static void release_shards(DSConcurrentDict *dict, size_t n) {
+    assert(dict);
+
+    for (size_t i = 0; i < n; i++) {
+        struct cdict_shard *shard = &dict->shards[i].shard;
+        pthread_rwlock_destroy(&shard->lock);
+        dsdict_destroy(shard->dict);
+    }
+
+    DSAllocator alloc = dict->alloc;
+    ds_free(&alloc, dict->shards, dict->nshards * sizeof(union cdict_slot));
+    ds_free(&alloc, dict, sizeof(DSConcurrentDict));
+}
+
+// Iterate on the next concurrent dictionary entry, copying the next
+// non-empty shard when the current snapshot is exhausted. An iterator
+// which cannot allocate a snapshot stops with DSITER_ERROR rather than
+// reporting the end of the dictionary.
+bool dsiter_dscdict_next(DSIter *iter, bool advance) {
+    assert(iter);
+    assert(iter->type == ITER_CDICT);
+
+    if ((DSITER_IS_FINISHED(iter)) || (DSITER_IS_FAILED(iter))) {
+        return false;
+    }
+
+    const DSConcurrentDict *dict = iter->target.cdict;
+    struct cdict_iter *state = iter->node.cdict;
+    while (state->next >= state->len) {
+        int stat = DSITER_NORMAL;
+        if (state->shard >= dict->nshards) {
+            stat = DSITER_NO_MORE_ELEMENTS;
+        } else if (!snapshot_shard(dict, state, &iter->alloc)) {
+            stat = DSITER_ERROR;
+        }
+
+        if (stat != DSITER_NORMAL) {
+            if (advance) {
+                iter->stat = stat;
+                state->key = NULL;
+                state->val = NULL;
+            }
+            return false;
+        }
+        state->shard++;
+    }
+
+    if (advance) {
+        iter->cur = (DSITER_IS_NEW_ITER(iter)) ? 0 : (iter->cur + 1);
+        iter->stat = DSITER_NORMAL;
+        state->key = state->pairs[state->next].key;
+        state->val = state->pairs[state->next].val;
+        state->next++;
+    }
+    return true;
+}
+
+// Return the key of the current concurrent dictionary iterator entry.
+void *dsiter_dscdict_key(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_CDICT);
+    return iter->node.cdict->key;
+}
+
+// Return the value of the current concurrent dictionary iterator entry.
+void *dsiter_dscdict_value(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_CDICT);
+    return iter->node.cdict->val;
+}
+
+// Restart a concurrent dictionary iterator from the first shard, keeping
+// the snapshot storage for reuse.
+void dsiter_dscdict_reset(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_CDICT);
+
+    struct cdict_iter *state = iter->node.cdict;
+    state->shard = 0;
+    state->next = 0;
+    state->len = 0;
+    state->key = NULL;
+    state->val = NULL;
+}
+
+// Free the snapshot held by a concurrent dictionary iterator.
+void dsiter_dscdict_release(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_CDICT);
+
+    struct cdict_iter *state = iter->node.cdict;
+    if (!state) { return; }
+
+    ds_free(&iter->alloc, state->pairs, state->cap * sizeof(struct cdict_pair));
+    ds_free(&iter->alloc, state, sizeof(struct cdict_iter));
+    iter->node.cdict = NULL;
+}
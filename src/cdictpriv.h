@@ -0,0 +1,43 @@
+/*****************************************************************************
+ * libds :: cdictpriv.h
+ *
+ * Private header for the concurrent dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_CDICTPRIV_H
+#define LIBDS_CDICTPRIV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "libds/cdict.h"
+
+struct cdict_pair {
+    void *key;
+    void *val;
+};
+
+/*
+ * Iterator state for a concurrent dictionary, which holds a copy of the
+ * elements of the shard being visited.
+ */
+struct cdict_iter {
+    size_t shard;
+    size_t next;
+    size_t len;
+    size_t cap;
+    struct cdict_pair *pairs;
+    void *key;
+    void *val;
+};
+
+bool dsiter_dscdict_next(DSIter *iter, bool advance);
+void *dsiter_dscdict_key(DSIter *iter);
+void *dsiter_dscdict_value(DSIter *iter);
+void dsiter_dscdict_reset(DSIter *iter);
+void dsiter_dscdict_release(DSIter *iter);
+
+#endif //LIBDS_CDICTPRIV_H
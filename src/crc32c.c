@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * libds :: crc32c.c
+ *
+ * CRC32C (Castagnoli) checksum and hash with runtime CPU dispatch.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_USE_SSE42 1
+#include <nmmintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#define CRC32C_USE_ARMV8 1
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+#include "libds/hash.h"
+#include "atomicpriv.h"
+
+static const uint32_t CRC32C_POLY = 0x82F63B78;
+
+typedef uint32_t (*crc32c_fn)(uint32_t crc, const uint8_t *p, size_t len);
+
+/*
+ * The implementation is selected (and the software tables built) exactly
+ * once by crc32c_resolve. crc32c_impl is published with release ordering
+ * after the tables are complete, so any thread which loads a non-NULL
+ * implementation with acquire ordering also sees the finished tables.
+ */
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+static DS_ATOMIC(crc32c_fn) crc32c_impl = NULL;
+static uint32_t CRC32C_TABLE[8][256];
+
+static void crc32c_resolve(void);
+static void crc32c_init_table(void);
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, size_t len);
+#if defined(CRC32C_USE_SSE42)
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *p, size_t len);
+#elif defined(CRC32C_USE_ARMV8)
+static uint32_t crc32c_armv8(uint32_t crc, const uint8_t *p, size_t len);
+#endif
+
+/*
+ * CRC32C PUBLIC FUNCTIONS
+ */
+
+uint32_t hash_crc32c(const void *data, size_t len, uint32_t seed) {
+    crc32c_fn impl = DS_ATOMIC_LOAD(&crc32c_impl, DS_ATOMIC_ACQUIRE);
+    if (!impl) {
+        pthread_once(&crc32c_once, crc32c_resolve);
+        impl = DS_ATOMIC_LOAD(&crc32c_impl, DS_ATOMIC_ACQUIRE);
+    }
+    return ~impl(~seed, data, len);
+}
+
+uint32_t hash_crc32c_str(const char *str) {
+    return hash_crc32c(str, strlen(str), 0);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Select the fastest implementation supported by the running CPU. Only
+// ever called once, through crc32c_once. The software tables are always
+// built since they are cheap.
+static void crc32c_resolve(void) {
+    crc32c_init_table();
+    crc32c_fn impl = crc32c_sw;
+
+#if defined(CRC32C_USE_SSE42)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        impl = crc32c_sse42;
+    }
+#elif defined(CRC32C_USE_ARMV8)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        impl = crc32c_armv8;
+    }
+#endif
+
+    DS_ATOMIC_STORE(&crc32c_impl, impl, DS_ATOMIC_RELEASE);
+}
+
+// Build the slicing-by-8 lookup tables for the software implementation.
+static void crc32c_init_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ CRC32C_POLY) : (crc >> 1);
+        }
+        CRC32C_TABLE[0][i] = crc;
+    }
+
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = CRC32C_TABLE[0][i];
+        for (int t = 1; t < 8; t++) {
+            crc = CRC32C_TABLE[0][crc & 0xFF] ^ (crc >> 8);
+            CRC32C_TABLE[t][i] = crc;
+        }
+    }
+}
+
+// Portable table driven implementation consuming 8 bytes per step.
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len >= 8) {
+        uint32_t lo = crc ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                             ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+        crc = CRC32C_TABLE[7][lo & 0xFF] ^
+              CRC32C_TABLE[6][(lo >> 8) & 0xFF] ^
+              CRC32C_TABLE[5][(lo >> 16) & 0xFF] ^
+              CRC32C_TABLE[4][lo >> 24] ^
+              CRC32C_TABLE[3][p[4]] ^
+              CRC32C_TABLE[2][p[5]] ^
+              CRC32C_TABLE[1][p[6]] ^
+              CRC32C_TABLE[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+
+    while (len > 0) {
+        crc = CRC32C_TABLE[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        len--;
+    }
+    return crc;
+}
+
+#if defined(CRC32C_USE_SSE42)
+// Hardware implementation using the SSE4.2 crc32 instruction.
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *p, size_t len) {
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        len -= 8;
+    }
+    crc = (uint32_t)crc64;
+#endif
+    while (len >= 4) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+        len -= 4;
+    }
+    while (len > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        len--;
+    }
+    return crc;
+}
+#elif defined(CRC32C_USE_ARMV8)
+// Hardware implementation using the ARMv8 CRC32 extension.
+__attribute__((target("+crc")))
+static uint32_t crc32c_armv8(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+        p += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        crc = __crc32cb(crc, *p++);
+        len--;
+    }
+    return crc;
+}
+#endif
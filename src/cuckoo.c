@@ -0,0 +1,500 @@
+/*****************************************************************************
+ * libds :: cuckoo.c
+ *
+ * Cuckoo hashing engine for the dictionary data structure.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "allocpriv.h"
+#include "cuckoopriv.h"
+#include "dictpriv.h"
+#include "hashpriv.h"
+
+static const size_t CUCKOO_ALIGN = 64;
+static const size_t CUCKOO_MAX_SEEDS = 4;
+static const size_t CUCKOO_NONE = SIZE_MAX;
+static const uint64_t CUCKOO_SEED = UINT64_C(0x6A09E667F3BCC909);
+
+/*
+ * Evictions made by a single insert before its last evicted element goes
+ * to the stash. Each one is recorded so it can be undone.
+ */
+enum { CUCKOO_MAX_KICKS = 128 };
+
+static bool place(struct cuckoo *table, uint64_t hash, void *key, void *data, bool spill);
+static bool fill(struct cuckoo *fresh, const struct cuckoo *table, bool spill);
+static struct cuckoo_slot *locate(const struct cuckoo *table, uint64_t hash, void *key, dsdict_compare_fn cmp);
+static size_t find_free(const struct cuckoo *table, size_t bucket);
+static bool stash_push(struct cuckoo *table, struct cuckoo_entry entry, bool spill);
+static bool stash_reserve(struct cuckoo *table);
+static void stash_link(struct cuckoo *table, size_t i);
+static void stash_unlink(struct cuckoo *table, size_t i);
+static void put_at(struct cuckoo *table, size_t i, struct cuckoo_entry entry);
+static inline uint32_t *chain_for(const struct cuckoo *table, uint64_t hash);
+static inline void buckets_for(const struct cuckoo *table, uint64_t hash, size_t *first, size_t *second);
+static inline uint32_t tag_for(uint64_t hash);
+static inline size_t bucket_count(size_t cap);
+static inline size_t raw_size(size_t nbuckets);
+
+/*
+ * CUCKOO ENGINE FUNCTIONS
+ */
+
+// Allocate the buckets and hashes for a new table holding at least cap
+// elements. The stash is only allocated once an element needs it.
+bool cuckoo_init(struct cuckoo *table, size_t cap, const DSAllocator *alloc) {
+    assert(table);
+    assert(alloc);
+    assert(cap > 0);
+    assert(sizeof(struct cuckoo_bucket) == CUCKOO_ALIGN);
+
+    size_t nbuckets = bucket_count(cap);
+    table->alloc = alloc;
+    table->raw = ds_calloc(alloc, 1, raw_size(nbuckets));
+    if (!table->raw) {
+        return false;
+    }
+
+    // Full hashes are only ever read for occupied slots, so they need
+    // not be cleared
+    size_t nslots = nbuckets * CUCKOO_BUCKET_SLOTS;
+    table->hashes = ds_alloc(alloc, nslots * sizeof(uint64_t));
+    if (!table->hashes) {
+        ds_free(alloc, table->raw, raw_size(nbuckets));
+        table->raw = NULL;
+        return false;
+    }
+
+    // Buckets are aligned so that each fills a single cache line
+    uintptr_t addr = (uintptr_t)table->raw;
+    table->buckets = (struct cuckoo_bucket *)((addr + (CUCKOO_ALIGN - 1)) & ~(uintptr_t)(CUCKOO_ALIGN - 1));
+    table->stash = NULL;
+    table->seed = CUCKOO_SEED;
+    table->cap = cap;
+    table->nslots = nslots;
+    table->mask = nbuckets - 1;
+    table->cnt = 0;
+    table->stashlen = 0;
+    table->stashcap = 0;
+    return true;
+}
+
+// Free the table storage, but do not free key/value pairs.
+void cuckoo_release(struct cuckoo *table) {
+    assert(table);
+    if (table->raw) {
+        ds_free(table->alloc, table->raw, raw_size(table->mask + 1));
+        ds_free(table->alloc, table->hashes, table->nslots * sizeof(uint64_t));
+        ds_free(table->alloc, table->stash, table->stashcap * sizeof(struct cuckoo_entry));
+    }
+    table->raw = NULL;
+    table->buckets = NULL;
+    table->stash = NULL;
+    table->hashes = NULL;
+    table->cap = 0;
+    table->nslots = 0;
+    table->cnt = 0;
+    table->stashlen = 0;
+    table->stashcap = 0;
+}
+
+// Return the slot holding the given key or NULL if it is not in the table.
+// At most two buckets are searched, and the stash only if the first of
+// them has overflowed into it.
+struct cuckoo_slot *cuckoo_find(const struct cuckoo *table, uint64_t hash, void *key, dsdict_compare_fn cmp) {
+    assert(table);
+    assert(cmp);
+    return locate(table, hash, key, cmp);
+}
+
+// Prefetch both buckets a lookup for the given hash may read.
+void cuckoo_prefetch(const struct cuckoo *table, uint64_t hash) {
+    assert(table);
+
+    size_t first, second;
+    buckets_for(table, hash, &first, &second);
+    DICT_PREFETCH(&table->buckets[first]);
+    DICT_PREFETCH(&table->buckets[second]);
+}
+
+// Add a key which is known not to be in the table, evicting other
+// elements into their alternate buckets if both of its buckets are full
+// and falling back to the stash if no place is found. Returns the slot
+// now holding the key, or NULL if the stash already holds
+// CUCKOO_STASH_SIZE elements or could not be allocated (in which case
+// the table is unchanged).
+struct cuckoo_slot *cuckoo_add(struct cuckoo *table, uint64_t hash, void *key, void *data) {
+    assert(table);
+    assert(key);
+
+    if (!place(table, hash, key, data, false)) {
+        return NULL;
+    }
+    table->cnt++;
+
+    // The new key may itself have been evicted along the way
+    return locate(table, hash, key, NULL);
+}
+
+// Add a key which is known not to be in the table like cuckoo_add, but
+// grow the stash past CUCKOO_STASH_SIZE elements if needed. Returns NULL
+// only if memory could not be allocated.
+struct cuckoo_slot *cuckoo_spill(struct cuckoo *table, uint64_t hash, void *key, void *data) {
+    assert(table);
+    assert(key);
+
+    if (!place(table, hash, key, data, true)) {
+        return NULL;
+    }
+    table->cnt++;
+    return locate(table, hash, key, NULL);
+}
+
+// Remove the given slot from the table. The key and data are left to
+// the caller. Stash slots are left empty rather than filled from the end
+// of the stash, so positions held by iterators stay valid until the next
+// cuckoo_unstash.
+void cuckoo_erase(struct cuckoo *table, struct cuckoo_slot *slot) {
+    assert(table);
+    assert(slot);
+
+    slot->key = NULL;
+    slot->data = NULL;
+    table->cnt--;
+}
+
+// Move any stash elements which now fit in one of their buckets back into
+// the table and drop stash slots emptied by cuckoo_erase. The stash is
+// freed once it is empty.
+void cuckoo_unstash(struct cuckoo *table) {
+    assert(table);
+
+    // Every chain is rebuilt below, since compacting moves stash elements
+    for (size_t i = 0; i < table->stashlen; i++) {
+        *chain_for(table, table->stash[i].hash) = 0;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < table->stashlen; i++) {
+        struct cuckoo_entry entry = table->stash[i];
+        if (!entry.slot.key) { continue; }
+
+        size_t first, second;
+        buckets_for(table, entry.hash, &first, &second);
+        size_t at = find_free(table, first);
+        if (at == CUCKOO_NONE) {
+            at = find_free(table, second);
+        }
+        if (at == CUCKOO_NONE) {
+            table->stash[kept] = entry;
+            stash_link(table, kept++);
+            continue;
+        }
+
+        put_at(table, at, entry);
+    }
+    table->stashlen = kept;
+
+    if (kept == 0) {
+        ds_free(table->alloc, table->stash, table->stashcap * sizeof(struct cuckoo_entry));
+        table->stash = NULL;
+        table->stashcap = 0;
+    }
+}
+
+// Move every element into a fresh table holding at least newcap elements,
+// choosing buckets with a new seed. A few more seeds are tried should the
+// new stash overflow, and the stash of the last is grown as needed. The
+// table is unchanged if memory could not be allocated.
+bool cuckoo_rehash(struct cuckoo *table, size_t newcap) {
+    assert(table);
+
+    uint64_t seed = table->seed;
+    for (size_t attempt = 0; attempt < CUCKOO_MAX_SEEDS; attempt++) {
+        struct cuckoo fresh;
+        if (!cuckoo_init(&fresh, newcap, table->alloc)) {
+            return false;
+        }
+
+        seed = hash_priv_u64(seed, CUCKOO_SEED);
+        fresh.seed = seed;
+        if (fill(&fresh, table, (attempt + 1) == CUCKOO_MAX_SEEDS)) {
+            cuckoo_release(table);
+            *table = fresh;
+            return true;
+        }
+        cuckoo_release(&fresh);
+    }
+
+    return false;
+}
+
+// Return the position of the first element at or after from, or
+// cuckoo_end if there are no more elements. Positions past the bucket
+// slots refer to the stash (see cuckoo_at).
+size_t cuckoo_next(const struct cuckoo *table, size_t from) {
+    assert(table);
+
+    size_t end = cuckoo_end(table);
+    for (size_t i = from; i < end; i++) {
+        if (cuckoo_at(table, i)->key) {
+            return i;
+        }
+    }
+    return end;
+}
+
+// Record the number of places searched to find every element and the
+// size of the table in a DSDictStats. Elements in their first bucket
+// count 1, in their second bucket 2 and in the stash 3.
+void cuckoo_stats(const struct cuckoo *table, DSDictStats *stats) {
+    assert(table);
+    assert(stats);
+
+    size_t total = 0;
+    size_t end = cuckoo_end(table);
+    for (size_t i = cuckoo_next(table, 0); i < end; i = cuckoo_next(table, i + 1)) {
+        size_t len = 3;
+        if (i < table->nslots) {
+            size_t first, second;
+            buckets_for(table, table->hashes[i], &first, &second);
+            len = ((i / CUCKOO_BUCKET_SLOTS) == first) ? 1 : 2;
+        }
+        dict_stats_record(stats, len);
+        total += len;
+    }
+
+    stats->occupied = table->cnt;
+    stats->mean_chain = (table->cnt > 0) ? ((double)total / table->cnt) : 0.0;
+    stats->table_bytes = raw_size(table->mask + 1) + (table->nslots * sizeof(uint64_t)) +
+                         (table->stashcap * sizeof(struct cuckoo_entry));
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Store an element in the table, evicting elements along a random walk
+// if both of its buckets are full. Whichever element is left without a
+// place after CUCKOO_MAX_KICKS evictions goes into the stash. If it
+// cannot (see stash_push), every eviction is undone and false is returned.
+static bool place(struct cuckoo *table, uint64_t hash, void *key, void *data, bool spill) {
+    size_t first, second;
+    buckets_for(table, hash, &first, &second);
+    size_t at = find_free(table, first);
+    if (at == CUCKOO_NONE) {
+        at = find_free(table, second);
+    }
+
+    // Evictions are chosen with a cheap generator seeded from the key
+    // hash, so the same sequence of operations always gives the same table
+    size_t path[CUCKOO_MAX_KICKS];
+    size_t kicks = 0;
+    uint64_t rng = hash_priv_u64(hash, table->cnt);
+    size_t bucket = (rng & 1) ? second : first;
+    struct cuckoo_entry cur = { hash, { key, data }, 0 };
+    while ((at == CUCKOO_NONE) && (kicks < CUCKOO_MAX_KICKS)) {
+        rng = hash_priv_u64(rng, CUCKOO_SEED);
+        size_t victim = (bucket * CUCKOO_BUCKET_SLOTS) + (size_t)(rng % CUCKOO_BUCKET_SLOTS);
+        struct cuckoo_entry evicted = { table->hashes[victim], *cuckoo_at(table, victim), 0 };
+        put_at(table, victim, cur);
+        path[kicks++] = victim;
+        cur = evicted;
+
+        // The evicted element moves to whichever of its buckets it was
+        // not just evicted from
+        buckets_for(table, cur.hash, &first, &second);
+        bucket = (bucket == first) ? second : first;
+        at = find_free(table, bucket);
+    }
+
+    if (at != CUCKOO_NONE) {
+        put_at(table, at, cur);
+        return true;
+    }
+
+    if (stash_push(table, cur, spill)) {
+        return true;
+    }
+
+    // Walk the evictions back so every element returns to its old slot
+    while (kicks > 0) {
+        size_t victim = path[--kicks];
+        struct cuckoo_entry placed = { table->hashes[victim], *cuckoo_at(table, victim), 0 };
+        put_at(table, victim, cur);
+        cur = placed;
+    }
+    return false;
+}
+
+// Place every element of table into the empty table fresh, growing its
+// stash as needed if spill is true. Returns false if the stash of fresh
+// overflowed or could not be allocated.
+static bool fill(struct cuckoo *fresh, const struct cuckoo *table, bool spill) {
+    size_t end = cuckoo_end(table);
+    for (size_t i = cuckoo_next(table, 0); i < end; i = cuckoo_next(table, i + 1)) {
+        uint64_t hash = (i < table->nslots) ? table->hashes[i] : table->stash[i - table->nslots].hash;
+        struct cuckoo_slot *slot = cuckoo_at(table, i);
+        if (!place(fresh, hash, slot->key, slot->data, spill)) {
+            return false;
+        }
+        fresh->cnt++;
+    }
+    return true;
+}
+
+// Return the slot holding key in either of its buckets or the stash
+// chain of the first, or NULL if it is not present. Keys are compared with cmp or, if cmp is
+// NULL, by identity.
+static struct cuckoo_slot *locate(const struct cuckoo *table, uint64_t hash, void *key, dsdict_compare_fn cmp) {
+    size_t buckets[2];
+    buckets_for(table, hash, &buckets[0], &buckets[1]);
+    uint32_t tag = tag_for(hash);
+    for (size_t b = 0; b < 2; b++) {
+        struct cuckoo_bucket *bucket = &table->buckets[buckets[b]];
+        for (size_t i = 0; i < CUCKOO_BUCKET_SLOTS; i++) {
+            struct cuckoo_slot *slot = &bucket->slots[i];
+            if ((bucket->tags[i] == tag) && (slot->key) &&
+                ((cmp) ? (cmp(slot->key, key) == 0) : (slot->key == key))) {
+                return slot;
+            }
+        }
+    }
+
+    for (uint32_t n = table->buckets[buckets[0]].chain; n != 0; n = table->stash[n - 1].next) {
+        struct cuckoo_entry *entry = &table->stash[n - 1];
+        if ((entry->hash == hash) && (entry->slot.key) &&
+            ((cmp) ? (cmp(entry->slot.key, key) == 0) : (entry->slot.key == key))) {
+            return &entry->slot;
+        }
+    }
+
+    return NULL;
+}
+
+// Return the position of the first empty slot in a bucket, or
+// CUCKOO_NONE if the bucket is full.
+static size_t find_free(const struct cuckoo *table, size_t bucket) {
+    const struct cuckoo_bucket *cur = &table->buckets[bucket];
+    for (size_t i = 0; i < CUCKOO_BUCKET_SLOTS; i++) {
+        if (!cur->slots[i].key) {
+            return (bucket * CUCKOO_BUCKET_SLOTS) + i;
+        }
+    }
+    return CUCKOO_NONE;
+}
+
+// Store an element in a stash slot left empty by cuckoo_erase or at the
+// end of the stash. Returns false if the stash could not be allocated, or
+// if it already holds CUCKOO_STASH_SIZE elements and spill is false.
+static bool stash_push(struct cuckoo *table, struct cuckoo_entry entry, bool spill) {
+    size_t spare = 0;
+    while ((spare < table->stashlen) && (table->stash[spare].slot.key)) {
+        spare++;
+    }
+
+    if (spare < table->stashlen) {
+        stash_unlink(table, spare);
+    } else {
+        if ((!spill) && (table->stashlen >= CUCKOO_STASH_SIZE)) { return false; }
+        if (!stash_reserve(table)) { return false; }
+        table->stashlen++;
+    }
+
+    table->stash[spare] = entry;
+    stash_link(table, spare);
+    return true;
+}
+
+// Make sure the stash has room for one more element, doubling it if
+// needed. Stash indices must fit in a chain link.
+static bool stash_reserve(struct cuckoo *table) {
+    if (table->stashlen < table->stashcap) { return true; }
+
+    size_t oldcap = table->stashcap;
+    size_t newcap = (oldcap > 0) ? (oldcap * 2) : CUCKOO_STASH_SIZE;
+    if ((newcap >= UINT32_MAX) || (newcap > SIZE_MAX / sizeof(struct cuckoo_entry))) {
+        return false;
+    }
+
+    struct cuckoo_entry *stash = (table->stash) ?
+        ds_realloc(table->alloc, table->stash, oldcap * sizeof(struct cuckoo_entry),
+                   newcap * sizeof(struct cuckoo_entry)) :
+        ds_alloc(table->alloc, newcap * sizeof(struct cuckoo_entry));
+    if (!stash) { return false; }
+
+    table->stash = stash;
+    table->stashcap = newcap;
+    return true;
+}
+
+// Add the stash element at index i to the chain of its first bucket.
+static void stash_link(struct cuckoo *table, size_t i) {
+    uint32_t *chain = chain_for(table, table->stash[i].hash);
+    table->stash[i].next = *chain;
+    *chain = (uint32_t)(i + 1);
+}
+
+// Remove the stash element at index i from the chain of its first bucket.
+static void stash_unlink(struct cuckoo *table, size_t i) {
+    uint32_t *link = chain_for(table, table->stash[i].hash);
+    while (*link != (uint32_t)(i + 1)) {
+        assert(*link != 0);
+        link = &table->stash[*link - 1].next;
+    }
+    *link = table->stash[i].next;
+}
+
+// Store an element in the bucket slot at position i.
+static void put_at(struct cuckoo *table, size_t i, struct cuckoo_entry entry) {
+    struct cuckoo_bucket *bucket = &table->buckets[i / CUCKOO_BUCKET_SLOTS];
+    bucket->tags[i % CUCKOO_BUCKET_SLOTS] = tag_for(entry.hash);
+    bucket->slots[i % CUCKOO_BUCKET_SLOTS] = entry.slot;
+    table->hashes[i] = entry.hash;
+}
+
+// Return the stash chain of the first bucket for a hash.
+static inline uint32_t *chain_for(const struct cuckoo *table, uint64_t hash) {
+    size_t first, second;
+    buckets_for(table, hash, &first, &second);
+    return &table->buckets[first].chain;
+}
+
+// Compute the two buckets for a hash from the two halves of a seeded
+// 64-bit mix of it, which are independent of one another. Both buckets
+// are always distinct, so every key has two places to go.
+static inline void buckets_for(const struct cuckoo *table, uint64_t hash, size_t *first, size_t *second) {
+    uint64_t mixed = hash_priv_u64(hash, table->seed);
+    *first = (size_t)mixed & table->mask;
+    *second = (size_t)(mixed >> 32) & table->mask;
+    if (*second == *first) {
+        *second = *first ^ 1;
+    }
+}
+
+// Fold a hash into the fingerprint kept beside its slot.
+static inline uint32_t tag_for(uint64_t hash) {
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Return the smallest power of 2 number of buckets (and at least two)
+// which holds cap elements.
+static inline size_t bucket_count(size_t cap) {
+    size_t nbuckets = 2;
+    while ((nbuckets * CUCKOO_BUCKET_SLOTS) < cap) {
+        nbuckets *= 2;
+    }
+    return nbuckets;
+}
+
+// Return the number of bytes allocated to hold nbuckets aligned buckets.
+static inline size_t raw_size(size_t nbuckets) {
+    return (nbuckets * sizeof(struct cuckoo_bucket)) + (CUCKOO_ALIGN - 1);
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * libds :: cuckoopriv.h
+ *
+ * Private header for the cuckoo hashing dictionary engine.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_CUCKOOPRIV_H
+#define LIBDS_CUCKOOPRIV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "libds/alloc.h"
+#include "libds/dict.h"
+
+/*
+ * Number of slots in each bucket. Each bucket holds the fingerprints and
+ * slots for its elements and fills exactly one 64 byte cache line.
+ */
+#if UINTPTR_MAX > UINT32_MAX
+#define CUCKOO_BUCKET_SLOTS 3
+#else
+#define CUCKOO_BUCKET_SLOTS 5
+#endif
+
+/*
+ * Number of elements held by the stash before a table is rehashed with
+ * new bucket choices (and grown, if it is crowded) instead. Elements which
+ * still find no place, such as keys sharing a single hash, grow the stash
+ * beyond this size.
+ */
+#define CUCKOO_STASH_SIZE 8
+
+/*
+ * Slots with a NULL key are empty.
+ */
+struct cuckoo_slot {
+    void *key;
+    void *data;
+};
+
+/*
+ * Stash elements are chained from the first of their two buckets. The
+ * chain is 1 more than the stash index of the first element in it, or 0
+ * if no stash element has this bucket as its first, so lookups which miss
+ * only walk the stash elements which share their first bucket.
+ */
+struct cuckoo_bucket {
+    uint32_t tags[CUCKOO_BUCKET_SLOTS];
+    uint32_t chain;
+    struct cuckoo_slot slots[CUCKOO_BUCKET_SLOTS];
+};
+
+/*
+ * Stash element. The next link is encoded like a bucket chain.
+ */
+struct cuckoo_entry {
+    uint64_t hash;
+    struct cuckoo_slot slot;
+    uint32_t next;
+};
+
+/*
+ * Bucketized cuckoo hash table.
+ *
+ * Every key may only be stored in one of two buckets, chosen by two
+ * independent parts of a seeded 64-bit mix of the key hash, or in a
+ * stash of elements which could not be placed in either. Inserting into
+ * a full pair of buckets evicts an element into its other bucket,
+ * repeating a bounded number of times. Buckets are cache line aligned
+ * and keep a 32-bit fingerprint of each element's hash beside its slot,
+ * so a lookup reads at most two cache lines of the table unless the
+ * first of its buckets has overflowed into the stash. The
+ * full hashes are kept in a separate array which is only read to move
+ * elements. The number of slots is the smallest power of 2 buckets
+ * holding at least cap elements. Storage comes from the owning
+ * dictionary's allocator, which must outlive the table.
+ */
+struct cuckoo {
+    void *raw;
+    struct cuckoo_bucket *buckets;
+    struct cuckoo_entry *stash;
+    uint64_t *hashes;
+    uint64_t seed;
+    size_t cap;
+    size_t nslots;
+    size_t mask;
+    size_t cnt;
+    size_t stashlen;
+    size_t stashcap;
+    const DSAllocator *alloc;
+};
+
+bool cuckoo_init(struct cuckoo *table, size_t cap, const DSAllocator *alloc);
+void cuckoo_release(struct cuckoo *table);
+struct cuckoo_slot *cuckoo_find(const struct cuckoo *table, uint64_t hash, void *key, dsdict_compare_fn cmp);
+void cuckoo_prefetch(const struct cuckoo *table, uint64_t hash);
+struct cuckoo_slot *cuckoo_add(struct cuckoo *table, uint64_t hash, void *key, void *data);
+struct cuckoo_slot *cuckoo_spill(struct cuckoo *table, uint64_t hash, void *key, void *data);
+void cuckoo_erase(struct cuckoo *table, struct cuckoo_slot *slot);
+void cuckoo_unstash(struct cuckoo *table);
+bool cuckoo_rehash(struct cuckoo *table, size_t newcap);
+size_t cuckoo_next(const struct cuckoo *table, size_t from);
+void cuckoo_stats(const struct cuckoo *table, DSDictStats *stats);
+
+// Return the slot at a position returned by cuckoo_next. Positions past
+// the end of the bucket slots refer to the stash.
+static inline struct cuckoo_slot *cuckoo_at(const struct cuckoo *table, size_t i) {
+    if (i >= table->nslots) {
+        return &table->stash[i - table->nslots].slot;
+    }
+    return &table->buckets[i / CUCKOO_BUCKET_SLOTS].slots[i % CUCKOO_BUCKET_SLOTS];
+}
+
+// Return the position just past the last element cuckoo_next can return.
+static inline size_t cuckoo_end(const struct cuckoo *table) {
+    return table->nslots + table->stashlen;
+}
+
+#endif //LIBDS_CUCKOOPRIV_H
@@ -9,24 +9,42 @@
  *****************************************************************************/
 
 #include <assert.h>
-#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "allocpriv.h"
+#include "cuckoopriv.h"
 #include "dictpriv.h"
 #include "iterpriv.h"
+#include "orderedpriv.h"
+#include "slabpriv.h"
+#include "swisspriv.h"
 
 static const double DSDICT_DEFAULT_LOAD = 0.66;
 static const size_t DSDICT_DEFAULT_CAP = 64;
+static const size_t DSDICT_MIN_CAP = 16;
 static const size_t DSDICT_DEFAULT_CAPACITY_FACTOR = 2;
+static const double DSDICT_SHRINK_FRACTION = 0.25;
+static const size_t DSDICT_MIGRATE_BUCKETS = 4;
+static const size_t DSDICT_MIGRATE_EMPTY_VISITS = 40;
 
 /*
- * Prime moduli for hash table capacity
+ * Number of keys hashed and prefetched together by the batched functions.
+ * Large enough to cover main memory latency, but small enough that the
+ * prefetched lines are still in cache when they are used.
+ */
+enum { DSDICT_BATCH_SIZE = 32 };
+
+/*
+ * Prime moduli for hash table capacity (only used by dictionaries created
+ * with DSDICT_PRIME_MODULI; others mask off the low bits of the mixed hash)
  * - Array index is power of 2 (i.e. index 1 is 2^1 = 2)
  * - Value at index is modulus to use for capacity at indexed power of 2
  * - Powers of 2 given at: https://primes.utm.edu/lists/2small/0bit.html
  */
-#define POW2(n, k) ((1 << n) - k)
+#define POW2(n, k) (((size_t)1 << n) - k)
 static const size_t DSDICT_MOD_TABLE[] = {
         1, 2, 3, 7, 13, 31, 61, 127, 251,                           /* Powers 0 through 8 */
         POW2(9, 3), POW2(10, 3), POW2(11, 9), POW2(12, 3),          /* Powers 9 through 12 */
@@ -35,56 +53,152 @@ static const size_t DSDICT_MOD_TABLE[] = {
         POW2(21, 9), POW2(22, 3), POW2(23, 15), POW2(24, 3),        /* Powers 21 through 24 */
         POW2(25, 39), POW2(26, 5), POW2(27, 39), POW2(28, 57),      /* Powers 25 through 28 */
         POW2(29, 3), POW2(30, 35), INT32_MAX,                       /* Powers 29 through 31 */
+#if SIZE_MAX > UINT32_MAX
+        POW2(32, 5), POW2(33, 9), POW2(34, 41), POW2(35, 31),       /* Powers 32 through 35 */
+        POW2(36, 5), POW2(37, 25), POW2(38, 45), POW2(39, 7),       /* Powers 36 through 39 */
+        POW2(40, 87), POW2(41, 21), POW2(42, 11), POW2(43, 57),     /* Powers 40 through 43 */
+        POW2(44, 17), POW2(45, 55), POW2(46, 21), POW2(47, 115),    /* Powers 44 through 47 */
+        POW2(48, 59), POW2(49, 81), POW2(50, 27), POW2(51, 129),    /* Powers 48 through 51 */
+        POW2(52, 47), POW2(53, 111), POW2(54, 33), POW2(55, 55),    /* Powers 52 through 55 */
+        POW2(56, 5), POW2(57, 13), POW2(58, 27), POW2(59, 55),      /* Powers 56 through 59 */
+        POW2(60, 93), POW2(61, 1), POW2(62, 57), POW2(63, 25),      /* Powers 60 through 63 */
+#endif
+};
+static const size_t DSDICT_MOD_TABLE_POWERS = sizeof(DSDICT_MOD_TABLE) / sizeof(DSDICT_MOD_TABLE[0]);
+
+enum DictEngine {
+    DICT_CHAINED,
+    DICT_OPEN_ADDRESSING,
+    DICT_ORDERED,
+    DICT_CUCKOO,
 };
 
 struct DSDict {
+    enum DictEngine engine;
     struct bucket **vals;
+    struct slab buckets;
+    struct swiss table;
+    struct ordered ordered;
+    struct cuckoo cuckoo;
     size_t cnt;
     size_t cap;
+    size_t power;
+    bool prime;
+    bool incremental;
+    struct bucket **oldvals;
+    size_t oldcap;
+    size_t oldpower;
+    size_t migrated;
+    size_t iters;
+    size_t mincap;
+    double load;
+    size_t resizes;
+    uint64_t resize_nanos;
     dsdict_hash_fn hash;
+    dsdict_hash64_fn hash64;
     dsdict_free_fn keyfree;
     dsdict_free_fn valfree;
     dsdict_compare_fn cmp;
+    DSAllocator alloc;
 };
 
+static struct bucket **chained_find(const DSDict *dict, uint64_t hash, void *key);
+static void chained_put(DSDict *dict, uint64_t hash, void *key, void *val);
+static struct bucket *chained_insert(DSDict *dict, uint64_t hash, void *key, void *val);
+static void *chained_get(const DSDict *dict, uint64_t hash, void *key);
+static void *chained_del(DSDict *dict, uint64_t hash, void *key);
+static void chained_prefetch(const DSDict *dict, uint64_t hash);
+static void chained_prefetch_chain(const DSDict *dict, uint64_t hash);
+static void chained_grow_for(DSDict *dict, size_t extra);
+static bool dict_lookup(const DSDict *dict, uint64_t hash, void *key, void **val);
+static void dict_prefetch(const DSDict *dict, uint64_t hash);
+static void foreach_visit(const void *key, void *val, void *ctx);
+static void **dict_entry(DSDict *dict, uint64_t hash, void *key, bool *inserted);
+static void swiss_put(DSDict *dict, uint64_t hash, void *key, void *val);
+static struct swiss_slot *swiss_insert(DSDict *dict, uint64_t hash, size_t free_at);
+static void *swiss_get(const DSDict *dict, uint64_t hash, void *key);
+static void *swiss_del(DSDict *dict, uint64_t hash, void *key);
+static bool swiss_make_room(DSDict *dict);
+static void ordered_put(DSDict *dict, uint64_t hash, void *key, void *val);
+static struct ordered_entry *ordered_insert(DSDict *dict, uint64_t hash, size_t free_at);
+static void *ordered_get(const DSDict *dict, uint64_t hash, void *key);
+static void *ordered_del(DSDict *dict, uint64_t hash, void *key);
+static bool ordered_make_room(DSDict *dict);
+static size_t ordered_usable(size_t cap, double load);
+static void cuckoo_put(DSDict *dict, uint64_t hash, void *key, void *val);
+static struct cuckoo_slot *cuckoo_insert(DSDict *dict, uint64_t hash, void *key);
+static void *cuckoo_get(const DSDict *dict, uint64_t hash, void *key);
+static void *cuckoo_del(DSDict *dict, uint64_t hash, void *key);
+static bool cuckoo_make_room(DSDict *dict);
+static DSDict *dict_new(dsdict_hash_fn hash, dsdict_hash64_fn hash64, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, size_t cap, const DSAllocator *alloc);
+static size_t dict_cap_for(size_t n, double load);
+static bool dict_set_cap(DSDict *dict, size_t newcap, bool sync);
+static void dict_maybe_shrink(DSDict *dict);
+static bool dict_pins_iters(const DSDict *dict);
 static bool dsdict_resize(DSDict *dict, size_t newcap);
-static bool transfer_vals(struct bucket **old, size_t oldcap, struct bucket **new, size_t newcap, dsdict_hash_fn hashfn);
+static bool split_vals(DSDict *dict);
+static bool begin_migration(DSDict *dict, size_t newcap);
+static void migrate_step(DSDict *dict);
+static void migrate_bucket(DSDict *dict, size_t i);
+static void finish_migration(DSDict *dict);
+static void transfer_vals(struct bucket **old, size_t oldcap, struct bucket **new, size_t newpower, bool prime);
 static void dsdict_free(DSDict *dict);
-static inline size_t compute_index(uint32_t hash, size_t cap);
+static void free_chains(DSDict *dict, struct bucket **vals, size_t cap);
+static void chained_stats(const DSDict *dict, DSDictStats *stats);
+static void resize_done(DSDict *dict, uint64_t start);
+static uint64_t dict_now(void);
+static inline size_t compute_index(uint64_t hash, size_t power, bool prime);
+static inline size_t compute_power(size_t cap);
+static inline uint64_t dict_hash(const DSDict *dict, void *key);
 
 /*
  * DICTIONARY PUBLIC FUNCTIONS
  */
 
 DSDict *dsdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree) {
-    if ((!hash) || (!cmpfn)) { return NULL; }
+    return dsdict_new_flags(hash, cmpfn, keyfree, valfree, DSDICT_CHAINED);
+}
 
-    DSDict *dict = malloc(sizeof(DSDict));
-    if (!dict) {
-        return NULL;
-    }
+DSDict *dsdict_new_flags(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags) {
+    return dsdict_new_alloc(hash, cmpfn, keyfree, valfree, flags, NULL);
+}
 
-    size_t cap = DSDICT_DEFAULT_CAP;
-    dict->vals = calloc(cap, sizeof(struct bucket));
-    if (!dict->vals) {
-        free(dict);
-        return NULL;
-    }
+DSDict *dsdict_new_alloc(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, const DSAllocator *alloc) {
+    return dict_new(hash, NULL, cmpfn, keyfree, valfree, flags, DSDICT_DEFAULT_CAP, alloc);
+}
 
-    dict->cnt = 0;
-    dict->cap = DSDICT_DEFAULT_CAP;
-    dict->hash = hash;
-    dict->keyfree = keyfree;
-    dict->valfree = valfree;
-    dict->cmp = cmpfn;
-    return dict;
+DSDict *dsdict_new_cap(size_t cap, dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, const DSAllocator *alloc) {
+    size_t newcap = dict_cap_for(cap, DSDICT_DEFAULT_LOAD);
+    if (newcap == 0) { return NULL; }
+    return dict_new(hash, NULL, cmpfn, keyfree, valfree, flags, newcap, alloc);
+}
+
+DSDict *dsdict_new_hash64(dsdict_hash64_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, const DSAllocator *alloc) {
+    if (!hash) { return NULL; }
+    return dict_new(NULL, hash, cmpfn, keyfree, valfree, flags, DSDICT_DEFAULT_CAP, alloc);
 }
 
 void dsdict_destroy(DSDict *dict) {
     if (!dict) { return; }
     dsdict_free(dict);
-    free(dict->vals);
-    free(dict);
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            slab_release(&dict->buckets);
+            ds_free(&dict->alloc, dict->oldvals, dict->oldcap * sizeof(struct bucket *));
+            ds_free(&dict->alloc, dict->vals, dict->cap * sizeof(struct bucket *));
+            break;
+        case DICT_OPEN_ADDRESSING:
+            swiss_release(&dict->table);
+            break;
+        case DICT_ORDERED:
+            ordered_release(&dict->ordered);
+            break;
+        case DICT_CUCKOO:
+            cuckoo_release(&dict->cuckoo);
+            break;
+    }
+    DSAllocator alloc = dict->alloc;
+    ds_free(&alloc, dict, sizeof(DSDict));
 }
 
 size_t dsdict_count(const DSDict *dict) {
@@ -97,145 +211,261 @@ size_t dsdict_cap(const DSDict *dict) {
     return dict->cap;
 }
 
-void dsdict_foreach(DSDict *dict, dsdict_foreach_fn func) {
-    if ((!dict) || (!func)) { return; }
+bool dsdict_reserve(DSDict *dict, size_t n) {
+    if (!dict) { return false; }
 
-    for (size_t i = 0; i < dict->cnt; i++) {
-        if (!dict->vals[i]) { continue; }
-        func(dict->vals[i]->key, dict->vals[i]->data);
+    size_t newcap = dict_cap_for(n, dict->load);
+    if (newcap == 0) { return false; }
+    if (newcap > dict->cap) {
+        if (!dict_set_cap(dict, newcap, false)) { return false; }
+    }
 
-        struct bucket *next = dict->vals[i]->next;
-        while ((next)){
-            func(next->key, next->data);
-            next = next->next;
-        }
+    // Never automatically shrink below the reservation
+    if (newcap > dict->mincap) {
+        dict->mincap = newcap;
     }
+    return true;
 }
 
-void dsdict_put(DSDict *dict, void *key, void *val) {
-    if ((!dict) || (!key)) { return; }
-
-    unsigned int hash = dict->hash(key);
-    size_t place = compute_index(hash, dict->cap);
+bool dsdict_set_load_factor(DSDict *dict, double load) {
+    if ((!dict) || (!(load > 0.0)) || (!(load < 1.0))) { return false; }
 
-    // Get reference to place and see if there is data there;
-    // if not, just set the data
-    struct bucket *cur = dict->vals[place];
-    if (!cur) {
-        dict->vals[place] = malloc(sizeof(struct bucket));
-        if (!dict->vals[place]) { return; }
-        cur = dict->vals[place];
-        goto dsdict_put_op;
+    dict->load = load;
+    size_t newcap = dict_cap_for(dict->cnt, load);
+    if (newcap == 0) { return false; }
+    if (newcap > dict->cap) {
+        return dict_set_cap(dict, newcap, false);
     }
+    return true;
+}
 
-    // If there was data, check if it's the same value;
-    // if so, we can overwrite it and we're done
-    if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
-        if (dict->valfree) { dict->valfree(cur->data); }
-        cur->data = val;
-        goto cleanup_dsdict_put;
-    }
+bool dsdict_migrate(DSDict *dict) {
+    if (!dict) { return false; }
 
-    // Otherwise traverse linked list and check if we can
-    // overwrite any connected nodes
-    struct bucket *prev = cur;
-    cur = cur->next;
-    while ((cur)) {
-        prev = cur;
-        if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
-            if (dict->valfree) { dict->valfree(cur->data); }
-            cur->data = val;
-            goto cleanup_dsdict_put;
-        }
-        cur = cur->next;
-    }
+    migrate_step(dict);
+    return (dict->oldvals != NULL);
+}
 
-    // If we made it this far, we need to add a new node at cur
-    prev->next = malloc(sizeof(struct bucket));
-    cur = prev->next;
+void dsdict_shrink_to_fit(DSDict *dict) {
+    if (!dict) { return; }
 
-    // Actually perform the titular "put"
-dsdict_put_op:
-    if (!cur) { return; }
+    dict->mincap = DSDICT_MIN_CAP;
+    size_t newcap = dict_cap_for(dict->cnt, dict->load);
+    if ((newcap > 0) && (newcap < dict->cap)) {
+        dict_set_cap(dict, newcap, true);
+    }
+}
 
-    cur->hash = hash;
-    cur->key = key;
-    cur->data = val;
-    cur->next = NULL;
-    dict->cnt++;
+bool dsdict_stats(const DSDict *dict, DSDictStats *out) {
+    if ((!dict) || (!out)) { return false; }
 
-    // Clean up and decide if we need to resize no
-cleanup_dsdict_put: {
-        double load = ((double)dict->cnt / dict->cap);
-        if (load >= DSDICT_DEFAULT_LOAD) {
-            dsdict_resize(dict, dict->cap * DSDICT_DEFAULT_CAPACITY_FACTOR);
-        }
+    memset(out, 0, sizeof(DSDictStats));
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            chained_stats(dict, out);
+            break;
+        case DICT_OPEN_ADDRESSING:
+            swiss_stats(&dict->table, out);
+            break;
+        case DICT_ORDERED:
+            ordered_stats(&dict->ordered, out);
+            break;
+        case DICT_CUCKOO:
+            cuckoo_stats(&dict->cuckoo, out);
+            break;
     }
-    return;
+
+    out->count = dict->cnt;
+    out->cap = dict->cap;
+    out->resizes = dict->resizes;
+    out->resize_nanos = dict->resize_nanos;
+    return true;
+}
+
+void dsdict_foreach(DSDict *dict, dsdict_foreach_fn func) {
+    if ((!dict) || (!func)) { return; }
+    dsdict_priv_foreach(dict, foreach_visit, &func);
+}
+
+void dsdict_put(DSDict *dict, void *key, void *val) {
+    if ((!dict) || (!key)) { return; }
+    dsdict_put_hashed(dict, key, dict_hash(dict, key), val);
 }
 
 void *dsdict_get(const DSDict *dict, void *key) {
     if ((!dict) || (!key)) { return NULL; }
+    return dsdict_get_hashed(dict, key, dict_hash(dict, key));
+}
+
+void *dsdict_del(DSDict *dict, void *key) {
+    if ((!dict) || (!key)) { return NULL; }
+    return dsdict_del_hashed(dict, key, dict_hash(dict, key));
+}
+
+uint64_t dsdict_hash_of(const DSDict *dict, void *key) {
+    if ((!dict) || (!key)) { return 0; }
+    return dict_hash(dict, key);
+}
 
-    unsigned int hash = dict->hash(key);
-    size_t place = compute_index(hash, dict->cap);
+void dsdict_put_hashed(DSDict *dict, void *key, uint64_t hash, void *val) {
+    if ((!dict) || (!key)) { return; }
 
-    struct bucket *cur = dict->vals[place];
-    if (!cur) { return NULL; }
-    if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
-        return cur->data;
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            chained_put(dict, hash, key, val);
+            return;
+        case DICT_OPEN_ADDRESSING:
+            swiss_put(dict, hash, key, val);
+            return;
+        case DICT_ORDERED:
+            ordered_put(dict, hash, key, val);
+            return;
+        case DICT_CUCKOO:
+            cuckoo_put(dict, hash, key, val);
+            return;
     }
+}
 
-    cur = cur->next;
-    while ((cur)) {
-        if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
-            return cur->data;
-        }
-        cur = cur->next;
+void *dsdict_get_hashed(const DSDict *dict, void *key, uint64_t hash) {
+    if ((!dict) || (!key)) { return NULL; }
+
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            return chained_get(dict, hash, key);
+        case DICT_OPEN_ADDRESSING:
+            return swiss_get(dict, hash, key);
+        case DICT_ORDERED:
+            return ordered_get(dict, hash, key);
+        case DICT_CUCKOO:
+            return cuckoo_get(dict, hash, key);
     }
 
     return NULL;
 }
 
-void *dsdict_del(DSDict *dict, void *key) {
+void *dsdict_del_hashed(DSDict *dict, void *key, uint64_t hash) {
     if ((!dict) || (!key)) { return NULL; }
 
-    unsigned int hash = dict->hash(key);
-    size_t place = compute_index(hash, dict->cap);
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            return chained_del(dict, hash, key);
+        case DICT_OPEN_ADDRESSING:
+            return swiss_del(dict, hash, key);
+        case DICT_ORDERED:
+            return ordered_del(dict, hash, key);
+        case DICT_CUCKOO:
+            return cuckoo_del(dict, hash, key);
+    }
 
-    struct bucket *cur = dict->vals[place];
-    if (!cur) { return NULL; }
-    if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
-        void *cache = cur->data;
-        dict->vals[place] = cur->next;
-        free(cur);
-        dict->cnt--;
-        return cache;
+    return NULL;
+}
+
+void **dsdict_get_or_insert(DSDict *dict, void *key, bool *inserted) {
+    bool added = false;
+    void **val = NULL;
+    if ((dict) && (key)) {
+        val = dict_entry(dict, dict_hash(dict, key), key, &added);
     }
 
-    cur = cur->next;
-    while ((cur)) {
-        if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
-            void *cache = cur->data;
-            dict->vals[place] = cur->next;
-            free(cur);
-            dict->cnt--;
-            return cache;
+    if (inserted) { *inserted = added; }
+    return val;
+}
+
+bool dsdict_update(DSDict *dict, void *key, dsdict_update_fn func, void *ctx) {
+    if ((!dict) || (!key) || (!func)) { return false; }
+    return dsdict_priv_update(dict, key, dict_hash(dict, key), func, ctx);
+}
+
+size_t dsdict_get_many(const DSDict *dict, void **keys, size_t n, void **vals) {
+    if ((!dict) || (!keys) || (!vals)) { return 0; }
+
+    uint64_t hashes[DSDICT_BATCH_SIZE];
+    size_t found = 0;
+    for (size_t base = 0; base < n; base += DSDICT_BATCH_SIZE) {
+        size_t cnt = ((n - base) < DSDICT_BATCH_SIZE) ? (n - base) : DSDICT_BATCH_SIZE;
+        void **batch = &keys[base];
+
+        // Hash every key first and prefetch the slot each one maps to,
+        // so the cache misses for the whole batch are in flight at once
+        for (size_t i = 0; i < cnt; i++) {
+            if (!batch[i]) { continue; }
+            hashes[i] = dict_hash(dict, batch[i]);
+            dict_prefetch(dict, hashes[i]);
+        }
+
+        // Chained dictionaries take a second miss on the first bucket
+        if (dict->engine == DICT_CHAINED) {
+            for (size_t i = 0; i < cnt; i++) {
+                if (!batch[i]) { continue; }
+                chained_prefetch_chain(dict, hashes[i]);
+            }
+        }
+
+        for (size_t i = 0; i < cnt; i++) {
+            vals[base + i] = NULL;
+            if (!batch[i]) { continue; }
+            if (dict_lookup(dict, hashes[i], batch[i], &vals[base + i])) {
+                found++;
+            }
         }
-        cur = cur->next;
     }
 
-    return NULL;
+    return found;
+}
+
+void dsdict_put_many(DSDict *dict, void **keys, void **vals, size_t n) {
+    if ((!dict) || (!keys) || (!vals)) { return; }
+
+    uint64_t hashes[DSDICT_BATCH_SIZE];
+    for (size_t base = 0; base < n; base += DSDICT_BATCH_SIZE) {
+        size_t cnt = ((n - base) < DSDICT_BATCH_SIZE) ? (n - base) : DSDICT_BATCH_SIZE;
+        void **batch = &keys[base];
+
+        // Growing up front keeps the prefetched slots valid for the batch
+        if (dict->engine == DICT_CHAINED) {
+            chained_grow_for(dict, cnt);
+        }
+
+        for (size_t i = 0; i < cnt; i++) {
+            if (!batch[i]) { continue; }
+            hashes[i] = dict_hash(dict, batch[i]);
+            dict_prefetch(dict, hashes[i]);
+        }
+
+        for (size_t i = 0; i < cnt; i++) {
+            if (!batch[i]) { continue; }
+            switch (dict->engine) {
+                case DICT_CHAINED:
+                    chained_put(dict, hashes[i], batch[i], vals[base + i]);
+                    break;
+                case DICT_OPEN_ADDRESSING:
+                    swiss_put(dict, hashes[i], batch[i], vals[base + i]);
+                    break;
+                case DICT_ORDERED:
+                    ordered_put(dict, hashes[i], batch[i], vals[base + i]);
+                    break;
+                case DICT_CUCKOO:
+                    cuckoo_put(dict, hashes[i], batch[i], vals[base + i]);
+                    break;
+            }
+        }
+    }
 }
 
 DSIter* dsdict_iter(DSDict *dict) {
     if (!dict) { return NULL; }
 
-    DSIter *iter = dsiter_priv_new(ITER_DICT, dict);
+    DSIter *iter = dsiter_priv_new(ITER_DICT, dict, &dict->alloc);
     if (!iter) {
         return NULL;
     }
 
+    // Only engines which move elements the iterator may still visit keep
+    // a count of live iterators; other iterators never touch the dict again
+    if (dict_pins_iters(dict)) {
+        dict->iters++;
+        iter->pinned = true;
+    }
     return iter;
 }
 
@@ -243,178 +473,1325 @@ DSIter* dsdict_iter(DSDict *dict) {
  * PRIVATE FUNCTIONS
  */
 
-// Resize a DSDict upwards
-static bool dsdict_resize(DSDict *dict, size_t newcap) {
+// Visit every key/value pair in a dictionary of any engine without
+// modifying the dictionary, so it is safe to call from concurrent readers.
+void dsdict_priv_foreach(const DSDict *dict, dsdict_visit_fn func, void *ctx) {
     assert(dict);
+    assert(func);
 
-    if ((newcap < 1) || (dict->cap >= newcap)) {
-        return false;
+    if (dict->engine == DICT_OPEN_ADDRESSING) {
+        const struct swiss *table = &dict->table;
+        for (size_t i = swiss_next(table, 0); i < table->cap; i = swiss_next(table, i + 1)) {
+            func(table->slots[i].key, table->slots[i].data, ctx);
+        }
+        return;
     }
 
-    // Make a new bucket and cache the old values so we can transfer them
-    struct bucket **cache = dict->vals;
-    dict->vals = calloc(newcap, sizeof(struct bucket));
-    if (!dict->vals) {
-        dict->vals = cache;
-        return false;
+    if (dict->engine == DICT_ORDERED) {
+        const struct ordered *table = &dict->ordered;
+        for (size_t i = ordered_next(table, 0); i < table->len; i = ordered_next(table, i + 1)) {
+            func(table->entries[i].key, table->entries[i].data, ctx);
+        }
+        return;
     }
 
-    // Transfer all of the old values into the new buckets
-    size_t oldcap = dict->cap;
-    if (!transfer_vals(cache, oldcap, dict->vals, newcap, dict->hash)) {
-        free(dict->vals);
-        dict->vals = cache;
-        return false;
+    if (dict->engine == DICT_CUCKOO) {
+        const struct cuckoo *table = &dict->cuckoo;
+        size_t end = cuckoo_end(table);
+        for (size_t i = cuckoo_next(table, 0); i < end; i = cuckoo_next(table, i + 1)) {
+            const struct cuckoo_slot *slot = cuckoo_at(table, i);
+            func(slot->key, slot->data, ctx);
+        }
+        return;
     }
-    dict->cap = newcap;
 
-    // Free the cached buckets, but do not free key/value pairs
-    free(cache);
+    for (size_t i = 0; i < dict->oldcap; i++) {
+        struct bucket *cur = dict->oldvals[i];
+        while ((cur)){
+            func(cur->key, cur->data, ctx);
+            cur = cur->next;
+        }
+    }
+
+    for (size_t i = 0; i < dict->cap; i++) {
+        struct bucket *cur = dict->vals[i];
+        while ((cur)){
+            func(cur->key, cur->data, ctx);
+            cur = cur->next;
+        }
+    }
+}
+
+// Replace the value for a key with the result of func using a hash the
+// caller has already computed, adding the key if it is not present.
+bool dsdict_priv_update(DSDict *dict, void *key, uint64_t hash, dsdict_update_fn func, void *ctx) {
+    assert(dict);
+    assert(key);
+    assert(func);
+
+    bool inserted;
+    void **val = dict_entry(dict, hash, key, &inserted);
+    if (!val) { return false; }
+
+    void *old = *val;
+    *val = func(old, ctx);
+    if ((!inserted) && (dict->valfree) && (old != *val)) {
+        dict->valfree(old);
+    }
     return true;
 }
 
-// Given a hash value and a capacity, compute the place of the element in the array.
-static inline size_t compute_index(uint32_t hash, size_t cap) {
-    double powerf = floor(log2((double)cap));
-    assert(powerf >= 0);
-    size_t power = (size_t)powerf;
-    size_t mod = (power <= 31) ? DSDICT_MOD_TABLE[power] : (size_t)cap;
-    return (hash % mod);
+// Adapt a public foreach callback to the private visitor interface.
+static void foreach_visit(const void *key, void *val, void *ctx) {
+    dsdict_foreach_fn *func = ctx;
+    (*func)(key, val);
 }
 
-// Transfer values from the old DSDict bucket cache to the new bucket
-static bool transfer_vals(struct bucket **old, size_t oldcap, struct bucket **new, size_t newcap, dsdict_hash_fn hashfn) {
-    assert(old);
-    assert(new);
-    assert(hashfn);
+// Create a new dictionary with the given initial capacity, which must be
+// a power of 2 which is at least DSDICT_MIN_CAP. Keys are hashed with
+// hash64 if it is given and hash otherwise.
+static DSDict *dict_new(dsdict_hash_fn hash, dsdict_hash64_fn hash64, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, int flags, size_t cap, const DSAllocator *alloc) {
+    if (((!hash) && (!hash64)) || (!cmpfn)) { return NULL; }
+    assert(cap >= DSDICT_MIN_CAP);
+    assert((cap & (cap - 1)) == 0);
 
-    // Iterate on every element of the old bucket
-    for (size_t i = 0; i < oldcap; i++) {
-        // Iterate on every hash table element in the old dictionary
-        struct bucket *curold = old[i];
-        while (curold) {
-            // Compute the new placement for the current element
-            size_t place = compute_index(curold->hash, newcap);
-
-            // Get reference to place and see if there is data there;
-            // if so, we need to traverse the linked list to get the last
-            // element and insert the hash table into that
-            struct bucket *curnew = new[place];
-            if (curnew) {
-                struct bucket *prev = curnew;
-                while ((curnew)) {
-                    prev = curnew;
-                    curnew = curnew->next;
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+
+    DSDict *dict = ds_alloc(&a, sizeof(DSDict));
+    if (!dict) {
+        return NULL;
+    }
+
+    dict->alloc = a;
+    if (flags & DSDICT_ORDERED) {
+        dict->engine = DICT_ORDERED;
+    } else if (flags & DSDICT_CUCKOO) {
+        dict->engine = DICT_CUCKOO;
+    } else if (flags & DSDICT_OPEN_ADDRESSING) {
+        dict->engine = DICT_OPEN_ADDRESSING;
+    } else {
+        dict->engine = DICT_CHAINED;
+    }
+    dict->vals = NULL;
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            dict->vals = ds_calloc(&dict->alloc, cap, sizeof(struct bucket *));
+            if (!dict->vals) {
+                ds_free(&a, dict, sizeof(DSDict));
+                return NULL;
+            }
+            slab_init(&dict->buckets, sizeof(struct bucket), &dict->alloc);
+            break;
+        case DICT_OPEN_ADDRESSING:
+            if (!swiss_init(&dict->table, cap, &dict->alloc)) {
+                ds_free(&a, dict, sizeof(DSDict));
+                return NULL;
+            }
+            break;
+        case DICT_ORDERED:
+            if (!ordered_init(&dict->ordered, cap, ordered_usable(cap, DSDICT_DEFAULT_LOAD), &dict->alloc)) {
+                ds_free(&a, dict, sizeof(DSDict));
+                return NULL;
+            }
+            break;
+        case DICT_CUCKOO:
+            if (!cuckoo_init(&dict->cuckoo, cap, &dict->alloc)) {
+                ds_free(&a, dict, sizeof(DSDict));
+                return NULL;
+            }
+            break;
+    }
+
+    dict->cnt = 0;
+    dict->cap = cap;
+    dict->power = compute_power(cap);
+    dict->prime = (flags & DSDICT_PRIME_MODULI) ? true : false;
+    dict->incremental = (flags & DSDICT_INCREMENTAL_RESIZE) ? true : false;
+    dict->oldvals = NULL;
+    dict->oldcap = 0;
+    dict->oldpower = 0;
+    dict->migrated = 0;
+    dict->iters = 0;
+    dict->mincap = cap;
+    dict->resizes = 0;
+    dict->resize_nanos = 0;
+    dict->load = DSDICT_DEFAULT_LOAD;
+    dict->hash = (hash64) ? NULL : hash;
+    dict->hash64 = hash64;
+    dict->keyfree = keyfree;
+    dict->valfree = valfree;
+    dict->cmp = cmpfn;
+    return dict;
+}
+
+// Return the link pointing to the bucket holding key in a chained
+// dictionary (either the slot in the bucket array or the next pointer
+// of the previous bucket in the chain), or NULL if it is not present.
+static struct bucket **chained_find(const DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    // Keys in old buckets which have not been migrated yet are still
+    // in the old table; everything else is in the current table
+    if (dict->oldvals) {
+        size_t oldplace = compute_index(hash, dict->oldpower, dict->prime);
+        if (oldplace >= dict->migrated) {
+            struct bucket **link = &dict->oldvals[oldplace];
+            while ((*link)) {
+                if (((*link)->hash == hash) && (dict->cmp((*link)->key, key) == 0)) {
+                    return link;
                 }
-                prev->next = curold;
-                curold = prev->next->next;
-                prev->next->next = NULL;
-            } else {
-                // Transfer the old element to the new slot
-                new[place] = curold;
-                curold = new[place]->next;
-                new[place]->next = NULL;
+                link = &(*link)->next;
             }
         }
+    }
 
-        old[i] = NULL;
+    size_t place = compute_index(hash, dict->power, dict->prime);
+    struct bucket **link = &dict->vals[place];
+    while ((*link)) {
+        if (((*link)->hash == hash) && (dict->cmp((*link)->key, key) == 0)) {
+            return link;
+        }
+        link = &(*link)->next;
     }
 
-    return true;
+    return NULL;
 }
 
-// Free all of the value pointers in a DSDict if a free function was given.
-static void dsdict_free(DSDict *dict) {
+// Put a key/value pair into a chained dictionary.
+static void chained_put(DSDict *dict, uint64_t hash, void *key, void *val) {
     assert(dict);
-    bool free_keys = (dict->keyfree) ? true : false;
-    bool free_vals = (dict->valfree) ? true : false;
+    migrate_step(dict);
 
-    for (size_t i = 0; i < dict->cap; i++) {
-        if (!dict->vals[i]) { continue; }
-        if (free_keys) {
-            dict->keyfree(dict->vals[i]->key);
-        }
-        if (free_vals) {
-            dict->valfree(dict->vals[i]->data);
-        }
+    // If the key already exists, we can overwrite it and we're done
+    struct bucket **link = chained_find(dict, hash, key);
+    if (link) {
+        if (dict->valfree) { dict->valfree((*link)->data); }
+        (*link)->data = val;
+        return;
+    }
 
-        struct bucket *cur = NULL;
-        struct bucket *next = dict->vals[i]->next;
-        while ((next)){
-            if (free_keys) {
-                dict->keyfree(next->key);
-            }
-            if (free_vals) {
-                dict->valfree(next->data);
-            }
-            cur = next;
-            next = next->next;
-            free(cur);
+    chained_insert(dict, hash, key, val);
+}
+
+// Add a key which is known not to be in a chained dictionary at the head
+// of its chain, resizing afterwards if needed. Buckets never move during
+// a resize, so the returned bucket remains valid. Returns NULL if no
+// bucket could be allocated.
+static struct bucket *chained_insert(DSDict *dict, uint64_t hash, void *key, void *val) {
+    assert(dict);
+
+    struct bucket *cur = slab_alloc(&dict->buckets);
+    if (!cur) { return NULL; }
+
+    size_t place = compute_index(hash, dict->power, dict->prime);
+    cur->hash = hash;
+    cur->key = key;
+    cur->data = val;
+    cur->next = dict->vals[place];
+    dict->vals[place] = cur;
+    dict->cnt++;
+
+    // Decide if we need to resize now
+    double load = ((double)dict->cnt / dict->cap);
+    if (load >= dict->load) {
+        size_t newcap = dict->cap * DSDICT_DEFAULT_CAPACITY_FACTOR;
+        if (dict->incremental) {
+            begin_migration(dict, newcap);
+        } else {
+            dsdict_resize(dict, newcap);
         }
+    }
+
+    return cur;
+}
+
+// Get the value for a key from a chained dictionary.
+static void *chained_get(const DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct bucket **link = chained_find(dict, hash, key);
+    return (link) ? (*link)->data : NULL;
+}
 
-        free(dict->vals[i]);
-        dict->vals[i] = NULL;
+// Remove a key from a chained dictionary and return its value.
+static void *chained_del(DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+    migrate_step(dict);
+
+    struct bucket **link = chained_find(dict, hash, key);
+    if (!link) { return NULL; }
+
+    struct bucket *cur = *link;
+    void *cache = cur->data;
+    *link = cur->next;
+    slab_free(&dict->buckets, cur);
+    dict->cnt--;
+    dict_maybe_shrink(dict);
+    return cache;
+}
+
+// Prefetch the bucket array slot(s) a chained lookup for hash will read.
+static void chained_prefetch(const DSDict *dict, uint64_t hash) {
+    assert(dict);
+
+    if (dict->oldvals) {
+        DICT_PREFETCH(&dict->oldvals[compute_index(hash, dict->oldpower, dict->prime)]);
     }
+    DICT_PREFETCH(&dict->vals[compute_index(hash, dict->power, dict->prime)]);
 }
 
-// Iterate on the next dictionary entry.
-bool dsiter_dsdict_next(DSIter *iter, bool advance) {
-    assert(iter);
-    assert(iter->type == ITER_DICT);
+// Prefetch the first bucket in the chain(s) a chained lookup for hash
+// will read. The bucket array slot should already have been prefetched.
+static void chained_prefetch_chain(const DSDict *dict, uint64_t hash) {
+    assert(dict);
 
-    // If we already know there are no more elements, quit
-    if (DSITER_IS_FINISHED(iter)) {
-        return false;
+    if (dict->oldvals) {
+        const struct bucket *old = dict->oldvals[compute_index(hash, dict->oldpower, dict->prime)];
+        if (old) { DICT_PREFETCH(old); }
     }
+    const struct bucket *cur = dict->vals[compute_index(hash, dict->power, dict->prime)];
+    if (cur) { DICT_PREFETCH(cur); }
+}
 
-    // Get the initial node pointer
-    if (DSITER_IS_NEW_ITER(iter)) {
-        DSDict *dict = iter->target.dict;
+// Grow a chained dictionary ahead of time so that adding extra more
+// elements will not trigger a resize.
+static void chained_grow_for(DSDict *dict, size_t extra) {
+    assert(dict);
 
-        // We do not need to traverse any linked lists
-        // since this is explicitly the first node
-        for (size_t i = 0; i < dict->cap; i++) {
-            if (dict->vals[i]) {
-                if (advance) {
-                    iter->node.dict = dict->vals[i];
-                    iter->cur = i;
-                    iter->stat = DSITER_NORMAL;
-                }
-                return true;
-            }
-        }
+    // Incremental dictionaries spread their resizes out on purpose
+    if (dict->incremental) { return; }
 
-        // No elements found in this dictionary
-        if (advance) {
-            iter->stat = DSITER_NO_MORE_ELEMENTS;
-        }
-        return false;
+    size_t newcap = dict_cap_for(dict->cnt + extra, dict->load);
+    if (newcap > dict->cap) {
+        dsdict_resize(dict, newcap);
     }
+}
 
-    // If there is a next node, set our next pointer to that
-    if (iter->node.dict->next) {
-        if (advance) {
-            iter->node.dict = iter->node.dict->next;
-        }
-        return true;
-    }
+// Find the value for a key in a dictionary of any engine without doing
+// any migration work. Returns false if the key is not present.
+static bool dict_lookup(const DSDict *dict, uint64_t hash, void *key, void **val) {
+    assert(dict);
+    assert(val);
 
-    // Otherwise, traverse through the array to find the next pointer
-    DSDict *dict = iter->target.dict;
-    for (size_t i = (iter->cur + 1); i < dict->cap; i++) {
-        if (dict->vals[i]) {
-            if (advance) {
-                iter->cur = i;
-                iter->node.dict = dict->vals[i];
-            }
+    switch (dict->engine) {
+        case DICT_CHAINED: {
+            struct bucket **link = chained_find(dict, hash, key);
+            if (!link) { return false; }
+            *val = (*link)->data;
+            return true;
+        }
+        case DICT_OPEN_ADDRESSING: {
+            struct swiss_slot *slot = swiss_find(&dict->table, hash, key, dict->cmp);
+            if (!slot) { return false; }
+            *val = slot->data;
+            return true;
+        }
+        case DICT_ORDERED: {
+            struct ordered_entry *entry = ordered_find(&dict->ordered, hash, key, dict->cmp);
+            if (!entry) { return false; }
+            *val = entry->data;
+            return true;
+        }
+        case DICT_CUCKOO: {
+            struct cuckoo_slot *slot = cuckoo_find(&dict->cuckoo, hash, key, dict->cmp);
+            if (!slot) { return false; }
+            *val = slot->data;
             return true;
         }
     }
 
-    // If we get here, there is no more data in the dict
-    if (advance) {
-        iter->stat = DSITER_NO_MORE_ELEMENTS;
-        iter->node.dict = NULL;
-    }
     return false;
 }
+
+// Prefetch the first memory a lookup for hash will read in a dictionary
+// of any engine.
+static void dict_prefetch(const DSDict *dict, uint64_t hash) {
+    assert(dict);
+
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            chained_prefetch(dict, hash);
+            return;
+        case DICT_OPEN_ADDRESSING:
+            swiss_prefetch(&dict->table, hash);
+            return;
+        case DICT_ORDERED:
+            ordered_prefetch(&dict->ordered, hash);
+            return;
+        case DICT_CUCKOO:
+            cuckoo_prefetch(&dict->cuckoo, hash);
+            return;
+    }
+}
+
+// Return a pointer to the value for a key in a dictionary of any
+// engine, adding the key with a NULL value if it is not present. Only a
+// single probe is made for the key. Returns NULL if the key could not be
+// added.
+static void **dict_entry(DSDict *dict, uint64_t hash, void *key, bool *inserted) {
+    assert(dict);
+    assert(inserted);
+
+    *inserted = false;
+    switch (dict->engine) {
+        case DICT_CHAINED: {
+            migrate_step(dict);
+            struct bucket **link = chained_find(dict, hash, key);
+            if (link) { return &(*link)->data; }
+
+            struct bucket *cur = chained_insert(dict, hash, key, NULL);
+            if (!cur) { return NULL; }
+            *inserted = true;
+            return &cur->data;
+        }
+        case DICT_OPEN_ADDRESSING: {
+            size_t free_at;
+            struct swiss_slot *slot = swiss_probe(&dict->table, hash, key, dict->cmp, &free_at);
+            if (slot) { return &slot->data; }
+
+            slot = swiss_insert(dict, hash, free_at);
+            if (!slot) { return NULL; }
+            slot->key = key;
+            slot->data = NULL;
+            *inserted = true;
+            return &slot->data;
+        }
+        case DICT_ORDERED: {
+            size_t free_at;
+            struct ordered_entry *entry = ordered_probe(&dict->ordered, hash, key, dict->cmp, &free_at);
+            if (entry) { return &entry->data; }
+
+            entry = ordered_insert(dict, hash, free_at);
+            if (!entry) { return NULL; }
+            entry->key = key;
+            *inserted = true;
+            return &entry->data;
+        }
+        case DICT_CUCKOO: {
+            struct cuckoo_slot *slot = cuckoo_find(&dict->cuckoo, hash, key, dict->cmp);
+            if (slot) { return &slot->data; }
+
+            slot = cuckoo_insert(dict, hash, key);
+            if (!slot) { return NULL; }
+            *inserted = true;
+            return &slot->data;
+        }
+    }
+
+    return NULL;
+}
+
+// Put a key/value pair into an open addressing dictionary.
+static void swiss_put(DSDict *dict, uint64_t hash, void *key, void *val) {
+    assert(dict);
+
+    // Overwrite the value in place if the key already exists
+    size_t free_at;
+    struct swiss_slot *slot = swiss_probe(&dict->table, hash, key, dict->cmp, &free_at);
+    if (slot) {
+        if (dict->valfree) { dict->valfree(slot->data); }
+        slot->data = val;
+        return;
+    }
+
+    slot = swiss_insert(dict, hash, free_at);
+    if (!slot) { return; }
+    slot->key = key;
+    slot->data = val;
+}
+
+// Claim a slot for a key which is known not to be in an open addressing
+// dictionary, given the free slot found by the probe which failed to find
+// it. Returns NULL if the table needed to grow and could not.
+static struct swiss_slot *swiss_insert(DSDict *dict, uint64_t hash, size_t free_at) {
+    assert(dict);
+
+    // Resize before claiming a slot so there is always an empty
+    // control byte to terminate probe sequences
+    const uint8_t *ctrl = dict->table.ctrl;
+    if (!swiss_make_room(dict)) { return NULL; }
+
+    // A rehash always allocates fresh storage before releasing the old,
+    // so the probed slot is only still valid if the storage is unchanged
+    struct swiss_slot *slot;
+    if ((dict->table.ctrl == ctrl) && (free_at < dict->table.cap)) {
+        slot = swiss_claim_at(&dict->table, hash, free_at);
+    } else {
+        slot = swiss_claim(&dict->table, hash);
+    }
+
+    dict->cnt++;
+    return slot;
+}
+
+// Get the value for a key from an open addressing dictionary.
+static void *swiss_get(const DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct swiss_slot *slot = swiss_find(&dict->table, hash, key, dict->cmp);
+    return (slot) ? slot->data : NULL;
+}
+
+// Remove a key from an open addressing dictionary and return its value.
+static void *swiss_del(DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct swiss_slot *slot = swiss_find(&dict->table, hash, key, dict->cmp);
+    if (!slot) { return NULL; }
+
+    void *cache = slot->data;
+    swiss_erase(&dict->table, slot);
+    dict->cnt--;
+    dict_maybe_shrink(dict);
+    return cache;
+}
+
+// Make sure an open addressing dictionary can accept one more element
+// without exceeding its load factor, counting tombstones as occupied.
+static bool swiss_make_room(DSDict *dict) {
+    assert(dict);
+
+    struct swiss *table = &dict->table;
+    double load = ((double)(table->cnt + table->deleted + 1) / table->cap);
+    if (load < dict->load) {
+        return true;
+    }
+
+    // Mostly tombstones can be cleared by rehashing at the same size
+    double live = ((double)(table->cnt + 1) / table->cap);
+    size_t newcap = (live < (dict->load / 2)) ? table->cap : table->cap * DSDICT_DEFAULT_CAPACITY_FACTOR;
+    uint64_t start = dict_now();
+    if (!swiss_rehash(table, newcap)) {
+        return false;
+    }
+    resize_done(dict, start);
+
+    dict->cap = table->cap;
+    return true;
+}
+
+// Put a key/value pair into an insertion ordered dictionary. Overwriting
+// the value of an existing key does not change its position.
+static void ordered_put(DSDict *dict, uint64_t hash, void *key, void *val) {
+    assert(dict);
+
+    size_t free_at;
+    struct ordered_entry *entry = ordered_probe(&dict->ordered, hash, key, dict->cmp, &free_at);
+    if (entry) {
+        if (dict->valfree) { dict->valfree(entry->data); }
+        entry->data = val;
+        return;
+    }
+
+    entry = ordered_insert(dict, hash, free_at);
+    if (!entry) { return; }
+    entry->key = key;
+    entry->data = val;
+}
+
+// Append an entry for a key which is known not to be in an insertion
+// ordered dictionary, given the free index slot found by the probe which
+// failed to find it. Returns NULL if the table needed to grow and could not.
+static struct ordered_entry *ordered_insert(DSDict *dict, uint64_t hash, size_t free_at) {
+    assert(dict);
+
+    // A rehash always allocates a fresh index, so the probed slot is
+    // only still valid if the index is unchanged
+    const void *index = dict->ordered.index;
+    if (!ordered_make_room(dict)) { return NULL; }
+    if (dict->ordered.index != index) {
+        free_at = dict->ordered.cap;
+    }
+
+    struct ordered_entry *entry = ordered_append(&dict->ordered, hash, free_at);
+    dict->cnt++;
+    return entry;
+}
+
+// Get the value for a key from an insertion ordered dictionary.
+static void *ordered_get(const DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct ordered_entry *entry = ordered_find(&dict->ordered, hash, key, dict->cmp);
+    return (entry) ? entry->data : NULL;
+}
+
+// Remove a key from an insertion ordered dictionary and return its value.
+static void *ordered_del(DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct ordered_entry *entry = ordered_find(&dict->ordered, hash, key, dict->cmp);
+    if (!entry) { return NULL; }
+
+    void *cache = entry->data;
+    ordered_erase(&dict->ordered, entry);
+    dict->cnt--;
+    dict_maybe_shrink(dict);
+    return cache;
+}
+
+// Make sure an insertion ordered dictionary has room to append one more
+// entry, counting holes left by deletions as used.
+static bool ordered_make_room(DSDict *dict) {
+    assert(dict);
+
+    struct ordered *table = &dict->ordered;
+    if (table->len < table->usable) {
+        return true;
+    }
+
+    // Mostly holes can be cleared by compacting at the same size (unless
+    // the load factor has been lowered since the table was built)
+    size_t newcap = dict_cap_for(table->cnt + 1, dict->load);
+    if (newcap == 0) { return false; }
+    if (newcap < table->cap) {
+        newcap = table->cap;
+    }
+    if ((table->cnt + 1) >= (ordered_usable(newcap, dict->load) / 2)) {
+        newcap *= DSDICT_DEFAULT_CAPACITY_FACTOR;
+    }
+    uint64_t start = dict_now();
+    if (!ordered_rehash(table, newcap, ordered_usable(newcap, dict->load))) {
+        return false;
+    }
+    resize_done(dict, start);
+
+    dict->cap = table->cap;
+    return true;
+}
+
+// Return the number of entries an insertion ordered table of the given
+// capacity may hold while staying below the load factor.
+static size_t ordered_usable(size_t cap, double load) {
+    size_t usable = (size_t)((double)cap * load);
+    while ((usable > 0) && (((double)usable / cap) >= load)) {
+        usable--;
+    }
+    return usable;
+}
+
+// Put a key/value pair into a cuckoo hashing dictionary.
+static void cuckoo_put(DSDict *dict, uint64_t hash, void *key, void *val) {
+    assert(dict);
+
+    struct cuckoo_slot *slot = cuckoo_find(&dict->cuckoo, hash, key, dict->cmp);
+    if (slot) {
+        if (dict->valfree) { dict->valfree(slot->data); }
+        slot->data = val;
+        return;
+    }
+
+    slot = cuckoo_insert(dict, hash, key);
+    if (!slot) { return; }
+    slot->data = val;
+}
+
+// Add a key which is known not to be in a cuckoo hashing dictionary with
+// a NULL value. Returns NULL if memory could not be allocated.
+static struct cuckoo_slot *cuckoo_insert(DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    if (!cuckoo_make_room(dict)) { return NULL; }
+    struct cuckoo *table = &dict->cuckoo;
+    struct cuckoo_slot *slot = cuckoo_add(table, hash, key, NULL);
+
+    // A full stash means the buckets are too crowded for evictions to
+    // find room, so the table is grown early; when the table is mostly
+    // empty the elements are placed again with new bucket choices. Keys
+    // which share a single hash cannot be separated either way, so once
+    // a rehash has left the stash over its usual size the key is chained
+    // in the stash rather than rehashing the table on every put.
+    if ((!slot) && (table->stashlen <= CUCKOO_STASH_SIZE)) {
+        bool crowded = (((double)table->cnt / table->cap) >= (dict->load / 2));
+        size_t newcap = (crowded) ? (table->cap * DSDICT_DEFAULT_CAPACITY_FACTOR) : table->cap;
+        uint64_t start = dict_now();
+        if (!cuckoo_rehash(table, newcap)) { return NULL; }
+        resize_done(dict, start);
+        dict->cap = table->cap;
+
+        slot = cuckoo_add(table, hash, key, NULL);
+    }
+    if (!slot) {
+        slot = cuckoo_spill(table, hash, key, NULL);
+        if (!slot) { return NULL; }
+    }
+
+    dict->cnt++;
+    return slot;
+}
+
+// Get the value for a key from a cuckoo hashing dictionary.
+static void *cuckoo_get(const DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct cuckoo_slot *slot = cuckoo_find(&dict->cuckoo, hash, key, dict->cmp);
+    return (slot) ? slot->data : NULL;
+}
+
+// Remove a key from a cuckoo hashing dictionary and return its value.
+static void *cuckoo_del(DSDict *dict, uint64_t hash, void *key) {
+    assert(dict);
+
+    struct cuckoo_slot *slot = cuckoo_find(&dict->cuckoo, hash, key, dict->cmp);
+    if (!slot) { return NULL; }
+
+    void *cache = slot->data;
+    cuckoo_erase(&dict->cuckoo, slot);
+    dict->cnt--;
+
+    // Iterators hold positions in the stash
+    if ((dict->iters == 0) && (dict->cuckoo.stashlen > 0)) {
+        cuckoo_unstash(&dict->cuckoo);
+    }
+    dict_maybe_shrink(dict);
+    return cache;
+}
+
+// Make sure a cuckoo hashing dictionary can accept one more element
+// without exceeding its load factor.
+static bool cuckoo_make_room(DSDict *dict) {
+    assert(dict);
+
+    struct cuckoo *table = &dict->cuckoo;
+    double load = ((double)(table->cnt + 1) / table->cap);
+    if (load < dict->load) {
+        return true;
+    }
+
+    uint64_t start = dict_now();
+    if (!cuckoo_rehash(table, table->cap * DSDICT_DEFAULT_CAPACITY_FACTOR)) {
+        return false;
+    }
+    resize_done(dict, start);
+
+    dict->cap = table->cap;
+    return true;
+}
+
+
+// Return the smallest power of 2 capacity (no smaller than DSDICT_MIN_CAP)
+// which holds n elements below the given load factor, or 0 if there is
+// no such capacity.
+static size_t dict_cap_for(size_t n, double load) {
+    size_t cap = DSDICT_MIN_CAP;
+    while (((double)n / cap) >= load) {
+        if (cap > (SIZE_MAX / DSDICT_DEFAULT_CAPACITY_FACTOR)) { return 0; }
+        cap *= DSDICT_DEFAULT_CAPACITY_FACTOR;
+    }
+    return cap;
+}
+
+// Move the elements of a dictionary of any engine into a table with
+// the given power of 2 capacity. Incremental dictionaries only begin
+// a migration into the new table, unless sync is given.
+static bool dict_set_cap(DSDict *dict, size_t newcap, bool sync) {
+    assert(dict);
+
+    if (newcap == dict->cap) { return true; }
+    uint64_t start = dict_now();
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            if ((dict->incremental) && (!sync)) {
+                return begin_migration(dict, newcap);
+            }
+            finish_migration(dict);
+            return dsdict_resize(dict, newcap);
+        case DICT_OPEN_ADDRESSING:
+            if (!swiss_rehash(&dict->table, newcap)) { return false; }
+            dict->cap = dict->table.cap;
+            resize_done(dict, start);
+            return true;
+        case DICT_ORDERED:
+            if (!ordered_rehash(&dict->ordered, newcap, ordered_usable(newcap, dict->load))) { return false; }
+            dict->cap = dict->ordered.cap;
+            resize_done(dict, start);
+            return true;
+        case DICT_CUCKOO:
+            if (!cuckoo_rehash(&dict->cuckoo, newcap)) { return false; }
+            dict->cap = dict->cuckoo.cap;
+            resize_done(dict, start);
+            return true;
+    }
+
+    return false;
+}
+
+// Return true if iterators over this dictionary must pause work which
+// moves elements they may still visit. Incremental migrations move chains
+// between tables, the cuckoo stash is folded back into the table and both
+// ordered and cuckoo dictionaries allow deleting during iteration, which
+// must not trigger a compacting shrink.
+static bool dict_pins_iters(const DSDict *dict) {
+    assert(dict);
+
+    switch (dict->engine) {
+        case DICT_CHAINED:
+            return dict->incremental;
+        case DICT_OPEN_ADDRESSING:
+            return false;
+        case DICT_ORDERED:
+        case DICT_CUCKOO:
+            return true;
+    }
+
+    return false;
+}
+
+// Shrink a dictionary after a deletion once it falls well below its load
+// factor. Shrinking to half the load factor, rather than the load factor
+// itself, leaves room so puts and deletes around the threshold do not
+// alternately grow and shrink the table.
+static void dict_maybe_shrink(DSDict *dict) {
+    assert(dict);
+
+    // Iterators hold positions in the current table
+    if ((dict->iters > 0) || (dict->cap <= dict->mincap)) { return; }
+    if (((double)dict->cnt / dict->cap) >= (dict->load * DSDICT_SHRINK_FRACTION)) { return; }
+
+    size_t newcap = dict_cap_for(dict->cnt, dict->load / 2);
+    if (newcap < dict->mincap) {
+        newcap = dict->mincap;
+    }
+    if ((newcap > 0) && (newcap < dict->cap)) {
+        dict_set_cap(dict, newcap, false);
+    }
+}
+
+// Resize the bucket array of a chained DSDict, which must not be in the
+// middle of an incremental migration.
+static bool dsdict_resize(DSDict *dict, size_t newcap) {
+    assert(dict);
+    assert(!dict->oldvals);
+
+    if ((newcap < 1) || (dict->cap == newcap)) {
+        return false;
+    }
+    assert((newcap & (newcap - 1)) == 0);
+    uint64_t start = dict_now();
+
+    // Doubling a masked table only ever splits each chain in two, so
+    // it can be done in place without recomputing any indices
+    if ((!dict->prime) && (newcap == (dict->cap * 2))) {
+        if (!split_vals(dict)) { return false; }
+        resize_done(dict, start);
+        return true;
+    }
+
+    // Make a new bucket and cache the old values so we can transfer them
+    struct bucket **cache = dict->vals;
+    dict->vals = ds_calloc(&dict->alloc, newcap, sizeof(struct bucket *));
+    if (!dict->vals) {
+        dict->vals = cache;
+        return false;
+    }
+
+    // Transfer all of the old values into the new buckets
+    size_t newpower = compute_power(newcap);
+    transfer_vals(cache, dict->cap, dict->vals, newpower, dict->prime);
+
+    // Free the cached buckets, but do not free key/value pairs
+    ds_free(&dict->alloc, cache, dict->cap * sizeof(struct bucket *));
+    dict->cap = newcap;
+    dict->power = newpower;
+    resize_done(dict, start);
+    return true;
+}
+
+// Double the size of a masked DSDict by splitting every chain in place.
+static bool split_vals(DSDict *dict) {
+    assert(dict);
+    assert(!dict->prime);
+
+    size_t oldcap = dict->cap;
+    struct bucket **vals = ds_realloc(&dict->alloc, dict->vals,
+                                      oldcap * sizeof(struct bucket *),
+                                      (oldcap * 2) * sizeof(struct bucket *));
+    if (!vals) {
+        return false;
+    }
+
+    // Each element either stays in bucket i or moves to bucket i + oldcap
+    // depending on the single new bit of its mixed hash which is now
+    // included in the index; relative chain order is preserved
+    for (size_t i = 0; i < oldcap; i++) {
+        struct bucket *stay = NULL;
+        struct bucket *move = NULL;
+        struct bucket **staytail = &stay;
+        struct bucket **movetail = &move;
+
+        struct bucket *cur = vals[i];
+        while (cur) {
+            if ((size_t)dict_mix(cur->hash) & oldcap) {
+                *movetail = cur;
+                movetail = &cur->next;
+            } else {
+                *staytail = cur;
+                staytail = &cur->next;
+            }
+            cur = cur->next;
+        }
+
+        *staytail = NULL;
+        *movetail = NULL;
+        vals[i] = stay;
+        vals[i + oldcap] = move;
+    }
+
+    dict->vals = vals;
+    dict->cap = oldcap * 2;
+    dict->power++;
+    return true;
+}
+
+// Start an incremental migration of a chained DSDict into a new table.
+static bool begin_migration(DSDict *dict, size_t newcap) {
+    assert(dict);
+    assert((newcap & (newcap - 1)) == 0);
+
+    // A migration still in progress must be finished before starting
+    // another; this only happens if the dictionary doubled in size
+    // faster than the migration could keep up
+    finish_migration(dict);
+
+    uint64_t start = dict_now();
+    struct bucket **vals = ds_calloc(&dict->alloc, newcap, sizeof(struct bucket *));
+    if (!vals) {
+        return false;
+    }
+
+    dict->oldvals = dict->vals;
+    dict->oldcap = dict->cap;
+    dict->oldpower = dict->power;
+    dict->migrated = 0;
+    dict->vals = vals;
+    dict->cap = newcap;
+    dict->power = compute_power(newcap);
+    resize_done(dict, start);
+    return true;
+}
+
+// Migrate a bounded number of buckets from the old table of a DSDict
+// being incrementally resized into the new table.
+static void migrate_step(DSDict *dict) {
+    assert(dict);
+
+    if ((!dict->oldvals) || (dict->iters > 0)) {
+        return;
+    }
+
+    size_t moved = 0;
+    size_t empty = 0;
+    while ((dict->migrated < dict->oldcap) &&
+           (moved < DSDICT_MIGRATE_BUCKETS) &&
+           (empty < DSDICT_MIGRATE_EMPTY_VISITS)) {
+        if (dict->oldvals[dict->migrated]) {
+            migrate_bucket(dict, dict->migrated);
+            moved++;
+        } else {
+            empty++;
+        }
+        dict->migrated++;
+    }
+
+    if (dict->migrated >= dict->oldcap) {
+        finish_migration(dict);
+    }
+}
+
+// Move every element in one old bucket into the new table.
+static void migrate_bucket(DSDict *dict, size_t i) {
+    assert(dict);
+    assert(dict->oldvals);
+
+    struct bucket *cur = dict->oldvals[i];
+    while (cur) {
+        struct bucket *next = cur->next;
+        size_t place = compute_index(cur->hash, dict->power, dict->prime);
+        cur->next = dict->vals[place];
+        dict->vals[place] = cur;
+        cur = next;
+    }
+    dict->oldvals[i] = NULL;
+}
+
+// Synchronously complete any incremental migration in progress.
+static void finish_migration(DSDict *dict) {
+    assert(dict);
+
+    if (!dict->oldvals) {
+        return;
+    }
+
+    uint64_t start = dict_now();
+    for (size_t i = dict->migrated; i < dict->oldcap; i++) {
+        if (dict->oldvals[i]) {
+            migrate_bucket(dict, i);
+        }
+    }
+
+    ds_free(&dict->alloc, dict->oldvals, dict->oldcap * sizeof(struct bucket *));
+    dict->oldvals = NULL;
+    dict->oldcap = 0;
+    dict->oldpower = 0;
+    dict->migrated = 0;
+    dict->resize_nanos += dict_now() - start;
+}
+
+// Record the number of chained elements in every bucket and the size of
+// the bucket arrays and bucket chunks in a DSDictStats.
+static void chained_stats(const DSDict *dict, DSDictStats *stats) {
+    assert(dict);
+    assert(stats);
+
+    size_t total = 0;
+    for (int t = 0; t < 2; t++) {
+        struct bucket **vals = (t == 0) ? dict->vals : dict->oldvals;
+        size_t cap = (t == 0) ? dict->cap : dict->oldcap;
+        if (!vals) { continue; }
+
+        for (size_t i = 0; i < cap; i++) {
+            size_t len = 0;
+            for (const struct bucket *cur = vals[i]; cur; cur = cur->next) {
+                len++;
+            }
+
+            dict_stats_record(stats, len);
+            if (len > 0) {
+                stats->occupied++;
+                total += len;
+            }
+        }
+        stats->table_bytes += cap * sizeof(struct bucket *);
+    }
+
+    stats->mean_chain = (stats->occupied > 0) ? ((double)total / stats->occupied) : 0.0;
+    stats->bucket_bytes = slab_bytes(&dict->buckets);
+}
+
+// Count a resize which began at start in the statistics of a DSDict.
+static void resize_done(DSDict *dict, uint64_t start) {
+    assert(dict);
+    dict->resizes++;
+    dict->resize_nanos += dict_now() - start;
+}
+
+// Return a timestamp in nanoseconds for timing resizes, from a monotonic
+// clock where one is available.
+static uint64_t dict_now(void) {
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return ((uint64_t)ts.tv_sec * UINT64_C(1000000000)) + (uint64_t)ts.tv_nsec;
+    }
+#endif
+    clock_t ticks = clock();
+    return (uint64_t)(((double)ticks / CLOCKS_PER_SEC) * 1e9);
+}
+
+// Return the power of 2 of a power of 2 capacity.
+static inline size_t compute_power(size_t cap) {
+    size_t power = 0;
+    while (((size_t)1 << power) < cap) {
+        power++;
+    }
+    return power;
+}
+
+// Given a hash value and a capacity (as a power of 2), compute the place
+// of the element in the array.
+static inline size_t compute_index(uint64_t hash, size_t power, bool prime) {
+    if (prime) {
+        size_t mod = (power < DSDICT_MOD_TABLE_POWERS) ? DSDICT_MOD_TABLE[power] : ((size_t)1 << power);
+        return (hash % mod);
+    }
+
+    return (size_t)dict_mix(hash) & (((size_t)1 << power) - 1);
+}
+
+// Hash a key with whichever hash function the dictionary was created
+// with. 32 bit hashes are zero extended, so they map to exactly the same
+// slots they always have.
+static inline uint64_t dict_hash(const DSDict *dict, void *key) {
+    return (dict->hash64) ? dict->hash64(key) : dict->hash(key);
+}
+
+// Transfer values from the old DSDict bucket cache to the new bucket
+static void transfer_vals(struct bucket **old, size_t oldcap, struct bucket **new, size_t newpower, bool prime) {
+    assert(old);
+    assert(new);
+
+    // Iterate on every element of the old bucket
+    for (size_t i = 0; i < oldcap; i++) {
+        // Move each element to the front of its new chain; the order of
+        // elements within a chain does not matter
+        struct bucket *curold = old[i];
+        while (curold) {
+            struct bucket *next = curold->next;
+            size_t place = compute_index(curold->hash, newpower, prime);
+            curold->next = new[place];
+            new[place] = curold;
+            curold = next;
+        }
+
+        old[i] = NULL;
+    }
+}
+
+// Free all of the value pointers in a DSDict if a free function was given.
+static void dsdict_free(DSDict *dict) {
+    assert(dict);
+    bool free_keys = (dict->keyfree) ? true : false;
+    bool free_vals = (dict->valfree) ? true : false;
+
+    if (dict->engine == DICT_OPEN_ADDRESSING) {
+        struct swiss *table = &dict->table;
+        if ((!free_keys) && (!free_vals)) { return; }
+        for (size_t i = swiss_next(table, 0); i < table->cap; i = swiss_next(table, i + 1)) {
+            if (free_keys) {
+                dict->keyfree(table->slots[i].key);
+            }
+            if (free_vals) {
+                dict->valfree(table->slots[i].data);
+            }
+        }
+        return;
+    }
+
+    if (dict->engine == DICT_ORDERED) {
+        struct ordered *table = &dict->ordered;
+        if ((!free_keys) && (!free_vals)) { return; }
+        for (size_t i = ordered_next(table, 0); i < table->len; i = ordered_next(table, i + 1)) {
+            if (free_keys) {
+                dict->keyfree(table->entries[i].key);
+            }
+            if (free_vals) {
+                dict->valfree(table->entries[i].data);
+            }
+        }
+        return;
+    }
+
+    if (dict->engine == DICT_CUCKOO) {
+        struct cuckoo *table = &dict->cuckoo;
+        if ((!free_keys) && (!free_vals)) { return; }
+        size_t end = cuckoo_end(table);
+        for (size_t i = cuckoo_next(table, 0); i < end; i = cuckoo_next(table, i + 1)) {
+            struct cuckoo_slot *slot = cuckoo_at(table, i);
+            if (free_keys) {
+                dict->keyfree(slot->key);
+            }
+            if (free_vals) {
+                dict->valfree(slot->data);
+            }
+        }
+        return;
+    }
+
+    // Buckets themselves are released in bulk with their slab, so the
+    // chains only need to be walked to free keys and values
+    if ((free_keys) || (free_vals)) {
+        if (dict->oldvals) {
+            free_chains(dict, dict->oldvals, dict->oldcap);
+        }
+        free_chains(dict, dict->vals, dict->cap);
+    }
+}
+
+// Free the keys and values in every bucket in a bucket array.
+static void free_chains(DSDict *dict, struct bucket **vals, size_t cap) {
+    assert(dict);
+    assert(vals);
+
+    for (size_t i = 0; i < cap; i++) {
+        struct bucket *cur = vals[i];
+        while ((cur)) {
+            if (dict->keyfree) {
+                dict->keyfree(cur->key);
+            }
+            if (dict->valfree) {
+                dict->valfree(cur->data);
+            }
+            cur = cur->next;
+        }
+    }
+}
+
+// Iterate on the next open addressing dictionary entry.
+static bool swiss_iter_next(DSIter *iter, bool advance) {
+    assert(iter);
+
+    const struct swiss *table = &iter->target.dict->table;
+    size_t from = (DSITER_IS_NEW_ITER(iter)) ? 0 : (iter->cur + 1);
+    size_t i = swiss_next(table, from);
+
+    if (i < table->cap) {
+        if (advance) {
+            iter->cur = i;
+            iter->stat = DSITER_NORMAL;
+        }
+        return true;
+    }
+
+    if (advance) {
+        iter->stat = DSITER_NO_MORE_ELEMENTS;
+    }
+    return false;
+}
+
+// Iterate on the next insertion ordered dictionary entry.
+static bool ordered_iter_next(DSIter *iter, bool advance) {
+    assert(iter);
+
+    const struct ordered *table = &iter->target.dict->ordered;
+    size_t from = (DSITER_IS_NEW_ITER(iter)) ? 0 : (iter->cur + 1);
+    size_t i = ordered_next(table, from);
+
+    if (i < table->len) {
+        if (advance) {
+            iter->cur = i;
+            iter->stat = DSITER_NORMAL;
+        }
+        return true;
+    }
+
+    if (advance) {
+        iter->stat = DSITER_NO_MORE_ELEMENTS;
+    }
+    return false;
+}
+
+// Iterate on the next cuckoo hashing dictionary entry.
+static bool cuckoo_iter_next(DSIter *iter, bool advance) {
+    assert(iter);
+
+    const struct cuckoo *table = &iter->target.dict->cuckoo;
+    size_t from = (DSITER_IS_NEW_ITER(iter)) ? 0 : (iter->cur + 1);
+    size_t i = cuckoo_next(table, from);
+
+    if (i < cuckoo_end(table)) {
+        if (advance) {
+            iter->cur = i;
+            iter->stat = DSITER_NORMAL;
+        }
+        return true;
+    }
+
+    if (advance) {
+        iter->stat = DSITER_NO_MORE_ELEMENTS;
+    }
+    return false;
+}
+
+// Iterate on the next dictionary entry.
+bool dsiter_dsdict_next(DSIter *iter, bool advance) {
+    assert(iter);
+    assert(iter->type == ITER_DICT);
+
+    // If we already know there are no more elements, quit
+    if (DSITER_IS_FINISHED(iter)) {
+        return false;
+    }
+
+    if (iter->target.dict->engine == DICT_OPEN_ADDRESSING) {
+        return swiss_iter_next(iter, advance);
+    }
+    if (iter->target.dict->engine == DICT_ORDERED) {
+        return ordered_iter_next(iter, advance);
+    }
+    if (iter->target.dict->engine == DICT_CUCKOO) {
+        return cuckoo_iter_next(iter, advance);
+    }
+
+    // If there is a next node in the current chain, set our next pointer to that
+    if ((!DSITER_IS_NEW_ITER(iter)) && (iter->node.dict->next)) {
+        if (advance) {
+            iter->node.dict = iter->node.dict->next;
+        }
+        return true;
+    }
+
+    // Otherwise, traverse through the array(s) to find the next pointer;
+    // buckets of any old table being migrated are numbered first
+    DSDict *dict = iter->target.dict;
+    size_t from = (DSITER_IS_NEW_ITER(iter)) ? 0 : (iter->cur + 1);
+    size_t span = dict->oldcap + dict->cap;
+    for (size_t i = from; i < span; i++) {
+        struct bucket *cur = (i < dict->oldcap) ? dict->oldvals[i] : dict->vals[i - dict->oldcap];
+        if (cur) {
+            if (advance) {
+                iter->cur = i;
+                iter->node.dict = cur;
+                iter->stat = DSITER_NORMAL;
+            }
+            return true;
+        }
+    }
+
+    // If we get here, there is no more data in the dict
+    if (advance) {
+        iter->stat = DSITER_NO_MORE_ELEMENTS;
+        iter->node.dict = NULL;
+    }
+    return false;
+}
+
+// Release a dictionary iterator, resuming any paused migration once
+// there are no more live iterators. Unpinned iterators never dereference
+// their dictionary here, so they may outlive it.
+void dsiter_dsdict_release(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_DICT);
+
+    if (!iter->pinned) { return; }
+    DSDict *dict = iter->target.dict;
+    if ((dict) && (dict->iters > 0)) {
+        dict->iters--;
+    }
+    iter->pinned = false;
+}
+
+// Return the key of the current dictionary iterator entry.
+void *dsiter_dsdict_key(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_DICT);
+
+    if (iter->target.dict->engine == DICT_OPEN_ADDRESSING) {
+        if (iter->stat != DSITER_NORMAL) { return NULL; }
+        return iter->target.dict->table.slots[iter->cur].key;
+    }
+    if (iter->target.dict->engine == DICT_ORDERED) {
+        if (iter->stat != DSITER_NORMAL) { return NULL; }
+        return iter->target.dict->ordered.entries[iter->cur].key;
+    }
+    if (iter->target.dict->engine == DICT_CUCKOO) {
+        if (iter->stat != DSITER_NORMAL) { return NULL; }
+        return cuckoo_at(&iter->target.dict->cuckoo, iter->cur)->key;
+    }
+
+    return (iter->node.dict) ? (iter->node.dict->key) : NULL;
+}
+
+// Return the value of the current dictionary iterator entry.
+void *dsiter_dsdict_value(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_DICT);
+
+    if (iter->target.dict->engine == DICT_OPEN_ADDRESSING) {
+        if (iter->stat != DSITER_NORMAL) { return NULL; }
+        return iter->target.dict->table.slots[iter->cur].data;
+    }
+    if (iter->target.dict->engine == DICT_ORDERED) {
+        if (iter->stat != DSITER_NORMAL) { return NULL; }
+        return iter->target.dict->ordered.entries[iter->cur].data;
+    }
+    if (iter->target.dict->engine == DICT_CUCKOO) {
+        if (iter->stat != DSITER_NORMAL) { return NULL; }
+        return cuckoo_at(&iter->target.dict->cuckoo, iter->cur)->data;
+    }
+
+    return (iter->node.dict) ? (iter->node.dict->data) : NULL;
+}
+
@@ -11,15 +11,64 @@
 #ifndef LIBDS_DICTPRIV_H
 #define LIBDS_DICTPRIV_H
 
+#include <stdint.h>
 #include "libds/dict.h"
 
 struct bucket{
-    unsigned int hash;
+    uint64_t hash;
     void *key;
     void *data;
     struct bucket *next;
 };
 
+/*
+ * Spread the bits of a caller supplied hash across 64 bits so that table
+ * indices taken from any part of the result depend on the entire input
+ * hash (2^64 / golden ratio multiplier). Folding the high half of the
+ * product back down carries the upper bits of 64 bit hashes into the
+ * low bits, which are otherwise only affected by the low input bits.
+ */
+static inline uint64_t dict_mix(uint64_t hash) {
+    uint64_t mixed = hash * UINT64_C(0x9E3779B97F4A7C15);
+    return mixed ^ (mixed >> 32);
+}
+
+/*
+ * Hint that memory at addr will be read soon. Batched operations use
+ * this to overlap the cache misses of many independent lookups.
+ */
+#if defined(__GNUC__)
+#define DICT_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define DICT_PREFETCH(addr) ((void)(addr))
+#endif
+
+/*
+ * Count one chain (or probe) of the given length in the histogram of a
+ * DSDictStats and raise max_chain if it is the longest yet. Callers sum
+ * the lengths themselves and compute mean_chain once every chain has
+ * been recorded.
+ */
+static inline void dict_stats_record(DSDictStats *stats, size_t len) {
+    size_t bin = (len < DSDICT_STATS_HISTOGRAM_BINS) ? len : (DSDICT_STATS_HISTOGRAM_BINS - 1);
+    stats->histogram[bin]++;
+    if (len > stats->max_chain) {
+        stats->max_chain = len;
+    }
+}
+
+/*
+ * Visitor used by dsdict_priv_foreach, which is given a context pointer
+ * unlike the public dsdict_foreach_fn.
+ */
+typedef void (*dsdict_visit_fn)(const void *key, void *val, void *ctx);
+
+void dsdict_priv_foreach(const DSDict *dict, dsdict_visit_fn func, void *ctx);
+bool dsdict_priv_update(DSDict *dict, void *key, uint64_t hash, dsdict_update_fn func, void *ctx);
+
 bool dsiter_dsdict_next(DSIter *iter, bool advance);
+void *dsiter_dsdict_key(DSIter *iter);
+void *dsiter_dsdict_value(DSIter *iter);
+void dsiter_dsdict_release(DSIter *iter);
 
 #endif //LIBDS_DICTPRIV_H
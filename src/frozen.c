@@ -0,0 +1,403 @@
+/*****************************************************************************
+ * libds :: frozen.c
+ *
+ * Immutable dictionary stored in a memory mapped file.
+ *
+ * A frozen dictionary file is laid out as a fixed size header, followed
+ * by an open addressing table of slots, followed by the records which
+ * hold each serialized key and value:
+ *
+ *   header   magic, version, byte order marker, count, capacity, hash
+ *            seed and the offsets of the slots, records and end of file
+ *   slots    capacity x { 64-bit key hash, 64-bit record offset }
+ *   records  { 32-bit key length, 32-bit value length, key, value }
+ *
+ * A slot with a record offset of 0 is empty. Keys and values both begin
+ * on 8 byte boundaries. Every position is an offset from the start of
+ * the file, so the file may be mapped anywhere and used in place.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "libds/frozen.h"
+#include "libds/hash.h"
+#include "dictpriv.h"
+
+static const char DSFROZEN_MAGIC[8] = { 'L', 'I', 'B', 'D', 'S', 'F', 'R', 'Z' };
+static const uint32_t DSFROZEN_VERSION = 1;
+static const uint32_t DSFROZEN_BYTE_ORDER = 0x01020304;
+static const uint64_t DSFROZEN_SEED = 0x9e3779b97f4a7c15ull;
+static const size_t DSFROZEN_MIN_CAP = 8;
+static const size_t DSFROZEN_ALIGN = 8;
+
+struct frozen_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t count;
+    uint64_t cap;
+    uint64_t seed;
+    uint64_t slots_off;
+    uint64_t data_off;
+    uint64_t file_size;
+};
+
+struct frozen_slot {
+    uint64_t hash;
+    uint64_t offset;
+};
+
+struct frozen_record {
+    uint32_t keylen;
+    uint32_t vallen;
+};
+
+struct DSFrozenDict {
+    const unsigned char *base;
+    size_t size;
+    const struct frozen_slot *slots;
+    size_t mask;
+    size_t count;
+    uint64_t seed;
+    uint64_t data_off;
+};
+
+/*
+ * State shared by the visitor which writes each element of a dictionary.
+ * The serialized key is copied into a scratch buffer, since the value
+ * serializer is allowed to overwrite the bytes it points to.
+ */
+struct frozen_writer {
+    FILE *file;
+    struct frozen_slot *slots;
+    size_t mask;
+    uint64_t offset;
+    dsfrozen_serialize_fn keyfn;
+    dsfrozen_serialize_fn valfn;
+    unsigned char *scratch;
+    size_t scratchcap;
+    bool failed;
+};
+
+static void frozen_write_elem(const void *key, void *val, void *ctx);
+static bool frozen_write_padded(FILE *file, const void *data, size_t len);
+static bool frozen_record(const DSFrozenDict *dict, uint64_t offset, const unsigned char **key, size_t *keylen, const unsigned char **val, size_t *vallen);
+static bool frozen_valid(const DSFrozenDict *dict, const struct frozen_header *header);
+static size_t frozen_cap_for(size_t n);
+static inline uint64_t frozen_pad(uint64_t len);
+
+/*
+ * FROZEN DICTIONARY PUBLIC FUNCTIONS
+ */
+
+bool dsdict_freeze_to_file(const DSDict *dict, const char *path, dsfrozen_serialize_fn keyfn, dsfrozen_serialize_fn valfn) {
+    if ((!dict) || (!path) || (!keyfn) || (!valfn)) { return false; }
+
+    bool ok = false;
+    size_t count = dsdict_count(dict);
+    size_t cap = frozen_cap_for(count);
+    size_t pathlen = strlen(path);
+    char *tmp = malloc(pathlen + sizeof(".XXXXXX"));
+    int fd = -1;
+    struct frozen_writer writer = {
+        .file = NULL,
+        .slots = calloc(cap, sizeof(struct frozen_slot)),
+        .mask = cap - 1,
+        .offset = sizeof(struct frozen_header) + ((uint64_t)cap * sizeof(struct frozen_slot)),
+        .keyfn = keyfn,
+        .valfn = valfn,
+        .scratch = NULL,
+        .scratchcap = 0,
+        .failed = false,
+    };
+    if ((!tmp) || (!writer.slots)) { goto cleanup_freeze; }
+
+    // The temporary file is created next to the final path, so the rename
+    // never crosses file systems, and under a unique name, so concurrent
+    // writers of the same path never write over each other's files
+    memcpy(tmp, path, pathlen);
+    memcpy(tmp + pathlen, ".XXXXXX", sizeof(".XXXXXX"));
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        free(tmp);
+        tmp = NULL;
+        goto cleanup_freeze;
+    }
+    if (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0) { goto cleanup_freeze; }
+    writer.file = fdopen(fd, "wb");
+    if (!writer.file) { goto cleanup_freeze; }
+    fd = -1;
+
+    // Records are written first, starting just past the slot table, and
+    // the header and slots are filled in once every offset is known
+    struct frozen_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DSFROZEN_MAGIC, sizeof(DSFROZEN_MAGIC));
+    header.version = DSFROZEN_VERSION;
+    header.byte_order = DSFROZEN_BYTE_ORDER;
+    header.count = count;
+    header.cap = cap;
+    header.seed = DSFROZEN_SEED;
+    header.slots_off = sizeof(struct frozen_header);
+    header.data_off = writer.offset;
+
+    if (fseeko(writer.file, (off_t)writer.offset, SEEK_SET) != 0) { goto cleanup_freeze; }
+    dsdict_priv_foreach(dict, frozen_write_elem, &writer);
+    if (writer.failed) { goto cleanup_freeze; }
+
+    header.file_size = writer.offset;
+    if (fseeko(writer.file, 0, SEEK_SET) != 0) { goto cleanup_freeze; }
+    if (fwrite(&header, sizeof(header), 1, writer.file) != 1) { goto cleanup_freeze; }
+    if (fwrite(writer.slots, sizeof(struct frozen_slot), cap, writer.file) != cap) { goto cleanup_freeze; }
+
+    // The contents must reach the disk before the rename does, or a crash
+    // could leave path naming an empty or partially written file
+    if (fflush(writer.file) != 0) { goto cleanup_freeze; }
+    if (fsync(fileno(writer.file)) != 0) { goto cleanup_freeze; }
+
+    FILE *file = writer.file;
+    writer.file = NULL;
+    if (fclose(file) != 0) { goto cleanup_freeze; }
+    ok = (rename(tmp, path) == 0);
+
+cleanup_freeze:
+    if (writer.file) { fclose(writer.file); }
+    if (fd >= 0) { close(fd); }
+    if ((!ok) && (tmp)) { remove(tmp); }
+    free(writer.scratch);
+    free(writer.slots);
+    free(tmp);
+    return ok;
+}
+
+DSFrozenDict *dsfrozen_open(const char *path) {
+    if (!path) { return NULL; }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { return NULL; }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) ||
+        (st.st_size < (off_t)sizeof(struct frozen_header)) ||
+        ((uint64_t)st.st_size > SIZE_MAX)) {
+        close(fd);
+        return NULL;
+    }
+
+    // The mapping holds its own reference to the file, so the descriptor
+    // is not needed once the file is mapped
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) { return NULL; }
+
+    DSFrozenDict *dict = malloc(sizeof(DSFrozenDict));
+    if (!dict) {
+        munmap(base, size);
+        return NULL;
+    }
+
+    dict->base = base;
+    dict->size = size;
+    const struct frozen_header *header = base;
+    if (!frozen_valid(dict, header)) {
+        dsfrozen_close(dict);
+        return NULL;
+    }
+
+    dict->slots = (const struct frozen_slot *)(dict->base + header->slots_off);
+    dict->mask = (size_t)header->cap - 1;
+    dict->count = (size_t)header->count;
+    dict->seed = header->seed;
+    dict->data_off = header->data_off;
+    return dict;
+}
+
+void dsfrozen_close(DSFrozenDict *dict) {
+    if (!dict) { return; }
+    munmap((void *)dict->base, dict->size);
+    free(dict);
+}
+
+size_t dsfrozen_count(const DSFrozenDict *dict) {
+    assert(dict);
+    return dict->count;
+}
+
+const void *dsfrozen_get(const DSFrozenDict *dict, const void *key, size_t keylen, size_t *vallen) {
+    assert(dict);
+    if ((!key) && (keylen > 0)) { return NULL; }
+
+    uint64_t hash = hash_wyhash(key, keylen, dict->seed);
+    size_t i = (size_t)hash & dict->mask;
+
+    // Every slot is visited at most once, so a damaged file which has no
+    // empty slots cannot cause an endless probe
+    for (size_t probes = 0; probes <= dict->mask; probes++) {
+        const struct frozen_slot *slot = &dict->slots[i];
+        if (slot->offset == 0) { return NULL; }
+
+        const unsigned char *cand, *val;
+        size_t candlen, len;
+        if ((slot->hash == hash) &&
+            (frozen_record(dict, slot->offset, &cand, &candlen, &val, &len)) &&
+            (candlen == keylen) &&
+            ((keylen == 0) || (memcmp(cand, key, keylen) == 0))) {
+            if (vallen) { *vallen = len; }
+            return val;
+        }
+
+        i = (i + 1) & dict->mask;
+    }
+
+    return NULL;
+}
+
+void dsfrozen_foreach(const DSFrozenDict *dict, dsfrozen_foreach_fn func) {
+    assert(dict);
+    assert(func);
+
+    for (size_t i = 0; i <= dict->mask; i++) {
+        const unsigned char *key, *val;
+        size_t keylen, vallen;
+        if ((dict->slots[i].offset != 0) &&
+            (frozen_record(dict, dict->slots[i].offset, &key, &keylen, &val, &vallen))) {
+            func(key, keylen, val, vallen);
+        }
+    }
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Serialize one dictionary element, append its record to the file and
+// claim a slot for it.
+static void frozen_write_elem(const void *key, void *val, void *ctx) {
+    struct frozen_writer *writer = ctx;
+    if (writer->failed) { return; }
+
+    size_t keylen = 0;
+    const void *keydata = writer->keyfn(key, &keylen);
+    if ((!keydata) || (keylen > UINT32_MAX)) {
+        writer->failed = true;
+        return;
+    }
+
+    if (keylen > writer->scratchcap) {
+        unsigned char *scratch = realloc(writer->scratch, keylen);
+        if (!scratch) {
+            writer->failed = true;
+            return;
+        }
+        writer->scratch = scratch;
+        writer->scratchcap = keylen;
+    }
+    if (keylen > 0) { memcpy(writer->scratch, keydata, keylen); }
+
+    size_t vallen = 0;
+    const void *valdata = writer->valfn(val, &vallen);
+    if ((!valdata) || (vallen > UINT32_MAX)) {
+        writer->failed = true;
+        return;
+    }
+
+    struct frozen_record rec = { (uint32_t)keylen, (uint32_t)vallen };
+    if ((fwrite(&rec, sizeof(rec), 1, writer->file) != 1) ||
+        (!frozen_write_padded(writer->file, writer->scratch, keylen)) ||
+        (!frozen_write_padded(writer->file, valdata, vallen))) {
+        writer->failed = true;
+        return;
+    }
+
+    uint64_t hash = hash_wyhash(writer->scratch, keylen, DSFROZEN_SEED);
+    size_t i = (size_t)hash & writer->mask;
+    while (writer->slots[i].offset != 0) {
+        i = (i + 1) & writer->mask;
+    }
+    writer->slots[i].hash = hash;
+    writer->slots[i].offset = writer->offset;
+    writer->offset += sizeof(rec) + frozen_pad(keylen) + frozen_pad(vallen);
+}
+
+// Write len bytes of data followed by zeroes up to the next 8 byte boundary.
+static bool frozen_write_padded(FILE *file, const void *data, size_t len) {
+    static const unsigned char zeroes[8] = { 0 };
+    size_t pad = (size_t)frozen_pad(len) - len;
+    if ((len > 0) && (fwrite(data, 1, len, file) != len)) { return false; }
+    if ((pad > 0) && (fwrite(zeroes, 1, pad, file) != pad)) { return false; }
+    return true;
+}
+
+// Locate the key and value of the record at the given offset, returning
+// false if any part of the record would lie outside of the file.
+static bool frozen_record(const DSFrozenDict *dict, uint64_t offset, const unsigned char **key, size_t *keylen, const unsigned char **val, size_t *vallen) {
+    uint64_t size = dict->size;
+    if ((offset < dict->data_off) ||
+        ((offset % DSFROZEN_ALIGN) != 0) ||
+        (offset > size - sizeof(struct frozen_record))) {
+        return false;
+    }
+
+    struct frozen_record rec;
+    memcpy(&rec, dict->base + offset, sizeof(rec));
+    uint64_t keyoff = offset + sizeof(rec);
+    uint64_t valoff = keyoff + frozen_pad(rec.keylen);
+    if ((valoff > size) || (rec.vallen > size - valoff)) { return false; }
+
+    *key = dict->base + keyoff;
+    *keylen = rec.keylen;
+    *val = dict->base + valoff;
+    *vallen = rec.vallen;
+    return true;
+}
+
+// Check that a mapped file has a header this version can read and that
+// the slot table described by the header lies within the file.
+static bool frozen_valid(const DSFrozenDict *dict, const struct frozen_header *header) {
+    if ((memcmp(header->magic, DSFROZEN_MAGIC, sizeof(DSFROZEN_MAGIC)) != 0) ||
+        (header->version != DSFROZEN_VERSION) ||
+        (header->byte_order != DSFROZEN_BYTE_ORDER) ||
+        (header->file_size != dict->size)) {
+        return false;
+    }
+
+    uint64_t cap = header->cap;
+    if ((cap < DSFROZEN_MIN_CAP) ||
+        ((cap & (cap - 1)) != 0) ||
+        (header->count >= cap) ||
+        (cap > (dict->size / sizeof(struct frozen_slot)))) {
+        return false;
+    }
+
+    return (header->slots_off == sizeof(struct frozen_header)) &&
+           (header->data_off == header->slots_off + (cap * sizeof(struct frozen_slot))) &&
+           (header->data_off <= dict->size);
+}
+
+// Return the smallest power of 2 capacity which holds n elements at no
+// more than 2/3 load.
+static size_t frozen_cap_for(size_t n) {
+    size_t cap = DSFROZEN_MIN_CAP;
+    while ((cap - (cap / 3)) <= n) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+// Round a length up to the next multiple of 8.
+static inline uint64_t frozen_pad(uint64_t len) {
+    return (len + (DSFROZEN_ALIGN - 1)) & ~((uint64_t)DSFROZEN_ALIGN - 1);
+}
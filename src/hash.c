@@ -8,8 +8,12 @@
  * License: MIT (see LICENSE document at source tree root)
  *****************************************************************************/
 
+#include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "libds/hash.h"
+#include "hashpriv.h"
 
 static const uint32_t HASH_LARSON_SEED = 23;
 static const uint32_t HASH_LARSON_FACTOR = 101;
@@ -19,6 +23,24 @@ static const uint32_t HASH_DJB2A_SEED = 5381;
 static const uint32_t HASH_DJB2A_FACTOR = 33;
 static const uint32_t HASH_SDBM_SHIFT1 = 6;
 static const uint32_t HASH_SDBM_SHIFT2 = 16;
+static const uint64_t HASH_WY_SECRET[4] = {
+        0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+        0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+static const size_t WYHASH_BLOCK = 48;
+static const size_t WYHASH_HISTORY = 16;
+
+static inline uint64_t wy_seed(uint64_t seed);
+static inline void wy_block(const uint8_t *p, uint64_t *seed, uint64_t *see1, uint64_t *see2);
+static inline uint64_t wy_short(const uint8_t *p, size_t len, uint64_t seed);
+static inline uint64_t wy_tail(const uint8_t *p, size_t i, size_t len, uint64_t seed);
+static inline uint64_t wy_final(uint64_t a, uint64_t b, uint64_t seed, size_t len);
+static inline void wy_mum(uint64_t *a, uint64_t *b);
+static inline uint64_t wy_mix(uint64_t a, uint64_t b);
+static inline uint64_t wy_read8(const uint8_t *p);
+static inline uint64_t wy_read4(const uint8_t *p);
+static inline uint64_t wy_read3(const uint8_t *p, size_t k);
 
 uint32_t hash_larson(const char *str) {
     uint32_t hash = HASH_LARSON_SEED;
@@ -63,3 +85,209 @@ uint32_t hash_sdbm(const char *str) {
 
     return hash;
 }
+
+uint64_t hash_wyhash(const void *data, size_t len, uint64_t seed) {
+    const uint8_t *p = data;
+    seed = wy_seed(seed);
+    if (len <= 16) {
+        return wy_short(p, len, seed);
+    }
+
+    size_t i = len;
+    if (i >= 48) {
+        // Three independent lanes keep the multipliers busy
+        uint64_t see1 = seed;
+        uint64_t see2 = seed;
+        do {
+            wy_block(p, &seed, &see1, &see2);
+            p += 48;
+            i -= 48;
+        } while (i >= 48);
+        seed ^= see1 ^ see2;
+    }
+    return wy_tail(p, i, len, seed);
+}
+
+void hash_wyhash_init(DSWyhashState *state, uint64_t seed) {
+    assert(state);
+    state->seed = wy_seed(seed);
+    state->see1 = state->seed;
+    state->see2 = state->seed;
+    state->len = 0;
+    state->pending = 0;
+}
+
+void hash_wyhash_update(DSWyhashState *state, const void *data, size_t len) {
+    assert(state);
+    const uint8_t *p = data;
+    if (len == 0) { return; }
+    state->len += len;
+
+    // Any full block is consumed eagerly, since the one-shot hash also
+    // consumes every full block before looking at the tail
+    uint8_t *pending = &state->buf[WYHASH_HISTORY];
+    if (state->pending > 0) {
+        size_t take = WYHASH_BLOCK - state->pending;
+        if (take > len) { take = len; }
+        memcpy(&pending[state->pending], p, take);
+        state->pending += take;
+        p += take;
+        len -= take;
+        if (state->pending < WYHASH_BLOCK) {
+            return;
+        }
+        wy_block(pending, &state->seed, &state->see1, &state->see2);
+        memcpy(state->buf, &pending[WYHASH_BLOCK - WYHASH_HISTORY], WYHASH_HISTORY);
+        state->pending = 0;
+    }
+
+    if (len >= WYHASH_BLOCK) {
+        do {
+            wy_block(p, &state->seed, &state->see1, &state->see2);
+            p += WYHASH_BLOCK;
+            len -= WYHASH_BLOCK;
+        } while (len >= WYHASH_BLOCK);
+        memcpy(state->buf, p - WYHASH_HISTORY, WYHASH_HISTORY);
+    }
+
+    memcpy(pending, p, len);
+    state->pending = len;
+}
+
+uint64_t hash_wyhash_final(const DSWyhashState *state) {
+    assert(state);
+    const uint8_t *pending = &state->buf[WYHASH_HISTORY];
+    size_t len = (size_t)state->len;
+
+    // Short inputs never filled a block, so the pending bytes are the input
+    if (len < WYHASH_BLOCK) {
+        if (len <= 16) {
+            return wy_short(pending, len, state->seed);
+        }
+        return wy_tail(pending, len, len, state->seed);
+    }
+
+    // The tail may read back into the history of the last full block
+    uint64_t seed = state->seed ^ state->see1 ^ state->see2;
+    return wy_tail(pending, state->pending, len, seed);
+}
+
+uint32_t hash_wyhash_str(const char *str) {
+    return (uint32_t) hash_wyhash(str, strlen(str), 0);
+}
+
+uint64_t hash_u64(uint64_t key, uint64_t seed) {
+    return hash_priv_u64(key, seed);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Mix the caller's seed with the secret before hashing any input.
+static inline uint64_t wy_seed(uint64_t seed) {
+    return seed ^ wy_mix(seed ^ HASH_WY_SECRET[0], HASH_WY_SECRET[1]);
+}
+
+// Consume one 48 byte block into the three hash lanes.
+static inline void wy_block(const uint8_t *p, uint64_t *seed, uint64_t *see1, uint64_t *see2) {
+    const uint64_t *secret = HASH_WY_SECRET;
+    *seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ *seed);
+    *see1 = wy_mix(wy_read8(p + 16) ^ secret[2], wy_read8(p + 24) ^ *see1);
+    *see2 = wy_mix(wy_read8(p + 32) ^ secret[3], wy_read8(p + 40) ^ *see2);
+}
+
+// Hash an entire input of at most 16 bytes.
+static inline uint64_t wy_short(const uint8_t *p, size_t len, uint64_t seed) {
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len >= 4) {
+        // Two overlapping reads cover every length from 4 to 16
+        size_t off = (len >> 3) << 2;
+        a = (wy_read4(p) << 32) | wy_read4(p + off);
+        b = (wy_read4(p + len - 4) << 32) | wy_read4(p + len - 4 - off);
+    } else if (len > 0) {
+        a = wy_read3(p, len);
+    }
+    return wy_final(a, b, seed, len);
+}
+
+// Hash the final i bytes at p of an input longer than 16 bytes. The last
+// 16 bytes of the input are always read, so if i < 16 this reads back
+// into bytes which precede p.
+static inline uint64_t wy_tail(const uint8_t *p, size_t i, size_t len, uint64_t seed) {
+    const uint64_t *secret = HASH_WY_SECRET;
+    while (i > 16) {
+        seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ seed);
+        p += 16;
+        i -= 16;
+    }
+    return wy_final(wy_read8(p + i - 16), wy_read8(p + i - 8), seed, len);
+}
+
+// Fold the final two words and the input length into the hash.
+static inline uint64_t wy_final(uint64_t a, uint64_t b, uint64_t seed, size_t len) {
+    const uint64_t *secret = HASH_WY_SECRET;
+    a ^= secret[1];
+    b ^= seed;
+    wy_mum(&a, &b);
+    return wy_mix(a ^ secret[0] ^ (uint64_t)len, b ^ secret[1]);
+}
+
+// Multiply two 64-bit values, leaving the low half of the 128-bit product
+// in a and the high half in b.
+static inline void wy_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 wy_u128;
+    wy_u128 r = (wy_u128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32;
+    uint64_t hb = *b >> 32;
+    uint64_t la = (uint32_t)*a;
+    uint64_t lb = (uint32_t)*b;
+    uint64_t rh = ha * hb;
+    uint64_t rm0 = ha * lb;
+    uint64_t rm1 = hb * la;
+    uint64_t rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = (t < rl);
+    uint64_t lo = t + (rm1 << 32);
+    c += (lo < t);
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+#endif
+}
+
+// Fold the 128-bit product of two values into 64 bits.
+static inline uint64_t wy_mix(uint64_t a, uint64_t b) {
+    wy_mum(&a, &b);
+    return a ^ b;
+}
+
+// Read 8 bytes as a little endian integer from a possibly unaligned pointer.
+static inline uint64_t wy_read8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// Read 4 bytes as a little endian integer from a possibly unaligned pointer.
+static inline uint64_t wy_read4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+// Read 1 to 3 bytes, touching the first, middle and last bytes.
+static inline uint64_t wy_read3(const uint8_t *p, size_t k) {
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
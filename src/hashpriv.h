@@ -0,0 +1,29 @@
+/*****************************************************************************
+ * libds :: hashpriv.h
+ *
+ * Private header for hashing algorithms.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_HASHPRIV_H
+#define LIBDS_HASHPRIV_H
+
+#include <stdint.h>
+
+/*
+ * Mix a 64-bit integer so that every output bit depends on every input
+ * bit (the SplitMix64 finalizer). Inlined into integer keyed containers
+ * so lookups do not pay for a function call.
+ */
+static inline uint64_t hash_priv_u64(uint64_t key, uint64_t seed) {
+    uint64_t x = key ^ seed;
+    x += UINT64_C(0x9E3779B97F4A7C15);
+    x = (x ^ (x >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return x ^ (x >> 31);
+}
+
+#endif //LIBDS_HASHPRIV_H
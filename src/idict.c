@@ -0,0 +1,449 @@
+/*****************************************************************************
+ * libds :: idict.c
+ *
+ * Hash table specialized for 64-bit integer keys.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "allocpriv.h"
+#include "hashpriv.h"
+#include "idictpriv.h"
+#include "iterpriv.h"
+
+static const double DSIDICT_LOAD = 0.7;
+static const size_t DSIDICT_DEFAULT_CAP = 16;
+static const size_t DSIDICT_MIN_CAP = 16;
+static const size_t DSIDICT_CAPACITY_FACTOR = 2;
+static const double DSIDICT_SHRINK_FRACTION = 0.25;
+
+/*
+ * Slots holding a key of 0 are empty. The key 0 itself is stored outside
+ * of the slot array, so every key can be stored without a separate
+ * occupancy array.
+ */
+struct idict_slot {
+    uint64_t key;
+    void *val;
+};
+
+struct DSIntDict {
+    struct idict_slot *slots;
+    size_t cap;
+    size_t mask;
+    size_t cnt;
+    size_t mincap;
+    bool haszero;
+    uint64_t zerokey;
+    void *zeroval;
+    dsdict_free_fn valfree;
+    DSAllocator alloc;
+};
+
+static DSIntDict *idict_new(size_t cap, dsdict_free_fn valfree, const DSAllocator *alloc);
+static bool idict_find(const DSIntDict *dict, uint64_t key, size_t *place);
+static void **idict_entry(DSIntDict *dict, uint64_t key, bool *inserted);
+static bool idict_make_room(DSIntDict *dict);
+static bool idict_resize(DSIntDict *dict, size_t newcap);
+static void idict_erase(DSIntDict *dict, size_t i);
+static void idict_maybe_shrink(DSIntDict *dict);
+static size_t idict_cap_for(size_t n);
+static inline size_t idict_index(const DSIntDict *dict, uint64_t key);
+
+/*
+ * INTEGER DICTIONARY PUBLIC FUNCTIONS
+ */
+
+DSIntDict *dsidict_new(dsdict_free_fn valfree) {
+    return idict_new(DSIDICT_DEFAULT_CAP, valfree, NULL);
+}
+
+DSIntDict *dsidict_new_cap(size_t cap, dsdict_free_fn valfree) {
+    size_t newcap = idict_cap_for(cap);
+    if (newcap == 0) { return NULL; }
+    return idict_new(newcap, valfree, NULL);
+}
+
+DSIntDict *dsidict_new_alloc(dsdict_free_fn valfree, const DSAllocator *alloc) {
+    return idict_new(DSIDICT_DEFAULT_CAP, valfree, alloc);
+}
+
+void dsidict_destroy(DSIntDict *dict) {
+    if (!dict) { return; }
+
+    if (dict->valfree) {
+        if (dict->haszero) {
+            dict->valfree(dict->zeroval);
+        }
+        for (size_t i = 0; i < dict->cap; i++) {
+            if (dict->slots[i].key != 0) {
+                dict->valfree(dict->slots[i].val);
+            }
+        }
+    }
+
+    DSAllocator alloc = dict->alloc;
+    ds_free(&alloc, dict->slots, dict->cap * sizeof(struct idict_slot));
+    ds_free(&alloc, dict, sizeof(DSIntDict));
+}
+
+size_t dsidict_count(const DSIntDict *dict) {
+    assert(dict);
+    return dict->cnt;
+}
+
+size_t dsidict_cap(const DSIntDict *dict) {
+    assert(dict);
+    return dict->cap;
+}
+
+bool dsidict_reserve(DSIntDict *dict, size_t n) {
+    if (!dict) { return false; }
+
+    size_t newcap = idict_cap_for(n);
+    if (newcap == 0) { return false; }
+    if (newcap > dict->cap) {
+        if (!idict_resize(dict, newcap)) { return false; }
+    }
+
+    // Never automatically shrink below the reservation
+    if (newcap > dict->mincap) {
+        dict->mincap = newcap;
+    }
+    return true;
+}
+
+void dsidict_shrink_to_fit(DSIntDict *dict) {
+    if (!dict) { return; }
+
+    dict->mincap = DSIDICT_MIN_CAP;
+    size_t newcap = idict_cap_for(dict->cnt);
+    if ((newcap > 0) && (newcap < dict->cap)) {
+        idict_resize(dict, newcap);
+    }
+}
+
+void dsidict_foreach(DSIntDict *dict, dsidict_foreach_fn func) {
+    if ((!dict) || (!func)) { return; }
+
+    if (dict->haszero) {
+        func(0, dict->zeroval);
+    }
+    for (size_t i = 0; i < dict->cap; i++) {
+        if (dict->slots[i].key != 0) {
+            func(dict->slots[i].key, dict->slots[i].val);
+        }
+    }
+}
+
+bool dsidict_put(DSIntDict *dict, uint64_t key, void *val) {
+    if (!dict) { return false; }
+
+    bool inserted;
+    void **slot = idict_entry(dict, key, &inserted);
+    if (!slot) { return false; }
+
+    if ((!inserted) && (dict->valfree)) {
+        dict->valfree(*slot);
+    }
+    *slot = val;
+    return true;
+}
+
+void *dsidict_get(const DSIntDict *dict, uint64_t key) {
+    if (!dict) { return NULL; }
+
+    if (key == 0) {
+        return (dict->haszero) ? dict->zeroval : NULL;
+    }
+
+    size_t i;
+    return (idict_find(dict, key, &i)) ? dict->slots[i].val : NULL;
+}
+
+void **dsidict_get_or_insert(DSIntDict *dict, uint64_t key, bool *inserted) {
+    bool added = false;
+    void **val = NULL;
+    if (dict) {
+        val = idict_entry(dict, key, &added);
+    }
+
+    if (inserted) { *inserted = added; }
+    return val;
+}
+
+void *dsidict_del(DSIntDict *dict, uint64_t key) {
+    if (!dict) { return NULL; }
+
+    void *cache = NULL;
+    if (key == 0) {
+        if (!dict->haszero) { return NULL; }
+        cache = dict->zeroval;
+        dict->haszero = false;
+        dict->zeroval = NULL;
+    } else {
+        size_t i;
+        if (!idict_find(dict, key, &i)) { return NULL; }
+        cache = dict->slots[i].val;
+        idict_erase(dict, i);
+    }
+
+    dict->cnt--;
+    idict_maybe_shrink(dict);
+    return cache;
+}
+
+DSIter *dsidict_iter(DSIntDict *dict) {
+    if (!dict) { return NULL; }
+    return dsiter_priv_new(ITER_IDICT, dict, &dict->alloc);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Create a new dictionary with the given power of 2 initial capacity.
+static DSIntDict *idict_new(size_t cap, dsdict_free_fn valfree, const DSAllocator *alloc) {
+    assert(cap >= DSIDICT_MIN_CAP);
+    assert((cap & (cap - 1)) == 0);
+
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+
+    DSIntDict *dict = ds_alloc(&a, sizeof(DSIntDict));
+    if (!dict) {
+        return NULL;
+    }
+
+    dict->alloc = a;
+    dict->slots = ds_calloc(&dict->alloc, cap, sizeof(struct idict_slot));
+    if (!dict->slots) {
+        ds_free(&a, dict, sizeof(DSIntDict));
+        return NULL;
+    }
+
+    dict->cap = cap;
+    dict->mask = cap - 1;
+    dict->cnt = 0;
+    dict->mincap = cap;
+    dict->haszero = false;
+    dict->zerokey = 0;
+    dict->zeroval = NULL;
+    dict->valfree = valfree;
+    return dict;
+}
+
+// Find the slot holding a non-zero key. If the key is not present, place
+// is set to the empty slot which ended the probe, where it would go.
+static bool idict_find(const DSIntDict *dict, uint64_t key, size_t *place) {
+    assert(dict);
+    assert(key != 0);
+    assert(place);
+
+    // The table is never full, so there is always an empty slot
+    size_t i = idict_index(dict, key);
+    for (;;) {
+        uint64_t cur = dict->slots[i].key;
+        if (cur == key) {
+            *place = i;
+            return true;
+        }
+        if (cur == 0) {
+            *place = i;
+            return false;
+        }
+        i = (i + 1) & dict->mask;
+    }
+}
+
+// Return a pointer to the value for a key, adding the key with a NULL
+// value if it is not present. Returns NULL if the key could not be added.
+static void **idict_entry(DSIntDict *dict, uint64_t key, bool *inserted) {
+    assert(dict);
+    assert(inserted);
+
+    *inserted = false;
+    if (key == 0) {
+        if (!dict->haszero) {
+            dict->haszero = true;
+            dict->zeroval = NULL;
+            dict->cnt++;
+            *inserted = true;
+        }
+        return &dict->zeroval;
+    }
+
+    size_t i;
+    if (idict_find(dict, key, &i)) {
+        return &dict->slots[i].val;
+    }
+
+    // A resize moves every element, so the key has to be placed again
+    if ((dict->cnt + 1) > (size_t)((double)dict->cap * DSIDICT_LOAD)) {
+        if (!idict_make_room(dict)) { return NULL; }
+        idict_find(dict, key, &i);
+    }
+
+    dict->slots[i].key = key;
+    dict->slots[i].val = NULL;
+    dict->cnt++;
+    *inserted = true;
+    return &dict->slots[i].val;
+}
+
+// Double the capacity of a dictionary which has reached its load factor.
+static bool idict_make_room(DSIntDict *dict) {
+    assert(dict);
+
+    if (dict->cap > (SIZE_MAX / sizeof(struct idict_slot) / DSIDICT_CAPACITY_FACTOR)) {
+        return false;
+    }
+    return idict_resize(dict, dict->cap * DSIDICT_CAPACITY_FACTOR);
+}
+
+// Move every element into a new slot array with the given power of 2
+// capacity. The dictionary is unchanged if the array cannot be allocated.
+static bool idict_resize(DSIntDict *dict, size_t newcap) {
+    assert(dict);
+    assert((newcap & (newcap - 1)) == 0);
+
+    struct idict_slot *slots = ds_calloc(&dict->alloc, newcap, sizeof(struct idict_slot));
+    if (!slots) {
+        return false;
+    }
+
+    struct idict_slot *old = dict->slots;
+    size_t oldcap = dict->cap;
+    dict->slots = slots;
+    dict->cap = newcap;
+    dict->mask = newcap - 1;
+
+    for (size_t i = 0; i < oldcap; i++) {
+        if (old[i].key == 0) { continue; }
+        size_t j = idict_index(dict, old[i].key);
+        while (slots[j].key != 0) {
+            j = (j + 1) & dict->mask;
+        }
+        slots[j] = old[i];
+    }
+
+    ds_free(&dict->alloc, old, oldcap * sizeof(struct idict_slot));
+    return true;
+}
+
+// Empty the slot at i, shifting later elements in the same probe run back
+// so that no lookup ever has to step over a deleted slot.
+static void idict_erase(DSIntDict *dict, size_t i) {
+    assert(dict);
+
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & dict->mask;
+        uint64_t key = dict->slots[j].key;
+        if (key == 0) { break; }
+
+        // The element at j may fill the hole at i only if i lies between
+        // its home slot and j, since it must stay reachable from home
+        size_t home = idict_index(dict, key);
+        if (((j - home) & dict->mask) >= ((j - i) & dict->mask)) {
+            dict->slots[i] = dict->slots[j];
+            i = j;
+        }
+    }
+
+    dict->slots[i].key = 0;
+    dict->slots[i].val = NULL;
+}
+
+// Shrink a dictionary after a deletion once it falls well below its load
+// factor, leaving room so puts and deletes around the threshold do not
+// alternately grow and shrink the table.
+static void idict_maybe_shrink(DSIntDict *dict) {
+    assert(dict);
+
+    if (dict->cap <= dict->mincap) { return; }
+    if (((double)dict->cnt / dict->cap) >= (DSIDICT_LOAD * DSIDICT_SHRINK_FRACTION)) { return; }
+
+    size_t newcap = idict_cap_for(dict->cnt * 2);
+    if (newcap < dict->mincap) {
+        newcap = dict->mincap;
+    }
+    if ((newcap > 0) && (newcap < dict->cap)) {
+        idict_resize(dict, newcap);
+    }
+}
+
+// Return the smallest power of 2 capacity (no smaller than DSIDICT_MIN_CAP)
+// which holds n elements without exceeding the load factor, or 0 if there
+// is no such capacity.
+static size_t idict_cap_for(size_t n) {
+    size_t cap = DSIDICT_MIN_CAP;
+    while (n > (size_t)((double)cap * DSIDICT_LOAD)) {
+        if (cap > (SIZE_MAX / sizeof(struct idict_slot) / DSIDICT_CAPACITY_FACTOR)) { return 0; }
+        cap *= DSIDICT_CAPACITY_FACTOR;
+    }
+    return cap;
+}
+
+// Return the home slot of a key.
+static inline size_t idict_index(const DSIntDict *dict, uint64_t key) {
+    return (size_t)hash_priv_u64(key, 0) & dict->mask;
+}
+
+// Iterate on the next integer dictionary entry. Slots are visited in
+// order, followed by the key 0 (at position cap) if it is present.
+bool dsiter_dsidict_next(DSIter *iter, bool advance) {
+    assert(iter);
+    assert(iter->type == ITER_IDICT);
+
+    if (DSITER_IS_FINISHED(iter)) {
+        return false;
+    }
+
+    const DSIntDict *dict = iter->target.idict;
+    size_t from = (DSITER_IS_NEW_ITER(iter)) ? 0 : (iter->cur + 1);
+    size_t i = from;
+    while ((i < dict->cap) && (dict->slots[i].key == 0)) {
+        i++;
+    }
+
+    if ((i < dict->cap) || ((i == dict->cap) && (dict->haszero))) {
+        if (advance) {
+            iter->cur = i;
+            iter->stat = DSITER_NORMAL;
+        }
+        return true;
+    }
+
+    if (advance) {
+        iter->stat = DSITER_NO_MORE_ELEMENTS;
+    }
+    return false;
+}
+
+// Return a pointer to the key of the current integer dictionary entry.
+void *dsiter_dsidict_key(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_IDICT);
+
+    if (iter->stat != DSITER_NORMAL) { return NULL; }
+    DSIntDict *dict = iter->target.idict;
+    return (iter->cur == dict->cap) ? &dict->zerokey : &dict->slots[iter->cur].key;
+}
+
+// Return the value of the current integer dictionary entry.
+void *dsiter_dsidict_value(DSIter *iter) {
+    assert(iter);
+    assert(iter->type == ITER_IDICT);
+
+    if (iter->stat != DSITER_NORMAL) { return NULL; }
+    DSIntDict *dict = iter->target.idict;
+    return (iter->cur == dict->cap) ? dict->zeroval : dict->slots[iter->cur].val;
+}
@@ -0,0 +1,21 @@
+/*****************************************************************************
+ * libds :: idictpriv.h
+ *
+ * Private header for integer keyed dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_IDICTPRIV_H
+#define LIBDS_IDICTPRIV_H
+
+#include <stdbool.h>
+#include "libds/idict.h"
+
+bool dsiter_dsidict_next(DSIter *iter, bool advance);
+void *dsiter_dsidict_key(DSIter *iter);
+void *dsiter_dsidict_value(DSIter *iter);
+
+#endif //LIBDS_IDICTPRIV_H
@@ -12,6 +12,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <assert.h>
+#include "allocpriv.h"
 #include "iterpriv.h"
 
 static bool set_target(DSIter *iter, void *val);
@@ -27,8 +28,12 @@ bool dsiter_next(DSIter *iter) {
     switch (iter->type) {
         case ITER_ARRAY:
             return dsiter_dsarray_next(iter, true);
+        case ITER_CDICT:
+            return dsiter_dscdict_next(iter, true);
         case ITER_DICT:
             return dsiter_dsdict_next(iter, true);
+        case ITER_IDICT:
+            return dsiter_dsidict_next(iter, true);
         case ITER_LIST:
             return dsiter_dslist_next(iter, true);
     }
@@ -42,8 +47,12 @@ bool dsiter_has_next(DSIter *iter) {
     switch (iter->type) {
         case ITER_ARRAY:
             return dsiter_dsarray_next(iter, false);
+        case ITER_CDICT:
+            return dsiter_dscdict_next(iter, false);
         case ITER_DICT:
             return dsiter_dsdict_next(iter, false);
+        case ITER_IDICT:
+            return dsiter_dsidict_next(iter, false);
         case ITER_LIST:
             return dsiter_dslist_next(iter, false);
     }
@@ -57,8 +66,12 @@ void *dsiter_key(DSIter *iter) {
     switch(iter->type) {
         case ITER_ARRAY:
             return NULL;
+        case ITER_CDICT:
+            return dsiter_dscdict_key(iter);
         case ITER_DICT:
-            return (iter->node.dict) ? (iter->node.dict->key) : NULL;
+            return dsiter_dsdict_key(iter);
+        case ITER_IDICT:
+            return dsiter_dsidict_key(iter);
         case ITER_LIST:
             return NULL;
     }
@@ -72,8 +85,12 @@ void *dsiter_value(DSIter *iter) {
     switch(iter->type) {
         case ITER_ARRAY:
             return dsarray_get(iter->target.array, iter->cur);
+        case ITER_CDICT:
+            return dsiter_dscdict_value(iter);
         case ITER_DICT:
-            return (iter->node.dict) ? (iter->node.dict->data) : NULL;
+            return dsiter_dsdict_value(iter);
+        case ITER_IDICT:
+            return dsiter_dsidict_value(iter);
         case ITER_LIST:
             return (iter->node.list) ? (iter->node.list->data) : NULL;
     }
@@ -86,36 +103,58 @@ size_t dsiter_index(const DSIter *iter) {
     return iter->cur;
 }
 
+bool dsiter_error(const DSIter *iter) {
+    if (!iter) { return false; }
+    return DSITER_IS_FAILED(iter);
+}
+
 void dsiter_reset(DSIter *iter) {
     if (!iter) { return; }
 
     iter->cur = 0;
     iter->stat = DSITER_NEW_ITERATOR;
+
+    // Concurrent dictionary iterators keep their snapshot storage
+    if (iter->type == ITER_CDICT) {
+        dsiter_dscdict_reset(iter);
+        return;
+    }
     set_node(iter, NULL);
 }
 
 void dsiter_destroy(DSIter *iter) {
     if (!iter) { return; }
 
+    if (iter->type == ITER_DICT) {
+        dsiter_dsdict_release(iter);
+    } else if (iter->type == ITER_CDICT) {
+        dsiter_dscdict_release(iter);
+    }
+
     set_target(iter, NULL);
     set_node(iter, NULL);
-    free(iter);
+    DSAllocator alloc = iter->alloc;
+    ds_free(&alloc, iter, sizeof(DSIter));
 }
 
 /*
  * PRIVATE FUNCTIONS
  */
 
-// Create a new DSIter of the given type on the given target.
-DSIter* dsiter_priv_new(enum IterType type, void *target) {
-    DSIter *iter = malloc(sizeof(DSIter));
+// Create a new DSIter of the given type on the given target, allocated
+// using the target container's allocator.
+DSIter* dsiter_priv_new(enum IterType type, void *target, const DSAllocator *alloc) {
+    assert(alloc);
+    DSIter *iter = ds_alloc(alloc, sizeof(DSIter));
     if (!iter) {
         return NULL;
     }
 
+    iter->alloc = *alloc;
     iter->type = type;
     iter->cur = 0;
     iter->stat = DSITER_NEW_ITERATOR;
+    iter->pinned = false;
     set_node(iter, NULL);
 
     if (!set_target(iter, target)) {
@@ -134,9 +173,15 @@ static bool set_target(DSIter *iter, void *val) {
         case ITER_ARRAY:
             iter->target.array = val;
             return true;
+        case ITER_CDICT:
+            iter->target.cdict = val;
+            return true;
         case ITER_DICT:
             iter->target.dict = val;
             return true;
+        case ITER_IDICT:
+            iter->target.idict = val;
+            return true;
         case ITER_LIST:
             iter->target.list = val;
             return true;
@@ -152,9 +197,14 @@ static bool set_node(DSIter *iter, void *val) {
     switch (iter->type) {
         case ITER_ARRAY:
             return true;
+        case ITER_CDICT:
+            iter->node.cdict = val;
+            return true;
         case ITER_DICT:
             iter->node.dict = val;
             return true;
+        case ITER_IDICT:
+            return true;
         case ITER_LIST:
             iter->node.list = val;
             return true;
@@ -11,23 +11,32 @@
 #ifndef LIBDS_ITERPRIV_H
 #define LIBDS_ITERPRIV_H
 
+#include <stdbool.h>
+#include "libds/alloc.h"
 #include "arraypriv.h"
+#include "cdictpriv.h"
 #include "dictpriv.h"
+#include "idictpriv.h"
 #include "listpriv.h"
 
 enum IterType {
     ITER_ARRAY,
+    ITER_CDICT,
     ITER_DICT,
+    ITER_IDICT,
     ITER_LIST,
 };
 
 union IterTarget {
     DSArray *array;
+    DSConcurrentDict *cdict;
     DSDict *dict;
+    DSIntDict *idict;
     DSList *list;
 };
 
 union IterNode {
+    struct cdict_iter *cdict;
     struct bucket *dict;
     struct node *list;
 };
@@ -38,10 +47,13 @@ struct DSIter {
     size_t cur;
     union IterNode node;
     int stat;
+    bool pinned;
+    DSAllocator alloc;
 };
 
-DSIter* dsiter_priv_new(enum IterType type, void *target);
+DSIter* dsiter_priv_new(enum IterType type, void *target, const DSAllocator *alloc);
 #define DSITER_IS_NEW_ITER(iter) (iter->stat == DSITER_NEW_ITERATOR)
 #define DSITER_IS_FINISHED(iter) (iter->stat == DSITER_NO_MORE_ELEMENTS)
+#define DSITER_IS_FAILED(iter) (iter->stat == DSITER_ERROR)
 
 #endif //LIBDS_ITERPRIV_H
@@ -12,18 +12,22 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include "libds/list.h"
+#include "allocpriv.h"
 #include "listpriv.h"
 #include "iterpriv.h"
+#include "slabpriv.h"
 
 struct DSList {
     struct node *head;
     struct node *foot;
     size_t len;
+    struct slab nodes;
     dslist_compare_fn cmp;
     dslist_free_fn free;
+    DSAllocator alloc;
 };
 
-static struct node *make_node(void *elem, struct node *next, struct node *prev);
+static struct node *make_node(DSList *list, void *elem, struct node *next, struct node *prev);
 static void *remove_node(DSList *list, struct node *cur);
 
 /*
@@ -31,14 +35,25 @@ static void *remove_node(DSList *list, struct node *cur);
  */
 
 DSList *dslist_new(dslist_compare_fn cmpfn, dslist_free_fn freefn) {
-    DSList *list = malloc(sizeof(struct DSList));
+    return dslist_new_alloc(cmpfn, freefn, NULL);
+}
+
+DSList *dslist_new_alloc(dslist_compare_fn cmpfn, dslist_free_fn freefn, const DSAllocator *alloc) {
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+
+    DSList *list = ds_alloc(&a, sizeof(struct DSList));
     if (!list) {
         return NULL;
     }
 
+    list->alloc = a;
     list->head = NULL;
     list->foot = NULL;
     list->len = 0;
+    slab_init(&list->nodes, sizeof(struct node), &list->alloc);
     list->cmp = cmpfn;
     list->free = freefn;
     return list;
@@ -47,7 +62,8 @@ DSList *dslist_new(dslist_compare_fn cmpfn, dslist_free_fn freefn) {
 void dslist_destroy(DSList *list) {
     if (!list) { return; }
     dslist_clear(list);
-    free(list);
+    DSAllocator alloc = list->alloc;
+    ds_free(&alloc, list, sizeof(struct DSList));
 }
 
 size_t dslist_len(const DSList *list) {
@@ -92,6 +108,13 @@ bool dslist_extend(DSList *list, DSList *other){
     if ((list->cmp != other->cmp) || (list->free != other->free)) {
         return false;
     }
+    if (!ds_alloc_same(&list->alloc, &other->alloc)) {
+        return false;
+    }
+
+    // Nodes are moved rather than copied, so this list must take over
+    // the storage they were allocated from
+    slab_absorb(&list->nodes, &other->nodes);
 
     if (list->len == 0) {
         list->head = other->head;
@@ -119,7 +142,7 @@ bool dslist_insert(DSList *list, void *elem, size_t index){
 
     // Insert at the front of the list (or starting a new list)
     if (index == 0) {
-        struct node *newnode = make_node(elem, list->head, NULL);
+        struct node *newnode = make_node(list, elem, list->head, NULL);
         if (!newnode) { return false; }
 
         if (list->head) { list->head->prev = newnode; }
@@ -131,7 +154,7 @@ bool dslist_insert(DSList *list, void *elem, size_t index){
 
     // Append an element at the end of the list
     if  (index == list->len) {
-        struct node *newnode = make_node(elem, NULL, list->foot);
+        struct node *newnode = make_node(list, elem, NULL, list->foot);
         if (!newnode) { return false; }
 
         list->foot->next = newnode;
@@ -145,9 +168,10 @@ bool dslist_insert(DSList *list, void *elem, size_t index){
     size_t count = 0;
     while (cur) {
         if (count == index) {
-            struct node *newnode = make_node(elem, cur, cur->prev);
+            struct node *newnode = make_node(list, elem, cur, cur->prev);
             if (!newnode) { return false; }
             if (cur->prev) { cur->prev->next = newnode; }
+            cur->prev = newnode;
             list->len++;
             return true;
         }
@@ -209,7 +233,7 @@ void *dslist_dequeue(DSList *list){
     head->next = NULL;
     head->prev = NULL;
     head->data = NULL;
-    free(head);
+    slab_free(&list->nodes, head);
 
     return data;
 }
@@ -229,29 +253,28 @@ void *dslist_pop(DSList *list){
     foot->next = NULL;
     foot->prev = NULL;
     foot->data = NULL;
-    free(foot);
+    slab_free(&list->nodes, foot);
 
     return data;
 }
 
 void dslist_clear(DSList *list){
     if (!list) { return; }
-    bool can_free = (list->free) ? true : false;
 
-    struct node *cur = list->head;
-    struct node *prev = cur;
-    while (cur) {
-        if (can_free) {
+    // Nodes are released in bulk with their slab, so the list only
+    // needs to be walked to free its elements
+    if (list->free) {
+        struct node *cur = list->head;
+        while (cur) {
             list->free(cur->data);
+            cur = cur->next;
         }
-        cur = cur->next;
-        free(prev);
-        prev = cur;
-        list->len--;
     }
 
+    slab_release(&list->nodes);
     list->head = NULL;
     list->foot = NULL;
+    list->len = 0;
 }
 
 int dslist_index(DSList *list, void *elem){
@@ -291,7 +314,7 @@ void dslist_reverse(DSList *list) {
 DSIter *dslist_iter(DSList *list) {
     if (!list) { return NULL; }
 
-    DSIter *iter = dsiter_priv_new(ITER_LIST, list);
+    DSIter *iter = dsiter_priv_new(ITER_LIST, list, &list->alloc);
     if (!iter) {
         return NULL;
     }
@@ -304,9 +327,9 @@ DSIter *dslist_iter(DSList *list) {
  */
 
 // Wrap the code required to create a new node
-static struct node *make_node(void *elem, struct node *next, struct node *prev) {
-    struct node *newnode = malloc(sizeof(struct node));
-    if (!newnode) { return false; }
+static struct node *make_node(DSList *list, void *elem, struct node *next, struct node *prev) {
+    struct node *newnode = slab_alloc(&list->nodes);
+    if (!newnode) { return NULL; }
     newnode->data = elem;
     newnode->next = next;
     newnode->prev = prev;
@@ -332,7 +355,7 @@ static void *remove_node(DSList *list, struct node *cur) {
 
     list->len--;
     void *data = cur->data;
-    free(cur);
+    slab_free(&list->nodes, cur);
     return data;
 }
 
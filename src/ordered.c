@@ -0,0 +1,312 @@
+/*****************************************************************************
+ * libds :: ordered.c
+ *
+ * Insertion ordered engine for the dictionary data structure.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "allocpriv.h"
+#include "dictpriv.h"
+#include "orderedpriv.h"
+
+/*
+ * Index slot values other than entry positions. Empty slots are all one
+ * bits at every width, so a new index can be cleared with memset.
+ */
+static const int64_t ORDERED_INDEX_EMPTY = -1;
+static const int64_t ORDERED_INDEX_DELETED = -2;
+
+static inline int64_t index_get(const void *index, size_t width, size_t i);
+static inline void index_set(void *index, size_t width, size_t i, int64_t val);
+static inline size_t index_width(size_t cap);
+static size_t find_free(const struct ordered *table, uint64_t hash);
+static size_t find_entry(const struct ordered *table, uint64_t hash, size_t pos);
+
+/*
+ * ORDERED ENGINE FUNCTIONS
+ */
+
+// Allocate the index and entries for a new table of the given capacity,
+// which can hold up to usable entries before it must be rehashed.
+bool ordered_init(struct ordered *table, size_t cap, size_t usable, const DSAllocator *alloc) {
+    assert(table);
+    assert(alloc);
+    assert((cap & (cap - 1)) == 0);
+    assert(usable < cap);
+
+    table->alloc = alloc;
+    table->width = index_width(cap);
+    table->index = ds_alloc(alloc, cap * table->width);
+    if (!table->index) {
+        return false;
+    }
+
+    table->entries = ds_alloc(alloc, usable * sizeof(struct ordered_entry));
+    if ((!table->entries) && (usable > 0)) {
+        ds_free(alloc, table->index, cap * table->width);
+        table->index = NULL;
+        return false;
+    }
+
+    memset(table->index, 0xFF, cap * table->width);
+    table->cap = cap;
+    table->len = 0;
+    table->usable = usable;
+    table->cnt = 0;
+    return true;
+}
+
+// Free the table storage, but do not free key/value pairs.
+void ordered_release(struct ordered *table) {
+    assert(table);
+    if (table->index) {
+        ds_free(table->alloc, table->index, table->cap * table->width);
+        ds_free(table->alloc, table->entries, table->usable * sizeof(struct ordered_entry));
+    }
+    table->index = NULL;
+    table->entries = NULL;
+    table->cap = 0;
+    table->len = 0;
+    table->usable = 0;
+    table->cnt = 0;
+}
+
+// Return the entry holding the given key or NULL if it is not in the table.
+struct ordered_entry *ordered_find(const struct ordered *table, uint64_t hash, void *key, dsdict_compare_fn cmp) {
+    return ordered_probe(table, hash, key, cmp, NULL);
+}
+
+// Return the entry holding the given key or NULL if it is not in the table.
+// If free_at is given, it is set to the first free index slot in the probe
+// sequence for the key (or the table capacity if the probe never passed a
+// free slot), so an insert after a failed lookup needs no second probe.
+struct ordered_entry *ordered_probe(const struct ordered *table, uint64_t hash, void *key, dsdict_compare_fn cmp, size_t *free_at) {
+    assert(table);
+    assert(cmp);
+
+    size_t mask = table->cap - 1;
+    size_t pos = (size_t)dict_mix(hash) & mask;
+    if (free_at) { *free_at = table->cap; }
+
+    // Triangular probing visits every slot exactly once for power of two
+    // capacities; there is always at least one empty slot
+    for (size_t step = 1; step <= table->cap; step++) {
+        int64_t ix = index_get(table->index, table->width, pos);
+        if (ix == ORDERED_INDEX_EMPTY) {
+            if ((free_at) && (*free_at == table->cap)) { *free_at = pos; }
+            return NULL;
+        }
+
+        if (ix == ORDERED_INDEX_DELETED) {
+            if ((free_at) && (*free_at == table->cap)) { *free_at = pos; }
+        } else {
+            struct ordered_entry *entry = &table->entries[ix];
+            if ((entry->hash == hash) && (cmp(entry->key, key) == 0)) {
+                return entry;
+            }
+        }
+        pos = (pos + step) & mask;
+    }
+
+    return NULL;
+}
+
+// Prefetch the index slot which a lookup for the given hash will read
+// first, so a later lookup does not stall on it.
+void ordered_prefetch(const struct ordered *table, uint64_t hash) {
+    assert(table);
+
+    size_t pos = (size_t)dict_mix(hash) & (table->cap - 1);
+    DICT_PREFETCH((const char *)table->index + (pos * table->width));
+}
+
+// Append a new entry for a key which is known not to be in the table,
+// given the free index slot found by the probe which failed to find it
+// (or the table capacity to search for one). The caller sets the key and
+// value of the returned entry. The table must have room for the entry.
+struct ordered_entry *ordered_append(struct ordered *table, uint64_t hash, size_t free_at) {
+    assert(table);
+    assert(table->len < table->usable);
+
+    if (free_at >= table->cap) {
+        free_at = find_free(table, hash);
+    }
+
+    struct ordered_entry *entry = &table->entries[table->len];
+    index_set(table->index, table->width, free_at, (int64_t)table->len);
+    entry->hash = hash;
+    entry->key = NULL;
+    entry->data = NULL;
+    table->len++;
+    table->cnt++;
+    return entry;
+}
+
+// Remove an entry from the table, leaving a hole in the entries array so
+// the positions of later entries (and any iterators) are unaffected.
+void ordered_erase(struct ordered *table, struct ordered_entry *entry) {
+    assert(table);
+    assert(entry);
+    assert(entry->key);
+
+    size_t pos = find_entry(table, entry->hash, (size_t)(entry - table->entries));
+    index_set(table->index, table->width, pos, ORDERED_INDEX_DELETED);
+    entry->key = NULL;
+    entry->data = NULL;
+    table->cnt--;
+}
+
+// Rebuild the table with the given capacity, compacting the live entries
+// to the front of a new entries array in their original order. The table
+// is unchanged if the new storage cannot be allocated.
+bool ordered_rehash(struct ordered *table, size_t newcap, size_t usable) {
+    assert(table);
+    assert(table->cnt <= usable);
+
+    struct ordered fresh;
+    if (!ordered_init(&fresh, newcap, usable, table->alloc)) {
+        return false;
+    }
+
+    for (size_t i = ordered_next(table, 0); i < table->len; i = ordered_next(table, i + 1)) {
+        const struct ordered_entry *old = &table->entries[i];
+        struct ordered_entry *entry = ordered_append(&fresh, old->hash, fresh.cap);
+        entry->key = old->key;
+        entry->data = old->data;
+    }
+
+    ordered_release(table);
+    *table = fresh;
+    return true;
+}
+
+// Return the position of the first live entry at or after from, or the
+// number of entries (including holes) if there are no more.
+size_t ordered_next(const struct ordered *table, size_t from) {
+    assert(table);
+
+    for (size_t i = from; i < table->len; i++) {
+        if (table->entries[i].key) {
+            return i;
+        }
+    }
+    return table->len;
+}
+
+// Record the probe length of every element and the size of the index
+// and entries array in a DSDictStats.
+void ordered_stats(const struct ordered *table, DSDictStats *stats) {
+    assert(table);
+    assert(stats);
+
+    size_t mask = table->cap - 1;
+    size_t total = 0;
+    for (size_t i = 0; i < table->cap; i++) {
+        int64_t ix = index_get(table->index, table->width, i);
+        if (ix < 0) { continue; }
+
+        // Replay the probe sequence for this element until its slot
+        size_t pos = (size_t)dict_mix(table->entries[ix].hash) & mask;
+        size_t len = 1;
+        for (size_t step = 1; (pos != i) && (step <= table->cap); step++) {
+            pos = (pos + step) & mask;
+            len++;
+        }
+
+        dict_stats_record(stats, len);
+        total += len;
+    }
+
+    stats->occupied = table->cnt;
+    stats->deleted = table->len - table->cnt;
+    stats->mean_chain = (table->cnt > 0) ? ((double)total / table->cnt) : 0.0;
+    stats->table_bytes = table->cap * table->width;
+    stats->bucket_bytes = table->usable * sizeof(struct ordered_entry);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Read the value of an index slot.
+static inline int64_t index_get(const void *index, size_t width, size_t i) {
+    switch (width) {
+        case 1:
+            return ((const int8_t *)index)[i];
+        case 2:
+            return ((const int16_t *)index)[i];
+        case 4:
+            return ((const int32_t *)index)[i];
+        default:
+            return ((const int64_t *)index)[i];
+    }
+}
+
+// Write the value of an index slot, which must fit in the index width.
+static inline void index_set(void *index, size_t width, size_t i, int64_t val) {
+    switch (width) {
+        case 1:
+            ((int8_t *)index)[i] = (int8_t)val;
+            return;
+        case 2:
+            ((int16_t *)index)[i] = (int16_t)val;
+            return;
+        case 4:
+            ((int32_t *)index)[i] = (int32_t)val;
+            return;
+        default:
+            ((int64_t *)index)[i] = val;
+            return;
+    }
+}
+
+// Return the narrowest index slot width which can hold every entry
+// position of a table with the given capacity.
+static inline size_t index_width(size_t cap) {
+    if (cap <= ((size_t)INT8_MAX + 1)) { return 1; }
+    if (cap <= ((size_t)INT16_MAX + 1)) { return 2; }
+    if (cap <= ((size_t)INT32_MAX + 1)) { return 4; }
+    return 8;
+}
+
+// Return the first free index slot in the probe sequence for a hash.
+static size_t find_free(const struct ordered *table, uint64_t hash) {
+    assert(table);
+
+    size_t mask = table->cap - 1;
+    size_t pos = (size_t)dict_mix(hash) & mask;
+    for (size_t step = 1; step <= table->cap; step++) {
+        int64_t ix = index_get(table->index, table->width, pos);
+        if ((ix == ORDERED_INDEX_EMPTY) || (ix == ORDERED_INDEX_DELETED)) {
+            return pos;
+        }
+        pos = (pos + step) & mask;
+    }
+
+    assert(false);
+    return table->cap;
+}
+
+// Return the index slot which refers to the entry at position pos.
+static size_t find_entry(const struct ordered *table, uint64_t hash, size_t pos) {
+    assert(table);
+
+    size_t mask = table->cap - 1;
+    size_t i = (size_t)dict_mix(hash) & mask;
+    for (size_t step = 1; step <= table->cap; step++) {
+        if (index_get(table->index, table->width, i) == (int64_t)pos) {
+            return i;
+        }
+        i = (i + step) & mask;
+    }
+
+    assert(false);
+    return table->cap;
+}
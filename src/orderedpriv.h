@@ -0,0 +1,63 @@
+/*****************************************************************************
+ * libds :: orderedpriv.h
+ *
+ * Private header for the insertion ordered dictionary engine.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_ORDEREDPRIV_H
+#define LIBDS_ORDEREDPRIV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "libds/alloc.h"
+#include "libds/dict.h"
+
+/*
+ * Entries are stored densely in insertion order. Deleted entries are left
+ * as holes (with a NULL key) until the next rehash compacts the array.
+ */
+struct ordered_entry {
+    uint64_t hash;
+    void *key;
+    void *data;
+};
+
+/*
+ * Compact (CPython style) ordered table.
+ *
+ * The open addressing index holds only the position of each element in
+ * the entries array, using the narrowest signed integer type which can
+ * address every entry (1, 2, 4 or 8 bytes per slot). The entries array
+ * is allocated once per rehash with room for exactly usable entries, so
+ * the table must be rehashed before any more can be appended. Storage
+ * comes from the owning dictionary's allocator, which must outlive the
+ * table.
+ */
+struct ordered {
+    void *index;
+    struct ordered_entry *entries;
+    size_t cap;
+    size_t width;
+    size_t len;
+    size_t usable;
+    size_t cnt;
+    const DSAllocator *alloc;
+};
+
+bool ordered_init(struct ordered *table, size_t cap, size_t usable, const DSAllocator *alloc);
+void ordered_release(struct ordered *table);
+struct ordered_entry *ordered_find(const struct ordered *table, uint64_t hash, void *key, dsdict_compare_fn cmp);
+struct ordered_entry *ordered_probe(const struct ordered *table, uint64_t hash, void *key, dsdict_compare_fn cmp, size_t *free_at);
+void ordered_prefetch(const struct ordered *table, uint64_t hash);
+struct ordered_entry *ordered_append(struct ordered *table, uint64_t hash, size_t free_at);
+void ordered_erase(struct ordered *table, struct ordered_entry *entry);
+bool ordered_rehash(struct ordered *table, size_t newcap, size_t usable);
+size_t ordered_next(const struct ordered *table, size_t from);
+void ordered_stats(const struct ordered *table, DSDictStats *stats);
+
+#endif //LIBDS_ORDEREDPRIV_H
@@ -0,0 +1,425 @@
+/*****************************************************************************
+ * libds :: perfect.c
+ *
+ * Read-only dictionary built on a minimal perfect hash function.
+ *
+ * The perfect hash function is found with the hash and displace (CHD)
+ * method. Each distinct key hash is mixed with a seed, and the high bits
+ * of the result pick one of about n/4 buckets. Buckets are then placed
+ * largest first: each is given the first displacement (pilot) for which
+ * every hash in the bucket lands on a slot which no earlier bucket took.
+ * A lookup recomputes the mixed hash, reads the pilot of its bucket and
+ * probes exactly one slot.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "libds/perfect.h"
+#include "allocpriv.h"
+#include "hashpriv.h"
+
+static const size_t DSPERFECT_BUCKET_SIZE = 4;
+static const size_t DSPERFECT_ATTEMPTS = 8;
+static const uint64_t DSPERFECT_TRIALS_PER_SLOT = 32;
+static const uint64_t DSPERFECT_SEED = 0x2545f4914f6cdd1dull;
+
+/*
+ * Each slot holds the first key with a given hash value. Any other keys
+ * with exactly the same hash are chained from the slot through 1-based
+ * indices into the extra array, with 0 ending the chain.
+ */
+struct perfect_slot {
+    uint32_t hash;
+    uint32_t more;
+    void *key;
+    void *val;
+};
+
+struct perfect_extra {
+    void *key;
+    void *val;
+    uint32_t next;
+};
+
+struct DSPerfectDict {
+    struct perfect_slot *slots;
+    size_t cap;
+    uint32_t *pilots;
+    size_t nbuckets;
+    struct perfect_extra *extra;
+    size_t nextra;
+    size_t count;
+    uint64_t seed;
+    dsdict_hash_fn hash;
+    dsdict_compare_fn cmpfn;
+    DSAllocator alloc;
+};
+
+/*
+ * Keys being placed are sorted by bucket, then hash, then input order.
+ * The first key with each hash is the head of its group and is placed in
+ * the table; later distinct keys with the same hash are extras, and keys
+ * equal to an earlier key in the group are dropped after handing their
+ * value to that key.
+ */
+enum perfect_role {
+    PERFECT_HEAD,
+    PERFECT_EXTRA,
+    PERFECT_DUPLICATE,
+};
+
+struct perfect_key {
+    uint64_t x;
+    uint32_t hash;
+    enum perfect_role role;
+    size_t keyidx;
+    size_t validx;
+    size_t pos;
+};
+
+static bool perfect_try(DSPerfectDict *dict, void **keys, void **vals, const uint32_t *hashes, size_t n, uint64_t seed);
+static void perfect_sort_bucket(struct perfect_key *order, size_t len);
+static size_t perfect_group(DSPerfectDict *dict, void **keys, struct perfect_key *order, size_t len);
+static bool perfect_place(DSPerfectDict *dict, void **keys, void **vals, struct perfect_key *order, const size_t *bstart, size_t maxheads);
+static size_t perfect_heads(const struct perfect_key *order, const size_t *bstart, size_t b);
+static void perfect_release(DSPerfectDict *dict);
+static inline size_t perfect_bucket(uint64_t x, size_t nbuckets);
+static inline size_t perfect_pos(uint64_t x, uint32_t pilot, size_t cap);
+
+/*
+ * PERFECT DICTIONARY PUBLIC FUNCTIONS
+ */
+
+DSPerfectDict *dsdict_build_perfect(void **keys, void **vals, size_t n, dsdict_hash_fn hash, dsdict_compare_fn cmpfn) {
+    return dsdict_build_perfect_alloc(keys, vals, n, hash, cmpfn, NULL);
+}
+
+DSPerfectDict *dsdict_build_perfect_alloc(void **keys, void **vals, size_t n, dsdict_hash_fn hash, dsdict_compare_fn cmpfn, const DSAllocator *alloc) {
+    if ((!hash) || (!cmpfn)) { return NULL; }
+    if ((n > 0) && ((!keys) || (!vals))) { return NULL; }
+
+    // Every per-key array is no larger than the array of perfect_keys
+    if (n > (SIZE_MAX / sizeof(struct perfect_key))) { return NULL; }
+
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+
+    DSPerfectDict *dict = ds_calloc(&a, 1, sizeof(DSPerfectDict));
+    if (!dict) { return NULL; }
+    dict->alloc = a;
+    dict->hash = hash;
+    dict->cmpfn = cmpfn;
+    if (n == 0) { return dict; }
+
+    // Each key is hashed once up front, since every attempt needs them
+    uint32_t *hashes = ds_alloc(&dict->alloc, n * sizeof(uint32_t));
+    if (!hashes) { goto cleanup_build_perfect; }
+    for (size_t i = 0; i < n; i++) {
+        if (!keys[i]) { goto cleanup_build_perfect; }
+        hashes[i] = hash(keys[i]);
+    }
+
+    for (size_t attempt = 0; attempt < DSPERFECT_ATTEMPTS; attempt++) {
+        if (perfect_try(dict, keys, vals, hashes, n, hash_priv_u64(attempt, DSPERFECT_SEED))) {
+            ds_free(&dict->alloc, hashes, n * sizeof(uint32_t));
+            return dict;
+        }
+        perfect_release(dict);
+    }
+
+cleanup_build_perfect:
+    ds_free(&dict->alloc, hashes, n * sizeof(uint32_t));
+    dsperfect_destroy(dict);
+    return NULL;
+}
+
+void dsperfect_destroy(DSPerfectDict *dict) {
+    if (!dict) { return; }
+    perfect_release(dict);
+    DSAllocator alloc = dict->alloc;
+    ds_free(&alloc, dict, sizeof(DSPerfectDict));
+}
+
+size_t dsperfect_count(const DSPerfectDict *dict) {
+    assert(dict);
+    return dict->count;
+}
+
+void *dsperfect_get(const DSPerfectDict *dict, void *key) {
+    assert(dict);
+    if ((!key) || (dict->cap == 0)) { return NULL; }
+
+    uint32_t hash = dict->hash(key);
+    uint64_t x = hash_priv_u64(hash, dict->seed);
+    uint32_t pilot = dict->pilots[perfect_bucket(x, dict->nbuckets)];
+    const struct perfect_slot *slot = &dict->slots[perfect_pos(x, pilot, dict->cap)];
+    if (slot->hash != hash) { return NULL; }
+    if (dict->cmpfn(key, slot->key) == 0) { return slot->val; }
+
+    for (uint32_t i = slot->more; i != 0; i = dict->extra[i - 1].next) {
+        if (dict->cmpfn(key, dict->extra[i - 1].key) == 0) {
+            return dict->extra[i - 1].val;
+        }
+    }
+
+    return NULL;
+}
+
+void dsperfect_foreach(const DSPerfectDict *dict, dsdict_foreach_fn func) {
+    assert(dict);
+    assert(func);
+
+    for (size_t i = 0; i < dict->cap; i++) {
+        func(dict->slots[i].key, dict->slots[i].val);
+    }
+    for (size_t i = 0; i < dict->nextra; i++) {
+        func(dict->extra[i].key, dict->extra[i].val);
+    }
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Attempt to build the table using the given seed, returning false if
+// memory could not be allocated or some bucket could not be placed.
+static bool perfect_try(DSPerfectDict *dict, void **keys, void **vals, const uint32_t *hashes, size_t n, uint64_t seed) {
+    bool ok = false;
+    size_t nbuckets = (n + DSPERFECT_BUCKET_SIZE - 1) / DSPERFECT_BUCKET_SIZE;
+    if (nbuckets > UINT32_MAX) { nbuckets = UINT32_MAX; }
+    struct perfect_key *order = ds_alloc(&dict->alloc, n * sizeof(struct perfect_key));
+    size_t *bstart = ds_calloc(&dict->alloc, nbuckets + 1, sizeof(size_t));
+    if ((!order) || (!bstart)) { goto cleanup_perfect_try; }
+
+    // Counting sort the keys by bucket, keeping them in input order
+    // within each bucket
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = hash_priv_u64(hashes[i], seed);
+        bstart[perfect_bucket(x, nbuckets) + 1]++;
+    }
+    for (size_t b = 0; b < nbuckets; b++) {
+        bstart[b + 1] += bstart[b];
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = hash_priv_u64(hashes[i], seed);
+        size_t b = perfect_bucket(x, nbuckets);
+        size_t at = bstart[b]++;
+        order[at].x = x;
+        order[at].hash = hashes[i];
+        order[at].role = PERFECT_HEAD;
+        order[at].keyidx = i;
+        order[at].validx = i;
+        order[at].pos = 0;
+    }
+    for (size_t b = nbuckets; b > 0; b--) {
+        bstart[b] = bstart[b - 1];
+    }
+    bstart[0] = 0;
+
+    // Keys with equal hashes always share a bucket, so grouping them only
+    // needs to look within each bucket
+    size_t maxheads = 0;
+    dict->cap = 0;
+    dict->nextra = 0;
+    for (size_t b = 0; b < nbuckets; b++) {
+        perfect_sort_bucket(&order[bstart[b]], bstart[b + 1] - bstart[b]);
+        size_t heads = perfect_group(dict, keys, &order[bstart[b]], bstart[b + 1] - bstart[b]);
+        if (heads > maxheads) { maxheads = heads; }
+    }
+    if (dict->nextra >= UINT32_MAX) { goto cleanup_perfect_try; }
+
+    dict->seed = seed;
+    dict->nbuckets = nbuckets;
+    dict->count = dict->cap + dict->nextra;
+    dict->slots = ds_calloc(&dict->alloc, dict->cap, sizeof(struct perfect_slot));
+    dict->pilots = ds_calloc(&dict->alloc, nbuckets, sizeof(uint32_t));
+    if ((!dict->slots) || (!dict->pilots)) { goto cleanup_perfect_try; }
+    if (dict->nextra > 0) {
+        dict->extra = ds_calloc(&dict->alloc, dict->nextra, sizeof(struct perfect_extra));
+        if (!dict->extra) { goto cleanup_perfect_try; }
+    }
+
+    ok = perfect_place(dict, keys, vals, order, bstart, maxheads);
+
+cleanup_perfect_try:
+    ds_free(&dict->alloc, order, n * sizeof(struct perfect_key));
+    ds_free(&dict->alloc, bstart, (nbuckets + 1) * sizeof(size_t));
+    return ok;
+}
+
+// Stable insertion sort of one bucket by hash. Buckets hold 4 keys on
+// average, so this is cheaper than a general purpose sort.
+static void perfect_sort_bucket(struct perfect_key *order, size_t len) {
+    for (size_t i = 1; i < len; i++) {
+        struct perfect_key cur = order[i];
+        size_t j = i;
+        while ((j > 0) && (order[j - 1].hash > cur.hash)) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = cur;
+    }
+}
+
+// Assign roles to the keys of one sorted bucket, counting heads into the
+// table capacity and extras into the extra count. Returns the number of
+// heads in the bucket.
+static size_t perfect_group(DSPerfectDict *dict, void **keys, struct perfect_key *order, size_t len) {
+    size_t heads = 0;
+    size_t group = 0;
+    for (size_t i = 0; i < len; i++) {
+        if ((i == 0) || (order[i].hash != order[group].hash)) {
+            group = i;
+            heads++;
+            continue;
+        }
+
+        order[i].role = PERFECT_EXTRA;
+        for (size_t j = group; j < i; j++) {
+            if ((order[j].role != PERFECT_DUPLICATE) &&
+                (dict->cmpfn(keys[order[i].keyidx], keys[order[j].keyidx]) == 0)) {
+                order[i].role = PERFECT_DUPLICATE;
+                order[j].validx = order[i].validx;
+                break;
+            }
+        }
+        if (order[i].role == PERFECT_EXTRA) { dict->nextra++; }
+    }
+
+    dict->cap += heads;
+    return heads;
+}
+
+// Find a pilot for every bucket, largest bucket first, and fill in the
+// slots and extra chains.
+static bool perfect_place(DSPerfectDict *dict, void **keys, void **vals, struct perfect_key *order, const size_t *bstart, size_t maxheads) {
+    bool ok = false;
+    size_t nbuckets = dict->nbuckets;
+    size_t *sizes = ds_calloc(&dict->alloc, maxheads + 2, sizeof(size_t));
+    size_t *border = ds_alloc(&dict->alloc, nbuckets * sizeof(size_t));
+    size_t *members = ds_alloc(&dict->alloc, maxheads * sizeof(size_t));
+    size_t *pos = ds_alloc(&dict->alloc, maxheads * sizeof(size_t));
+    unsigned char *taken = ds_calloc(&dict->alloc, dict->cap, 1);
+    if ((!sizes) || (!border) || (!members) || (!pos) || (!taken)) { goto cleanup_perfect_place; }
+
+    // Counting sort the buckets by number of heads, largest first
+    for (size_t b = 0; b < nbuckets; b++) {
+        sizes[maxheads - perfect_heads(order, bstart, b) + 1]++;
+    }
+    for (size_t s = 0; s <= maxheads; s++) {
+        sizes[s + 1] += sizes[s];
+    }
+    for (size_t b = 0; b < nbuckets; b++) {
+        border[sizes[maxheads - perfect_heads(order, bstart, b)]++] = b;
+    }
+
+    // The last few buckets placed have few free slots to choose from, so
+    // the number of pilots tried before giving up on a seed scales with
+    // the size of the table
+    uint64_t limit = (DSPERFECT_TRIALS_PER_SLOT * (uint64_t)dict->cap) + 1024;
+    if (limit > UINT32_MAX) { limit = UINT32_MAX; }
+
+    for (size_t k = 0; k < nbuckets; k++) {
+        size_t b = border[k];
+        size_t nmembers = 0;
+        for (size_t i = bstart[b]; i < bstart[b + 1]; i++) {
+            if (order[i].role == PERFECT_HEAD) { members[nmembers++] = i; }
+        }
+        if (nmembers == 0) { break; }
+
+        uint64_t pilot = 0;
+        for (; pilot < limit; pilot++) {
+            bool fits = true;
+            for (size_t j = 0; (fits) && (j < nmembers); j++) {
+                pos[j] = perfect_pos(order[members[j]].x, (uint32_t)pilot, dict->cap);
+                fits = (!taken[pos[j]]);
+                for (size_t l = 0; (fits) && (l < j); l++) {
+                    fits = (pos[l] != pos[j]);
+                }
+            }
+            if (fits) { break; }
+        }
+        if (pilot == limit) { goto cleanup_perfect_place; }
+
+        dict->pilots[b] = (uint32_t)pilot;
+        for (size_t j = 0; j < nmembers; j++) {
+            struct perfect_key *head = &order[members[j]];
+            taken[pos[j]] = 1;
+            head->pos = pos[j];
+            dict->slots[pos[j]].hash = head->hash;
+            dict->slots[pos[j]].more = 0;
+            dict->slots[pos[j]].key = keys[head->keyidx];
+            dict->slots[pos[j]].val = vals[head->validx];
+        }
+    }
+
+    // Extras follow their head in sorted order, so each can be chained
+    // from the slot its head was placed in
+    size_t nextra = 0;
+    size_t head = 0;
+    for (size_t i = 0; i < bstart[nbuckets]; i++) {
+        if (order[i].role == PERFECT_HEAD) {
+            head = i;
+        } else if (order[i].role == PERFECT_EXTRA) {
+            struct perfect_slot *slot = &dict->slots[order[head].pos];
+            dict->extra[nextra].key = keys[order[i].keyidx];
+            dict->extra[nextra].val = vals[order[i].validx];
+            dict->extra[nextra].next = slot->more;
+            slot->more = (uint32_t)(++nextra);
+        }
+    }
+
+    ok = true;
+
+cleanup_perfect_place:
+    ds_free(&dict->alloc, sizes, (maxheads + 2) * sizeof(size_t));
+    ds_free(&dict->alloc, border, nbuckets * sizeof(size_t));
+    ds_free(&dict->alloc, members, maxheads * sizeof(size_t));
+    ds_free(&dict->alloc, pos, maxheads * sizeof(size_t));
+    ds_free(&dict->alloc, taken, dict->cap);
+    return ok;
+}
+
+// Return the number of heads in bucket b.
+static size_t perfect_heads(const struct perfect_key *order, const size_t *bstart, size_t b) {
+    size_t heads = 0;
+    for (size_t i = bstart[b]; i < bstart[b + 1]; i++) {
+        heads += (order[i].role == PERFECT_HEAD);
+    }
+    return heads;
+}
+
+// Free the table built by an attempt.
+static void perfect_release(DSPerfectDict *dict) {
+    ds_free(&dict->alloc, dict->slots, dict->cap * sizeof(struct perfect_slot));
+    ds_free(&dict->alloc, dict->pilots, dict->nbuckets * sizeof(uint32_t));
+    ds_free(&dict->alloc, dict->extra, dict->nextra * sizeof(struct perfect_extra));
+    dict->slots = NULL;
+    dict->pilots = NULL;
+    dict->extra = NULL;
+    dict->cap = 0;
+    dict->nbuckets = 0;
+    dict->nextra = 0;
+    dict->count = 0;
+}
+
+// Map the high bits of a mixed hash onto a bucket.
+static inline size_t perfect_bucket(uint64_t x, size_t nbuckets) {
+    return (size_t)(((x >> 32) * (uint64_t)nbuckets) >> 32);
+}
+
+// Return the slot of a mixed hash displaced by the pilot of its bucket.
+// The hash is remixed with the pilot, rather than combined with it by a
+// simple XOR or addition, since those keep the same distance between two
+// keys for every pilot and so could never separate a pair which lands on
+// the same slot modulo a power of 2 capacity.
+static inline size_t perfect_pos(uint64_t x, uint32_t pilot, size_t cap) {
+    return (size_t)(hash_priv_u64(x, pilot) % cap);
+}
@@ -0,0 +1,531 @@
+/*****************************************************************************
+ * libds :: rdict.c
+ *
+ * Read-mostly dictionary with wait-free lookups.
+ *
+ * Readers only ever load shared memory; every store a reader makes is to
+ * its own epoch slot. Writers serialize on a mutex, publish new nodes and
+ * tables with release stores once they are fully built, and defer freeing
+ * anything a reader may still be looking at until every reader has been
+ * seen outside of a read section or inside a newer one.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "libds/rdict.h"
+#include "allocpriv.h"
+#include "atomicpriv.h"
+#include "dictpriv.h"
+#include "slabpriv.h"
+
+static const double DSRDICT_LOAD = 0.75;
+static const size_t DSRDICT_DEFAULT_CAP = 64;
+static const size_t DSRDICT_RETIRED_CAP = 16;
+
+/*
+ * Readers are padded so that a reader entering and leaving read sections
+ * does not share a cache line with other readers.
+ */
+#define RDICT_READER_PAD 96
+
+struct rdict_node {
+    uint32_t hash;
+    void *key;
+    DS_ATOMIC(void *) val;
+    DS_ATOMIC(struct rdict_node *) next;
+};
+
+struct rdict_table {
+    size_t cap;
+    DS_ATOMIC(struct rdict_node *) slots[];
+};
+
+enum RetireKind {
+    RETIRE_VALUE,
+    RETIRE_ENTRY,
+    RETIRE_TABLE,
+};
+
+/*
+ * Memory which was unlinked while readers might still be using it, along
+ * with the global epoch at the time it was unlinked.
+ */
+struct rdict_retired {
+    enum RetireKind kind;
+    void *ptr;
+    uint64_t epoch;
+};
+
+struct DSReadDictReader {
+    DS_ATOMIC(uint64_t) epoch;
+    size_t depth;
+    DSReadDict *dict;
+    DSReadDictReader *next;
+    char pad[RDICT_READER_PAD];
+};
+
+struct DSReadDict {
+    DS_ATOMIC(struct rdict_table *) table;
+    DS_ATOMIC(size_t) cnt;
+    DS_ATOMIC(uint64_t) epoch;
+    pthread_mutex_t lock;
+    DSReadDictReader *readers;
+    struct rdict_retired *retired;
+    size_t nretired;
+    size_t capretired;
+    struct slab nodes;
+    dsdict_hash_fn hash;
+    dsdict_compare_fn cmp;
+    dsdict_free_fn keyfree;
+    dsdict_free_fn valfree;
+    DSAllocator alloc;
+};
+
+static struct rdict_table *table_new(DSReadDict *dict, size_t cap);
+static void table_free(DSReadDict *dict, struct rdict_table *table, bool entries);
+static bool grow_table(DSReadDict *dict);
+static void retire(DSReadDict *dict, enum RetireKind kind, void *ptr);
+static void end_write(DSReadDict *dict);
+static size_t reclaim(DSReadDict *dict);
+static void free_retired(DSReadDict *dict, struct rdict_retired *item);
+static bool retired_before(const DSReadDict *dict, uint64_t epoch);
+static inline size_t slot_index(const struct rdict_table *table, uint32_t hash);
+
+/*
+ * READ-MOSTLY DICTIONARY PUBLIC FUNCTIONS
+ */
+
+DSReadDict *dsrdict_new(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree) {
+    return dsrdict_new_alloc(hash, cmpfn, keyfree, valfree, NULL);
+}
+
+DSReadDict *dsrdict_new_alloc(dsdict_hash_fn hash, dsdict_compare_fn cmpfn, dsdict_free_fn keyfree, dsdict_free_fn valfree, const DSAllocator *alloc) {
+    if ((!hash) || (!cmpfn)) { return NULL; }
+
+    DSAllocator a;
+    if (!ds_alloc_init(&a, alloc)) {
+        return NULL;
+    }
+    DSReadDict *dict = ds_alloc(&a, sizeof(DSReadDict));
+    if (!dict) {
+        return NULL;
+    }
+
+    dict->alloc = a;
+    dict->table = table_new(dict, DSRDICT_DEFAULT_CAP);
+    if (!dict->table) {
+        ds_free(&a, dict, sizeof(DSReadDict));
+        return NULL;
+    }
+    if (pthread_mutex_init(&dict->lock, NULL) != 0) {
+        table_free(dict, dict->table, false);
+        ds_free(&a, dict, sizeof(DSReadDict));
+        return NULL;
+    }
+
+    dict->cnt = 0;
+    dict->epoch = 1;
+    dict->readers = NULL;
+    dict->retired = NULL;
+    dict->nretired = 0;
+    dict->capretired = 0;
+    slab_init(&dict->nodes, sizeof(struct rdict_node), &dict->alloc);
+    dict->hash = hash;
+    dict->cmp = cmpfn;
+    dict->keyfree = keyfree;
+    dict->valfree = valfree;
+    return dict;
+}
+
+void dsrdict_destroy(DSReadDict *dict) {
+    if (!dict) { return; }
+
+    for (size_t i = 0; i < dict->nretired; i++) {
+        free_retired(dict, &dict->retired[i]);
+    }
+    ds_free(&dict->alloc, dict->retired, dict->capretired * sizeof(struct rdict_retired));
+    table_free(dict, dict->table, true);
+    slab_release(&dict->nodes);
+
+    DSReadDictReader *reader = dict->readers;
+    while (reader) {
+        DSReadDictReader *next = reader->next;
+        ds_free(&dict->alloc, reader, sizeof(DSReadDictReader));
+        reader = next;
+    }
+
+    pthread_mutex_destroy(&dict->lock);
+    DSAllocator alloc = dict->alloc;
+    ds_free(&alloc, dict, sizeof(DSReadDict));
+}
+
+size_t dsrdict_count(const DSReadDict *dict) {
+    assert(dict);
+    return DS_ATOMIC_LOAD(&dict->cnt, DS_ATOMIC_RELAXED);
+}
+
+bool dsrdict_put(DSReadDict *dict, void *key, void *val) {
+    if ((!dict) || (!key)) { return false; }
+
+    uint32_t hash = dict->hash(key);
+    pthread_mutex_lock(&dict->lock);
+
+    // Values are replaced in place with a single release store, so
+    // readers see either the old or the new value
+    struct rdict_table *table = dict->table;
+    for (struct rdict_node *cur = table->slots[slot_index(table, hash)]; cur; cur = cur->next) {
+        if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
+            void *old = cur->val;
+            DS_ATOMIC_STORE(&cur->val, val, DS_ATOMIC_RELEASE);
+            if ((old != val) && (dict->valfree)) {
+                retire(dict, RETIRE_VALUE, old);
+            }
+            end_write(dict);
+            pthread_mutex_unlock(&dict->lock);
+            return true;
+        }
+    }
+
+    if (((double)(dict->cnt + 1) / table->cap) > DSRDICT_LOAD) {
+        grow_table(dict);
+        table = dict->table;
+    }
+
+    struct rdict_node *node = slab_alloc(&dict->nodes);
+    if (!node) {
+        pthread_mutex_unlock(&dict->lock);
+        return false;
+    }
+
+    // The node is complete before it is published at the head of its chain
+    size_t i = slot_index(table, hash);
+    node->hash = hash;
+    node->key = key;
+    node->val = val;
+    node->next = table->slots[i];
+    DS_ATOMIC_STORE(&table->slots[i], node, DS_ATOMIC_RELEASE);
+    DS_ATOMIC_STORE(&dict->cnt, dict->cnt + 1, DS_ATOMIC_RELAXED);
+
+    end_write(dict);
+    pthread_mutex_unlock(&dict->lock);
+    return true;
+}
+
+bool dsrdict_del(DSReadDict *dict, void *key) {
+    if ((!dict) || (!key)) { return false; }
+
+    uint32_t hash = dict->hash(key);
+    pthread_mutex_lock(&dict->lock);
+
+    // Readers already on the removed node can still follow its next link
+    struct rdict_table *table = dict->table;
+    DS_ATOMIC(struct rdict_node *) *link = &table->slots[slot_index(table, hash)];
+    while (*link) {
+        struct rdict_node *cur = *link;
+        if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
+            DS_ATOMIC_STORE(link, cur->next, DS_ATOMIC_RELEASE);
+            DS_ATOMIC_STORE(&dict->cnt, dict->cnt - 1, DS_ATOMIC_RELAXED);
+            retire(dict, RETIRE_ENTRY, cur);
+            end_write(dict);
+            pthread_mutex_unlock(&dict->lock);
+            return true;
+        }
+        link = &cur->next;
+    }
+
+    pthread_mutex_unlock(&dict->lock);
+    return false;
+}
+
+void dsrdict_synchronize(DSReadDict *dict) {
+    if (!dict) { return; }
+
+    // Only memory retired before this call is waited for, so concurrent
+    // writers cannot keep the caller here indefinitely. The lock is not
+    // held while waiting, since readers may need it to finish up.
+    pthread_mutex_lock(&dict->lock);
+    end_write(dict);
+    uint64_t epoch = dict->epoch;
+    bool pending = retired_before(dict, epoch);
+    pthread_mutex_unlock(&dict->lock);
+
+    while (pending) {
+        sched_yield();
+        pthread_mutex_lock(&dict->lock);
+        reclaim(dict);
+        pending = retired_before(dict, epoch);
+        pthread_mutex_unlock(&dict->lock);
+    }
+}
+
+DSReadDictReader *dsrdict_reader_new(DSReadDict *dict) {
+    if (!dict) { return NULL; }
+
+    DSReadDictReader *reader = ds_alloc(&dict->alloc, sizeof(DSReadDictReader));
+    if (!reader) {
+        return NULL;
+    }
+
+    reader->epoch = 0;
+    reader->depth = 0;
+    reader->dict = dict;
+
+    pthread_mutex_lock(&dict->lock);
+    reader->next = dict->readers;
+    dict->readers = reader;
+    pthread_mutex_unlock(&dict->lock);
+    return reader;
+}
+
+void dsrdict_reader_destroy(DSReadDictReader *reader) {
+    if (!reader) { return; }
+    assert(reader->depth == 0);
+
+    DSReadDict *dict = reader->dict;
+    pthread_mutex_lock(&dict->lock);
+    DSReadDictReader **link = &dict->readers;
+    while (*link) {
+        if (*link == reader) {
+            *link = reader->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    pthread_mutex_unlock(&dict->lock);
+
+    ds_free(&dict->alloc, reader, sizeof(DSReadDictReader));
+}
+
+void dsrdict_read_begin(DSReadDictReader *reader) {
+    assert(reader);
+    if (reader->depth++ > 0) { return; }
+
+    // The fence orders the announcement before every load in the read
+    // section; it pairs with the fence writers issue before scanning
+    uint64_t epoch = DS_ATOMIC_LOAD(&reader->dict->epoch, DS_ATOMIC_ACQUIRE);
+    DS_ATOMIC_STORE(&reader->epoch, epoch, DS_ATOMIC_RELAXED);
+    DS_ATOMIC_FENCE(DS_ATOMIC_SEQ_CST);
+}
+
+void dsrdict_read_end(DSReadDictReader *reader) {
+    assert(reader);
+    assert(reader->depth > 0);
+    if (--reader->depth > 0) { return; }
+
+    DS_ATOMIC_STORE(&reader->epoch, 0, DS_ATOMIC_RELEASE);
+}
+
+void *dsrdict_get(DSReadDictReader *reader, void *key) {
+    if ((!reader) || (!key)) { return NULL; }
+
+    const DSReadDict *dict = reader->dict;
+    uint32_t hash = dict->hash(key);
+    void *val = NULL;
+
+    dsrdict_read_begin(reader);
+    struct rdict_table *table = DS_ATOMIC_LOAD(&dict->table, DS_ATOMIC_ACQUIRE);
+    struct rdict_node *cur = DS_ATOMIC_LOAD(&table->slots[slot_index(table, hash)], DS_ATOMIC_ACQUIRE);
+    while (cur) {
+        if ((cur->hash == hash) && (dict->cmp(cur->key, key) == 0)) {
+            val = DS_ATOMIC_LOAD(&cur->val, DS_ATOMIC_ACQUIRE);
+            break;
+        }
+        cur = DS_ATOMIC_LOAD(&cur->next, DS_ATOMIC_ACQUIRE);
+    }
+    dsrdict_read_end(reader);
+
+    return val;
+}
+
+void dsrdict_foreach(DSReadDictReader *reader, dsdict_foreach_fn func) {
+    if ((!reader) || (!func)) { return; }
+
+    dsrdict_read_begin(reader);
+    struct rdict_table *table = DS_ATOMIC_LOAD(&reader->dict->table, DS_ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < table->cap; i++) {
+        struct rdict_node *cur = DS_ATOMIC_LOAD(&table->slots[i], DS_ATOMIC_ACQUIRE);
+        while (cur) {
+            func(cur->key, DS_ATOMIC_LOAD(&cur->val, DS_ATOMIC_ACQUIRE));
+            cur = DS_ATOMIC_LOAD(&cur->next, DS_ATOMIC_ACQUIRE);
+        }
+    }
+    dsrdict_read_end(reader);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Allocate a new empty table with the given power of 2 capacity.
+static struct rdict_table *table_new(DSReadDict *dict, size_t cap) {
+    assert(dict);
+    assert((cap & (cap - 1)) == 0);
+
+    struct rdict_table *table = ds_calloc(&dict->alloc, 1, sizeof(struct rdict_table) + (cap * sizeof(DS_ATOMIC(struct rdict_node *))));
+    if (!table) {
+        return NULL;
+    }
+
+    table->cap = cap;
+    return table;
+}
+
+// Free a table and its nodes, and the keys and values of its nodes if
+// entries is given.
+static void table_free(DSReadDict *dict, struct rdict_table *table, bool entries) {
+    assert(dict);
+    assert(table);
+
+    for (size_t i = 0; i < table->cap; i++) {
+        struct rdict_node *cur = table->slots[i];
+        while (cur) {
+            struct rdict_node *next = cur->next;
+            if ((entries) && (dict->keyfree)) { dict->keyfree(cur->key); }
+            if ((entries) && (dict->valfree)) { dict->valfree(cur->val); }
+            slab_free(&dict->nodes, cur);
+            cur = next;
+        }
+    }
+
+    ds_free(&dict->alloc, table, sizeof(struct rdict_table) + (table->cap * sizeof(DS_ATOMIC(struct rdict_node *))));
+}
+
+// Publish a table twice the size of the current table. Readers may be
+// walking the chains of the current table, so every node is copied into
+// the new table rather than relinked, and the old table is retired whole.
+static bool grow_table(DSReadDict *dict) {
+    assert(dict);
+
+    struct rdict_table *old = dict->table;
+    struct rdict_table *table = table_new(dict, old->cap * 2);
+    if (!table) {
+        return false;
+    }
+
+    for (size_t i = 0; i < old->cap; i++) {
+        for (struct rdict_node *cur = old->slots[i]; cur; cur = cur->next) {
+            struct rdict_node *node = slab_alloc(&dict->nodes);
+            if (!node) {
+                table_free(dict, table, false);
+                return false;
+            }
+
+            size_t place = slot_index(table, cur->hash);
+            *node = *cur;
+            node->next = table->slots[place];
+            table->slots[place] = node;
+        }
+    }
+
+    DS_ATOMIC_STORE(&dict->table, table, DS_ATOMIC_RELEASE);
+    retire(dict, RETIRE_TABLE, old);
+    return true;
+}
+
+// Queue memory to be freed once no reader can be using it. If the queue
+// cannot grow, the memory is leaked rather than freed early.
+static void retire(DSReadDict *dict, enum RetireKind kind, void *ptr) {
+    assert(dict);
+
+    if (dict->nretired == dict->capretired) {
+        size_t newcap = (dict->capretired > 0) ? (dict->capretired * 2) : DSRDICT_RETIRED_CAP;
+        struct rdict_retired *retired = ds_realloc(&dict->alloc, dict->retired,
+                                                   dict->capretired * sizeof(struct rdict_retired),
+                                                   newcap * sizeof(struct rdict_retired));
+        if (!retired) {
+            return;
+        }
+        dict->retired = retired;
+        dict->capretired = newcap;
+    }
+
+    struct rdict_retired *item = &dict->retired[dict->nretired++];
+    item->kind = kind;
+    item->ptr = ptr;
+    item->epoch = dict->epoch;
+}
+
+// Finish a write by advancing the global epoch past everything retired
+// during the write, then free whatever no reader can still be using.
+static void end_write(DSReadDict *dict) {
+    assert(dict);
+
+    DS_ATOMIC_STORE(&dict->epoch, dict->epoch + 1, DS_ATOMIC_SEQ_CST);
+    DS_ATOMIC_FENCE(DS_ATOMIC_SEQ_CST);
+    if (dict->nretired > 0) {
+        reclaim(dict);
+    }
+}
+
+// Free every retired item older than the oldest epoch any reader is
+// currently reading in, and return the number of items left.
+static size_t reclaim(DSReadDict *dict) {
+    assert(dict);
+
+    uint64_t oldest = UINT64_MAX;
+    for (DSReadDictReader *reader = dict->readers; reader; reader = reader->next) {
+        uint64_t epoch = DS_ATOMIC_LOAD(&reader->epoch, DS_ATOMIC_ACQUIRE);
+        if ((epoch != 0) && (epoch < oldest)) {
+            oldest = epoch;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < dict->nretired; i++) {
+        if (dict->retired[i].epoch < oldest) {
+            free_retired(dict, &dict->retired[i]);
+        } else {
+            dict->retired[kept++] = dict->retired[i];
+        }
+    }
+
+    dict->nretired = kept;
+    return kept;
+}
+
+// Return true if any item retired before the given epoch is still waiting
+// to be freed.
+static bool retired_before(const DSReadDict *dict, uint64_t epoch) {
+    assert(dict);
+
+    for (size_t i = 0; i < dict->nretired; i++) {
+        if (dict->retired[i].epoch < epoch) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Free a single retired item.
+static void free_retired(DSReadDict *dict, struct rdict_retired *item) {
+    assert(dict);
+    assert(item);
+
+    switch (item->kind) {
+        case RETIRE_VALUE:
+            if (dict->valfree) { dict->valfree(item->ptr); }
+            break;
+        case RETIRE_ENTRY: {
+            struct rdict_node *node = item->ptr;
+            if (dict->keyfree) { dict->keyfree(node->key); }
+            if (dict->valfree) { dict->valfree(node->val); }
+            slab_free(&dict->nodes, node);
+            break;
+        }
+        case RETIRE_TABLE:
+            table_free(dict, item->ptr, false);
+            break;
+    }
+}
+
+// Select the slot for a hash in a power of 2 capacity table.
+static inline size_t slot_index(const struct rdict_table *table, uint32_t hash) {
+    return (size_t)dict_mix(hash) & (table->cap - 1);
+}
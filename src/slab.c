@@ -0,0 +1,167 @@
+/*****************************************************************************
+ * libds :: slab.c
+ *
+ * Fixed size node allocator shared by the linked container types.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include "allocpriv.h"
+#include "slabpriv.h"
+
+static const size_t SLAB_MIN_CHUNK = 32;
+static const size_t SLAB_MAX_CHUNK = 4096;
+
+struct slab_chunk {
+    struct slab_chunk *next;
+    size_t cap;
+};
+
+/*
+ * Round chunk headers up so the nodes which follow them are suitably
+ * aligned for any of the types stored in a node.
+ */
+union slab_header {
+    struct slab_chunk chunk;
+    void *ptr;
+    long double ld;
+};
+
+static bool add_chunk(struct slab *slab);
+
+/*
+ * SLAB FUNCTIONS
+ */
+
+// Initialize an empty slab for nodes of the given size.
+void slab_init(struct slab *slab, size_t size, const DSAllocator *alloc) {
+    assert(slab);
+    assert(size > 0);
+    assert(alloc);
+
+    // Freed nodes store the free list link in place
+    size_t align = sizeof(void *);
+    if (size < sizeof(void *)) { size = sizeof(void *); }
+    slab->size = ((size + align - 1) / align) * align;
+    slab->chunkcap = SLAB_MIN_CHUNK;
+    slab->chunks = NULL;
+    slab->next = NULL;
+    slab->end = NULL;
+    slab->free = NULL;
+    slab->alloc = alloc;
+}
+
+// Allocate a single node, or return NULL if memory could not be allocated.
+void *slab_alloc(struct slab *slab) {
+    assert(slab);
+
+    if (slab->free) {
+        void *obj = slab->free;
+        slab->free = *(void **)obj;
+        return obj;
+    }
+
+    if ((slab->next == slab->end) && (!add_chunk(slab))) {
+        return NULL;
+    }
+
+    void *obj = slab->next;
+    slab->next += slab->size;
+    return obj;
+}
+
+// Return a single node to the slab for reuse.
+void slab_free(struct slab *slab, void *obj) {
+    assert(slab);
+    if (!obj) { return; }
+
+    *(void **)obj = slab->free;
+    slab->free = obj;
+}
+
+// Free every chunk in the slab at once, invalidating every node.
+void slab_release(struct slab *slab) {
+    assert(slab);
+
+    struct slab_chunk *cur = slab->chunks;
+    while (cur) {
+        struct slab_chunk *next = cur->next;
+        ds_free(slab->alloc, cur, sizeof(union slab_header) + (cur->cap * slab->size));
+        cur = next;
+    }
+
+    slab_init(slab, slab->size, slab->alloc);
+}
+
+// Take ownership of every chunk (and so every live node) in other, which
+// is left empty. Both slabs must have been created for the same size
+// and with equivalent allocators.
+void slab_absorb(struct slab *slab, struct slab *other) {
+    assert(slab);
+    assert(other);
+    assert(slab->size == other->size);
+    assert(ds_alloc_same(slab->alloc, other->alloc));
+
+    if (!other->chunks) { return; }
+
+    struct slab_chunk *tail = other->chunks;
+    while (tail->next) {
+        tail = tail->next;
+    }
+    tail->next = slab->chunks;
+    slab->chunks = other->chunks;
+
+    // Free nodes from the other slab are still usable
+    while (other->free) {
+        void *obj = other->free;
+        other->free = *(void **)obj;
+        slab_free(slab, obj);
+    }
+
+    if (slab->chunkcap < other->chunkcap) {
+        slab->chunkcap = other->chunkcap;
+    }
+
+    slab_init(other, other->size, other->alloc);
+}
+
+// Return the number of bytes allocated for every chunk in the slab.
+size_t slab_bytes(const struct slab *slab) {
+    assert(slab);
+
+    size_t bytes = 0;
+    for (const struct slab_chunk *cur = slab->chunks; cur; cur = cur->next) {
+        bytes += sizeof(union slab_header) + (cur->cap * slab->size);
+    }
+    return bytes;
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Allocate a new chunk, doubling the chunk size up to a maximum.
+static bool add_chunk(struct slab *slab) {
+    assert(slab);
+
+    size_t cap = slab->chunkcap;
+    struct slab_chunk *chunk = ds_alloc(slab->alloc, sizeof(union slab_header) + (cap * slab->size));
+    if (!chunk) {
+        return false;
+    }
+
+    chunk->next = slab->chunks;
+    chunk->cap = cap;
+    slab->chunks = chunk;
+    slab->next = (char *)chunk + sizeof(union slab_header);
+    slab->end = slab->next + (cap * slab->size);
+
+    if (slab->chunkcap < SLAB_MAX_CHUNK) {
+        slab->chunkcap *= 2;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+/*****************************************************************************
+ * libds :: slabpriv.h
+ *
+ * Private header for the fixed size node allocator.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_SLABPRIV_H
+#define LIBDS_SLABPRIV_H
+
+#include <stddef.h>
+#include "libds/alloc.h"
+
+struct slab_chunk;
+
+/*
+ * Allocator for fixed size container nodes (such as dictionary buckets
+ * and list nodes). Nodes are carved out of progressively larger chunks
+ * and freed nodes are kept on a free list for reuse, so the general
+ * purpose allocator is only called once per chunk. Chunks are only
+ * returned when the whole slab is released.
+ *
+ * Chunks are allocated from the owning container's allocator, which must
+ * outlive the slab.
+ */
+struct slab {
+    size_t size;
+    size_t chunkcap;
+    struct slab_chunk *chunks;
+    char *next;
+    char *end;
+    void *free;
+    const DSAllocator *alloc;
+};
+
+void slab_init(struct slab *slab, size_t size, const DSAllocator *alloc);
+void *slab_alloc(struct slab *slab);
+void slab_free(struct slab *slab, void *obj);
+void slab_release(struct slab *slab);
+void slab_absorb(struct slab *slab, struct slab *other);
+size_t slab_bytes(const struct slab *slab);
+
+#endif //LIBDS_SLABPRIV_H
@@ -0,0 +1,351 @@
+/*****************************************************************************
+ * libds :: swiss.c
+ *
+ * Open addressing engine for the dictionary data structure.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SWISS_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+#include "allocpriv.h"
+#include "dictpriv.h"
+#include "swisspriv.h"
+
+static const uint8_t SWISS_CTRL_EMPTY = 0x80;
+static const uint8_t SWISS_CTRL_DELETED = 0xFE;
+static const uint8_t SWISS_H2_MASK = 0x7F;
+
+static inline uint32_t group_match(const uint8_t *group, uint8_t h2);
+static inline uint32_t group_match_empty(const uint8_t *group);
+static inline uint32_t group_match_free(const uint8_t *group);
+static inline unsigned int ctz32(uint32_t bits);
+static inline void set_ctrl(struct swiss *table, size_t i, uint8_t ctrl);
+static size_t find_free(const struct swiss *table, uint64_t mixed);
+
+/*
+ * OPEN ADDRESSING ENGINE FUNCTIONS
+ */
+
+// Allocate the control bytes and slots for a new table of the given capacity.
+bool swiss_init(struct swiss *table, size_t cap, const DSAllocator *alloc) {
+    assert(table);
+    assert(alloc);
+    assert(cap >= SWISS_GROUP_WIDTH);
+    assert((cap & (cap - 1)) == 0);
+
+    table->alloc = alloc;
+    table->ctrl = ds_alloc(alloc, cap + SWISS_GROUP_WIDTH);
+    if (!table->ctrl) {
+        return false;
+    }
+
+    table->slots = ds_alloc(alloc, cap * sizeof(struct swiss_slot));
+    if (!table->slots) {
+        ds_free(alloc, table->ctrl, cap + SWISS_GROUP_WIDTH);
+        table->ctrl = NULL;
+        return false;
+    }
+
+    memset(table->ctrl, SWISS_CTRL_EMPTY, cap + SWISS_GROUP_WIDTH);
+    table->cap = cap;
+    table->cnt = 0;
+    table->deleted = 0;
+    return true;
+}
+
+// Free the table storage, but do not free key/value pairs.
+void swiss_release(struct swiss *table) {
+    assert(table);
+    if (table->ctrl) {
+        ds_free(table->alloc, table->ctrl, table->cap + SWISS_GROUP_WIDTH);
+        ds_free(table->alloc, table->slots, table->cap * sizeof(struct swiss_slot));
+    }
+    table->ctrl = NULL;
+    table->slots = NULL;
+    table->cap = 0;
+    table->cnt = 0;
+    table->deleted = 0;
+}
+
+// Return the slot holding the given key or NULL if it is not in the table.
+struct swiss_slot *swiss_find(const struct swiss *table, uint64_t hash, void *key, dsdict_compare_fn cmp) {
+    return swiss_probe(table, hash, key, cmp, NULL);
+}
+
+// Return the slot holding the given key or NULL if it is not in the table.
+// If free_at is given, it is set to the index of the slot swiss_claim would
+// choose for the key (or the table capacity if the probe never passed a
+// free slot), so an insert after a failed lookup needs no second probe.
+struct swiss_slot *swiss_probe(const struct swiss *table, uint64_t hash, void *key, dsdict_compare_fn cmp, size_t *free_at) {
+    assert(table);
+    assert(cmp);
+
+    uint64_t mixed = dict_mix(hash);
+    uint8_t h2 = (uint8_t)(mixed & SWISS_H2_MASK);
+    size_t mask = table->cap - 1;
+    size_t pos = (size_t)(mixed >> 7) & mask;
+    if (free_at) { *free_at = table->cap; }
+
+    // Triangular probing over whole groups visits every group exactly
+    // once for power of two capacities
+    for (size_t step = SWISS_GROUP_WIDTH; step <= table->cap; step += SWISS_GROUP_WIDTH) {
+        const uint8_t *group = &table->ctrl[pos];
+        uint32_t match = group_match(group, h2);
+        while (match) {
+            size_t i = (pos + ctz32(match)) & mask;
+            struct swiss_slot *slot = &table->slots[i];
+            if ((slot->hash == hash) && (cmp(slot->key, key) == 0)) {
+                return slot;
+            }
+            match &= match - 1;
+        }
+
+        // The first free slot in the probe sequence is the one find_free
+        // would return for this hash
+        if ((free_at) && (*free_at == table->cap)) {
+            uint32_t avail = group_match_free(group);
+            if (avail) { *free_at = (pos + ctz32(avail)) & mask; }
+        }
+
+        // An empty control byte in this group means the key was never
+        // displaced any further than this
+        if (group_match_empty(group)) {
+            return NULL;
+        }
+        pos = (pos + step) & mask;
+    }
+
+    return NULL;
+}
+
+// Prefetch the first control group and slot which a lookup for the given
+// hash will read, so a later lookup does not stall on either of them.
+void swiss_prefetch(const struct swiss *table, uint64_t hash) {
+    assert(table);
+
+    uint64_t mixed = dict_mix(hash);
+    size_t pos = (size_t)(mixed >> 7) & (table->cap - 1);
+    DICT_PREFETCH(&table->ctrl[pos]);
+    DICT_PREFETCH(&table->slots[pos]);
+}
+
+// Claim a free slot for a key which is known not to be in the table. The
+// caller is responsible for filling in the key and data.
+struct swiss_slot *swiss_claim(struct swiss *table, uint64_t hash) {
+    assert(table);
+    return swiss_claim_at(table, hash, find_free(table, dict_mix(hash)));
+}
+
+// Claim the free slot at index i, which must have been returned by
+// swiss_probe for this hash with no changes to the table since.
+struct swiss_slot *swiss_claim_at(struct swiss *table, uint64_t hash, size_t i) {
+    assert(table);
+    assert((table->cnt + table->deleted) < table->cap);
+    assert(i < table->cap);
+
+    if (table->ctrl[i] == SWISS_CTRL_DELETED) {
+        table->deleted--;
+    }
+
+    set_ctrl(table, i, (uint8_t)(dict_mix(hash) & SWISS_H2_MASK));
+    table->cnt++;
+    table->slots[i].hash = hash;
+    return &table->slots[i];
+}
+
+// Remove the given slot from the table. The key and data are left to
+// the caller.
+void swiss_erase(struct swiss *table, struct swiss_slot *slot) {
+    assert(table);
+    assert(slot);
+
+    size_t mask = table->cap - 1;
+    size_t i = (size_t)(slot - table->slots);
+    assert(i < table->cap);
+
+    // If no group window covering this slot was ever completely full,
+    // no probe sequence can have passed over it and the slot may be
+    // returned to the empty state rather than left as a tombstone
+    uint32_t before = group_match_empty(&table->ctrl[(i - SWISS_GROUP_WIDTH) & mask]);
+    uint32_t after = group_match_empty(&table->ctrl[i]);
+    unsigned int lead = 0;
+    while ((lead < SWISS_GROUP_WIDTH) && !(before & (1u << (SWISS_GROUP_WIDTH - 1 - lead)))) {
+        lead++;
+    }
+    unsigned int trail = (after) ? ctz32(after) : SWISS_GROUP_WIDTH;
+
+    table->cnt--;
+    if ((lead + trail) < SWISS_GROUP_WIDTH) {
+        set_ctrl(table, i, SWISS_CTRL_EMPTY);
+    } else {
+        set_ctrl(table, i, SWISS_CTRL_DELETED);
+        table->deleted++;
+    }
+}
+
+// Move every element into a fresh table of the given capacity, which
+// also clears out any tombstones left by deletions.
+bool swiss_rehash(struct swiss *table, size_t newcap) {
+    assert(table);
+    assert(newcap > table->cnt);
+
+    struct swiss fresh;
+    if (!swiss_init(&fresh, newcap, table->alloc)) {
+        return false;
+    }
+
+    for (size_t i = swiss_next(table, 0); i < table->cap; i = swiss_next(table, i + 1)) {
+        struct swiss_slot *old = &table->slots[i];
+        uint64_t mixed = dict_mix(old->hash);
+        size_t place = find_free(&fresh, mixed);
+        set_ctrl(&fresh, place, (uint8_t)(mixed & SWISS_H2_MASK));
+        fresh.slots[place] = *old;
+        fresh.cnt++;
+    }
+
+    swiss_release(table);
+    *table = fresh;
+    return true;
+}
+
+// Return the index of the first occupied slot at or after from, or the
+// table capacity if there are no more occupied slots.
+size_t swiss_next(const struct swiss *table, size_t from) {
+    assert(table);
+
+    for (size_t i = from; i < table->cap; i++) {
+        if (!(table->ctrl[i] & SWISS_CTRL_EMPTY)) {
+            return i;
+        }
+    }
+
+    return table->cap;
+}
+
+// Record the probe length of every element and the size of the table in
+// a DSDictStats. Probe lengths are counted in groups.
+void swiss_stats(const struct swiss *table, DSDictStats *stats) {
+    assert(table);
+    assert(stats);
+
+    size_t mask = table->cap - 1;
+    size_t total = 0;
+    for (size_t i = 0; i < table->cap; i++) {
+        if (table->ctrl[i] & SWISS_CTRL_EMPTY) { continue; }
+
+        // Replay the probe sequence for this element until the group
+        // which holds it
+        size_t pos = (size_t)(dict_mix(table->slots[i].hash) >> 7) & mask;
+        size_t len = 1;
+        for (size_t step = SWISS_GROUP_WIDTH; step <= table->cap; step += SWISS_GROUP_WIDTH) {
+            if (((i - pos) & mask) < SWISS_GROUP_WIDTH) { break; }
+            pos = (pos + step) & mask;
+            len++;
+        }
+
+        dict_stats_record(stats, len);
+        total += len;
+    }
+
+    stats->occupied = table->cnt;
+    stats->deleted = table->deleted;
+    stats->mean_chain = (table->cnt > 0) ? ((double)total / table->cnt) : 0.0;
+    stats->table_bytes = (table->cap + SWISS_GROUP_WIDTH) + (table->cap * sizeof(struct swiss_slot));
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+#ifdef SWISS_USE_SSE2
+
+// Return a bitmask of the control bytes in the group matching h2.
+static inline uint32_t group_match(const uint8_t *group, uint8_t h2) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    __m128i match = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2));
+    return (uint32_t)_mm_movemask_epi8(match);
+}
+
+// Return a bitmask of the empty control bytes in the group.
+static inline uint32_t group_match_empty(const uint8_t *group) {
+    return group_match(group, SWISS_CTRL_EMPTY);
+}
+
+// Return a bitmask of the empty or deleted control bytes in the group.
+static inline uint32_t group_match_free(const uint8_t *group) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(ctrl);
+}
+
+#else
+
+// Return a bitmask of the control bytes in the group matching h2.
+static inline uint32_t group_match(const uint8_t *group, uint8_t h2) {
+    uint32_t match = 0;
+    for (unsigned int i = 0; i < SWISS_GROUP_WIDTH; i++) {
+        if (group[i] == h2) { match |= (1u << i); }
+    }
+    return match;
+}
+
+// Return a bitmask of the empty control bytes in the group.
+static inline uint32_t group_match_empty(const uint8_t *group) {
+    return group_match(group, SWISS_CTRL_EMPTY);
+}
+
+// Return a bitmask of the empty or deleted control bytes in the group.
+static inline uint32_t group_match_free(const uint8_t *group) {
+    uint32_t match = 0;
+    for (unsigned int i = 0; i < SWISS_GROUP_WIDTH; i++) {
+        if (group[i] & SWISS_CTRL_EMPTY) { match |= (1u << i); }
+    }
+    return match;
+}
+
+#endif
+
+// Count the trailing zero bits in a non-zero group bitmask.
+static inline unsigned int ctz32(uint32_t bits) {
+    assert(bits);
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctz(bits);
+#else
+    unsigned int n = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Set a control byte, keeping the mirrored bytes after the table in sync.
+static inline void set_ctrl(struct swiss *table, size_t i, uint8_t ctrl) {
+    table->ctrl[i] = ctrl;
+    if (i < SWISS_GROUP_WIDTH) {
+        table->ctrl[table->cap + i] = ctrl;
+    }
+}
+
+// Find the first empty or deleted slot in the probe sequence for a hash.
+static size_t find_free(const struct swiss *table, uint64_t mixed) {
+    size_t mask = table->cap - 1;
+    size_t pos = (size_t)(mixed >> 7) & mask;
+
+    for (size_t step = SWISS_GROUP_WIDTH; ; step += SWISS_GROUP_WIDTH) {
+        uint32_t match = group_match_free(&table->ctrl[pos]);
+        if (match) {
+            return (pos + ctz32(match)) & mask;
+        }
+        pos = (pos + step) & mask;
+    }
+}
@@ -0,0 +1,65 @@
+/*****************************************************************************
+ * libds :: swisspriv.h
+ *
+ * Private header for the open addressing dictionary engine.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_SWISSPRIV_H
+#define LIBDS_SWISSPRIV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "libds/alloc.h"
+#include "libds/dict.h"
+
+/*
+ * Number of control bytes examined in a single probe step. Capacities
+ * for the open addressing table are always a power of two which is at
+ * least this wide.
+ */
+#define SWISS_GROUP_WIDTH 16
+
+struct swiss_slot {
+    uint64_t hash;
+    void *key;
+    void *data;
+};
+
+/*
+ * Open addressing table in the style of the Abseil "Swiss table".
+ *
+ * Each slot has a single metadata byte in ctrl which is either empty,
+ * deleted or holds the low 7 bits of the mixed key hash. Lookups scan
+ * a full group of control bytes at once and only touch the slot array
+ * for control bytes which match. The first SWISS_GROUP_WIDTH control
+ * bytes are mirrored after the end of the array so group loads never
+ * need to wrap around. Storage comes from the owning dictionary's
+ * allocator, which must outlive the table.
+ */
+struct swiss {
+    uint8_t *ctrl;
+    struct swiss_slot *slots;
+    size_t cap;
+    size_t cnt;
+    size_t deleted;
+    const DSAllocator *alloc;
+};
+
+bool swiss_init(struct swiss *table, size_t cap, const DSAllocator *alloc);
+void swiss_release(struct swiss *table);
+struct swiss_slot *swiss_find(const struct swiss *table, uint64_t hash, void *key, dsdict_compare_fn cmp);
+struct swiss_slot *swiss_probe(const struct swiss *table, uint64_t hash, void *key, dsdict_compare_fn cmp, size_t *free_at);
+void swiss_prefetch(const struct swiss *table, uint64_t hash);
+struct swiss_slot *swiss_claim(struct swiss *table, uint64_t hash);
+struct swiss_slot *swiss_claim_at(struct swiss *table, uint64_t hash, size_t i);
+void swiss_erase(struct swiss *table, struct swiss_slot *slot);
+bool swiss_rehash(struct swiss *table, size_t newcap);
+size_t swiss_next(const struct swiss *table, size_t from);
+void swiss_stats(const struct swiss *table, DSDictStats *stats);
+
+#endif //LIBDS_SWISSPRIV_H
@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * libds :: arena_test.c
+ *
+ * Test functions for DSArena.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/CUnit.h"
+#include "libds/arena.h"
+#include "libds/array.h"
+#include "libds/buffer.h"
+#include "libds/dict.h"
+#include "libds/list.h"
+#include "arena_test.h"
+
+static DSArena *arena_test = NULL;
+
+void arena_test_setup(void) {
+    arena_test = dsarena_new(4096);
+    CU_ASSERT_FATAL(arena_test != NULL);
+}
+
+void arena_test_teardown(void) {
+    dsarena_destroy(arena_test);
+    arena_test = NULL;
+}
+
+void arena_test_alloc(void) {
+    const DSAllocator *alloc = dsarena_allocator(arena_test);
+    CU_ASSERT_FATAL(alloc != NULL);
+    CU_ASSERT(dsarena_used(arena_test) == 0);
+
+    /* Allocations are aligned and do not overlap */
+    char *first = alloc->alloc(alloc->ctx, 3);
+    char *second = alloc->alloc(alloc->ctx, 40);
+    CU_ASSERT_FATAL((first != NULL) && (second != NULL));
+    CU_ASSERT(((uintptr_t)first % sizeof(void *)) == 0);
+    CU_ASSERT(((uintptr_t)second % sizeof(void *)) == 0);
+    CU_ASSERT(second >= first + 3);
+    memset(first, 'a', 3);
+    memset(second, 'b', 40);
+    CU_ASSERT(first[2] == 'a');
+
+    /* Only the most recent allocation is reclaimed by a free */
+    size_t used = dsarena_used(arena_test);
+    alloc->free(alloc->ctx, first, 3);
+    CU_ASSERT(dsarena_used(arena_test) == used);
+    alloc->free(alloc->ctx, second, 40);
+    CU_ASSERT(dsarena_used(arena_test) < used);
+    CU_ASSERT(alloc->alloc(alloc->ctx, 40) == second);
+
+    /* Allocations spill over into new blocks, and large ones get their own */
+    for (int i = 0; i < 100; i++) {
+        char *ptr = alloc->alloc(alloc->ctx, 200);
+        CU_ASSERT_FATAL(ptr != NULL);
+        memset(ptr, 'c', 200);
+    }
+    char *large = alloc->alloc(alloc->ctx, 10000);
+    CU_ASSERT_FATAL(large != NULL);
+    memset(large, 'd', 10000);
+    CU_ASSERT(dsarena_used(arena_test) >= 30000);
+}
+
+void arena_test_realloc(void) {
+    const DSAllocator *alloc = dsarena_allocator(arena_test);
+
+    /* The last allocation grows in place */
+    char *ptr = alloc->alloc(alloc->ctx, 16);
+    CU_ASSERT_FATAL(ptr != NULL);
+    strcpy(ptr, "Hello");
+    char *grown = alloc->realloc(alloc->ctx, ptr, 16, 64);
+    CU_ASSERT(grown == ptr);
+
+    /* Older allocations are copied */
+    char *other = alloc->alloc(alloc->ctx, 8);
+    CU_ASSERT_FATAL(other != NULL);
+    char *moved = alloc->realloc(alloc->ctx, grown, 64, 128);
+    CU_ASSERT_FATAL(moved != NULL);
+    CU_ASSERT(moved != grown);
+    CU_ASSERT(strcmp(moved, "Hello") == 0);
+
+    /* Growing past the block size moves into a dedicated block */
+    char *big = alloc->realloc(alloc->ctx, moved, 128, 8192);
+    CU_ASSERT_FATAL(big != NULL);
+    CU_ASSERT(strcmp(big, "Hello") == 0);
+}
+
+void arena_test_containers(void) {
+    const DSAllocator *alloc = dsarena_allocator(arena_test);
+
+    for (int round = 0; round < 3; round++) {
+        DSArray *array = dsarray_new_alloc(4, NULL, NULL, alloc);
+        DSList *list = dslist_new_alloc(NULL, NULL, alloc);
+        DSDict *dict = dsdict_new_alloc((dsdict_hash_fn) dsbuf_hash,
+                                        (dsdict_compare_fn) dsbuf_compare,
+                                        NULL, NULL, DSDICT_CHAINED, alloc);
+        CU_ASSERT_FATAL((array != NULL) && (list != NULL) && (dict != NULL));
+
+        /* Keys are owned by the arena too, so nothing needs to be freed */
+        for (int i = 0; i < 200; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            DSBuffer *buf = dsbuf_new_buffer_alloc(0, alloc);
+            CU_ASSERT_FATAL(buf != NULL);
+            CU_ASSERT(dsbuf_append_str(buf, key) == true);
+            CU_ASSERT(dsarray_append(array, buf) == true);
+            CU_ASSERT(dslist_append(list, buf) == true);
+            dsdict_put(dict, buf, buf);
+        }
+
+        CU_ASSERT(dsarray_len(array) == 200);
+        CU_ASSERT(dslist_len(list) == 200);
+        CU_ASSERT(dsdict_count(dict) == 200);
+        DSBuffer *probe = dsarray_get(array, 123);
+        CU_ASSERT(dsbuf_equals_char(probe, "Key 123"));
+        CU_ASSERT(dsdict_get(dict, probe) == probe);
+        CU_ASSERT(dslist_get(list, 123) == probe);
+
+        /* Reclaim every container at once */
+        CU_ASSERT(dsarena_used(arena_test) > 0);
+        dsarena_reset(arena_test);
+        CU_ASSERT(dsarena_used(arena_test) == 0);
+    }
+}
+
+void arena_test_reset(void) {
+    const DSAllocator *alloc = dsarena_allocator(arena_test);
+
+    /* A reset arena reuses its memory for new allocations */
+    char *first = alloc->alloc(alloc->ctx, 64);
+    CU_ASSERT_FATAL(first != NULL);
+    CU_ASSERT(alloc->alloc(alloc->ctx, 10000) != NULL);
+    dsarena_reset(arena_test);
+    CU_ASSERT(dsarena_used(arena_test) == 0);
+    CU_ASSERT(alloc->alloc(alloc->ctx, 64) == first);
+
+    /* Resetting twice or resetting an empty arena is harmless */
+    dsarena_reset(arena_test);
+    dsarena_reset(arena_test);
+    CU_ASSERT(dsarena_used(arena_test) == 0);
+}
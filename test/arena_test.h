@@ -0,0 +1,21 @@
+/*****************************************************************************
+ * libds :: arena_test.h
+ *
+ * Test functions for DSArena.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_ARENA_TEST_H
+#define LIBDS_ARENA_TEST_H
+
+void arena_test_setup(void);
+void arena_test_teardown(void);
+void arena_test_alloc(void);
+void arena_test_realloc(void);
+void arena_test_containers(void);
+void arena_test_reset(void);
+
+#endif //LIBDS_ARENA_TEST_H
@@ -8,10 +8,17 @@
  * License: MIT (see LICENSE document at source tree root)
  *****************************************************************************/
 
+#include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "CUnit/CUnit.h"
 #include "libds/buffer.h"
+#include "libds/dict.h"
+#include "libds/hash.h"
 #include "buffer_test.h"
 
 static DSBuffer *buf_test = NULL;
@@ -215,6 +222,130 @@ void buf_test_compare(void) {
     dsbuf_destroy(buf2);
 }
 
+void buf_test_running_hash(void) {
+    CU_ASSERT(dsbuf_append_str(buf_test, "prefix before tracking") == true);
+    CU_ASSERT(dsbuf_track_hash(buf_test, 7) == true);
+
+    /* Appended pieces of every size keep the hash up to date */
+    DSBuffer *piece = dsbuf_new("a piece appended from another buffer");
+    CU_ASSERT_FATAL(piece != NULL);
+    for (int i = 0; i < 200; i++) {
+        switch (i % 3) {
+            case 0:
+                CU_ASSERT(dsbuf_append_char(buf_test, 'a' + (i % 26)) == true);
+                break;
+            case 1:
+                CU_ASSERT(dsbuf_append_str(buf_test, "some longer string contents which span a block") == true);
+                break;
+            default:
+                CU_ASSERT(dsbuf_append(buf_test, piece) == true);
+                break;
+        }
+        const char *str = dsbuf_char_ptr(buf_test);
+        CU_ASSERT(dsbuf_running_hash(buf_test) == hash_wyhash(str, dsbuf_len(buf_test), 7));
+    }
+    dsbuf_destroy(piece);
+
+    /* Copies continue the running hash independently */
+    DSBuffer *dup = dsbuf_dup(buf_test);
+    CU_ASSERT_FATAL(dup != NULL);
+    CU_ASSERT(dsbuf_append_char(dup, 'z') == true);
+    CU_ASSERT(dsbuf_running_hash(dup) == hash_wyhash(dsbuf_char_ptr(dup), dsbuf_len(dup), 7));
+    CU_ASSERT(dsbuf_running_hash(buf_test) == hash_wyhash(dsbuf_char_ptr(buf_test), dsbuf_len(buf_test), 7));
+    dsbuf_destroy(dup);
+
+    /* Untracked buffers are hashed on demand */
+    DSBuffer *plain = dsbuf_new("untracked");
+    CU_ASSERT_FATAL(plain != NULL);
+    CU_ASSERT(dsbuf_running_hash(plain) == hash_wyhash("untracked", strlen("untracked"), 0));
+    dsbuf_destroy(plain);
+}
+
+void buf_test_hash_cache(void) {
+    /* Hashes cover the whole buffer, not just up to the first NUL */
+    DSBuffer *left = dsbuf_new_l("ab\0cd", 5);
+    DSBuffer *right = dsbuf_new_l("ab\0ce", 5);
+    CU_ASSERT_FATAL((left != NULL) && (right != NULL));
+    CU_ASSERT(dsbuf_hash(left) == (unsigned int)hash_wyhash("ab\0cd", 5, 0));
+    CU_ASSERT(dsbuf_hash(left) != dsbuf_hash(right));
+    CU_ASSERT(dsbuf_dict_compare(left, right) != 0);
+
+    /* Mutating a buffer invalidates the cached hash */
+    unsigned int before = dsbuf_hash(buf_test);
+    CU_ASSERT(dsbuf_append_char(buf_test, 'x') == true);
+    CU_ASSERT(dsbuf_hash(buf_test) != before);
+    CU_ASSERT(dsbuf_append_str(buf_test, "yz") == true);
+    CU_ASSERT(dsbuf_dict_hash(buf_test) == (uint32_t)hash_wyhash("xyz", 3, 0));
+    CU_ASSERT(dsbuf_append(buf_test, left) == true);
+    CU_ASSERT(dsbuf_dict_hash(buf_test) == (uint32_t)hash_wyhash("xyzab\0cd", 8, 0));
+
+    /* Equal buffers compare equal, and copies keep the cached hash */
+    DSBuffer *dup = dsbuf_dup(buf_test);
+    CU_ASSERT_FATAL(dup != NULL);
+    CU_ASSERT(dsbuf_dict_compare(dup, buf_test) == 0);
+    CU_ASSERT(dsbuf_dict_compare(dup, left) == -dsbuf_dict_compare(left, dup));
+    CU_ASSERT(dsbuf_dict_compare(NULL, dup) == INT_MIN);
+    dsbuf_destroy(dup);
+
+    /* The adapters can be used as dictionary functions without casts */
+    DSDict *dict = dsdict_new(dsbuf_dict_hash, dsbuf_dict_compare, NULL, NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    dsdict_put(dict, left, right);
+    dsdict_put(dict, right, left);
+    DSBuffer *probe = dsbuf_new_l("ab\0cd", 5);
+    CU_ASSERT_FATAL(probe != NULL);
+    CU_ASSERT(dsdict_get(dict, probe) == right);
+    CU_ASSERT(dsdict_count(dict) == 2);
+    dsdict_destroy(dict);
+
+    dsbuf_destroy(probe);
+    dsbuf_destroy(left);
+    dsbuf_destroy(right);
+}
+
+enum { BUF_TEST_THREADS = 4, BUF_TEST_KEYS = 64 };
+
+static void *buf_test_hash_worker(void *arg);
+
+void buf_test_hash_threads(void) {
+    /* Fresh buffers are hashed for the first time by every thread at once */
+    DSBuffer *keys[BUF_TEST_KEYS];
+    for (int i = 0; i < BUF_TEST_KEYS; i++) {
+        char key[32];
+        sprintf(key, "Concurrent Key %d", i);
+        keys[i] = dsbuf_new(key);
+        CU_ASSERT_FATAL(keys[i] != NULL);
+    }
+
+    pthread_t threads[BUF_TEST_THREADS];
+    for (int t = 0; t < BUF_TEST_THREADS; t++) {
+        CU_ASSERT_FATAL(pthread_create(&threads[t], NULL, buf_test_hash_worker, keys) == 0);
+    }
+    for (int t = 0; t < BUF_TEST_THREADS; t++) {
+        void *errors;
+        pthread_join(threads[t], &errors);
+        CU_ASSERT(errors == NULL);
+    }
+
+    for (int i = 0; i < BUF_TEST_KEYS; i++) {
+        dsbuf_destroy(keys[i]);
+    }
+}
+
+// Hash and compare every key, returning a non-NULL pointer on any
+// mismatch.
+static void *buf_test_hash_worker(void *arg) {
+    DSBuffer **keys = arg;
+    uintptr_t errors = 0;
+    for (int i = 0; i < BUF_TEST_KEYS; i++) {
+        uint32_t expected = (uint32_t)hash_wyhash(dsbuf_char_ptr(keys[i]), dsbuf_len(keys[i]), 0);
+        if (dsbuf_dict_hash(keys[i]) != expected) { errors++; }
+        if (dsbuf_dict_compare(keys[i], keys[i]) != 0) { errors++; }
+        if (dsbuf_dict_compare(keys[i], keys[(i + 1) % BUF_TEST_KEYS]) == 0) { errors++; }
+    }
+    return (void *)errors;
+}
+
 void buf_test_compare_utf8(void) {
     // TODO: finish writing this once a library is decided on
 }
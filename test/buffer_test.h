@@ -23,6 +23,9 @@ void buf_test_equals(void);
 void buf_test_equals_char(void);
 void buf_test_to_char_array(void);
 void buf_test_compare(void);
+void buf_test_running_hash(void);
+void buf_test_hash_cache(void);
+void buf_test_hash_threads(void);
 void buf_test_compare_utf8(void);
 
 #endif //LIBDS_BUFFER_TEST_H
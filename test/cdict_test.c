@@ -0,0 +1,318 @@
+/*****************************************************************************
+ * libds :: cdict_test.c
+ *
+ * Test functions for concurrent dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "CUnit/CUnit.h"
+#include "libds/buffer.h"
+#include "libds/cdict.h"
+#include "cdict_test.h"
+
+enum { CDICT_TEST_THREADS = 8, CDICT_TEST_KEYS = 2000 };
+
+struct cdict_test_worker {
+    DSConcurrentDict *dict;
+    int *keys;
+    int id;
+    size_t errors;
+};
+
+struct cdict_test_counts {
+    size_t allocs;
+    size_t frees;
+    size_t live;
+    bool fail;
+};
+
+static uint32_t cdict_test_hash(void *key);
+static int cdict_test_compare(const void *left, const void *right);
+static void *cdict_test_increment(void *val, void *ctx);
+static void *cdict_test_worker(void *arg);
+static void *cdict_test_alloc(void *ctx, size_t size);
+static void *cdict_test_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+static void cdict_test_free(void *ctx, void *ptr, size_t size);
+
+void cdict_test_basic(void) {
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING, DSDICT_INCREMENTAL_RESIZE };
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSConcurrentDict *dict = dscdict_new(dsbuf_dict_hash, dsbuf_dict_compare,
+                                             NULL, (dsdict_free_fn) dsbuf_destroy,
+                                             flags[f], 5);
+        CU_ASSERT_FATAL(dict != NULL);
+        CU_ASSERT(dscdict_shards(dict) == 8);
+        CU_ASSERT(dscdict_count(dict) == 0);
+
+        DSBuffer *keys[500];
+        for (int i = 0; i < 500; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            keys[i] = dsbuf_new(key);
+            CU_ASSERT_FATAL(keys[i] != NULL);
+            dscdict_put(dict, keys[i], dsbuf_new(key));
+        }
+        CU_ASSERT(dscdict_count(dict) == 500);
+
+        for (int i = 0; i < 500; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            DSBuffer *probe = dsbuf_new(key);
+            CU_ASSERT_FATAL(probe != NULL);
+            DSBuffer *val = dscdict_get(dict, probe);
+            CU_ASSERT_FATAL(val != NULL);
+            CU_ASSERT(dsbuf_equals_char(val, key));
+            if (i % 2 == 1) {
+                CU_ASSERT(dscdict_del(dict, probe) == val);
+                CU_ASSERT(dscdict_get(dict, probe) == NULL);
+                dsbuf_destroy(val);
+            }
+            dsbuf_destroy(probe);
+        }
+        CU_ASSERT(dscdict_count(dict) == 250);
+
+        CU_ASSERT(dscdict_get(dict, NULL) == NULL);
+        CU_ASSERT(dscdict_del(dict, NULL) == NULL);
+        CU_ASSERT(!dscdict_update(dict, NULL, NULL, NULL));
+        dscdict_destroy(dict);
+        for (int i = 0; i < 500; i++) {
+            dsbuf_destroy(keys[i]);
+        }
+    }
+
+    CU_ASSERT(dscdict_new(NULL, dsbuf_dict_compare, NULL, NULL, 0, 0) == NULL);
+    DSConcurrentDict *dict = dscdict_new(dsbuf_dict_hash, dsbuf_dict_compare, NULL, NULL, 0, 0);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dscdict_shards(dict) == DSCDICT_DEFAULT_SHARDS);
+    dscdict_destroy(dict);
+}
+
+void cdict_test_threads(void) {
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING, DSDICT_INCREMENTAL_RESIZE };
+    static int keys[CDICT_TEST_KEYS];
+    for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+        keys[i] = i;
+    }
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSConcurrentDict *dict = dscdict_new(cdict_test_hash, cdict_test_compare,
+                                             NULL, NULL, flags[f], 4);
+        CU_ASSERT_FATAL(dict != NULL);
+
+        // Every thread increments every counter once, and also puts,
+        // reads and deletes keys of its own
+        pthread_t threads[CDICT_TEST_THREADS];
+        struct cdict_test_worker workers[CDICT_TEST_THREADS];
+        for (int t = 0; t < CDICT_TEST_THREADS; t++) {
+            workers[t].dict = dict;
+            workers[t].keys = keys;
+            workers[t].id = t;
+            workers[t].errors = 0;
+            CU_ASSERT_FATAL(pthread_create(&threads[t], NULL, cdict_test_worker, &workers[t]) == 0);
+        }
+        for (int t = 0; t < CDICT_TEST_THREADS; t++) {
+            pthread_join(threads[t], NULL);
+            CU_ASSERT(workers[t].errors == 0);
+        }
+
+        CU_ASSERT(dscdict_count(dict) == CDICT_TEST_KEYS);
+        for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+            CU_ASSERT((uintptr_t)dscdict_get(dict, &keys[i]) == CDICT_TEST_THREADS);
+        }
+        dscdict_destroy(dict);
+    }
+}
+
+void cdict_test_iter(void) {
+    static int keys[CDICT_TEST_KEYS];
+    for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+        keys[i] = i;
+    }
+
+    DSConcurrentDict *dict = dscdict_new(cdict_test_hash, cdict_test_compare, NULL, NULL, 0, 16);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+        dscdict_put(dict, &keys[i], &keys[i]);
+    }
+
+    DSIter *iter = dscdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    for (int pass = 0; pass < 2; pass++) {
+        // Deleting during iteration is safe, since shards are copied
+        static bool seen[CDICT_TEST_KEYS];
+        for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+            seen[i] = false;
+        }
+
+        size_t n = 0;
+        while (dsiter_next(iter)) {
+            int *key = dsiter_key(iter);
+            CU_ASSERT_FATAL(key != NULL);
+            CU_ASSERT(dsiter_value(iter) == key);
+            CU_ASSERT(dsiter_index(iter) == n);
+            CU_ASSERT(!seen[*key]);
+            seen[*key] = true;
+            if (pass == 0) {
+                dscdict_del(dict, key);
+            }
+            n++;
+        }
+        CU_ASSERT(n == CDICT_TEST_KEYS);
+        CU_ASSERT(!dsiter_has_next(iter));
+        CU_ASSERT(dsiter_key(iter) == NULL);
+
+        // Put everything back and iterate again from the start
+        if (pass == 0) {
+            CU_ASSERT(dscdict_count(dict) == 0);
+            for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+                dscdict_put(dict, &keys[i], &keys[i]);
+            }
+        }
+        dsiter_reset(iter);
+    }
+
+    dsiter_destroy(iter);
+    dscdict_destroy(dict);
+}
+
+void cdict_test_allocator(void) {
+    static int keys[CDICT_TEST_KEYS];
+    for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+        keys[i] = i;
+    }
+
+    // Shards, their dictionaries and iterator snapshots all come from
+    // the given allocator
+    struct cdict_test_counts counts = { 0, 0, 0, false };
+    DSAllocator alloc = { cdict_test_alloc, NULL, cdict_test_realloc, cdict_test_free, &counts };
+    DSConcurrentDict *dict = dscdict_new_alloc(cdict_test_hash, cdict_test_compare,
+                                               NULL, NULL, 0, 8, &alloc);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+        dscdict_put(dict, &keys[i], &keys[i]);
+    }
+    CU_ASSERT(dscdict_count(dict) == CDICT_TEST_KEYS);
+
+    size_t before = counts.allocs;
+    DSIter *iter = dscdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    size_t n = 0;
+    while (dsiter_next(iter)) {
+        n++;
+    }
+    CU_ASSERT(n == CDICT_TEST_KEYS);
+    CU_ASSERT(counts.allocs > before + 1);
+    CU_ASSERT(!dsiter_error(iter));
+    dsiter_destroy(iter);
+
+    // An iterator which cannot copy a shard reports an error rather than
+    // appearing to reach the end, until it is reset
+    iter = dscdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    counts.fail = true;
+    CU_ASSERT(!dsiter_next(iter));
+    CU_ASSERT(dsiter_error(iter));
+    counts.fail = false;
+    CU_ASSERT(!dsiter_next(iter));
+    dsiter_reset(iter);
+    CU_ASSERT(!dsiter_error(iter));
+    n = 0;
+    while (dsiter_next(iter)) {
+        n++;
+    }
+    CU_ASSERT(n == CDICT_TEST_KEYS);
+    CU_ASSERT(!dsiter_error(iter));
+    dsiter_destroy(iter);
+
+    dscdict_destroy(dict);
+    CU_ASSERT(counts.allocs == counts.frees);
+    CU_ASSERT(counts.live == 0);
+
+    DSAllocator invalid = { NULL, NULL, NULL, NULL, NULL };
+    CU_ASSERT(dscdict_new_alloc(cdict_test_hash, cdict_test_compare, NULL, NULL, 0, 8, &invalid) == NULL);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+static uint32_t cdict_test_hash(void *key) {
+    return (uint32_t)(*(int *)key) * 2654435761u;
+}
+
+static int cdict_test_compare(const void *left, const void *right) {
+    return *(const int *)left - *(const int *)right;
+}
+
+// Update function which increments a counter value.
+static void *cdict_test_increment(void *val, void *ctx) {
+    (void)ctx;
+    return (void *)((uintptr_t)val + 1);
+}
+
+// Run a mix of operations on a shared dictionary from one thread.
+static void *cdict_test_worker(void *arg) {
+    struct cdict_test_worker *worker = arg;
+    int own[64];
+    for (int i = 0; i < 64; i++) {
+        own[i] = CDICT_TEST_KEYS + (worker->id * 64) + i;
+    }
+
+    for (int i = 0; i < CDICT_TEST_KEYS; i++) {
+        int k = (i + (worker->id * 97)) % CDICT_TEST_KEYS;
+        if (!dscdict_update(worker->dict, &worker->keys[k], cdict_test_increment, NULL)) {
+            worker->errors++;
+        }
+
+        int *mine = &own[i % 64];
+        dscdict_put(worker->dict, mine, mine);
+        if (dscdict_get(worker->dict, mine) != mine) {
+            worker->errors++;
+        }
+        if (dscdict_del(worker->dict, mine) != mine) {
+            worker->errors++;
+        }
+    }
+
+    return NULL;
+}
+
+// Counting allocator which tracks the number of live bytes allocated,
+// using the sizes passed back in by the dictionary, and which fails
+// every allocation while fail is set.
+static void *cdict_test_alloc(void *ctx, size_t size) {
+    struct cdict_test_counts *counts = ctx;
+    if (counts->fail) { return NULL; }
+    counts->allocs++;
+    counts->live += size;
+    return malloc(size);
+}
+
+static void *cdict_test_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+    struct cdict_test_counts *counts = ctx;
+    if (counts->fail) { return NULL; }
+    if (!ptr) {
+        return cdict_test_alloc(ctx, newsize);
+    }
+    void *resized = realloc(ptr, newsize);
+    if (resized) {
+        counts->live = counts->live - oldsize + newsize;
+    }
+    return resized;
+}
+
+static void cdict_test_free(void *ctx, void *ptr, size_t size) {
+    struct cdict_test_counts *counts = ctx;
+    counts->frees++;
+    counts->live -= size;
+    free(ptr);
+}
@@ -0,0 +1,19 @@
+/*****************************************************************************
+ * libds :: cdict_test.h
+ *
+ * Test functions for concurrent dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_CDICT_TEST_H
+#define LIBDS_CDICT_TEST_H
+
+void cdict_test_basic(void);
+void cdict_test_threads(void);
+void cdict_test_iter(void);
+void cdict_test_allocator(void);
+
+#endif //LIBDS_CDICT_TEST_H
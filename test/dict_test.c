@@ -10,6 +10,7 @@
 
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "CUnit/CUnit.h"
 #include "libds/buffer.h"
@@ -19,8 +20,29 @@
 static DSDict *dict_test = NULL;
 static int dsdict_collision_cap = 0;
 static int dsdict_collision_place = 0;
+static size_t dict_test_hash_calls = 0;
+static size_t dict_test_compare_calls = 0;
+
+struct dict_test_counts {
+    size_t allocs;
+    size_t callocs;
+    size_t frees;
+    size_t live;
+};
 
 static unsigned int dict_test_hash(void *obj);
+static unsigned int dict_test_counting_hash(void *obj);
+static void *dict_test_increment(void *val, void *ctx);
+static unsigned int dict_test_int_hash(void *obj);
+static unsigned int dict_test_constant_hash(void *obj);
+static unsigned int dict_test_few_hash(void *obj);
+static int dict_test_int_compare(const void *left, const void *right);
+static uint64_t dict_test_high_hash(void *obj);
+static int dict_test_counting_compare(const void *left, const void *right);
+static void *dict_test_alloc(void *ctx, size_t size);
+static void *dict_test_calloc(void *ctx, size_t num, size_t size);
+static void *dict_test_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+static void dict_test_free(void *ctx, void *ptr, size_t size);
 
 void dict_test_setup(void) {
     dict_test = dsdict_new((dsdict_hash_fn) dsbuf_hash,
@@ -92,7 +114,7 @@ void dict_test_collision(void) {
     DSBuffer *test3 = NULL;
 
     /* Mock our hash, so we can simulate key collision
-     * We are forcing this both puts into the bucket 10 */
+     * We are forcing both puts into the same bucket */
     dsdict_collision_cap = (int)dsdict_cap(dict);
     dsdict_collision_place = 10;
 
@@ -231,6 +253,11 @@ void dict_test_resize(void) {
     }
 
     CU_ASSERT(dsdict_count(dict_test) == cap);
+
+    // Capacities are always powers of 2
+    size_t newcap = dsdict_cap(dict_test);
+    CU_ASSERT(newcap > (size_t)cap);
+    CU_ASSERT((newcap & (newcap - 1)) == 0);
 }
 
 void dict_test_iter(void) {
@@ -278,11 +305,988 @@ void dict_test_iter(void) {
     dsdict_destroy(dict);
 }
 
+void dict_test_prime_moduli(void) {
+    enum { num_keys = 500 };
+    DSDict *dict = dsdict_new_flags((dsdict_hash_fn) dsbuf_hash,
+                                    (dsdict_compare_fn) dsbuf_compare,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    DSDICT_CHAINED | DSDICT_PRIME_MODULI);
+    CU_ASSERT_FATAL(dict != NULL);
+
+    for (int i = 0; i < num_keys; i++) {
+        char key[32];
+        sprintf(key, "Key %d", i);
+        DSBuffer *keybuf = dsbuf_new(key);
+        CU_ASSERT_FATAL(keybuf != NULL);
+        DSBuffer *valbuf = dsbuf_new(key);
+        CU_ASSERT_FATAL(valbuf != NULL);
+        dsdict_put(dict, keybuf, valbuf);
+    }
+    CU_ASSERT(dsdict_count(dict) == (size_t)num_keys);
+
+    for (int i = 0; i < num_keys; i++) {
+        char key[32];
+        sprintf(key, "Key %d", i);
+        DSBuffer *keybuf = dsbuf_new(key);
+        CU_ASSERT_FATAL(keybuf != NULL);
+        DSBuffer *tmpval = dsdict_get(dict, keybuf);
+        CU_ASSERT(tmpval != NULL);
+        CU_ASSERT(dsbuf_compare(keybuf, tmpval) == 0);
+        dsbuf_destroy(keybuf);
+    }
+
+    dsdict_destroy(dict);
+}
+
+void dict_test_incremental_resize(void) {
+    enum { num_keys = 2000 };
+    DSDict *dict = dsdict_new_flags((dsdict_hash_fn) dsbuf_hash,
+                                    (dsdict_compare_fn) dsbuf_compare,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    NULL,
+                                    DSDICT_CHAINED | DSDICT_INCREMENTAL_RESIZE);
+    CU_ASSERT_FATAL(dict != NULL);
+    DSBuffer *keys[num_keys];
+
+    // Stop inserting immediately after a resize begins, so the migration
+    // into the new table is still in progress
+    size_t cap = dsdict_cap(dict);
+    int num_put = 0;
+    for (int i = 0; i < num_keys; i++) {
+        char key[32];
+        sprintf(key, "Key %d", i);
+        keys[i] = dsbuf_new(key);
+        CU_ASSERT_FATAL(keys[i] != NULL);
+        dsdict_put(dict, keys[i], keys[i]);
+        num_put++;
+        CU_ASSERT(dsdict_get(dict, keys[i]) == keys[i]);
+        if ((i > num_keys / 2) && (dsdict_cap(dict) != cap)) { break; }
+        cap = dsdict_cap(dict);
+    }
+    CU_ASSERT(dsdict_count(dict) == (size_t)num_put);
+
+    // Iterate across the migration, interleaving lookups
+    DSIter *iter = dsdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    int count_iters = 0;
+    while (dsiter_next(iter)) {
+        CU_ASSERT(dsiter_key(iter) == dsiter_value(iter));
+        CU_ASSERT(dsdict_get(dict, keys[count_iters]) == keys[count_iters]);
+        count_iters++;
+    }
+    CU_ASSERT(count_iters == num_put);
+    dsiter_destroy(iter);
+
+    // Lookups never do migration work, so it is still pending once the
+    // iterator is gone until it is finished explicitly
+    for (int i = 0; i < num_put; i++) {
+        CU_ASSERT(dsdict_get(dict, keys[i]) == keys[i]);
+    }
+    void *found[num_keys];
+    CU_ASSERT(dsdict_get_many(dict, (void **) keys, (size_t)num_put, found) == (size_t)num_put);
+    CU_ASSERT(dsdict_migrate(dict));
+    while (dsdict_migrate(dict)) {
+        CU_ASSERT(dsdict_get(dict, keys[0]) == keys[0]);
+    }
+    CU_ASSERT(!dsdict_migrate(dict));
+    for (int i = 0; i < num_put; i += 2) {
+        CU_ASSERT(dsdict_del(dict, keys[i]) == keys[i]);
+        dsbuf_destroy(keys[i]);
+    }
+    for (int i = 1; i < num_put; i += 2) {
+        CU_ASSERT(dsdict_get(dict, keys[i]) == keys[i]);
+    }
+    CU_ASSERT(dsdict_count(dict) == (size_t)(num_put / 2));
+
+    dsdict_destroy(dict);
+}
+
+void dict_test_del_collision(void) {
+    DSDict *dict = dsdict_new(dict_test_hash,
+                              (dsdict_compare_fn) dsbuf_compare,
+                              (dsdict_free_fn) dsbuf_destroy,
+                              (dsdict_free_fn) dsbuf_destroy);
+    CU_ASSERT_FATAL(dict != NULL);
+    dsdict_collision_cap = (int)dsdict_cap(dict);
+    dsdict_collision_place = 10;
+
+    /* Chain three keys in the same bucket */
+    DSBuffer *key1 = dsbuf_new("Key1");
+    DSBuffer *key2 = dsbuf_new("Key2--");
+    DSBuffer *key3 = dsbuf_new("Key3----");
+    DSBuffer *val1 = dsbuf_new("Val1");
+    DSBuffer *val2 = dsbuf_new("Val2");
+    DSBuffer *val3 = dsbuf_new("Val3");
+    dsdict_put(dict, key1, val1);
+    dsdict_put(dict, key2, val2);
+    dsdict_put(dict, key3, val3);
+    CU_ASSERT(dsdict_count(dict) == 3);
+
+    /* Deleting from the middle of the chain must keep its neighbors */
+    CU_ASSERT(dsdict_del(dict, key2) == val2);
+    CU_ASSERT(dsdict_count(dict) == 2);
+    CU_ASSERT(dsdict_get(dict, key1) == val1);
+    CU_ASSERT(dsdict_get(dict, key2) == NULL);
+    CU_ASSERT(dsdict_get(dict, key3) == val3);
+
+    dsbuf_destroy(key2);
+    dsbuf_destroy(val2);
+    dsdict_destroy(dict);
+}
+
+void dict_test_open_addressing(void) {
+    enum { num_keys = 1000 };
+    DSDict *dict = dsdict_new_flags((dsdict_hash_fn) dsbuf_hash,
+                                    (dsdict_compare_fn) dsbuf_compare,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    DSDICT_OPEN_ADDRESSING);
+    CU_ASSERT_FATAL(dict != NULL);
+    size_t startcap = dsdict_cap(dict);
+    DSBuffer *keys[num_keys];
+
+    // Put enough elements to force several resizes
+    for (int i = 0; i < num_keys; i++) {
+        char key[32];
+        char val[32];
+        sprintf(key, "Key %d", i);
+        sprintf(val, "Value %d", i);
+        keys[i] = dsbuf_new(key);
+        CU_ASSERT_FATAL(keys[i] != NULL);
+        DSBuffer *valbuf = dsbuf_new(val);
+        CU_ASSERT_FATAL(valbuf != NULL);
+        dsdict_put(dict, keys[i], valbuf);
+        CU_ASSERT(dsdict_get(dict, keys[i]) == valbuf);
+    }
+    CU_ASSERT(dsdict_count(dict) == (size_t)num_keys);
+    CU_ASSERT(dsdict_cap(dict) > startcap);
+
+    // Overwrite an existing key
+    DSBuffer *probe = dsbuf_new("Key 7");
+    DSBuffer *newval = dsbuf_new("New Value");
+    dsdict_put(dict, probe, newval);
+    CU_ASSERT(dsdict_count(dict) == (size_t)num_keys);
+    CU_ASSERT(dsdict_get(dict, probe) == newval);
+
+    // Delete every even key, leaving tombstones between the odd ones
+    for (int i = 0; i < num_keys; i += 2) {
+        DSBuffer *val = dsdict_del(dict, keys[i]);
+        CU_ASSERT(val != NULL);
+        dsbuf_destroy(val);
+        CU_ASSERT(dsdict_get(dict, keys[i]) == NULL);
+        dsbuf_destroy(keys[i]);
+    }
+    CU_ASSERT(dsdict_count(dict) == (size_t)(num_keys / 2));
+
+    // Verify the remaining keys are still reachable past the tombstones
+    for (int i = 1; i < num_keys; i += 2) {
+        char key[32];
+        char val[32];
+        sprintf(key, "Key %d", i);
+        sprintf(val, "Value %d", i);
+        DSBuffer *keybuf = dsbuf_new(key);
+        CU_ASSERT_FATAL(keybuf != NULL);
+        DSBuffer *tmpval = dsdict_get(dict, keybuf);
+        CU_ASSERT(tmpval == newval || dsbuf_equals_char(tmpval, val));
+        dsbuf_destroy(keybuf);
+    }
+
+    // Iterators see exactly the live elements
+    DSIter *iter = dsdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    size_t count_iters = 0;
+    while (dsiter_next(iter)) {
+        CU_ASSERT(dsiter_key(iter) != NULL);
+        CU_ASSERT(dsiter_value(iter) != NULL);
+        count_iters++;
+    }
+    CU_ASSERT(count_iters == dsdict_count(dict));
+    CU_ASSERT(dsiter_has_next(iter) == false);
+    dsiter_destroy(iter);
+
+    dsbuf_destroy(probe);
+    dsdict_destroy(dict);
+}
+
+void dict_test_allocator(void) {
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_ORDERED, DSDICT_CUCKOO };
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        struct dict_test_counts counts = { 0, 0, 0, 0 };
+        DSAllocator alloc = { dict_test_alloc, NULL, dict_test_realloc, dict_test_free, &counts };
+        DSDict *dict = dsdict_new_alloc((dsdict_hash_fn) dsbuf_hash,
+                                        (dsdict_compare_fn) dsbuf_compare,
+                                        (dsdict_free_fn) dsbuf_destroy,
+                                        (dsdict_free_fn) dsbuf_destroy,
+                                        flags[f], &alloc);
+        CU_ASSERT_FATAL(dict != NULL);
+        CU_ASSERT(counts.allocs > 0);
+
+        // Force several resizes and bucket chunk allocations
+        for (int i = 0; i < 500; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            DSBuffer *keybuf = dsbuf_new(key);
+            DSBuffer *valbuf = dsbuf_new(key);
+            CU_ASSERT_FATAL((keybuf != NULL) && (valbuf != NULL));
+            dsdict_put(dict, keybuf, valbuf);
+        }
+        CU_ASSERT(dsdict_count(dict) == 500);
+
+        // Iterators come from the dictionary allocator too
+        size_t before = counts.allocs;
+        DSIter *iter = dsdict_iter(dict);
+        CU_ASSERT_FATAL(iter != NULL);
+        CU_ASSERT(counts.allocs == before + 1);
+        size_t count_iters = 0;
+        while (dsiter_next(iter)) {
+            count_iters++;
+        }
+        CU_ASSERT(count_iters == 500);
+        dsiter_destroy(iter);
+
+        // Every block is returned with the size it was allocated with
+        dsdict_destroy(dict);
+        CU_ASSERT(counts.allocs == counts.frees);
+        CU_ASSERT(counts.live == 0);
+    }
+
+    // Tables are zeroed by the allocator when it is able to
+    struct dict_test_counts counts = { 0, 0, 0, 0 };
+    DSAllocator zeroing = { dict_test_alloc, dict_test_calloc, dict_test_realloc, dict_test_free, &counts };
+    DSDict *dict = dsdict_new_alloc((dsdict_hash_fn) dsbuf_hash,
+                                    (dsdict_compare_fn) dsbuf_compare,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    (dsdict_free_fn) dsbuf_destroy,
+                                    DSDICT_INCREMENTAL_RESIZE, &zeroing);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < 500; i++) {
+        char key[32];
+        sprintf(key, "Key %d", i);
+        dsdict_put(dict, dsbuf_new(key), dsbuf_new(key));
+    }
+    CU_ASSERT(dsdict_count(dict) == 500);
+    CU_ASSERT(counts.callocs > 1);
+    dsdict_destroy(dict);
+    CU_ASSERT(counts.allocs + counts.callocs == counts.frees);
+    CU_ASSERT(counts.live == 0);
+
+    // Allocators must at least provide an allocation function
+    DSAllocator bad = { NULL, NULL, NULL, NULL, NULL };
+    CU_ASSERT(dsdict_new_alloc((dsdict_hash_fn) dsbuf_hash,
+                               (dsdict_compare_fn) dsbuf_compare,
+                               NULL, NULL, DSDICT_CHAINED, &bad) == NULL);
+}
+
+void dict_test_many(void) {
+    enum { num_keys = 300 };
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_ORDERED, DSDICT_CUCKOO };
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSDict *dict = dsdict_new_flags(dsbuf_dict_hash, dsbuf_dict_compare,
+                                        (dsdict_free_fn) dsbuf_destroy,
+                                        (dsdict_free_fn) dsbuf_destroy,
+                                        flags[f]);
+        CU_ASSERT_FATAL(dict != NULL);
+
+        // Put every even key in one call, with a NULL key in the middle
+        void *keys[num_keys];
+        void *vals[num_keys];
+        for (int i = 0; i < num_keys; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i * 2);
+            keys[i] = dsbuf_new(key);
+            vals[i] = dsbuf_new(key);
+            CU_ASSERT_FATAL((keys[i] != NULL) && (vals[i] != NULL));
+        }
+        DSBuffer *skipkey = keys[150];
+        DSBuffer *skipval = vals[150];
+        keys[150] = NULL;
+        dsdict_put_many(dict, keys, vals, num_keys);
+        CU_ASSERT(dsdict_count(dict) == num_keys - 1);
+        dsbuf_destroy(skipkey);
+        dsbuf_destroy(skipval);
+
+        // Look up every key, only half of which are present
+        void *probes[num_keys * 2];
+        void *found[num_keys * 2];
+        for (int i = 0; i < num_keys * 2; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            probes[i] = dsbuf_new(key);
+            CU_ASSERT_FATAL(probes[i] != NULL);
+        }
+        CU_ASSERT(dsdict_get_many(dict, probes, num_keys * 2, found) == num_keys - 1);
+        for (int i = 0; i < num_keys * 2; i++) {
+            if ((i % 2 == 0) && (i != 300)) {
+                CU_ASSERT(found[i] == vals[i / 2]);
+                CU_ASSERT(found[i] == dsdict_get(dict, probes[i]));
+            } else {
+                CU_ASSERT(found[i] == NULL);
+            }
+            dsbuf_destroy(probes[i]);
+        }
+
+        CU_ASSERT(dsdict_get_many(dict, probes, 0, found) == 0);
+        dsdict_destroy(dict);
+    }
+}
+
+void dict_test_hashed(void) {
+    enum { num_keys = 200 };
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_ORDERED, DSDICT_CUCKOO };
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSDict *dict = dsdict_new_flags(dict_test_counting_hash, dsbuf_dict_compare,
+                                        NULL, (dsdict_free_fn) dsbuf_destroy,
+                                        flags[f]);
+        CU_ASSERT_FATAL(dict != NULL);
+        dict_test_hash_calls = 0;
+
+        // Get-then-put sequences hash each key exactly once
+        DSBuffer *keys[num_keys];
+        for (int i = 0; i < num_keys; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            keys[i] = dsbuf_new(key);
+            CU_ASSERT_FATAL(keys[i] != NULL);
+            uint64_t hash = dsdict_hash_of(dict, keys[i]);
+            CU_ASSERT(hash == dsbuf_dict_hash(keys[i]));
+            CU_ASSERT(dsdict_get_hashed(dict, keys[i], hash) == NULL);
+            dsdict_put_hashed(dict, keys[i], hash, dsbuf_new(key));
+        }
+        CU_ASSERT(dict_test_hash_calls == num_keys);
+        CU_ASSERT(dsdict_count(dict) == num_keys);
+
+        // Hashed and unhashed operations are interchangeable
+        for (int i = 0; i < num_keys; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            DSBuffer *probe = dsbuf_new(key);
+            CU_ASSERT_FATAL(probe != NULL);
+            DSBuffer *val = dsdict_get(dict, probe);
+            CU_ASSERT_FATAL(val != NULL);
+            CU_ASSERT(dsbuf_equals_char(val, key));
+            CU_ASSERT(dsdict_get_hashed(dict, probe, dsbuf_dict_hash(probe)) == val);
+            if (i % 2 == 0) {
+                val = dsdict_del_hashed(dict, probe, dsbuf_dict_hash(probe));
+                CU_ASSERT(val != NULL);
+                CU_ASSERT(dsdict_get(dict, probe) == NULL);
+                dsbuf_destroy(val);
+            }
+            dsbuf_destroy(probe);
+        }
+        CU_ASSERT(dsdict_count(dict) == num_keys / 2);
+
+        CU_ASSERT(dsdict_hash_of(dict, NULL) == 0);
+        CU_ASSERT(dsdict_hash_of(NULL, keys[0]) == 0);
+        CU_ASSERT(dsdict_get_hashed(dict, NULL, 0) == NULL);
+        CU_ASSERT(dsdict_del_hashed(dict, NULL, 0) == NULL);
+        dsdict_destroy(dict);
+        for (int i = 0; i < num_keys; i++) {
+            dsbuf_destroy(keys[i]);
+        }
+    }
+}
+
+void dict_test_upsert(void) {
+    enum { num_keys = 150, rounds = 4 };
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_ORDERED, DSDICT_CUCKOO };
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSDict *dict = dsdict_new_flags(dict_test_counting_hash, dsbuf_dict_compare,
+                                        (dsdict_free_fn) dsbuf_destroy, NULL,
+                                        flags[f]);
+        CU_ASSERT_FATAL(dict != NULL);
+        dict_test_hash_calls = 0;
+
+        // Count every key several times through the entry pointer; the
+        // dictionary only keeps the key passed in on the first round
+        size_t adds = 0;
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < num_keys; i++) {
+                char key[32];
+                sprintf(key, "Key %d", i);
+                DSBuffer *k = dsbuf_new(key);
+                CU_ASSERT_FATAL(k != NULL);
+                bool inserted;
+                void **val = dsdict_get_or_insert(dict, k, &inserted);
+                CU_ASSERT_FATAL(val != NULL);
+                CU_ASSERT(inserted == (r == 0));
+                if (inserted) {
+                    CU_ASSERT(*val == NULL);
+                    adds++;
+                } else {
+                    dsbuf_destroy(k);
+                }
+                *val = (void *)((uintptr_t)*val + 1);
+            }
+        }
+        CU_ASSERT(adds == num_keys);
+        CU_ASSERT(dsdict_count(dict) == num_keys);
+        CU_ASSERT(dict_test_hash_calls == num_keys * rounds);
+
+        // Update the same counters through a callback
+        for (int i = 0; i < num_keys; i++) {
+            char key[32];
+            sprintf(key, "Key %d", i);
+            DSBuffer *k = dsbuf_new(key);
+            CU_ASSERT_FATAL(k != NULL);
+            uintptr_t step = (uintptr_t)i;
+            CU_ASSERT(dsdict_update(dict, k, dict_test_increment, &step));
+            CU_ASSERT((uintptr_t)dsdict_get(dict, k) == rounds + step);
+            dsbuf_destroy(k);
+        }
+        CU_ASSERT(dsdict_count(dict) == num_keys);
+
+        // Updating a missing key adds it
+        DSBuffer *fresh = dsbuf_new("Fresh Key");
+        CU_ASSERT_FATAL(fresh != NULL);
+        uintptr_t step = 7;
+        CU_ASSERT(dsdict_update(dict, fresh, dict_test_increment, &step));
+        CU_ASSERT((uintptr_t)dsdict_get(dict, fresh) == 7);
+        CU_ASSERT(dsdict_count(dict) == num_keys + 1);
+
+        CU_ASSERT(dsdict_get_or_insert(dict, NULL, NULL) == NULL);
+        CU_ASSERT(dsdict_get_or_insert(NULL, fresh, NULL) == NULL);
+        CU_ASSERT(!dsdict_update(dict, fresh, NULL, NULL));
+        CU_ASSERT(!dsdict_update(dict, NULL, dict_test_increment, &step));
+        dsdict_destroy(dict);
+    }
+}
+
+void dict_test_sizing(void) {
+    enum { num_keys = 4000 };
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_PRIME_MODULI,
+                          DSDICT_ORDERED, DSDICT_CUCKOO };
+    static int keys[num_keys];
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+    }
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        // Pre-sized dictionaries never resize while loading
+        struct dict_test_counts counts = { 0, 0, 0, 0 };
+        DSAllocator alloc = { dict_test_alloc, NULL, dict_test_realloc, dict_test_free, &counts };
+        DSDict *dict = dsdict_new_cap(1000, dict_test_int_hash, dict_test_int_compare,
+                                      NULL, NULL, flags[f], &alloc);
+        CU_ASSERT_FATAL(dict != NULL);
+        CU_ASSERT(counts.allocs > 0);
+        size_t cap = dsdict_cap(dict);
+        CU_ASSERT(cap == 2048);
+        for (int i = 0; i < 1000; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_cap(dict) == cap);
+
+        // Nor do they shrink below their initial size
+        for (int i = 10; i < 1000; i++) {
+            CU_ASSERT(dsdict_del(dict, &keys[i]) == &keys[i]);
+        }
+        CU_ASSERT(dsdict_cap(dict) == cap);
+
+        // Until they are explicitly shrunk
+        dsdict_shrink_to_fit(dict);
+        CU_ASSERT(dsdict_cap(dict) == 16);
+        for (int i = 0; i < 10; i++) {
+            CU_ASSERT(dsdict_get(dict, &keys[i]) == &keys[i]);
+        }
+
+        // Reserving grows the table once up front
+        CU_ASSERT(dsdict_reserve(dict, num_keys));
+        cap = dsdict_cap(dict);
+        CU_ASSERT(cap == 8192);
+        for (int i = 0; i < num_keys; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_cap(dict) == cap);
+        CU_ASSERT(dsdict_count(dict) == num_keys);
+        dsdict_destroy(dict);
+        CU_ASSERT(counts.live == 0);
+        CU_ASSERT(counts.allocs == counts.frees);
+
+        // Dictionaries shrink automatically once mostly empty
+        dict = dsdict_new_flags(dict_test_int_hash, dict_test_int_compare, NULL, NULL, flags[f]);
+        CU_ASSERT_FATAL(dict != NULL);
+        for (int i = 0; i < num_keys; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        size_t peak = dsdict_cap(dict);
+        for (int i = 20; i < num_keys; i++) {
+            CU_ASSERT(dsdict_del(dict, &keys[i]) == &keys[i]);
+        }
+        CU_ASSERT(dsdict_cap(dict) < peak);
+        CU_ASSERT(dsdict_cap(dict) >= 64);
+        for (int i = 0; i < num_keys; i++) {
+            CU_ASSERT(dsdict_get(dict, &keys[i]) == ((i < 20) ? &keys[i] : NULL));
+        }
+
+        // Lower load factors grow the table straight away
+        for (int i = 20; i < 40; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_set_load_factor(dict, 0.25));
+        CU_ASSERT(((double)dsdict_count(dict) / dsdict_cap(dict)) < 0.25);
+        CU_ASSERT(!dsdict_set_load_factor(dict, 0.0));
+        CU_ASSERT(!dsdict_set_load_factor(dict, 1.0));
+        CU_ASSERT(!dsdict_set_load_factor(dict, -0.5));
+        for (int i = 0; i < 40; i++) {
+            CU_ASSERT(dsdict_get(dict, &keys[i]) == &keys[i]);
+        }
+        dsdict_destroy(dict);
+    }
+
+    CU_ASSERT(!dsdict_reserve(NULL, 10));
+    CU_ASSERT(dsdict_new_cap(10, NULL, dict_test_int_compare, NULL, NULL, 0, NULL) == NULL);
+}
+
+void dict_test_stats(void) {
+    enum { num_keys = 1000, num_bad = 100 };
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_PRIME_MODULI,
+                          DSDICT_ORDERED, DSDICT_CUCKOO };
+    static int keys[num_keys];
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+    }
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        bool chained = !(flags[f] & (DSDICT_OPEN_ADDRESSING | DSDICT_ORDERED | DSDICT_CUCKOO));
+        struct dict_test_counts counts = { 0, 0, 0, 0 };
+        DSAllocator alloc = { dict_test_alloc, NULL, dict_test_realloc, dict_test_free, &counts };
+        DSDict *dict = dsdict_new_alloc(dict_test_int_hash, dict_test_int_compare,
+                                        NULL, NULL, flags[f], &alloc);
+        CU_ASSERT_FATAL(dict != NULL);
+
+        DSDictStats stats;
+        CU_ASSERT(dsdict_stats(dict, &stats));
+        CU_ASSERT(stats.count == 0);
+        CU_ASSERT(stats.cap == dsdict_cap(dict));
+        CU_ASSERT(stats.occupied == 0);
+        CU_ASSERT(stats.max_chain == 0);
+        CU_ASSERT(stats.resizes == 0);
+        CU_ASSERT(stats.table_bytes > 0);
+
+        for (int i = 0; i < num_keys; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_del(dict, &keys[0]) == &keys[0]);
+        CU_ASSERT(dsdict_stats(dict, &stats));
+        CU_ASSERT(stats.count == num_keys - 1);
+        CU_ASSERT(stats.cap == dsdict_cap(dict));
+        CU_ASSERT(stats.resizes > 0);
+        CU_ASSERT(stats.max_chain >= 1);
+        CU_ASSERT(stats.mean_chain >= 1.0);
+        CU_ASSERT(stats.mean_chain <= (double)stats.max_chain);
+        CU_ASSERT(stats.table_bytes + stats.bucket_bytes <= counts.live);
+
+        // Every bucket (chained) or every element (otherwise) is in
+        // exactly one bin of the histogram
+        size_t binned = 0;
+        for (size_t b = 0; b < DSDICT_STATS_HISTOGRAM_BINS; b++) {
+            binned += stats.histogram[b];
+        }
+        if (chained) {
+            CU_ASSERT(binned >= stats.cap);
+            CU_ASSERT(stats.occupied <= stats.count);
+            CU_ASSERT(stats.bucket_bytes > 0);
+            CU_ASSERT(stats.deleted == 0);
+        } else {
+            CU_ASSERT(binned == stats.count);
+            CU_ASSERT(stats.occupied == stats.count);
+            CU_ASSERT(stats.histogram[0] == 0);
+        }
+        if (flags[f] & DSDICT_ORDERED) {
+            CU_ASSERT(stats.deleted == 1);
+            CU_ASSERT(stats.bucket_bytes > 0);
+        }
+        dsdict_destroy(dict);
+
+        // A hash function which maps every key alike shows up as one long
+        // chain or long probes
+        dict = dsdict_new_flags(dict_test_constant_hash, dict_test_int_compare, NULL, NULL, flags[f]);
+        CU_ASSERT_FATAL(dict != NULL);
+        for (int i = 0; i < num_bad; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_stats(dict, &stats));
+        CU_ASSERT(stats.count == num_bad);
+        CU_ASSERT(stats.mean_chain > 2.0);
+        size_t longest = (stats.max_chain < DSDICT_STATS_HISTOGRAM_BINS) ? stats.max_chain : (DSDICT_STATS_HISTOGRAM_BINS - 1);
+        CU_ASSERT(stats.histogram[longest] >= 1);
+        if (chained) {
+            CU_ASSERT(stats.occupied == 1);
+            CU_ASSERT(stats.max_chain == num_bad);
+        } else {
+            CU_ASSERT(stats.max_chain > 2);
+        }
+        dsdict_destroy(dict);
+    }
+
+    DSDictStats stats;
+    CU_ASSERT(!dsdict_stats(NULL, &stats));
+    DSDict *dict = dsdict_new(dict_test_int_hash, dict_test_int_compare, NULL, NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(!dsdict_stats(dict, NULL));
+    dsdict_destroy(dict);
+}
+
+void dict_test_ordered(void) {
+    enum { num_keys = 3000 };
+    static int keys[num_keys];
+    static int order[num_keys];
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+    }
+
+    DSDict *dict = dsdict_new_flags(dict_test_int_hash, dict_test_int_compare,
+                                    NULL, NULL, DSDICT_ORDERED);
+    CU_ASSERT_FATAL(dict != NULL);
+
+    // Insert in a scrambled order, forcing several resizes on the way
+    for (int i = 0; i < num_keys; i++) {
+        order[i] = (i * 7) % num_keys;
+        dsdict_put(dict, &keys[order[i]], &keys[order[i]]);
+    }
+    CU_ASSERT(dsdict_count(dict) == num_keys);
+
+    // Overwriting a value keeps its position; deleting and re-adding a
+    // key moves it to the end (7 is the second key inserted)
+    dsdict_put(dict, &keys[0], &keys[1]);
+    CU_ASSERT(dsdict_del(dict, &keys[7]) == &keys[7]);
+    dsdict_put(dict, &keys[7], &keys[7]);
+    for (int i = 1; i < num_keys - 1; i++) {
+        order[i] = order[i + 1];
+    }
+    order[num_keys - 1] = 7;
+
+    DSIter *iter = dsdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    int n = 0;
+    while (dsiter_next(iter)) {
+        int *key = dsiter_key(iter);
+        CU_ASSERT_FATAL(key != NULL);
+        CU_ASSERT(*key == order[n]);
+        CU_ASSERT(dsiter_value(iter) == ((*key == 0) ? &keys[1] : key));
+        n++;
+    }
+    CU_ASSERT(n == num_keys);
+
+    // Deleting during iteration is safe
+    dsiter_reset(iter);
+    while (dsiter_next(iter)) {
+        int *key = dsiter_key(iter);
+        CU_ASSERT_FATAL(key != NULL);
+        if (*key % 3 != 0) {
+            CU_ASSERT(dsdict_del(dict, key) == key);
+            CU_ASSERT(dsiter_key(iter) == NULL);
+        }
+    }
+    dsiter_destroy(iter);
+    CU_ASSERT(dsdict_count(dict) == num_keys / 3);
+
+    // Compacting the table after deletions keeps the insertion order
+    dsdict_shrink_to_fit(dict);
+    CU_ASSERT(dsdict_cap(dict) < 4096);
+    iter = dsdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    n = 0;
+    for (int i = 0; i < num_keys; i++) {
+        if (order[i] % 3 != 0) { continue; }
+        CU_ASSERT_FATAL(dsiter_next(iter));
+        CU_ASSERT(*(int *)dsiter_key(iter) == order[i]);
+        n++;
+    }
+    CU_ASSERT(n == num_keys / 3);
+    CU_ASSERT(!dsiter_next(iter));
+    dsiter_destroy(iter);
+    dsdict_destroy(dict);
+}
+
+void dict_test_cuckoo(void) {
+    enum { num_keys = 5000, num_bad = 200 };
+    static int keys[num_keys];
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+    }
+
+    DSDict *dict = dsdict_new_flags(dict_test_int_hash, dict_test_counting_compare,
+                                    NULL, NULL, DSDICT_CUCKOO);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < num_keys; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    CU_ASSERT(dsdict_count(dict) == num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        CU_ASSERT(dsdict_get(dict, &keys[i]) == &keys[i]);
+    }
+
+    // Well spread keys almost never reach the stash, so every element is
+    // found in one of its two buckets
+    DSDictStats stats;
+    CU_ASSERT(dsdict_stats(dict, &stats));
+    CU_ASSERT(stats.max_chain <= 3);
+    CU_ASSERT(stats.histogram[3] <= 8);
+
+    // Fingerprints rule out nearly every slot a missing key is checked
+    // against, so misses almost never compare keys
+    static int missing[num_keys];
+    dict_test_compare_calls = 0;
+    for (int i = 0; i < num_keys; i++) {
+        missing[i] = num_keys + i;
+        CU_ASSERT(dsdict_get(dict, &missing[i]) == NULL);
+    }
+    CU_ASSERT(dict_test_compare_calls <= 2);
+    dsdict_destroy(dict);
+
+    // Keys which all share a hash overflow their two buckets into the
+    // stash, which must still find, iterate and delete them correctly;
+    // no amount of rehashing separates them, so the stash grows instead
+    dict = dsdict_new_flags(dict_test_constant_hash, dict_test_int_compare,
+                            NULL, NULL, DSDICT_CUCKOO);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < num_bad; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    dsdict_put(dict, &keys[0], &keys[1]);
+    CU_ASSERT(dsdict_count(dict) == num_bad);
+    for (int i = 0; i < num_bad; i++) {
+        CU_ASSERT(dsdict_get(dict, &keys[i]) == ((i == 0) ? &keys[1] : &keys[i]));
+    }
+    CU_ASSERT(dsdict_stats(dict, &stats));
+    CU_ASSERT(stats.histogram[3] > 8);
+    CU_ASSERT(stats.histogram[1] + stats.histogram[2] + stats.histogram[3] == num_bad);
+
+    // Deleting during iteration is safe, including from the stash
+    DSIter *iter = dsdict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    int n = 0;
+    while (dsiter_next(iter)) {
+        int *key = dsiter_key(iter);
+        CU_ASSERT_FATAL(key != NULL);
+        if (*key % 2 != 0) {
+            CU_ASSERT(dsdict_del(dict, key) == key);
+            CU_ASSERT(dsiter_key(iter) == NULL);
+        }
+        n++;
+    }
+    dsiter_destroy(iter);
+    CU_ASSERT(n == num_bad);
+    CU_ASSERT(dsdict_count(dict) == num_bad / 2);
+
+    // Later deletes move the remaining stash elements back into the
+    // buckets they left
+    CU_ASSERT(dsdict_del(dict, &keys[0]) == &keys[1]);
+    for (int i = 10; i < num_bad; i += 2) {
+        CU_ASSERT(dsdict_del(dict, &keys[i]) == &keys[i]);
+    }
+    for (int i = 0; i < num_bad; i++) {
+        CU_ASSERT(dsdict_get(dict, &keys[i]) == (((i % 2 == 0) && (i != 0) && (i < 10)) ? &keys[i] : NULL));
+    }
+    CU_ASSERT(dsdict_stats(dict, &stats));
+    CU_ASSERT(stats.count == 4);
+    CU_ASSERT(stats.histogram[3] == 0);
+    CU_ASSERT(stats.histogram[1] + stats.histogram[2] == stats.count);
+    dsdict_destroy(dict);
+
+    // Small groups of keys sharing a hash are chained from their own
+    // buckets, so none of them is lost
+    dict = dsdict_new_flags(dict_test_few_hash, dict_test_int_compare,
+                            NULL, NULL, DSDICT_CUCKOO);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < num_keys; i++) {
+        dsdict_put(dict, &keys[i], &keys[i]);
+    }
+    CU_ASSERT(dsdict_count(dict) == num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        CU_ASSERT(dsdict_del(dict, &keys[i]) == &keys[i]);
+    }
+    CU_ASSERT(dsdict_count(dict) == 0);
+    dsdict_destroy(dict);
+}
+
+void dict_test_hash64(void) {
+    enum { num_keys = 3000 };
+    const int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING,
+                          DSDICT_INCREMENTAL_RESIZE, DSDICT_PRIME_MODULI,
+                          DSDICT_ORDERED, DSDICT_CUCKOO };
+    static int keys[num_keys];
+    static int probes[num_keys];
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+        probes[i] = i;
+    }
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        // Every key hash differs only in its upper 32 bits, so any engine
+        // which dropped them would compare every key against every other
+        DSDict *dict = dsdict_new_hash64(dict_test_high_hash, dict_test_counting_compare,
+                                         NULL, NULL, flags[f], NULL);
+        CU_ASSERT_FATAL(dict != NULL);
+        for (int i = 0; i < num_keys; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_count(dict) == num_keys);
+        CU_ASSERT(dsdict_hash_of(dict, &keys[7]) == dict_test_high_hash(&keys[7]));
+
+        dict_test_compare_calls = 0;
+        for (int i = 0; i < num_keys; i++) {
+            CU_ASSERT(dsdict_get(dict, &probes[i]) == &keys[i]);
+        }
+        CU_ASSERT(dict_test_compare_calls == num_keys);
+
+        uint64_t hash = dsdict_hash_of(dict, &probes[5]);
+        CU_ASSERT(dsdict_get_hashed(dict, &probes[5], hash) == &keys[5]);
+        CU_ASSERT(dsdict_get_hashed(dict, &probes[5], (uint32_t)hash) == NULL);
+        CU_ASSERT(dsdict_del_hashed(dict, &probes[5], hash) == &keys[5]);
+        dsdict_put_hashed(dict, &keys[5], hash, &keys[6]);
+        CU_ASSERT(dsdict_get(dict, &probes[5]) == &keys[6]);
+
+        for (int i = 0; i < num_keys; i += 2) {
+            CU_ASSERT(dsdict_del(dict, &probes[i]) == ((i == 5) ? &keys[6] : &keys[i]));
+        }
+        CU_ASSERT(dsdict_count(dict) == num_keys / 2);
+        dsdict_destroy(dict);
+
+        // Reserving before the first put sizes them like dsdict_new_cap
+        dict = dsdict_new_hash64(dict_test_high_hash, dict_test_counting_compare,
+                                 NULL, NULL, flags[f], NULL);
+        CU_ASSERT_FATAL(dict != NULL);
+        CU_ASSERT(dsdict_reserve(dict, num_keys));
+        size_t cap = dsdict_cap(dict);
+        for (int i = 0; i < num_keys; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+        CU_ASSERT(dsdict_cap(dict) == cap);
+        dsdict_destroy(dict);
+    }
+
+    CU_ASSERT(dsdict_new_hash64(NULL, dict_test_int_compare, NULL, NULL, 0, NULL) == NULL);
+    CU_ASSERT(dsdict_new_hash64(dict_test_high_hash, NULL, NULL, NULL, 0, NULL) == NULL);
+}
+
+void dict_test_iter_lifetime(void) {
+    enum { num_keys = 512 };
+    static int keys[num_keys];
+    int flags[] = { DSDICT_CHAINED, DSDICT_OPEN_ADDRESSING };
+
+    for (int i = 0; i < num_keys; i++) { keys[i] = i; }
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSDict *dict = dsdict_new_flags(dict_test_int_hash, dict_test_int_compare,
+                                        NULL, NULL, flags[f]);
+        CU_ASSERT_FATAL(dict != NULL);
+        for (int i = 0; i < num_keys; i++) {
+            dsdict_put(dict, &keys[i], &keys[i]);
+        }
+
+        // A live iterator on an engine which never moves elements behind
+        // it must not stop the dictionary from shrinking
+        DSIter *iter = dsdict_iter(dict);
+        CU_ASSERT_FATAL(iter != NULL);
+        size_t cap = dsdict_cap(dict);
+        for (int i = 0; i < num_keys - 4; i++) {
+            dsdict_del(dict, &keys[i]);
+        }
+        CU_ASSERT(dsdict_count(dict) == 4);
+        CU_ASSERT(dsdict_cap(dict) < cap);
+
+        // Nor may releasing it touch the dictionary once it is gone
+        dsdict_destroy(dict);
+        dsiter_destroy(iter);
+    }
+}
+
 // Mock hash function for testing hashing collisions. Produces the same
-// hash for strings of different sizes. This is important in the case
-// that you need to have a semi-deterministic way to mock the hash (i.e.
-// you need the same hash again for a get).
+// hash for every key, so every key is forced into the same bucket (or
+// probe sequence) no matter how the dictionary maps hashes to buckets.
+// This is important in the case that you need to have a deterministic
+// way to mock the hash (i.e. you need the same hash again for a get).
 static unsigned int dict_test_hash(void *obj) {
-    char *str = *(char**)obj;
-    return (unsigned int)((strlen(str) * dsdict_collision_cap) + dsdict_collision_place);
+    (void)obj;
+    return (unsigned int)((dsdict_collision_cap * 2) + dsdict_collision_place);
+}
+
+// Hash function which counts how many times the dictionary hashed a key.
+static unsigned int dict_test_counting_hash(void *obj) {
+    dict_test_hash_calls++;
+    return dsbuf_dict_hash(obj);
+}
+
+// Update function which adds the step given in ctx to a counter value.
+static void *dict_test_increment(void *val, void *ctx) {
+    return (void *)((uintptr_t)val + *(uintptr_t *)ctx);
+}
+
+// Hash function for int keys.
+static unsigned int dict_test_int_hash(void *obj) {
+    return (unsigned int)(*(int *)obj) * 2654435761u;
+}
+
+// Hash function which maps every key to the same bucket.
+static unsigned int dict_test_constant_hash(void *obj) {
+    (void)obj;
+    return 42;
+}
+
+// Hash function which maps every key to one of three hashes.
+static unsigned int dict_test_few_hash(void *obj) {
+    return (unsigned int)(*(int *)obj % 3);
+}
+
+static int dict_test_int_compare(const void *left, const void *right) {
+    return *(const int *)left - *(const int *)right;
+}
+
+// 64-bit hash function for int keys which leaves the low 32 bits of
+// every hash alike.
+static uint64_t dict_test_high_hash(void *obj) {
+    return ((uint64_t)(unsigned int)(*(int *)obj) << 32) | UINT64_C(0xABCD);
+}
+
+// Compare function for int keys which counts how many times it is called.
+static int dict_test_counting_compare(const void *left, const void *right) {
+    dict_test_compare_calls++;
+    return dict_test_int_compare(left, right);
+}
+
+// Counting allocator which tracks the number of live bytes allocated,
+// using the sizes passed back in by the containers.
+static void *dict_test_alloc(void *ctx, size_t size) {
+    struct dict_test_counts *counts = ctx;
+    counts->allocs++;
+    counts->live += size;
+    return malloc(size);
+}
+
+static void *dict_test_calloc(void *ctx, size_t num, size_t size) {
+    struct dict_test_counts *counts = ctx;
+    counts->callocs++;
+    counts->live += num * size;
+    return calloc(num, size);
+}
+
+static void *dict_test_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+    struct dict_test_counts *counts = ctx;
+    if (!ptr) {
+        return dict_test_alloc(ctx, newsize);
+    }
+    void *resized = realloc(ptr, newsize);
+    if (resized) {
+        counts->live = counts->live - oldsize + newsize;
+    }
+    return resized;
+}
+
+static void dict_test_free(void *ctx, void *ptr, size_t size) {
+    struct dict_test_counts *counts = ctx;
+    counts->frees++;
+    counts->live -= size;
+    free(ptr);
 }
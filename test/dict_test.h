@@ -19,5 +19,19 @@ void dict_test_get(void);
 void dict_test_del(void);
 void dict_test_resize(void);
 void dict_test_iter(void);
+void dict_test_prime_moduli(void);
+void dict_test_incremental_resize(void);
+void dict_test_del_collision(void);
+void dict_test_open_addressing(void);
+void dict_test_allocator(void);
+void dict_test_many(void);
+void dict_test_hashed(void);
+void dict_test_upsert(void);
+void dict_test_sizing(void);
+void dict_test_stats(void);
+void dict_test_ordered(void);
+void dict_test_cuckoo(void);
+void dict_test_hash64(void);
+void dict_test_iter_lifetime(void);
 
 #endif //LIBDS_DICT_TEST_H
@@ -0,0 +1,289 @@
+/*****************************************************************************
+ * libds :: frozen_test.c
+ *
+ * Test functions for frozen dictionary files.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <glob.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "CUnit/CUnit.h"
+#include "libds/dict.h"
+#include "libds/frozen.h"
+#include "frozen_test.h"
+
+enum { FROZEN_TEST_KEYS = 3000, FROZEN_TEST_VALLEN = 24 };
+
+static int frozen_test_keys[FROZEN_TEST_KEYS];
+static char frozen_test_vals[FROZEN_TEST_KEYS][FROZEN_TEST_VALLEN];
+static size_t frozen_test_visited = 0;
+static size_t frozen_test_bytes = 0;
+
+static bool frozen_test_tmpname(char *path, size_t len);
+static size_t frozen_test_leftovers(const char *path);
+static DSDict *frozen_test_dict(int flags, int nkeys, const char *prefix);
+static uint32_t frozen_test_hash(void *key);
+static int frozen_test_compare(const void *left, const void *right);
+static const void *frozen_test_int(const void *obj, size_t *len);
+static const void *frozen_test_str(const void *obj, size_t *len);
+static const void *frozen_test_fail(const void *obj, size_t *len);
+static void frozen_test_visit(const void *key, size_t keylen, const void *val, size_t vallen);
+
+void frozen_test_roundtrip(void) {
+    const int flags[] = { 0, DSDICT_OPEN_ADDRESSING, DSDICT_ORDERED };
+    char path[64];
+    CU_ASSERT_FATAL(frozen_test_tmpname(path, sizeof(path)));
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        DSDict *dict = frozen_test_dict(flags[f], FROZEN_TEST_KEYS, "value");
+        CU_ASSERT_FATAL(dict != NULL);
+        CU_ASSERT_FATAL(dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_str));
+
+        DSFrozenDict *frozen = dsfrozen_open(path);
+        CU_ASSERT_FATAL(frozen != NULL);
+        CU_ASSERT(dsfrozen_count(frozen) == FROZEN_TEST_KEYS);
+
+        // Every value is read directly out of the mapped file
+        for (int i = 0; i < FROZEN_TEST_KEYS; i++) {
+            size_t vallen = 0;
+            const char *val = dsfrozen_get(frozen, &i, sizeof(i), &vallen);
+            CU_ASSERT_FATAL(val != NULL);
+            CU_ASSERT(vallen == strlen(frozen_test_vals[i]));
+            CU_ASSERT(memcmp(val, frozen_test_vals[i], vallen) == 0);
+            CU_ASSERT(((uintptr_t)val % 8) == 0);
+        }
+
+        // Keys which were never added and keys of the wrong length miss
+        for (int i = FROZEN_TEST_KEYS; i < FROZEN_TEST_KEYS * 2; i++) {
+            CU_ASSERT(dsfrozen_get(frozen, &i, sizeof(i), NULL) == NULL);
+        }
+        int64_t wide = 1;
+        CU_ASSERT(dsfrozen_get(frozen, &wide, sizeof(wide), NULL) == NULL);
+        CU_ASSERT(dsfrozen_get(frozen, "", 0, NULL) == NULL);
+
+        frozen_test_visited = 0;
+        frozen_test_bytes = 0;
+        dsfrozen_foreach(frozen, frozen_test_visit);
+        CU_ASSERT(frozen_test_visited == FROZEN_TEST_KEYS);
+        CU_ASSERT(frozen_test_bytes == FROZEN_TEST_KEYS * sizeof(int));
+
+        dsfrozen_close(frozen);
+        dsdict_destroy(dict);
+    }
+
+    unlink(path);
+}
+
+void frozen_test_replace(void) {
+    char path[64];
+    CU_ASSERT_FATAL(frozen_test_tmpname(path, sizeof(path)));
+
+    DSDict *dict = frozen_test_dict(0, 100, "old");
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT_FATAL(dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_str));
+    dsdict_destroy(dict);
+
+    DSFrozenDict *old = dsfrozen_open(path);
+    CU_ASSERT_FATAL(old != NULL);
+
+    // Writing a new version replaces the file, so the old mapping keeps
+    // seeing the old contents while a fresh open sees the new ones
+    dict = frozen_test_dict(0, 200, "new");
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT_FATAL(dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_str));
+    dsdict_destroy(dict);
+
+    DSFrozenDict *fresh = dsfrozen_open(path);
+    CU_ASSERT_FATAL(fresh != NULL);
+    CU_ASSERT(dsfrozen_count(old) == 100);
+    CU_ASSERT(dsfrozen_count(fresh) == 200);
+
+    int key = 50;
+    size_t vallen = 0;
+    const char *val = dsfrozen_get(old, &key, sizeof(key), &vallen);
+    CU_ASSERT_FATAL(val != NULL);
+    CU_ASSERT((vallen == 6) && (memcmp(val, "old 50", 6) == 0));
+    val = dsfrozen_get(fresh, &key, sizeof(key), &vallen);
+    CU_ASSERT_FATAL(val != NULL);
+    CU_ASSERT((vallen == 6) && (memcmp(val, "new 50", 6) == 0));
+
+    key = 150;
+    CU_ASSERT(dsfrozen_get(old, &key, sizeof(key), NULL) == NULL);
+    CU_ASSERT(dsfrozen_get(fresh, &key, sizeof(key), NULL) != NULL);
+
+    dsfrozen_close(old);
+    dsfrozen_close(fresh);
+    unlink(path);
+}
+
+void frozen_test_empty(void) {
+    char path[64];
+    CU_ASSERT_FATAL(frozen_test_tmpname(path, sizeof(path)));
+
+    DSDict *dict = frozen_test_dict(0, 0, "");
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT_FATAL(dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_str));
+
+    DSFrozenDict *frozen = dsfrozen_open(path);
+    CU_ASSERT_FATAL(frozen != NULL);
+    CU_ASSERT(dsfrozen_count(frozen) == 0);
+    int key = 0;
+    CU_ASSERT(dsfrozen_get(frozen, &key, sizeof(key), NULL) == NULL);
+    frozen_test_visited = 0;
+    dsfrozen_foreach(frozen, frozen_test_visit);
+    CU_ASSERT(frozen_test_visited == 0);
+    dsfrozen_close(frozen);
+
+    // Empty values are stored and found like any other
+    static char empty[] = "";
+    frozen_test_keys[7] = 7;
+    dsdict_put(dict, &frozen_test_keys[7], empty);
+    CU_ASSERT_FATAL(dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_str));
+    frozen = dsfrozen_open(path);
+    CU_ASSERT_FATAL(frozen != NULL);
+    size_t vallen = 1;
+    key = 7;
+    CU_ASSERT(dsfrozen_get(frozen, &key, sizeof(key), &vallen) != NULL);
+    CU_ASSERT(vallen == 0);
+    dsfrozen_close(frozen);
+
+    dsdict_destroy(dict);
+    unlink(path);
+}
+
+void frozen_test_invalid(void) {
+    char path[64];
+    CU_ASSERT_FATAL(frozen_test_tmpname(path, sizeof(path)));
+
+    DSDict *dict = frozen_test_dict(0, 100, "value");
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(!dsdict_freeze_to_file(NULL, path, frozen_test_int, frozen_test_str));
+    CU_ASSERT(!dsdict_freeze_to_file(dict, NULL, frozen_test_int, frozen_test_str));
+    CU_ASSERT(!dsdict_freeze_to_file(dict, path, NULL, frozen_test_str));
+    CU_ASSERT(!dsdict_freeze_to_file(dict, path, frozen_test_int, NULL));
+    CU_ASSERT(dsfrozen_open(NULL) == NULL);
+    dsfrozen_close(NULL);
+
+    // A failed write leaves neither the file nor its temporary behind
+    unlink(path);
+    CU_ASSERT(!dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_fail));
+    CU_ASSERT(access(path, F_OK) != 0);
+    CU_ASSERT(frozen_test_leftovers(path) == 0);
+    CU_ASSERT(dsfrozen_open(path) == NULL);
+
+    // Files which are truncated or damaged are rejected when opened
+    CU_ASSERT_FATAL(dsdict_freeze_to_file(dict, path, frozen_test_int, frozen_test_str));
+    CU_ASSERT(frozen_test_leftovers(path) == 0);
+    FILE *file = fopen(path, "rb");
+    CU_ASSERT_FATAL(file != NULL);
+    CU_ASSERT_FATAL(fseek(file, 0, SEEK_END) == 0);
+    long size = ftell(file);
+    CU_ASSERT_FATAL(size > 64);
+    unsigned char *contents = malloc((size_t)size);
+    CU_ASSERT_FATAL(contents != NULL);
+    rewind(file);
+    CU_ASSERT_FATAL(fread(contents, 1, (size_t)size, file) == (size_t)size);
+    fclose(file);
+
+    file = fopen(path, "wb");
+    CU_ASSERT_FATAL(file != NULL);
+    fwrite(contents, 1, (size_t)size - 8, file);
+    fclose(file);
+    CU_ASSERT(dsfrozen_open(path) == NULL);
+
+    contents[0] = 'X';
+    file = fopen(path, "wb");
+    CU_ASSERT_FATAL(file != NULL);
+    fwrite(contents, 1, (size_t)size, file);
+    fclose(file);
+    CU_ASSERT(dsfrozen_open(path) == NULL);
+
+    file = fopen(path, "wb");
+    CU_ASSERT_FATAL(file != NULL);
+    fwrite(contents, 1, 16, file);
+    fclose(file);
+    CU_ASSERT(dsfrozen_open(path) == NULL);
+
+    free(contents);
+    dsdict_destroy(dict);
+    unlink(path);
+}
+
+// Reserve a unique temporary file name for a frozen dictionary.
+static bool frozen_test_tmpname(char *path, size_t len) {
+    snprintf(path, len, "/tmp/libds_frozen_XXXXXX");
+    int fd = mkstemp(path);
+    if (fd < 0) { return false; }
+    close(fd);
+    return true;
+}
+
+// Count the temporary files left behind by writes to path.
+static size_t frozen_test_leftovers(const char *path) {
+    char pattern[80];
+    snprintf(pattern, sizeof(pattern), "%s.??????", path);
+    glob_t found;
+    if (glob(pattern, 0, NULL, &found) != 0) { return 0; }
+    size_t count = found.gl_pathc;
+    globfree(&found);
+    return count;
+}
+
+// Create a dictionary mapping the integers 0 to nkeys to strings.
+static DSDict *frozen_test_dict(int flags, int nkeys, const char *prefix) {
+    DSDict *dict = dsdict_new_flags(frozen_test_hash, frozen_test_compare, NULL, NULL, flags);
+    if (!dict) { return NULL; }
+
+    for (int i = 0; i < nkeys; i++) {
+        frozen_test_keys[i] = i;
+        snprintf(frozen_test_vals[i], FROZEN_TEST_VALLEN, "%s %d", prefix, i);
+        dsdict_put(dict, &frozen_test_keys[i], frozen_test_vals[i]);
+    }
+
+    return dict;
+}
+
+static uint32_t frozen_test_hash(void *key) {
+    uint32_t h = (uint32_t)(*(int *)key);
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static int frozen_test_compare(const void *left, const void *right) {
+    return *(const int *)left - *(const int *)right;
+}
+
+static const void *frozen_test_int(const void *obj, size_t *len) {
+    *len = sizeof(int);
+    return obj;
+}
+
+static const void *frozen_test_str(const void *obj, size_t *len) {
+    *len = strlen(obj);
+    return obj;
+}
+
+static const void *frozen_test_fail(const void *obj, size_t *len) {
+    (void)obj;
+    *len = 0;
+    return NULL;
+}
+
+static void frozen_test_visit(const void *key, size_t keylen, const void *val, size_t vallen) {
+    int i;
+    memcpy(&i, key, sizeof(i));
+    frozen_test_visited++;
+    frozen_test_bytes += keylen;
+    CU_ASSERT(vallen == strlen(frozen_test_vals[i]));
+    CU_ASSERT(memcmp(val, frozen_test_vals[i], vallen) == 0);
+}
@@ -0,0 +1,19 @@
+/*****************************************************************************
+ * libds :: frozen_test.h
+ *
+ * Test functions for frozen dictionary files.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_FROZEN_TEST_H
+#define LIBDS_FROZEN_TEST_H
+
+void frozen_test_roundtrip(void);
+void frozen_test_replace(void);
+void frozen_test_empty(void);
+void frozen_test_invalid(void);
+
+#endif //LIBDS_FROZEN_TEST_H
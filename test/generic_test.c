@@ -0,0 +1,250 @@
+/*****************************************************************************
+ * libds :: generic_test.c
+ *
+ * Test functions for generated type-specialized containers.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/CUnit.h"
+#include "libds/arena.h"
+#include "libds/generic.h"
+#include "libds/hash.h"
+#include "generic_test.h"
+
+enum { GENERIC_TEST_KEYS = 2000, GENERIC_TEST_OPS = 50000 };
+
+struct point {
+    int x;
+    int y;
+};
+
+// Clustering every key into 8 hashes makes long probe runs, so deletes
+// have to shift many elements back
+#define GENERIC_TEST_WEAK_HASH(key) ((uint32_t)(key) & 7u)
+#define GENERIC_TEST_INT_EQ(left, right) ((left) == (right))
+#define GENERIC_TEST_STR_EQ(left, right) (strcmp((left), (right)) == 0)
+
+LIBDS_DEFINE_VEC(pointvec, struct point)
+LIBDS_DEFINE_DICT(strmap, const char *, struct point, hash_wyhash_str, GENERIC_TEST_STR_EQ)
+LIBDS_DEFINE_DICT(intmap, int, int, GENERIC_TEST_WEAK_HASH, GENERIC_TEST_INT_EQ)
+
+void generic_test_vec(void) {
+    pointvec vec;
+    CU_ASSERT_FATAL(pointvec_init(&vec));
+    CU_ASSERT(pointvec_len(&vec) == 0);
+    CU_ASSERT(pointvec_cap(&vec) == 0);
+    CU_ASSERT(pointvec_get(&vec, 0) == NULL);
+    CU_ASSERT(pointvec_top(&vec) == NULL);
+    CU_ASSERT(!pointvec_pop(&vec, NULL));
+
+    // Grows exactly as a DSArray does
+    for (int i = 0; i < 100; i++) {
+        struct point p = { i, -i };
+        CU_ASSERT(pointvec_append(&vec, p));
+        if (i == 0) {
+            CU_ASSERT(pointvec_cap(&vec) == DSARRAY_DEFAULT_CAPACITY);
+        }
+    }
+    CU_ASSERT(pointvec_len(&vec) == 100);
+    CU_ASSERT(pointvec_cap(&vec) == DSARRAY_DEFAULT_CAPACITY * 16);
+    for (int i = 0; i < 100; i++) {
+        struct point *p = pointvec_get(&vec, (size_t)i);
+        CU_ASSERT_FATAL(p != NULL);
+        CU_ASSERT((p->x == i) && (p->y == -i));
+    }
+    CU_ASSERT(pointvec_get(&vec, 100) == NULL);
+    CU_ASSERT(pointvec_top(&vec)->x == 99);
+
+    // Inserting and removing shift the other elements
+    struct point first = { -1, 1 };
+    CU_ASSERT(pointvec_insert(&vec, first, 0));
+    CU_ASSERT(!pointvec_insert(&vec, first, 102));
+    CU_ASSERT(pointvec_len(&vec) == 101);
+    CU_ASSERT(pointvec_get(&vec, 0)->x == -1);
+    CU_ASSERT(pointvec_get(&vec, 1)->x == 0);
+
+    struct point out = { 0, 0 };
+    CU_ASSERT(pointvec_remove_index(&vec, 50, &out));
+    CU_ASSERT(out.x == 49);
+    CU_ASSERT(pointvec_get(&vec, 50)->x == 50);
+    CU_ASSERT(!pointvec_remove_index(&vec, 100, &out));
+    CU_ASSERT(pointvec_pop(&vec, &out));
+    CU_ASSERT(out.x == 99);
+    CU_ASSERT(pointvec_len(&vec) == 99);
+
+    pointvec_reverse(&vec);
+    CU_ASSERT(pointvec_get(&vec, 0)->x == 98);
+    CU_ASSERT(pointvec_top(&vec)->x == -1);
+
+    CU_ASSERT(pointvec_reserve(&vec, 1000));
+    CU_ASSERT(pointvec_cap(&vec) == 1000);
+    CU_ASSERT(pointvec_get(&vec, 0)->x == 98);
+
+    pointvec_clear(&vec);
+    CU_ASSERT(pointvec_len(&vec) == 0);
+    CU_ASSERT(pointvec_cap(&vec) == 1000);
+    pointvec_destroy(&vec);
+    CU_ASSERT(pointvec_cap(&vec) == 0);
+}
+
+void generic_test_dict(void) {
+    static char keys[GENERIC_TEST_KEYS][16];
+    strmap dict;
+    CU_ASSERT_FATAL(strmap_init(&dict));
+    CU_ASSERT(strmap_count(&dict) == 0);
+    CU_ASSERT(strmap_get(&dict, "missing") == NULL);
+    CU_ASSERT(!strmap_del(&dict, "missing", NULL));
+
+    for (int i = 0; i < GENERIC_TEST_KEYS; i++) {
+        sprintf(keys[i], "Key %d", i);
+        struct point p = { i, i * 2 };
+        CU_ASSERT(strmap_put(&dict, keys[i], p));
+    }
+    CU_ASSERT(strmap_count(&dict) == GENERIC_TEST_KEYS);
+
+    // Keys are compared by value rather than by pointer
+    for (int i = 0; i < GENERIC_TEST_KEYS; i++) {
+        char probe[16];
+        sprintf(probe, "Key %d", i);
+        struct point *p = strmap_get(&dict, probe);
+        CU_ASSERT_FATAL(p != NULL);
+        CU_ASSERT((p->x == i) && (p->y == i * 2));
+    }
+
+    // Overwriting keeps the count and replaces the value
+    struct point replaced = { -5, -5 };
+    CU_ASSERT(strmap_put(&dict, "Key 5", replaced));
+    CU_ASSERT(strmap_count(&dict) == GENERIC_TEST_KEYS);
+    CU_ASSERT(strmap_get(&dict, "Key 5")->x == -5);
+
+    // Upserts add zeroed values
+    bool inserted;
+    struct point *slot = strmap_get_or_insert(&dict, "new", &inserted);
+    CU_ASSERT_FATAL(slot != NULL);
+    CU_ASSERT(inserted);
+    CU_ASSERT((slot->x == 0) && (slot->y == 0));
+    slot->x = 7;
+    slot = strmap_get_or_insert(&dict, "new", &inserted);
+    CU_ASSERT_FATAL(slot != NULL);
+    CU_ASSERT(!inserted);
+    CU_ASSERT(slot->x == 7);
+
+    struct point out;
+    CU_ASSERT(strmap_del(&dict, "new", &out));
+    CU_ASSERT(out.x == 7);
+    CU_ASSERT(strmap_get(&dict, "new") == NULL);
+
+    // Every element is visited exactly once
+    static bool seen[GENERIC_TEST_KEYS];
+    memset(seen, 0, sizeof(seen));
+    size_t pos = 0;
+    size_t n = 0;
+    const char **key;
+    struct point *val;
+    while (strmap_next(&dict, &pos, &key, &val)) {
+        int i = atoi(*key + 4);
+        CU_ASSERT(!seen[i]);
+        seen[i] = true;
+        n++;
+    }
+    CU_ASSERT(n == GENERIC_TEST_KEYS);
+
+    // Deleting down to a few elements shrinks the table again
+    size_t cap = strmap_cap(&dict);
+    for (int i = 0; i < GENERIC_TEST_KEYS - 10; i++) {
+        CU_ASSERT(strmap_del(&dict, keys[i], NULL));
+    }
+    CU_ASSERT(strmap_count(&dict) == 10);
+    CU_ASSERT(strmap_cap(&dict) < cap);
+    for (int i = GENERIC_TEST_KEYS - 10; i < GENERIC_TEST_KEYS; i++) {
+        CU_ASSERT(strmap_get(&dict, keys[i]) != NULL);
+    }
+
+    strmap_clear(&dict);
+    CU_ASSERT(strmap_count(&dict) == 0);
+    CU_ASSERT(strmap_get(&dict, keys[GENERIC_TEST_KEYS - 1]) == NULL);
+    strmap_destroy(&dict);
+}
+
+void generic_test_dict_random(void) {
+    static int expected[GENERIC_TEST_KEYS];
+    static bool present[GENERIC_TEST_KEYS];
+    memset(present, 0, sizeof(present));
+    size_t cnt = 0;
+
+    intmap dict;
+    CU_ASSERT_FATAL(intmap_init(&dict));
+    CU_ASSERT(intmap_reserve(&dict, 100));
+    CU_ASSERT(intmap_cap(&dict) == 256);
+
+    srand(19);
+    for (int op = 0; op < GENERIC_TEST_OPS; op++) {
+        int key = rand() % GENERIC_TEST_KEYS;
+        switch (rand() % 3) {
+            case 0: {
+                CU_ASSERT_FATAL(intmap_put(&dict, key, op));
+                if (!present[key]) { cnt++; }
+                present[key] = true;
+                expected[key] = op;
+                break;
+            }
+            case 1: {
+                int out = -1;
+                CU_ASSERT(intmap_del(&dict, key, &out) == present[key]);
+                if (present[key]) {
+                    CU_ASSERT(out == expected[key]);
+                    cnt--;
+                }
+                present[key] = false;
+                break;
+            }
+            default: {
+                int *val = intmap_get(&dict, key);
+                CU_ASSERT((val != NULL) == present[key]);
+                if ((val) && (present[key])) {
+                    CU_ASSERT(*val == expected[key]);
+                }
+                break;
+            }
+        }
+    }
+
+    CU_ASSERT(intmap_count(&dict) == cnt);
+    for (int i = 0; i < GENERIC_TEST_KEYS; i++) {
+        int *val = intmap_get(&dict, i);
+        CU_ASSERT((val != NULL) == present[i]);
+        if ((val) && (present[i])) {
+            CU_ASSERT(*val == expected[i]);
+        }
+    }
+    intmap_destroy(&dict);
+}
+
+void generic_test_alloc(void) {
+    DSArena *arena = dsarena_new(0);
+    CU_ASSERT_FATAL(arena != NULL);
+
+    pointvec vec;
+    intmap dict;
+    CU_ASSERT_FATAL(pointvec_init_alloc(&vec, dsarena_allocator(arena)));
+    CU_ASSERT_FATAL(intmap_init_alloc(&dict, dsarena_allocator(arena)));
+    for (int i = 0; i < 500; i++) {
+        struct point p = { i, i };
+        CU_ASSERT(pointvec_append(&vec, p));
+        CU_ASSERT(intmap_put(&dict, i, i));
+    }
+    CU_ASSERT(dsarena_used(arena) > 0);
+    CU_ASSERT(pointvec_get(&vec, 499)->y == 499);
+    CU_ASSERT(*intmap_get(&dict, 499) == 499);
+
+    pointvec_destroy(&vec);
+    intmap_destroy(&dict);
+    dsarena_destroy(arena);
+}
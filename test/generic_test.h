@@ -0,0 +1,19 @@
+/*****************************************************************************
+ * libds :: generic_test.h
+ *
+ * Test functions for generated type-specialized containers.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_GENERIC_TEST_H
+#define LIBDS_GENERIC_TEST_H
+
+void generic_test_vec(void);
+void generic_test_dict(void);
+void generic_test_dict_random(void);
+void generic_test_alloc(void);
+
+#endif //LIBDS_GENERIC_TEST_H
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * libds :: hash_test.c
+ *
+ * Test functions for hashing algorithms.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "CUnit/CUnit.h"
+#include "libds/hash.h"
+#include "hash_test.h"
+
+static uint32_t hash_test_crc32c_ref(const uint8_t *p, size_t len, uint32_t crc);
+
+void hash_test_wyhash(void) {
+    /* Known value from the reference implementation */
+    CU_ASSERT(hash_wyhash("", 0, 0) == 0x93228a4de0eec5a2ull);
+
+    /* Hashes depend on the seed and are stable between calls */
+    const char *str = "https://example.com/some/long/request/path?with=query";
+    size_t len = strlen(str);
+    CU_ASSERT(hash_wyhash(str, len, 0) == hash_wyhash(str, len, 0));
+    CU_ASSERT(hash_wyhash(str, len, 0) != hash_wyhash(str, len, 1));
+    CU_ASSERT(hash_wyhash_str(str) == (uint32_t)hash_wyhash(str, len, 0));
+
+    /* Every length is hashed exactly, including embedded NUL bytes */
+    uint8_t buf[256];
+    memset(buf, 0, sizeof(buf));
+    uint64_t hashes[sizeof(buf) + 1];
+    for (size_t i = 0; i <= sizeof(buf); i++) {
+        hashes[i] = hash_wyhash(buf, i, 0);
+        for (size_t j = 0; j < i; j++) {
+            CU_ASSERT(hashes[i] != hashes[j]);
+        }
+    }
+
+    /* Flipping any single bit changes the hash */
+    for (size_t i = 0; i < 100; i++) {
+        buf[i] = (uint8_t)(i * 13);
+    }
+    uint64_t base = hash_wyhash(buf, 100, 0);
+    for (size_t i = 0; i < 100 * 8; i++) {
+        buf[i / 8] ^= (uint8_t)(1 << (i % 8));
+        CU_ASSERT(hash_wyhash(buf, 100, 0) != base);
+        buf[i / 8] ^= (uint8_t)(1 << (i % 8));
+    }
+    CU_ASSERT(hash_wyhash(buf, 100, 0) == base);
+}
+
+void hash_test_wyhash_stream(void) {
+    uint8_t buf[500];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)((i * 29) + 11);
+    }
+
+    /* Every way of splitting the input gives the one-shot hash */
+    const size_t steps[] = { 1, 3, 7, 16, 17, 47, 48, 49, 100 };
+    for (size_t len = 0; len <= sizeof(buf); len += 7) {
+        uint64_t expected = hash_wyhash(buf, len, 42);
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+            DSWyhashState state;
+            hash_wyhash_init(&state, 42);
+            for (size_t off = 0; off < len; off += steps[s]) {
+                size_t n = ((len - off) < steps[s]) ? (len - off) : steps[s];
+                hash_wyhash_update(&state, &buf[off], n);
+            }
+            CU_ASSERT(hash_wyhash_final(&state) == expected);
+        }
+    }
+
+    /* Finalizing does not prevent adding more data */
+    DSWyhashState state;
+    hash_wyhash_init(&state, 0);
+    hash_wyhash_update(&state, buf, 60);
+    CU_ASSERT(hash_wyhash_final(&state) == hash_wyhash(buf, 60, 0));
+    hash_wyhash_update(&state, &buf[60], 5);
+    CU_ASSERT(hash_wyhash_final(&state) == hash_wyhash(buf, 65, 0));
+}
+
+void hash_test_crc32c(void) {
+    /* Standard check value for CRC32C */
+    CU_ASSERT(hash_crc32c("123456789", 9, 0) == 0xE3069283);
+    CU_ASSERT(hash_crc32c_str("123456789") == 0xE3069283);
+    CU_ASSERT(hash_crc32c("", 0, 0) == 0);
+
+    /* Match a bitwise reference at every length and alignment */
+    uint8_t buf[300];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)((i * 131) + 7);
+    }
+    for (size_t off = 0; off < 8; off++) {
+        for (size_t len = 0; (off + len) <= sizeof(buf); len += 3) {
+            CU_ASSERT(hash_crc32c(&buf[off], len, 0) == hash_test_crc32c_ref(&buf[off], len, 0));
+        }
+    }
+
+    /* Checksums can be computed incrementally by chaining the seed */
+    uint32_t whole = hash_crc32c(buf, sizeof(buf), 0);
+    for (size_t split = 0; split <= sizeof(buf); split += 17) {
+        uint32_t first = hash_crc32c(buf, split, 0);
+        CU_ASSERT(hash_crc32c(&buf[split], sizeof(buf) - split, first) == whole);
+    }
+}
+
+void hash_test_u64(void) {
+    /* SplitMix64 reference output for a state of 0 */
+    CU_ASSERT(hash_u64(0, 0) == 0xE220A8397B1DCDAFull);
+    CU_ASSERT(hash_u64(1, 0) != hash_u64(2, 0));
+    CU_ASSERT(hash_u64(1, 0) != hash_u64(1, 1));
+
+    /* Flipping any input bit flips about half of the output bits */
+    for (int bit = 0; bit < 64; bit++) {
+        int total = 0;
+        for (uint64_t key = 1; key <= 64; key++) {
+            uint64_t diff = hash_u64(key, 0) ^ hash_u64(key ^ ((uint64_t)1 << bit), 0);
+            for (; diff; diff &= diff - 1) {
+                total++;
+            }
+        }
+        CU_ASSERT((total > 24 * 64) && (total < 40 * 64));
+    }
+}
+
+// Bit at a time CRC32C used to check the optimized implementations.
+static uint32_t hash_test_crc32c_ref(const uint8_t *p, size_t len, uint32_t crc) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0x82F63B78) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,19 @@
+/*****************************************************************************
+ * libds :: hash_test.h
+ *
+ * Test functions for hashing algorithms.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_HASH_TEST_H
+#define LIBDS_HASH_TEST_H
+
+void hash_test_wyhash(void);
+void hash_test_wyhash_stream(void);
+void hash_test_crc32c(void);
+void hash_test_u64(void);
+
+#endif //LIBDS_HASH_TEST_H
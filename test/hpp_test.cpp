@@ -0,0 +1,337 @@
+/*****************************************************************************
+ * libds :: hpp_test.cpp
+ *
+ * Test functions for the C++ facade. The tests are exported with C linkage
+ * so they can be registered by the C test runner.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "CUnit/CUnit.h"
+#include "libds/libds.hpp"
+
+extern "C" {
+#include "hpp_test.h"
+}
+
+namespace {
+
+const int HPP_TEST_KEYS = 2000;
+const int HPP_TEST_OPS = 50000;
+
+// Element type which counts how many instances are alive, to check that
+// containers construct and destroy exactly as many elements as they hold.
+struct counted {
+    static int live;
+    int val;
+
+    counted() : val(0) { live++; }
+    explicit counted(int v) : val(v) { live++; }
+    counted(const counted &other) : val(other.val) { live++; }
+    counted(counted &&other) : val(other.val) { other.val = -1; live++; }
+    ~counted() { live--; }
+    counted &operator=(const counted &other) { val = other.val; return *this; }
+    counted &operator=(counted &&other) { val = other.val; other.val = -1; return *this; }
+};
+
+int counted::live = 0;
+
+// Element type whose copies start throwing after a set number, and whose
+// moves may throw, so containers must copy it to stay exception safe.
+struct fragile {
+    static int copies_left;
+    int val;
+
+    explicit fragile(int v) : val(v) {}
+    fragile(const fragile &other) : val(other.val) {
+        if (copies_left-- == 0) { throw std::runtime_error("fragile copy"); }
+    }
+    fragile(fragile &&other) : val(other.val) { other.val = -1; }
+};
+
+int fragile::copies_left = 0;
+
+// Hash which clusters every key into 8 hashes, so deletes have to shift
+// long probe runs back.
+struct weak_hash {
+    uint32_t operator()(int key) const { return static_cast<uint32_t>(key) & 7u; }
+};
+
+}
+
+void hpp_test_buffer(void) {
+    ds::buffer buf("Hello");
+    CU_ASSERT(buf.size() == 5);
+    CU_ASSERT(buf == "Hello");
+    buf += ", ";
+    buf += ds::buffer("world");
+    buf += '!';
+    CU_ASSERT(buf == "Hello, world!");
+    CU_ASSERT(buf[7] == 'w');
+    CU_ASSERT(buf.substr(7, 5) == "world");
+
+    bool threw = false;
+    try {
+        buf.substr(100, 1);
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    CU_ASSERT(threw);
+
+    // Copies are independent, moves transfer the underlying buffer
+    ds::buffer copy(buf);
+    copy += "?";
+    CU_ASSERT(buf == "Hello, world!");
+    CU_ASSERT(copy == "Hello, world!?");
+    DSBuffer *raw = copy.get();
+    ds::buffer moved(std::move(copy));
+    CU_ASSERT(moved.get() == raw);
+    CU_ASSERT(copy.get() == nullptr);
+
+    CU_ASSERT(ds::buffer("abc") < ds::buffer("abd"));
+    CU_ASSERT(ds::buffer(std::string("abc")) == "abc");
+    CU_ASSERT(ds::hash<ds::buffer>()(ds::buffer("abc")) == dsbuf_hash(ds::buffer("abc").get()));
+
+    DSBuffer *released = moved.release();
+    CU_ASSERT(released == raw);
+    dsbuf_destroy(released);
+}
+
+void hpp_test_array(void) {
+    {
+        ds::array<counted> arr;
+        CU_ASSERT(arr.empty());
+        CU_ASSERT(arr.capacity() == 0);
+
+        // Grows exactly as a DSArray does
+        for (int i = 0; i < 100; i++) {
+            arr.emplace_back(i);
+            if (i == 0) {
+                CU_ASSERT(arr.capacity() == DSARRAY_DEFAULT_CAPACITY);
+            }
+        }
+        CU_ASSERT(arr.size() == 100);
+        CU_ASSERT(arr.capacity() == DSARRAY_DEFAULT_CAPACITY * 16);
+        CU_ASSERT(counted::live == 100);
+
+        int expected = 0;
+        for (const counted &c : arr) {
+            CU_ASSERT(c.val == expected);
+            expected++;
+        }
+
+        arr.insert(0, counted(-1));
+        CU_ASSERT(arr[0].val == -1);
+        CU_ASSERT(arr[1].val == 0);
+        CU_ASSERT(arr.remove_index(50).val == 49);
+        CU_ASSERT(arr.pop().val == 99);
+        CU_ASSERT(arr.size() == 99);
+        CU_ASSERT(counted::live == 99);
+
+        arr.reverse();
+        CU_ASSERT(arr[0].val == 98);
+        CU_ASSERT(arr.back().val == -1);
+
+        bool threw = false;
+        try {
+            arr.at(99);
+        } catch (const std::out_of_range &) {
+            threw = true;
+        }
+        CU_ASSERT(threw);
+
+        ds::array<counted> copy(arr);
+        CU_ASSERT(copy.size() == 99);
+        CU_ASSERT(counted::live == 198);
+        ds::array<counted> moved(std::move(copy));
+        CU_ASSERT(copy.size() == 0);
+        CU_ASSERT(moved[0].val == 98);
+        CU_ASSERT(counted::live == 198);
+
+        moved.clear();
+        CU_ASSERT(counted::live == 99);
+
+        ds::array<std::string> strs = { "a", "b", "c" };
+        CU_ASSERT(strs.size() == 3);
+        CU_ASSERT(strs[2] == "c");
+    }
+    CU_ASSERT(counted::live == 0);
+}
+
+void hpp_test_array_growth(void) {
+    // Elements passed by reference to an array that must grow are read
+    // before the old storage is released
+    ds::array<std::string> strs;
+    std::string text(40, 'x');
+    for (size_t i = 0; i < DSARRAY_DEFAULT_CAPACITY; i++) {
+        strs.push_back(text);
+    }
+    CU_ASSERT(strs.size() == strs.capacity());
+    strs.push_back(strs[0]);
+    CU_ASSERT(strs.back() == text);
+    while (strs.size() < strs.capacity()) {
+        strs.emplace_back(text);
+    }
+    strs.emplace_back(strs[strs.size() - 1]);
+    for (const std::string &s : strs) {
+        CU_ASSERT(s == text);
+    }
+
+    // An element which throws while being copied into larger storage
+    // leaves the array as it was
+    ds::array<fragile> arr;
+    arr.reserve(4);
+    for (int i = 0; i < 4; i++) {
+        arr.emplace_back(i);
+    }
+    fragile::copies_left = 2;
+    bool threw = false;
+    try {
+        arr.reserve(64);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    CU_ASSERT(threw);
+    CU_ASSERT(arr.capacity() == 4);
+    for (int i = 0; i < 4; i++) {
+        CU_ASSERT(arr[static_cast<size_t>(i)].val == i);
+    }
+
+    fragile::copies_left = 2;
+    threw = false;
+    try {
+        arr.emplace_back(4);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    CU_ASSERT(threw);
+    CU_ASSERT(arr.size() == 4);
+    CU_ASSERT(arr[3].val == 3);
+
+    fragile::copies_left = 4;
+    arr.emplace_back(4);
+    CU_ASSERT(arr.size() == 5);
+    CU_ASSERT(arr[0].val == 0);
+    CU_ASSERT(arr[4].val == 4);
+}
+
+void hpp_test_dict(void) {
+    {
+        ds::dict<std::string, counted> dict;
+        CU_ASSERT(dict.empty());
+        CU_ASSERT(dict.get("missing") == nullptr);
+        CU_ASSERT(!dict.del("missing"));
+
+        for (int i = 0; i < HPP_TEST_KEYS; i++) {
+            CU_ASSERT(dict.put("Key " + std::to_string(i), counted(i)));
+        }
+        CU_ASSERT(dict.size() == static_cast<size_t>(HPP_TEST_KEYS));
+        CU_ASSERT(counted::live == HPP_TEST_KEYS);
+        for (int i = 0; i < HPP_TEST_KEYS; i++) {
+            counted *c = dict.get("Key " + std::to_string(i));
+            CU_ASSERT_FATAL(c != nullptr);
+            CU_ASSERT(c->val == i);
+        }
+
+        // Overwriting keeps the count and replaces the value
+        CU_ASSERT(!dict.put("Key 5", counted(-5)));
+        CU_ASSERT(dict.get("Key 5")->val == -5);
+        CU_ASSERT(dict.size() == static_cast<size_t>(HPP_TEST_KEYS));
+
+        bool inserted;
+        counted &fresh = dict.get_or_insert("new", &inserted);
+        CU_ASSERT(inserted);
+        CU_ASSERT(fresh.val == 0);
+        dict["new"].val = 7;
+        CU_ASSERT(dict.contains("new"));
+        counted out;
+        CU_ASSERT(dict.del("new", out));
+        CU_ASSERT(out.val == 7);
+        CU_ASSERT(!dict.contains("new"));
+
+        size_t n = 0;
+        for (auto &entry : dict) {
+            CU_ASSERT(entry.first == "Key " + std::to_string(entry.second.val) || entry.first == "Key 5");
+            n++;
+        }
+        CU_ASSERT(n == dict.size());
+
+        // Copies are independent, moves transfer the table
+        ds::dict<std::string, counted> copy(dict);
+        CU_ASSERT(copy.size() == dict.size());
+        copy.del("Key 0");
+        CU_ASSERT(dict.contains("Key 0"));
+        ds::dict<std::string, counted> moved(std::move(copy));
+        CU_ASSERT(copy.size() == 0);
+        CU_ASSERT(moved.size() == dict.size() - 1);
+
+        // Deleting down to a few elements shrinks the table again
+        size_t cap = dict.capacity();
+        for (int i = 0; i < HPP_TEST_KEYS - 10; i++) {
+            CU_ASSERT(dict.del("Key " + std::to_string(i)));
+        }
+        CU_ASSERT(dict.size() == 10);
+        CU_ASSERT(dict.capacity() < cap);
+        CU_ASSERT(dict.get("Key " + std::to_string(HPP_TEST_KEYS - 1))->val == HPP_TEST_KEYS - 1);
+
+        dict.clear();
+        CU_ASSERT(dict.empty());
+        CU_ASSERT(counted::live == static_cast<int>(moved.size()) + 1);
+    }
+    CU_ASSERT(counted::live == 0);
+
+    ds::dict<int, int> ints;
+    ints.reserve(100);
+    CU_ASSERT(ints.capacity() == 256);
+}
+
+void hpp_test_dict_random(void) {
+    static int expected[HPP_TEST_KEYS];
+    static bool present[HPP_TEST_KEYS];
+    for (int i = 0; i < HPP_TEST_KEYS; i++) {
+        present[i] = false;
+    }
+    size_t cnt = 0;
+
+    ds::dict<int, int, weak_hash> dict;
+    srand(23);
+    for (int op = 0; op < HPP_TEST_OPS; op++) {
+        int key = rand() % HPP_TEST_KEYS;
+        switch (rand() % 3) {
+            case 0:
+                CU_ASSERT(dict.put(key, op) == !present[key]);
+                if (!present[key]) { cnt++; }
+                present[key] = true;
+                expected[key] = op;
+                break;
+            case 1:
+                CU_ASSERT(dict.del(key) == present[key]);
+                if (present[key]) { cnt--; }
+                present[key] = false;
+                break;
+            default: {
+                int *val = dict.get(key);
+                CU_ASSERT((val != nullptr) == present[key]);
+                if ((val) && (present[key])) {
+                    CU_ASSERT(*val == expected[key]);
+                }
+                break;
+            }
+        }
+    }
+
+    CU_ASSERT(dict.size() == cnt);
+    for (int i = 0; i < HPP_TEST_KEYS; i++) {
+        const int *val = static_cast<const ds::dict<int, int, weak_hash> &>(dict).get(i);
+        CU_ASSERT((val != nullptr) == present[i]);
+        if ((val) && (present[i])) {
+            CU_ASSERT(*val == expected[i]);
+        }
+    }
+}
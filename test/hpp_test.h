@@ -0,0 +1,20 @@
+/*****************************************************************************
+ * libds :: hpp_test.h
+ *
+ * Test functions for the C++ facade.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_HPP_TEST_H
+#define LIBDS_HPP_TEST_H
+
+void hpp_test_buffer(void);
+void hpp_test_array(void);
+void hpp_test_array_growth(void);
+void hpp_test_dict(void);
+void hpp_test_dict_random(void);
+
+#endif //LIBDS_HPP_TEST_H
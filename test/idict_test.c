@@ -0,0 +1,227 @@
+/*****************************************************************************
+ * libds :: idict_test.c
+ *
+ * Test functions for integer keyed dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "CUnit/CUnit.h"
+#include "libds/idict.h"
+#include "idict_test.h"
+
+enum { IDICT_TEST_KEYS = 4096 };
+
+static size_t idict_test_freed = 0;
+static size_t idict_test_visited = 0;
+
+static void idict_test_counting_free(void *val);
+static void idict_test_visit(uint64_t key, void *val);
+
+void idict_test_basic(void) {
+    static int vals[IDICT_TEST_KEYS];
+    idict_test_freed = 0;
+    DSIntDict *dict = dsidict_new(idict_test_counting_free);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dsidict_count(dict) == 0);
+    CU_ASSERT(dsidict_get(dict, 0) == NULL);
+
+    // Sequential IDs (including 0) and IDs which differ only in their
+    // high bits all land in a power of 2 table without trouble
+    for (uint64_t i = 0; i < IDICT_TEST_KEYS; i++) {
+        uint64_t key = (i % 2 == 0) ? i : (i << 40);
+        CU_ASSERT(dsidict_put(dict, key, &vals[i]));
+    }
+    CU_ASSERT(dsidict_count(dict) == IDICT_TEST_KEYS);
+    for (uint64_t i = 0; i < IDICT_TEST_KEYS; i++) {
+        uint64_t key = (i % 2 == 0) ? i : (i << 40);
+        CU_ASSERT(dsidict_get(dict, key) == &vals[i]);
+    }
+    CU_ASSERT(dsidict_get(dict, 1) == NULL);
+    CU_ASSERT(dsidict_get(dict, UINT64_MAX) == NULL);
+
+    // Overwriting frees the old value
+    CU_ASSERT(dsidict_put(dict, 0, &vals[1]));
+    CU_ASSERT(dsidict_put(dict, (uint64_t)3 << 40, &vals[2]));
+    CU_ASSERT(idict_test_freed == 2);
+    CU_ASSERT(dsidict_count(dict) == IDICT_TEST_KEYS);
+    CU_ASSERT(dsidict_get(dict, 0) == &vals[1]);
+
+    // Deleted values are returned rather than freed
+    CU_ASSERT(dsidict_del(dict, 0) == &vals[1]);
+    CU_ASSERT(dsidict_del(dict, 0) == NULL);
+    CU_ASSERT(dsidict_get(dict, 0) == NULL);
+    CU_ASSERT(dsidict_del(dict, 2) == &vals[2]);
+    CU_ASSERT(dsidict_del(dict, 1) == NULL);
+    CU_ASSERT(dsidict_count(dict) == IDICT_TEST_KEYS - 2);
+    CU_ASSERT(idict_test_freed == 2);
+
+    // Upserts share a single probe
+    bool inserted;
+    void **slot = dsidict_get_or_insert(dict, UINT64_MAX, &inserted);
+    CU_ASSERT_FATAL(slot != NULL);
+    CU_ASSERT(inserted);
+    CU_ASSERT(*slot == NULL);
+    *slot = &vals[3];
+    slot = dsidict_get_or_insert(dict, UINT64_MAX, &inserted);
+    CU_ASSERT_FATAL(slot != NULL);
+    CU_ASSERT(!inserted);
+    CU_ASSERT(*slot == &vals[3]);
+
+    idict_test_visited = 0;
+    dsidict_foreach(dict, idict_test_visit);
+    CU_ASSERT(idict_test_visited == dsidict_count(dict));
+
+    size_t cnt = dsidict_count(dict);
+    dsidict_destroy(dict);
+    CU_ASSERT(idict_test_freed == cnt + 2);
+
+    CU_ASSERT(dsidict_get(NULL, 1) == NULL);
+    CU_ASSERT(!dsidict_put(NULL, 1, NULL));
+    CU_ASSERT(dsidict_del(NULL, 1) == NULL);
+}
+
+void idict_test_random(void) {
+    // Keys from a small range collide often, so deletions regularly shift
+    // long probe runs (including runs which wrap around the table)
+    enum { range = 700, steps = 200000 };
+    static bool present[range];
+    static int vals[range];
+    for (int i = 0; i < range; i++) {
+        present[i] = false;
+    }
+
+    DSIntDict *dict = dsidict_new(NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+
+    size_t cnt = 0;
+    size_t errors = 0;
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (int step = 0; step < steps; step++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        int k = (int)((state >> 33) % range);
+        uint64_t key = (uint64_t)k * 0x10000;
+        switch ((state >> 20) % 3) {
+            case 0:
+                dsidict_put(dict, key, &vals[k]);
+                if (!present[k]) { cnt++; }
+                present[k] = true;
+                break;
+            case 1:
+                if (dsidict_del(dict, key) != (present[k] ? &vals[k] : NULL)) { errors++; }
+                if (present[k]) { cnt--; }
+                present[k] = false;
+                break;
+            default:
+                if (dsidict_get(dict, key) != (present[k] ? &vals[k] : NULL)) { errors++; }
+                break;
+        }
+        if (dsidict_count(dict) != cnt) { errors++; }
+    }
+    CU_ASSERT(errors == 0);
+
+    for (int k = 0; k < range; k++) {
+        CU_ASSERT(dsidict_get(dict, (uint64_t)k * 0x10000) == (present[k] ? &vals[k] : NULL));
+    }
+    dsidict_destroy(dict);
+}
+
+void idict_test_iter(void) {
+    static int vals[IDICT_TEST_KEYS];
+    static bool seen[IDICT_TEST_KEYS];
+    DSIntDict *dict = dsidict_new(NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < IDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsidict_put(dict, (uint64_t)i, &vals[i]));
+        seen[i] = false;
+    }
+
+    DSIter *iter = dsidict_iter(dict);
+    CU_ASSERT_FATAL(iter != NULL);
+    for (int pass = 0; pass < 2; pass++) {
+        size_t n = 0;
+        while (dsiter_next(iter)) {
+            uint64_t *key = dsiter_key(iter);
+            CU_ASSERT_FATAL(key != NULL);
+            CU_ASSERT_FATAL(*key < IDICT_TEST_KEYS);
+            CU_ASSERT(dsiter_value(iter) == &vals[*key]);
+            CU_ASSERT(seen[*key] == (pass == 1));
+            seen[*key] = true;
+            n++;
+        }
+        CU_ASSERT(n == IDICT_TEST_KEYS);
+        CU_ASSERT(!dsiter_has_next(iter));
+        CU_ASSERT(dsiter_key(iter) == NULL);
+        CU_ASSERT(dsiter_value(iter) == NULL);
+        dsiter_reset(iter);
+    }
+    dsiter_destroy(iter);
+    dsidict_destroy(dict);
+}
+
+void idict_test_sizing(void) {
+    static int vals[IDICT_TEST_KEYS];
+    DSIntDict *dict = dsidict_new_cap(1000, NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    size_t cap = dsidict_cap(dict);
+    CU_ASSERT(cap == 2048);
+    for (int i = 0; i < 1000; i++) {
+        CU_ASSERT(dsidict_put(dict, (uint64_t)i + 1, &vals[i]));
+    }
+    CU_ASSERT(dsidict_cap(dict) == cap);
+
+    // Pre-sized dictionaries do not shrink below their initial size
+    for (int i = 10; i < 1000; i++) {
+        CU_ASSERT(dsidict_del(dict, (uint64_t)i + 1) == &vals[i]);
+    }
+    CU_ASSERT(dsidict_cap(dict) == cap);
+    dsidict_shrink_to_fit(dict);
+    CU_ASSERT(dsidict_cap(dict) == 16);
+
+    CU_ASSERT(dsidict_reserve(dict, IDICT_TEST_KEYS));
+    cap = dsidict_cap(dict);
+    for (int i = 0; i < IDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsidict_put(dict, (uint64_t)i + 1, &vals[i]));
+    }
+    CU_ASSERT(dsidict_cap(dict) == cap);
+    dsidict_destroy(dict);
+
+    // Dictionaries shrink automatically once mostly empty
+    dict = dsidict_new(NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < IDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsidict_put(dict, (uint64_t)i, &vals[i]));
+    }
+    size_t peak = dsidict_cap(dict);
+    for (int i = 20; i < IDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsidict_del(dict, (uint64_t)i) == &vals[i]);
+    }
+    CU_ASSERT(dsidict_cap(dict) < peak);
+    for (int i = 0; i < IDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsidict_get(dict, (uint64_t)i) == ((i < 20) ? &vals[i] : NULL));
+    }
+    dsidict_destroy(dict);
+
+    CU_ASSERT(!dsidict_reserve(NULL, 10));
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+// Free function which counts the values it is given.
+static void idict_test_counting_free(void *val) {
+    (void)val;
+    idict_test_freed++;
+}
+
+// Foreach function which counts the elements it visits.
+static void idict_test_visit(uint64_t key, void *val) {
+    (void)key;
+    if (val) { idict_test_visited++; }
+}
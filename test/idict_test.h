@@ -0,0 +1,19 @@
+/*****************************************************************************
+ * libds :: idict_test.h
+ *
+ * Test functions for integer keyed dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_IDICT_TEST_H
+#define LIBDS_IDICT_TEST_H
+
+void idict_test_basic(void);
+void idict_test_random(void);
+void idict_test_iter(void);
+void idict_test_sizing(void);
+
+#endif //LIBDS_IDICT_TEST_H
@@ -19,7 +19,13 @@
 
 static DSList *list_test = NULL;
 
+struct list_test_region {
+    char buf[64 * 1024];
+    size_t used;
+};
+
 static int list_test_comparator(const void *left, const void *right);
+static void *list_test_region_alloc(void *ctx, size_t size);
 
 void list_test_setup(void) {
     list_test = dslist_new((dslist_compare_fn) list_test_comparator, free);
@@ -361,6 +367,79 @@ void list_test_queue(void) {
     }
 }
 
+void list_test_node_reuse(void) {
+    /* Churn through many more nodes than are ever live at once */
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 1000; i++) {
+            char *val = malloc(16);
+            CU_ASSERT_FATAL(val != NULL);
+            sprintf(val, "Str %d", i);
+            CU_ASSERT(dslist_enqueue(list_test, val) == true);
+            if (i % 3 == 0) {
+                free(dslist_dequeue(list_test));
+            }
+        }
+        CU_ASSERT(dslist_len(list_test) == 666);
+
+        /* Nodes in the middle of the list must stay linked both ways */
+        char *mid = malloc(16);
+        CU_ASSERT_FATAL(mid != NULL);
+        strcpy(mid, "Middle");
+        CU_ASSERT(dslist_insert(list_test, mid, 300) == true);
+        CU_ASSERT(dslist_get(list_test, 300) == mid);
+        dslist_reverse(list_test);
+        CU_ASSERT(dslist_get(list_test, 366) == mid);
+        CU_ASSERT(dslist_len(list_test) == 667);
+
+        /* Clearing releases every node, and the list remains usable */
+        dslist_clear(list_test);
+        CU_ASSERT(dslist_len(list_test) == 0);
+        CU_ASSERT(dslist_dequeue(list_test) == NULL);
+    }
+}
+
+void list_test_allocator(void) {
+    /* Region allocators do not need to provide free or realloc */
+    static struct list_test_region region;
+    region.used = 0;
+    DSAllocator alloc = { list_test_region_alloc, NULL, NULL, NULL, &region };
+
+    DSList *list = dslist_new_alloc((dslist_compare_fn) list_test_comparator, NULL, &alloc);
+    CU_ASSERT_FATAL(list != NULL);
+    CU_ASSERT(region.used > 0);
+
+    char *vals[] = { "first", "second", "third" };
+    for (int round = 0; round < 100; round++) {
+        for (size_t i = 0; i < 3; i++) {
+            CU_ASSERT(dslist_append(list, vals[i]) == true);
+        }
+        CU_ASSERT(dslist_pop(list) == vals[2]);
+    }
+    CU_ASSERT(dslist_len(list) == 200);
+    CU_ASSERT(dslist_get(list, 199) == vals[1]);
+
+    DSIter *iter = dslist_iter(list);
+    CU_ASSERT_FATAL(iter != NULL);
+    size_t count_iters = 0;
+    while (dsiter_next(iter)) {
+        count_iters++;
+    }
+    CU_ASSERT(count_iters == 200);
+    dsiter_destroy(iter);
+
+    /* Nodes cannot be moved between lists with different allocators */
+    DSList *other = dslist_new((dslist_compare_fn) list_test_comparator, NULL);
+    CU_ASSERT_FATAL(other != NULL);
+    CU_ASSERT(dslist_append(other, vals[0]) == true);
+    CU_ASSERT(dslist_extend(list, other) == false);
+    CU_ASSERT(dslist_len(other) == 1);
+    dslist_destroy(other);
+
+    size_t used = region.used;
+    dslist_destroy(list);
+    CU_ASSERT(region.used == used);
+}
+
 void list_test_iter(void) {
     int num_iters = 0;
     DSList *list = dslist_new((dslist_compare_fn) dsbuf_compare,
@@ -403,3 +482,15 @@ static int list_test_comparator(const void *left, const void *right) {
     const char *r = *(const void**)right;
     return strcmp(l, r);
 }
+
+// Simple bump allocator over a static region which never frees memory.
+static void *list_test_region_alloc(void *ctx, size_t size) {
+    struct list_test_region *region = ctx;
+    size_t align = sizeof(long double);
+    size_t start = ((region->used + align - 1) / align) * align;
+    if ((start + size) > sizeof(region->buf)) {
+        return NULL;
+    }
+    region->used = start + size;
+    return &region->buf[start];
+}
@@ -24,6 +24,8 @@ void list_test_pop(void);
 void list_test_reverse(void);
 void list_test_clear(void);
 void list_test_queue(void);
+void list_test_node_reuse(void);
+void list_test_allocator(void);
 void list_test_iter(void);
 
 #endif //LIBDS_LIST_TEST_H
@@ -10,10 +10,37 @@
 
 #include <stdbool.h>
 #include "CUnit/Basic.h"
+#include "arena_test.h"
 #include "array_test.h"
 #include "buffer_test.h"
+#include "cdict_test.h"
 #include "dict_test.h"
+#include "frozen_test.h"
+#include "generic_test.h"
+#include "hash_test.h"
+#include "hpp_test.h"
+#include "idict_test.h"
 #include "list_test.h"
+#include "perfect_test.h"
+#include "rdict_test.h"
+
+bool setup_arena_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite_with_setup_and_teardown("Arena Suite", NULL, NULL, arena_test_setup, arena_test_teardown);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Arena Alloc", arena_test_alloc) == NULL) ||
+        (CU_add_test(pSuite, "Arena Realloc", arena_test_realloc) == NULL) ||
+        (CU_add_test(pSuite, "Arena Containers", arena_test_containers) == NULL) ||
+        (CU_add_test(pSuite, "Arena Reset", arena_test_reset) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
 
 bool setup_buffer_tests(void) {
     /* add a suite to the registry */
@@ -33,6 +60,9 @@ bool setup_buffer_tests(void) {
         (CU_add_test(pSuite, "Buffer Equals Char*", buf_test_equals_char) == NULL) ||
         (CU_add_test(pSuite, "Buffer To Char*", buf_test_to_char_array) == NULL) ||
         (CU_add_test(pSuite, "Buffer Compare", buf_test_compare) == NULL) ||
+        (CU_add_test(pSuite, "Buffer Running Hash", buf_test_running_hash) == NULL) ||
+        (CU_add_test(pSuite, "Buffer Hash Cache", buf_test_hash_cache) == NULL) ||
+        (CU_add_test(pSuite, "Buffer Hash Threads", buf_test_hash_threads) == NULL) ||
         (CU_add_test(pSuite, "Buffer Compare as UTF-8", buf_test_compare_utf8) == NULL)) {
         return false;
     }
@@ -40,6 +70,24 @@ bool setup_buffer_tests(void) {
     return true;
 }
 
+bool setup_cdict_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Concurrent Dictionary Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Concurrent Dict Put/Get/Del", cdict_test_basic) == NULL) ||
+        (CU_add_test(pSuite, "Concurrent Dict Threads", cdict_test_threads) == NULL) ||
+        (CU_add_test(pSuite, "Concurrent Dict Iterator", cdict_test_iter) == NULL) ||
+        (CU_add_test(pSuite, "Concurrent Dict Allocator", cdict_test_allocator) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
 bool setup_dict_tests(void)  {
     /* add a suite to the registry */
     CU_pSuite pSuite = CU_add_suite_with_setup_and_teardown("Dictionary Suite", NULL, NULL, dict_test_setup, dict_test_teardown);
@@ -53,7 +101,21 @@ bool setup_dict_tests(void)  {
         (CU_add_test(pSuite, "Dict Get", dict_test_get) == NULL) ||
         (CU_add_test(pSuite, "Dict Del", dict_test_del) == NULL) ||
         (CU_add_test(pSuite, "Dict Resize", dict_test_resize) == NULL) ||
-        (CU_add_test(pSuite, "Dict Iterator", dict_test_iter) == NULL)) {
+        (CU_add_test(pSuite, "Dict Iterator", dict_test_iter) == NULL) ||
+        (CU_add_test(pSuite, "Dict Prime Moduli", dict_test_prime_moduli) == NULL) ||
+        (CU_add_test(pSuite, "Dict Incremental Resize", dict_test_incremental_resize) == NULL) ||
+        (CU_add_test(pSuite, "Dict Del Collision", dict_test_del_collision) == NULL) ||
+        (CU_add_test(pSuite, "Dict Open Addressing", dict_test_open_addressing) == NULL) ||
+        (CU_add_test(pSuite, "Dict Allocator", dict_test_allocator) == NULL) ||
+        (CU_add_test(pSuite, "Dict Get/Put Many", dict_test_many) == NULL) ||
+        (CU_add_test(pSuite, "Dict Hashed", dict_test_hashed) == NULL) ||
+        (CU_add_test(pSuite, "Dict Upsert", dict_test_upsert) == NULL) ||
+        (CU_add_test(pSuite, "Dict Sizing", dict_test_sizing) == NULL) ||
+        (CU_add_test(pSuite, "Dict Stats", dict_test_stats) == NULL) ||
+        (CU_add_test(pSuite, "Dict Ordered", dict_test_ordered) == NULL) ||
+        (CU_add_test(pSuite, "Dict Cuckoo", dict_test_cuckoo) == NULL) ||
+        (CU_add_test(pSuite, "Dict 64-bit Hash", dict_test_hash64) == NULL) ||
+        (CU_add_test(pSuite, "Dict Iterator Lifetime", dict_test_iter_lifetime) == NULL)) {
         return false;
     }
 
@@ -89,6 +151,97 @@ bool setup_array_tests(void)  {
     return true;
 }
 
+bool setup_frozen_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Frozen Dictionary Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Frozen Dict Round Trip", frozen_test_roundtrip) == NULL) ||
+        (CU_add_test(pSuite, "Frozen Dict Replace", frozen_test_replace) == NULL) ||
+        (CU_add_test(pSuite, "Frozen Dict Empty", frozen_test_empty) == NULL) ||
+        (CU_add_test(pSuite, "Frozen Dict Invalid Files", frozen_test_invalid) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool setup_generic_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Generic Container Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Generic Vec", generic_test_vec) == NULL) ||
+        (CU_add_test(pSuite, "Generic Dict", generic_test_dict) == NULL) ||
+        (CU_add_test(pSuite, "Generic Dict Random Operations", generic_test_dict_random) == NULL) ||
+        (CU_add_test(pSuite, "Generic Allocator", generic_test_alloc) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool setup_hash_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Hash Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Hash wyhash", hash_test_wyhash) == NULL) ||
+        (CU_add_test(pSuite, "Hash wyhash Streaming", hash_test_wyhash_stream) == NULL) ||
+        (CU_add_test(pSuite, "Hash CRC32C", hash_test_crc32c) == NULL) ||
+        (CU_add_test(pSuite, "Hash u64", hash_test_u64) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool setup_hpp_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("C++ Facade Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "C++ Buffer", hpp_test_buffer) == NULL) ||
+        (CU_add_test(pSuite, "C++ Array", hpp_test_array) == NULL) ||
+        (CU_add_test(pSuite, "C++ Array Growth", hpp_test_array_growth) == NULL) ||
+        (CU_add_test(pSuite, "C++ Dict", hpp_test_dict) == NULL) ||
+        (CU_add_test(pSuite, "C++ Dict Random Operations", hpp_test_dict_random) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool setup_idict_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Integer Dictionary Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Int Dict Put/Get/Del", idict_test_basic) == NULL) ||
+        (CU_add_test(pSuite, "Int Dict Random Operations", idict_test_random) == NULL) ||
+        (CU_add_test(pSuite, "Int Dict Iterator", idict_test_iter) == NULL) ||
+        (CU_add_test(pSuite, "Int Dict Sizing", idict_test_sizing) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
 bool setup_list_test(void) {
     /* add a suite to the registry */
     CU_pSuite pSuite = CU_add_suite_with_setup_and_teardown("List Suite", NULL, NULL, list_test_setup, list_test_teardown);
@@ -108,6 +261,8 @@ bool setup_list_test(void) {
         (CU_add_test(pSuite, "List Reverse", list_test_reverse) == NULL) ||
         (CU_add_test(pSuite, "List Clear", list_test_clear) == NULL) ||
         (CU_add_test(pSuite, "List Enqueue/Dequeue", list_test_queue) == NULL) ||
+        (CU_add_test(pSuite, "List Node Reuse", list_test_node_reuse) == NULL) ||
+        (CU_add_test(pSuite, "List Allocator", list_test_allocator) == NULL) ||
         (CU_add_test(pSuite, "List Iterator", list_test_iter) == NULL)) {
         return false;
     }
@@ -115,6 +270,44 @@ bool setup_list_test(void) {
     return true;
 }
 
+bool setup_perfect_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Perfect Hash Dictionary Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Perfect Dict Build/Get", perfect_test_basic) == NULL) ||
+        (CU_add_test(pSuite, "Perfect Dict Hash Collisions", perfect_test_collisions) == NULL) ||
+        (CU_add_test(pSuite, "Perfect Dict Duplicate Keys", perfect_test_duplicates) == NULL) ||
+        (CU_add_test(pSuite, "Perfect Dict Sizes", perfect_test_sizes) == NULL) ||
+        (CU_add_test(pSuite, "Perfect Dict Allocator", perfect_test_allocator) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool setup_rdict_tests(void) {
+    /* add a suite to the registry */
+    CU_pSuite pSuite = CU_add_suite("Read-Mostly Dictionary Suite", NULL, NULL);
+    if (pSuite == NULL) {
+        return false;
+    }
+
+    /* add the tests to the suite */
+    if ((CU_add_test(pSuite, "Read-Mostly Dict Put/Get/Del", rdict_test_basic) == NULL) ||
+        (CU_add_test(pSuite, "Read-Mostly Dict Reclamation", rdict_test_reclaim) == NULL) ||
+        (CU_add_test(pSuite, "Read-Mostly Dict Threads", rdict_test_threads) == NULL) ||
+        (CU_add_test(pSuite, "Read-Mostly Dict Synchronize", rdict_test_synchronize) == NULL) ||
+        (CU_add_test(pSuite, "Read-Mostly Dict Allocator", rdict_test_allocator) == NULL)) {
+        return false;
+    }
+
+    return true;
+}
+
 int main(int argc, const char* argv[]) {
     /* Initialize the CUnit test registry */
     if (CU_initialize_registry() != CUE_SUCCESS) {
@@ -122,10 +315,19 @@ int main(int argc, const char* argv[]) {
     }
 
     /* Add test suites to the registry */
-    if ((!setup_array_tests()) ||
+    if ((!setup_arena_tests()) ||
+        (!setup_array_tests()) ||
         (!setup_buffer_tests()) ||
+        (!setup_cdict_tests()) ||
         (!setup_dict_tests()) ||
-        (!setup_list_test()))
+        (!setup_frozen_tests()) ||
+        (!setup_generic_tests()) ||
+        (!setup_hash_tests()) ||
+        (!setup_hpp_tests()) ||
+        (!setup_idict_tests()) ||
+        (!setup_list_test()) ||
+        (!setup_perfect_tests()) ||
+        (!setup_rdict_tests()))
     {
         goto cleanup_main;
     }
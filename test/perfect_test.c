@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * libds :: perfect_test.c
+ *
+ * Test functions for perfect hash dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "CUnit/CUnit.h"
+#include "libds/perfect.h"
+#include "perfect_test.h"
+
+enum { PERFECT_TEST_KEYS = 5000 };
+
+static int perfect_test_keys[PERFECT_TEST_KEYS * 2];
+static void *perfect_test_kptrs[PERFECT_TEST_KEYS];
+static void *perfect_test_vptrs[PERFECT_TEST_KEYS];
+static size_t perfect_test_visited = 0;
+
+struct perfect_test_counts {
+    size_t allocs;
+    size_t frees;
+    size_t live;
+};
+
+static void perfect_test_fill(size_t n, size_t stride);
+static bool perfect_test_check(const DSPerfectDict *dict, size_t n);
+static uint32_t perfect_test_hash(void *key);
+static uint32_t perfect_test_weak_hash(void *key);
+static int perfect_test_compare(const void *left, const void *right);
+static void perfect_test_visit(const void *key, void *val);
+static void *perfect_test_alloc(void *ctx, size_t size);
+static void perfect_test_free(void *ctx, void *ptr, size_t size);
+
+void perfect_test_basic(void) {
+    perfect_test_fill(PERFECT_TEST_KEYS, 1);
+    DSPerfectDict *dict = dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, PERFECT_TEST_KEYS,
+                                               perfect_test_hash, perfect_test_compare);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dsperfect_count(dict) == PERFECT_TEST_KEYS);
+    CU_ASSERT(perfect_test_check(dict, PERFECT_TEST_KEYS));
+
+    // Keys which were never added are not found
+    for (int i = PERFECT_TEST_KEYS; i < PERFECT_TEST_KEYS * 2; i++) {
+        CU_ASSERT(dsperfect_get(dict, &perfect_test_keys[i]) == NULL);
+    }
+    CU_ASSERT(dsperfect_get(dict, NULL) == NULL);
+
+    perfect_test_visited = 0;
+    dsperfect_foreach(dict, perfect_test_visit);
+    CU_ASSERT(perfect_test_visited == PERFECT_TEST_KEYS);
+    dsperfect_destroy(dict);
+}
+
+void perfect_test_collisions(void) {
+    // Only 13 distinct hash values, so nearly every key shares its hash
+    // with many others and is reached through the slot of its group
+    perfect_test_fill(1000, 1);
+    DSPerfectDict *dict = dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, 1000,
+                                               perfect_test_weak_hash, perfect_test_compare);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dsperfect_count(dict) == 1000);
+    CU_ASSERT(perfect_test_check(dict, 1000));
+    for (int i = 1000; i < 2000; i++) {
+        CU_ASSERT(dsperfect_get(dict, &perfect_test_keys[i]) == NULL);
+    }
+
+    perfect_test_visited = 0;
+    dsperfect_foreach(dict, perfect_test_visit);
+    CU_ASSERT(perfect_test_visited == 1000);
+    dsperfect_destroy(dict);
+}
+
+void perfect_test_duplicates(void) {
+    // Every key appears twice; the second value wins
+    perfect_test_fill(PERFECT_TEST_KEYS, 1);
+    static int later[PERFECT_TEST_KEYS];
+    for (size_t i = 0; i < PERFECT_TEST_KEYS / 2; i++) {
+        size_t dup = i + (PERFECT_TEST_KEYS / 2);
+        later[i] = (int)i;
+        perfect_test_kptrs[dup] = &later[i];
+        perfect_test_vptrs[dup] = &later[i];
+    }
+
+    DSPerfectDict *dict = dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, PERFECT_TEST_KEYS,
+                                               perfect_test_hash, perfect_test_compare);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dsperfect_count(dict) == PERFECT_TEST_KEYS / 2);
+    for (int i = 0; i < PERFECT_TEST_KEYS / 2; i++) {
+        CU_ASSERT(dsperfect_get(dict, &perfect_test_keys[i]) == &later[i]);
+    }
+    CU_ASSERT(dsperfect_get(dict, &perfect_test_keys[PERFECT_TEST_KEYS / 2]) == NULL);
+    dsperfect_destroy(dict);
+
+    // The same with colliding hashes
+    dict = dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, PERFECT_TEST_KEYS,
+                                perfect_test_weak_hash, perfect_test_compare);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dsperfect_count(dict) == PERFECT_TEST_KEYS / 2);
+    for (int i = 0; i < PERFECT_TEST_KEYS / 2; i++) {
+        CU_ASSERT(dsperfect_get(dict, &perfect_test_keys[i]) == &later[i]);
+    }
+    perfect_test_visited = 0;
+    dsperfect_foreach(dict, perfect_test_visit);
+    CU_ASSERT(perfect_test_visited == PERFECT_TEST_KEYS / 2);
+    dsperfect_destroy(dict);
+}
+
+void perfect_test_sizes(void) {
+    // Small and sparse key sets, including the empty set
+    for (size_t n = 0; n <= 300; n++) {
+        perfect_test_fill(n, 7);
+        DSPerfectDict *dict = dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, n,
+                                                   perfect_test_hash, perfect_test_compare);
+        CU_ASSERT_FATAL(dict != NULL);
+        CU_ASSERT(dsperfect_count(dict) == n);
+        CU_ASSERT(perfect_test_check(dict, n));
+        CU_ASSERT(dsperfect_get(dict, &perfect_test_keys[1]) == NULL);
+        dsperfect_destroy(dict);
+    }
+
+    perfect_test_fill(10, 1);
+    CU_ASSERT(dsdict_build_perfect(NULL, perfect_test_vptrs, 10, perfect_test_hash, perfect_test_compare) == NULL);
+    CU_ASSERT(dsdict_build_perfect(perfect_test_kptrs, NULL, 10, perfect_test_hash, perfect_test_compare) == NULL);
+    CU_ASSERT(dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, 10, NULL, perfect_test_compare) == NULL);
+    CU_ASSERT(dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, 10, perfect_test_hash, NULL) == NULL);
+    perfect_test_kptrs[5] = NULL;
+    CU_ASSERT(dsdict_build_perfect(perfect_test_kptrs, perfect_test_vptrs, 10, perfect_test_hash, perfect_test_compare) == NULL);
+    dsperfect_destroy(NULL);
+}
+
+void perfect_test_allocator(void) {
+    // The table and all of the scratch space used to build it come from
+    // the given allocator, and are returned with the sizes they had
+    perfect_test_fill(1000, 1);
+    struct perfect_test_counts counts = { 0, 0, 0 };
+    DSAllocator alloc = { perfect_test_alloc, NULL, NULL, perfect_test_free, &counts };
+    DSPerfectDict *dict = dsdict_build_perfect_alloc(perfect_test_kptrs, perfect_test_vptrs, 1000,
+                                                     perfect_test_weak_hash, perfect_test_compare, &alloc);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(perfect_test_check(dict, 1000));
+    CU_ASSERT(counts.allocs > 3);
+    dsperfect_destroy(dict);
+    CU_ASSERT(counts.allocs == counts.frees);
+    CU_ASSERT(counts.live == 0);
+
+    // Key counts whose scratch space would overflow are refused before
+    // anything is allocated
+    CU_ASSERT(dsdict_build_perfect_alloc(perfect_test_kptrs, perfect_test_vptrs, SIZE_MAX,
+                                         perfect_test_hash, perfect_test_compare, &alloc) == NULL);
+    CU_ASSERT(counts.allocs == counts.frees);
+
+    DSAllocator invalid = { NULL, NULL, NULL, NULL, NULL };
+    CU_ASSERT(dsdict_build_perfect_alloc(perfect_test_kptrs, perfect_test_vptrs, 10,
+                                         perfect_test_hash, perfect_test_compare, &invalid) == NULL);
+}
+
+// Use the keys 0, stride, 2*stride, ... mapping each to itself. The keys
+// array holds every integer up to twice the number of keys.
+static void perfect_test_fill(size_t n, size_t stride) {
+    for (int i = 0; i < PERFECT_TEST_KEYS * 2; i++) {
+        perfect_test_keys[i] = i;
+    }
+    for (size_t i = 0; i < n; i++) {
+        size_t k = (i * stride) % (PERFECT_TEST_KEYS * 2);
+        perfect_test_kptrs[i] = &perfect_test_keys[k];
+        perfect_test_vptrs[i] = &perfect_test_keys[k];
+    }
+}
+
+// Check that each of the first n keys maps to its value.
+static bool perfect_test_check(const DSPerfectDict *dict, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int key = *(int *)perfect_test_kptrs[i];
+        if (dsperfect_get(dict, &key) != perfect_test_vptrs[i]) { return false; }
+    }
+    return true;
+}
+
+static uint32_t perfect_test_hash(void *key) {
+    uint32_t h = (uint32_t)(*(int *)key);
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static uint32_t perfect_test_weak_hash(void *key) {
+    return (uint32_t)(*(int *)key % 13);
+}
+
+static int perfect_test_compare(const void *left, const void *right) {
+    return *(const int *)left - *(const int *)right;
+}
+
+static void perfect_test_visit(const void *key, void *val) {
+    if (*(const int *)key == *(int *)val) {
+        perfect_test_visited++;
+    }
+}
+
+// Counting allocator which tracks the number of live bytes allocated,
+// using the sizes passed back in by the dictionary.
+static void *perfect_test_alloc(void *ctx, size_t size) {
+    struct perfect_test_counts *counts = ctx;
+    counts->allocs++;
+    counts->live += size;
+    return malloc(size);
+}
+
+static void perfect_test_free(void *ctx, void *ptr, size_t size) {
+    struct perfect_test_counts *counts = ctx;
+    counts->frees++;
+    counts->live -= size;
+    free(ptr);
+}
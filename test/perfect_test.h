@@ -0,0 +1,20 @@
+/*****************************************************************************
+ * libds :: perfect_test.h
+ *
+ * Test functions for perfect hash dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_PERFECT_TEST_H
+#define LIBDS_PERFECT_TEST_H
+
+void perfect_test_basic(void);
+void perfect_test_collisions(void);
+void perfect_test_duplicates(void);
+void perfect_test_sizes(void);
+void perfect_test_allocator(void);
+
+#endif //LIBDS_PERFECT_TEST_H
@@ -0,0 +1,363 @@
+/*****************************************************************************
+ * libds :: rdict_test.c
+ *
+ * Test functions for read-mostly dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "CUnit/CUnit.h"
+#include "libds/buffer.h"
+#include "libds/rdict.h"
+#include "rdict_test.h"
+
+enum { RDICT_TEST_READERS = 4, RDICT_TEST_KEYS = 1000, RDICT_TEST_ROUNDS = 20 };
+
+struct rdict_test_reader {
+    DSReadDict *dict;
+    int *keys;
+    int *alts;
+    bool *done;
+    size_t errors;
+};
+
+struct rdict_test_writer {
+    DSReadDict *dict;
+    int *key;
+    bool entered;
+    bool wrote;
+};
+
+struct rdict_test_counts {
+    size_t allocs;
+    size_t frees;
+    size_t live;
+};
+
+static size_t rdict_test_freed = 0;
+
+static uint32_t rdict_test_hash(void *key);
+static int rdict_test_compare(const void *left, const void *right);
+static void rdict_test_counting_free(void *val);
+static void *rdict_test_reader(void *arg);
+static void *rdict_test_writing_reader(void *arg);
+static void *rdict_test_alloc(void *ctx, size_t size);
+static void *rdict_test_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+static void rdict_test_free(void *ctx, void *ptr, size_t size);
+
+void rdict_test_basic(void) {
+    DSReadDict *dict = dsrdict_new(dsbuf_dict_hash, dsbuf_dict_compare,
+                                   (dsdict_free_fn) dsbuf_destroy,
+                                   (dsdict_free_fn) dsbuf_destroy);
+    CU_ASSERT_FATAL(dict != NULL);
+    DSReadDictReader *reader = dsrdict_reader_new(dict);
+    CU_ASSERT_FATAL(reader != NULL);
+    CU_ASSERT(dsrdict_count(dict) == 0);
+
+    for (int i = 0; i < 500; i++) {
+        char key[32];
+        sprintf(key, "Key %d", i);
+        CU_ASSERT(dsrdict_put(dict, dsbuf_new(key), dsbuf_new(key)));
+    }
+    CU_ASSERT(dsrdict_count(dict) == 500);
+
+    dsrdict_read_begin(reader);
+    for (int i = 0; i < 500; i++) {
+        char key[32];
+        sprintf(key, "Key %d", i);
+        DSBuffer *probe = dsbuf_new(key);
+        CU_ASSERT_FATAL(probe != NULL);
+        DSBuffer *val = dsrdict_get(reader, probe);
+        CU_ASSERT_FATAL(val != NULL);
+        CU_ASSERT(dsbuf_equals_char(val, key));
+
+        // Deleted values stay readable until the read section ends
+        if (i % 2 == 1) {
+            CU_ASSERT(dsrdict_del(dict, probe));
+            CU_ASSERT(!dsrdict_del(dict, probe));
+            CU_ASSERT(dsrdict_get(reader, probe) == NULL);
+            CU_ASSERT(dsbuf_equals_char(val, key));
+        }
+        dsbuf_destroy(probe);
+    }
+    dsrdict_read_end(reader);
+    CU_ASSERT(dsrdict_count(dict) == 250);
+
+    // Overwriting a key keeps the original key and replaces the value
+    DSBuffer *probe = dsbuf_new("Key 0");
+    CU_ASSERT_FATAL(probe != NULL);
+    CU_ASSERT(dsrdict_put(dict, probe, dsbuf_new("Value 0")));
+    CU_ASSERT(dsrdict_count(dict) == 250);
+    CU_ASSERT(dsbuf_equals_char(dsrdict_get(reader, probe), "Value 0"));
+    dsbuf_destroy(probe);
+
+    CU_ASSERT(dsrdict_get(reader, NULL) == NULL);
+    CU_ASSERT(!dsrdict_put(dict, NULL, NULL));
+    CU_ASSERT(!dsrdict_del(dict, NULL));
+    CU_ASSERT(dsrdict_new(NULL, dsbuf_dict_compare, NULL, NULL) == NULL);
+
+    // Readers which were never destroyed are freed with the dictionary
+    CU_ASSERT(dsrdict_reader_new(dict) != NULL);
+    dsrdict_reader_destroy(reader);
+    dsrdict_destroy(dict);
+}
+
+void rdict_test_reclaim(void) {
+    static int keys[RDICT_TEST_KEYS];
+    for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+        keys[i] = i;
+    }
+
+    rdict_test_freed = 0;
+    DSReadDict *dict = dsrdict_new(rdict_test_hash, rdict_test_compare, NULL, rdict_test_counting_free);
+    CU_ASSERT_FATAL(dict != NULL);
+    DSReadDictReader *reader = dsrdict_reader_new(dict);
+    CU_ASSERT_FATAL(reader != NULL);
+
+    for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+        int *val = malloc(sizeof(int));
+        CU_ASSERT_FATAL(val != NULL);
+        *val = i;
+        CU_ASSERT(dsrdict_put(dict, &keys[i], val));
+    }
+
+    // Nothing read inside the section may be freed until it ends, even as
+    // writers overwrite, delete and resize the table
+    dsrdict_read_begin(reader);
+    int *held = dsrdict_get(reader, &keys[7]);
+    CU_ASSERT_FATAL(held != NULL);
+    dsrdict_read_begin(reader);
+    dsrdict_read_end(reader);
+    for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsrdict_del(dict, &keys[i]));
+    }
+    CU_ASSERT(dsrdict_count(dict) == 0);
+    CU_ASSERT(rdict_test_freed == 0);
+    CU_ASSERT(*held == 7);
+    dsrdict_read_end(reader);
+
+    dsrdict_synchronize(dict);
+    CU_ASSERT(rdict_test_freed == RDICT_TEST_KEYS);
+
+    // Outside of any read section memory is reclaimed by the next write
+    for (int i = 0; i < 10; i++) {
+        int *val = malloc(sizeof(int));
+        CU_ASSERT_FATAL(val != NULL);
+        *val = i;
+        CU_ASSERT(dsrdict_put(dict, &keys[0], val));
+    }
+    CU_ASSERT(rdict_test_freed == RDICT_TEST_KEYS + 9);
+
+    dsrdict_reader_destroy(reader);
+    dsrdict_destroy(dict);
+    CU_ASSERT(rdict_test_freed == RDICT_TEST_KEYS + 10);
+}
+
+void rdict_test_threads(void) {
+    static int keys[RDICT_TEST_KEYS * 2];
+    static int alts[RDICT_TEST_KEYS * 2];
+    for (int i = 0; i < RDICT_TEST_KEYS * 2; i++) {
+        keys[i] = i;
+        alts[i] = i;
+    }
+
+    DSReadDict *dict = dsrdict_new(rdict_test_hash, rdict_test_compare, NULL, NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsrdict_put(dict, &keys[i], &keys[i]));
+    }
+
+    // Readers check that the first half of the keys are always present
+    // while the writer flips their values and adds and removes the second
+    // half, growing the table each round
+    bool done = false;
+    pthread_t threads[RDICT_TEST_READERS];
+    struct rdict_test_reader readers[RDICT_TEST_READERS];
+    for (int t = 0; t < RDICT_TEST_READERS; t++) {
+        readers[t].dict = dict;
+        readers[t].keys = keys;
+        readers[t].alts = alts;
+        readers[t].done = &done;
+        readers[t].errors = 0;
+        CU_ASSERT_FATAL(pthread_create(&threads[t], NULL, rdict_test_reader, &readers[t]) == 0);
+    }
+
+    for (int round = 0; round < RDICT_TEST_ROUNDS; round++) {
+        for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+            int *vals = (round % 2 == 0) ? alts : keys;
+            CU_ASSERT(dsrdict_put(dict, &keys[i], &vals[i]));
+            CU_ASSERT(dsrdict_put(dict, &keys[RDICT_TEST_KEYS + i], &keys[RDICT_TEST_KEYS + i]));
+        }
+        for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+            CU_ASSERT(dsrdict_del(dict, &keys[RDICT_TEST_KEYS + i]));
+        }
+    }
+
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    for (int t = 0; t < RDICT_TEST_READERS; t++) {
+        pthread_join(threads[t], NULL);
+        CU_ASSERT(readers[t].errors == 0);
+    }
+
+    CU_ASSERT(dsrdict_count(dict) == RDICT_TEST_KEYS);
+    dsrdict_synchronize(dict);
+    dsrdict_destroy(dict);
+}
+
+void rdict_test_synchronize(void) {
+    int keys[2] = { 1, 2 };
+    DSReadDict *dict = dsrdict_new(rdict_test_hash, rdict_test_compare, NULL, NULL);
+    CU_ASSERT_FATAL(dict != NULL);
+    CU_ASSERT(dsrdict_put(dict, &keys[0], &keys[0]));
+
+    // The reader writes to the dictionary from inside its read section
+    // while this thread is waiting on that same read section to end
+    struct rdict_test_writer state = { dict, &keys[1], false, false };
+    pthread_t thread;
+    CU_ASSERT_FATAL(pthread_create(&thread, NULL, rdict_test_writing_reader, &state) == 0);
+    while (!__atomic_load_n(&state.entered, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+
+    CU_ASSERT(dsrdict_del(dict, &keys[0]));
+    dsrdict_synchronize(dict);
+    pthread_join(thread, NULL);
+    CU_ASSERT(state.wrote);
+    CU_ASSERT(dsrdict_count(dict) == 1);
+    dsrdict_destroy(dict);
+}
+
+void rdict_test_allocator(void) {
+    static int keys[RDICT_TEST_KEYS];
+    for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+        keys[i] = i;
+    }
+
+    // Tables, nodes, readers and the retire queue all come from the
+    // given allocator, and are all returned with the sizes they had
+    struct rdict_test_counts counts = { 0, 0, 0 };
+    DSAllocator alloc = { rdict_test_alloc, NULL, rdict_test_realloc, rdict_test_free, &counts };
+    DSReadDict *dict = dsrdict_new_alloc(rdict_test_hash, rdict_test_compare, NULL, NULL, &alloc);
+    CU_ASSERT_FATAL(dict != NULL);
+    DSReadDictReader *reader = dsrdict_reader_new(dict);
+    CU_ASSERT_FATAL(reader != NULL);
+
+    for (int i = 0; i < RDICT_TEST_KEYS; i++) {
+        CU_ASSERT(dsrdict_put(dict, &keys[i], &keys[i]));
+    }
+    for (int i = 0; i < RDICT_TEST_KEYS; i += 2) {
+        CU_ASSERT(dsrdict_del(dict, &keys[i]));
+    }
+    CU_ASSERT(dsrdict_get(reader, &keys[1]) == &keys[1]);
+    CU_ASSERT(dsrdict_count(dict) == RDICT_TEST_KEYS / 2);
+    dsrdict_synchronize(dict);
+
+    dsrdict_reader_destroy(reader);
+    dsrdict_destroy(dict);
+    CU_ASSERT(counts.allocs == counts.frees);
+    CU_ASSERT(counts.live == 0);
+
+    DSAllocator invalid = { NULL, NULL, NULL, NULL, NULL };
+    CU_ASSERT(dsrdict_new_alloc(rdict_test_hash, rdict_test_compare, NULL, NULL, &invalid) == NULL);
+}
+
+/*
+ * PRIVATE FUNCTIONS
+ */
+
+static uint32_t rdict_test_hash(void *key) {
+    return (uint32_t)(*(int *)key) * 2654435761u;
+}
+
+static int rdict_test_compare(const void *left, const void *right) {
+    return *(const int *)left - *(const int *)right;
+}
+
+// Free function which counts the values it frees.
+static void rdict_test_counting_free(void *val) {
+    rdict_test_freed++;
+    free(val);
+}
+
+// Repeatedly read every key from one thread until the writer is done.
+static void *rdict_test_reader(void *arg) {
+    struct rdict_test_reader *state = arg;
+    DSReadDictReader *reader = dsrdict_reader_new(state->dict);
+    if (!reader) {
+        state->errors++;
+        return NULL;
+    }
+
+    while (!__atomic_load_n(state->done, __ATOMIC_ACQUIRE)) {
+        dsrdict_read_begin(reader);
+        for (int i = 0; i < RDICT_TEST_KEYS * 2; i++) {
+            int *val = dsrdict_get(reader, &state->keys[i]);
+            if ((i < RDICT_TEST_KEYS) && (!val)) {
+                state->errors++;
+            } else if ((val) && (val != &state->keys[i]) && (val != &state->alts[i])) {
+                state->errors++;
+            }
+        }
+        dsrdict_read_end(reader);
+    }
+
+    dsrdict_reader_destroy(reader);
+    return NULL;
+}
+
+// Enter a read section, then write to the dictionary before leaving it.
+static void *rdict_test_writing_reader(void *arg) {
+    struct rdict_test_writer *state = arg;
+    DSReadDictReader *reader = dsrdict_reader_new(state->dict);
+    if (!reader) {
+        __atomic_store_n(&state->entered, true, __ATOMIC_RELEASE);
+        return NULL;
+    }
+
+    dsrdict_read_begin(reader);
+    __atomic_store_n(&state->entered, true, __ATOMIC_RELEASE);
+    struct timespec pause = { 0, 10 * 1000 * 1000 };
+    nanosleep(&pause, NULL);
+    state->wrote = dsrdict_put(state->dict, state->key, state->key);
+    dsrdict_read_end(reader);
+
+    dsrdict_reader_destroy(reader);
+    return NULL;
+}
+
+// Counting allocator which tracks the number of live bytes allocated,
+// using the sizes passed back in by the dictionary.
+static void *rdict_test_alloc(void *ctx, size_t size) {
+    struct rdict_test_counts *counts = ctx;
+    counts->allocs++;
+    counts->live += size;
+    return malloc(size);
+}
+
+static void *rdict_test_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+    struct rdict_test_counts *counts = ctx;
+    if (!ptr) {
+        return rdict_test_alloc(ctx, newsize);
+    }
+    void *resized = realloc(ptr, newsize);
+    if (resized) {
+        counts->live = counts->live - oldsize + newsize;
+    }
+    return resized;
+}
+
+static void rdict_test_free(void *ctx, void *ptr, size_t size) {
+    struct rdict_test_counts *counts = ctx;
+    counts->frees++;
+    counts->live -= size;
+    free(ptr);
+}
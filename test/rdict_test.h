@@ -0,0 +1,20 @@
+/*****************************************************************************
+ * libds :: rdict_test.h
+ *
+ * Test functions for read-mostly dictionary data type.
+ *
+ * Author:  Chris Rink <chrisrink10@gmail.com>
+ *
+ * License: MIT (see LICENSE document at source tree root)
+ *****************************************************************************/
+
+#ifndef LIBDS_RDICT_TEST_H
+#define LIBDS_RDICT_TEST_H
+
+void rdict_test_basic(void);
+void rdict_test_reclaim(void);
+void rdict_test_threads(void);
+void rdict_test_synchronize(void);
+void rdict_test_allocator(void);
+
+#endif //LIBDS_RDICT_TEST_H